@@ -0,0 +1,197 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include "array.h"
+#include "atomic.h"
+#include "condition_variable.h"
+#include "dstrings.h"
+#include "job_pool.h"
+#include "mutex.h"
+#include "thread.h"
+
+namespace dmJobPool
+{
+    struct JobPool
+    {
+        dmArray<dmThread::Thread>               m_Workers;
+        // Serializes calls to Run
+        dmMutex::HMutex                         m_RunMutex;
+        // Protects the job state below
+        dmMutex::HMutex                         m_Mutex;
+        dmConditionVariable::HConditionVariable m_JobAvailable;
+        dmConditionVariable::HConditionVariable m_WorkersDone;
+
+        JobFunction                             m_Function;
+        void*                                   m_Context;
+        uint32_t                                m_Count;
+        uint32_t                                m_ChunkSize;
+        uint32_t                                m_ChunkCount;
+        // Next chunk to be processed, claimed without locking
+        int32_atomic_t                          m_NextChunk;
+        // Incremented for each new job
+        uint32_t                                m_JobId;
+        // Number of workers currently processing chunks
+        uint32_t                                m_ActiveWorkers;
+        bool                                    m_Quit;
+    };
+
+    static void ProcessChunks(JobPool* pool)
+    {
+        uint32_t chunk_count = pool->m_ChunkCount;
+        uint32_t chunk_size = pool->m_ChunkSize;
+        uint32_t count = pool->m_Count;
+        while (true)
+        {
+            uint32_t chunk = (uint32_t)dmAtomicIncrement32(&pool->m_NextChunk);
+            if (chunk >= chunk_count)
+            {
+                break;
+            }
+            uint32_t begin = chunk * chunk_size;
+            uint32_t end = begin + chunk_size;
+            if (end > count)
+            {
+                end = count;
+            }
+            pool->m_Function(pool->m_Context, begin, end);
+        }
+    }
+
+    static void Worker(void* arg)
+    {
+        JobPool* pool = (JobPool*)arg;
+        uint32_t job_id = 0;
+
+        dmMutex::Lock(pool->m_Mutex);
+        while (true)
+        {
+            while (!pool->m_Quit && pool->m_JobId == job_id)
+            {
+                dmConditionVariable::Wait(pool->m_JobAvailable, pool->m_Mutex);
+            }
+            if (pool->m_Quit)
+            {
+                break;
+            }
+            job_id = pool->m_JobId;
+            ++pool->m_ActiveWorkers;
+            dmMutex::Unlock(pool->m_Mutex);
+
+            ProcessChunks(pool);
+
+            dmMutex::Lock(pool->m_Mutex);
+            if (--pool->m_ActiveWorkers == 0)
+            {
+                dmConditionVariable::Broadcast(pool->m_WorkersDone);
+            }
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+
+    HJobPool New(uint32_t worker_count, const char* name)
+    {
+#if defined(__EMSCRIPTEN__)
+        // No thread support
+        worker_count = 0;
+#endif
+        JobPool* pool = new JobPool;
+        pool->m_RunMutex = dmMutex::New();
+        pool->m_Mutex = dmMutex::New();
+        pool->m_JobAvailable = dmConditionVariable::New();
+        pool->m_WorkersDone = dmConditionVariable::New();
+        pool->m_Function = 0;
+        pool->m_Context = 0;
+        pool->m_Count = 0;
+        pool->m_ChunkSize = 0;
+        pool->m_ChunkCount = 0;
+        pool->m_NextChunk = 0;
+        pool->m_JobId = 0;
+        pool->m_ActiveWorkers = 0;
+        pool->m_Quit = false;
+
+        pool->m_Workers.SetCapacity(worker_count);
+        for (uint32_t i = 0; i < worker_count; ++i)
+        {
+            char thread_name[64];
+            dmSnPrintf(thread_name, sizeof(thread_name), "%s%u", name, i);
+            pool->m_Workers.Push(dmThread::New(Worker, 0x80000, pool, thread_name));
+        }
+        return pool;
+    }
+
+    void Delete(HJobPool pool)
+    {
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Quit = true;
+        dmConditionVariable::Broadcast(pool->m_JobAvailable);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        for (uint32_t i = 0; i < pool->m_Workers.Size(); ++i)
+        {
+            dmThread::Join(pool->m_Workers[i]);
+        }
+
+        dmConditionVariable::Delete(pool->m_WorkersDone);
+        dmConditionVariable::Delete(pool->m_JobAvailable);
+        dmMutex::Delete(pool->m_Mutex);
+        dmMutex::Delete(pool->m_RunMutex);
+        delete pool;
+    }
+
+    uint32_t GetWorkerCount(HJobPool pool)
+    {
+        return pool ? pool->m_Workers.Size() : 0;
+    }
+
+    void Run(HJobPool pool, JobFunction function, void* context, uint32_t count, uint32_t chunk_size)
+    {
+        assert(chunk_size > 0);
+        if (count == 0)
+        {
+            return;
+        }
+        if (GetWorkerCount(pool) == 0 || count <= chunk_size)
+        {
+            function(context, 0, count);
+            return;
+        }
+
+        DM_MUTEX_SCOPED_LOCK(pool->m_RunMutex);
+
+        dmMutex::Lock(pool->m_Mutex);
+        // Workers that woke up too late for the previous job might still be looking at it
+        while (pool->m_ActiveWorkers > 0)
+        {
+            dmConditionVariable::Wait(pool->m_WorkersDone, pool->m_Mutex);
+        }
+        pool->m_Function = function;
+        pool->m_Context = context;
+        pool->m_Count = count;
+        pool->m_ChunkSize = chunk_size;
+        pool->m_ChunkCount = (count + chunk_size - 1) / chunk_size;
+        pool->m_NextChunk = 0;
+        ++pool->m_JobId;
+        dmConditionVariable::Broadcast(pool->m_JobAvailable);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        ProcessChunks(pool);
+
+        // All chunks are claimed at this point, wait for the workers to finish theirs
+        dmMutex::Lock(pool->m_Mutex);
+        while (pool->m_ActiveWorkers > 0)
+        {
+            dmConditionVariable::Wait(pool->m_WorkersDone, pool->m_Mutex);
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_JOB_POOL_H
+#define DM_JOB_POOL_H
+
+#include <stdint.h>
+
+/**
+ * Pool of worker threads for data parallel jobs.
+ * A job is a range of items which is split into chunks, and the chunks are
+ * processed by the workers and the calling thread. Only one job runs at a time.
+ */
+namespace dmJobPool
+{
+    /// Job pool handle
+    typedef struct JobPool* HJobPool;
+
+    /**
+     * Job function, called for each chunk of a job
+     * @param context job context
+     * @param begin first item of the chunk
+     * @param end one past the last item of the chunk
+     */
+    typedef void (*JobFunction)(void* context, uint32_t begin, uint32_t end);
+
+    /**
+     * Create a new job pool
+     * @param worker_count number of worker threads. With zero workers, all jobs are run on the calling thread.
+     * @param name name of the worker threads
+     * @return job pool handle
+     */
+    HJobPool New(uint32_t worker_count, const char* name);
+
+    /**
+     * Delete a job pool, and join its worker threads
+     * @param pool job pool
+     */
+    void Delete(HJobPool pool);
+
+    /**
+     * Get the number of worker threads
+     * @param pool job pool, may be 0x0
+     * @return number of worker threads, zero if the pool is 0x0
+     */
+    uint32_t GetWorkerCount(HJobPool pool);
+
+    /**
+     * Run a job over the items [0, count), split into chunks of chunk_size items.
+     * The calling thread takes part in the job, and the function returns when all
+     * chunks have been processed. The job runs on the calling thread only if the pool
+     * is 0x0, has no workers, or if the job fits in a single chunk.
+     * @param pool job pool, may be 0x0
+     * @param function function to call for each chunk
+     * @param context context passed to the function
+     * @param count number of items
+     * @param chunk_size max number of items per chunk
+     */
+    void Run(HJobPool pool, JobFunction function, void* context, uint32_t count, uint32_t chunk_size);
+}
+
+#endif // DM_JOB_POOL_H
@@ -16,6 +16,7 @@
 #include "atomic.h"
 #include "hash.h"
 #include "hashtable.h"
+#include "index_pool.h"
 #include "profile.h"
 #include "array.h"
 #include "condition_variable.h"
@@ -31,9 +32,11 @@ namespace dmMessage
 
     struct MemoryPage
     {
-        uint8_t     m_Memory[DM_MESSAGE_PAGE_SIZE];
-        uint32_t    m_Current;
-        MemoryPage* m_NextPage;
+        uint8_t        m_Memory[DM_MESSAGE_PAGE_SIZE];
+        uint32_t       m_Current;
+        // Number of messages allocated in the page that are not yet linked into the message list
+        int32_atomic_t m_Pending;
+        MemoryPage*    m_NextPage;
     };
 
     struct MemoryAllocator
@@ -82,12 +85,14 @@ namespace dmMessage
         }
 
         new_page->m_Current = 0;
+        new_page->m_Pending = 0;
         new_page->m_NextPage = 0;
 
         allocator->m_CurrentPage = new_page;
     }
 
-    static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size)
+    // The message is pending in the returned page until the message is linked into the message list
+    static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size, MemoryPage** out_page)
     {
         // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
         size += DM_MESSAGE_ALIGNMENT-1;
@@ -103,35 +108,57 @@ namespace dmMessage
         MemoryPage* page = allocator->m_CurrentPage;
         void* ret = (void*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
         page->m_Current += size;
+        dmAtomicIncrement32(&page->m_Pending);
+        *out_page = page;
         return ret;
     }
 
     struct MessageSocket
     {
-        uint32_t        m_RefCount; // Is protected by "g_MessageContext->m_Spinlock"
-        dmhash_t        m_NameHash;
-        Message*        m_Header;
-        Message*        m_Tail;
-        const char*     m_Name;
-        dmMutex::HMutex m_Mutex;
+        // A socket that has been released by everyone can't be acquired again
+        int32_atomic_t    m_RefCount;
+        // Cleared when the socket is deleted, in order to invalidate cached lookups
+        dmhash_t          m_NameHash;
+        // Posted messages, most recent first. Messages are pushed without locking and
+        // the whole list is taken when dispatching, i.e. there can only be one dispatcher at a time.
+        Message* volatile m_Head;
+        const char*       m_Name;
+        // Number of threads waiting for messages in DispatchBlocking
+        int32_atomic_t    m_Waiting;
+        dmMutex::HMutex   m_Mutex;
         dmConditionVariable::HConditionVariable m_Condition;
-        MemoryAllocator m_Allocator;
+        // Only held while allocating message memory and when recycling pages
+        dmSpinlock::lock_t m_AllocatorLock;
+        MemoryAllocator   m_Allocator;
     };
 
     const uint32_t MAX_SOCKETS = 256;
+    // Number of entries in the socket lookup cache, must be a power of two
+    const uint32_t SOCKET_CACHE_SIZE = 512;
 
     struct MessageContext
     {
-        dmHashTable64<MessageSocket> m_Sockets;
-        dmSpinlock::lock_t m_Spinlock;
+        // The sockets are never moved, which lets the lookup cache refer to them without locking
+        MessageSocket           m_Sockets[MAX_SOCKETS];
+        dmIndexPool16           m_SocketIndices;
+        // Socket name hash to index in m_Sockets
+        dmHashTable64<uint16_t> m_SocketTable;
+        // Socket index + 1, by the lower bits of the socket name hash. Entries might be stale and are verified when used.
+        int32_atomic_t          m_SocketCache[SOCKET_CACHE_SIZE];
+        // Protects m_SocketIndices and m_SocketTable
+        dmSpinlock::lock_t      m_Spinlock;
     };
 
     MessageContext* g_MessageContext = 0;
 
     static MessageContext* Create(uint32_t max_sockets)
     {
+        assert(max_sockets <= MAX_SOCKETS);
         MessageContext* ctx = new MessageContext;
-        ctx->m_Sockets.SetCapacity(max_sockets, max_sockets);
+        memset(ctx->m_Sockets, 0, sizeof(ctx->m_Sockets));
+        memset((void*)ctx->m_SocketCache, 0, sizeof(ctx->m_SocketCache));
+        ctx->m_SocketIndices.SetCapacity(max_sockets);
+        ctx->m_SocketTable.SetCapacity(max_sockets, max_sockets);
         dmSpinlock::Init(&ctx->m_Spinlock);
         return ctx;
     }
@@ -150,6 +177,29 @@ namespace dmMessage
         }
     } g_ContextDestroyer;
 
+    static inline Message* AtomicCompareStorePointer(Message* volatile* ptr, Message* value, Message* comparand)
+    {
+#if defined(_MSC_VER)
+        return (Message*) InterlockedCompareExchangePointer((PVOID volatile*) ptr, value, comparand);
+#else
+        return __sync_val_compare_and_swap(ptr, comparand, value);
+#endif
+    }
+
+    // Messages are linked most recent first, this returns them in the order they were posted
+    static Message* ReverseMessages(Message* message_object)
+    {
+        Message* reversed = 0;
+        while (message_object)
+        {
+            Message* next = message_object->m_Next;
+            message_object->m_Next = reversed;
+            reversed = message_object;
+            message_object = next;
+        }
+        return reversed;
+    }
+
     Result NewSocket(const char* name, HSocket* socket)
     {
         if (g_MessageContext == 0)
@@ -171,21 +221,26 @@ namespace dmMessage
 
         DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
 
-        if (g_MessageContext->m_Sockets.Full())
+        // Deleted sockets keep their slot until the last reference is released
+        if (g_MessageContext->m_SocketTable.Full() || g_MessageContext->m_SocketIndices.Remaining() == 0)
         {
             return RESULT_SOCKET_OUT_OF_RESOURCES;
         }
 
-        MessageSocket s;
-        s.m_RefCount = 1;
-        s.m_Header = 0;
-        s.m_Tail = 0;
-        s.m_NameHash = name_hash;
-        s.m_Name = strdup(name);
-        s.m_Mutex = dmMutex::New();
-        s.m_Condition = dmConditionVariable::New();
-
-        g_MessageContext->m_Sockets.Put(name_hash, s);
+        uint16_t index = g_MessageContext->m_SocketIndices.Pop();
+        MessageSocket* s = &g_MessageContext->m_Sockets[index];
+        s->m_NameHash = name_hash;
+        s->m_Head = 0;
+        s->m_Name = strdup(name);
+        s->m_Waiting = 0;
+        s->m_Mutex = dmMutex::New();
+        s->m_Condition = dmConditionVariable::New();
+        dmSpinlock::Init(&s->m_AllocatorLock);
+        s->m_Allocator = MemoryAllocator();
+        // The socket can be acquired from the lookup cache from here on
+        dmAtomicIncrement32(&s->m_RefCount);
+
+        g_MessageContext->m_SocketTable.Put(name_hash, index);
         *socket = name_hash;
 
         return RESULT_OK;
@@ -193,7 +248,7 @@ namespace dmMessage
 
     static void DisposeSocket(MessageSocket* s)
     {
-        Message *message_object = s->m_Header;
+        Message *message_object = ReverseMessages(s->m_Head);
         while (message_object)
         {
             if (message_object->m_DestroyCallback)
@@ -202,8 +257,10 @@ namespace dmMessage
             }
             message_object = message_object->m_Next;
         }
+        s->m_Head = 0;
 
         free((void*) s->m_Name);
+        s->m_Name = 0;
 
         MemoryPage* p = s->m_Allocator.m_FreePages;
         while (p)
@@ -223,42 +280,80 @@ namespace dmMessage
         {
             delete s->m_Allocator.m_CurrentPage;
         }
+        s->m_Allocator = MemoryAllocator();
 
         dmConditionVariable::Delete(s->m_Condition);
 
         dmMutex::Delete(s->m_Mutex);
 
-        memset(s, 0, sizeof(*s));
+        DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
+        g_MessageContext->m_SocketIndices.Push((uint16_t)(s - g_MessageContext->m_Sockets));
     }
 
     static void ReleaseSocket(MessageSocket* s)
     {
+        if (dmAtomicDecrement32(&s->m_RefCount) == 1)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-            --s->m_RefCount;
+            DisposeSocket(s);
+        }
+    }
 
-            if (s->m_RefCount > 0)
+    // Adds a reference, unless the socket has already been released by everyone
+    static bool TryRetainSocket(MessageSocket* s)
+    {
+        int32_t ref_count = s->m_RefCount;
+        while (ref_count > 0)
+        {
+            int32_t prev = dmAtomicCompareStore32(&s->m_RefCount, ref_count + 1, ref_count);
+            if (prev == ref_count)
             {
-                return;
+                return true;
             }
+            ref_count = prev;
         }
-        DisposeSocket(s);
+        return false;
     }
 
     static MessageSocket* AcquireSocket(HSocket socket)
     {
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
+        MessageContext* ctx = g_MessageContext;
+        if (ctx == 0 || socket == 0)
+        {
+            return 0x0;
+        }
 
-        MessageSocket* s = g_MessageContext->m_Sockets.Get(socket);
+        // Fast path, without taking the global lock
+        int32_atomic_t* cache_entry = &ctx->m_SocketCache[socket & (SOCKET_CACHE_SIZE - 1)];
+        int32_t cached_index = *cache_entry;
+        if (cached_index != 0)
+        {
+            MessageSocket* s = &ctx->m_Sockets[cached_index - 1];
+            if (TryRetainSocket(s))
+            {
+                if (s->m_NameHash == socket)
+                {
+                    return s;
+                }
+                // Deleted, or the slot has been reused by another socket
+                ReleaseSocket(s);
+            }
+        }
 
-        if (s == 0x0)
+        DM_SPINLOCK_SCOPED_LOCK(ctx->m_Spinlock);
+
+        uint16_t* index = ctx->m_SocketTable.Get(socket);
+        if (index == 0x0)
         {
             return 0x0;
         }
 
+        MessageSocket* s = &ctx->m_Sockets[*index];
+
+        // The socket table holds a reference until the socket is deleted
         assert(s->m_RefCount >= 1);
 
-        ++s->m_RefCount;
+        dmAtomicIncrement32(&s->m_RefCount);
+        dmAtomicStore32(cache_entry, *index + 1);
 
         return s;
     }
@@ -268,22 +363,18 @@ namespace dmMessage
         MessageSocket* s = 0x0;
         {
             DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-            s = g_MessageContext->m_Sockets.Get(socket);
-            if (s == 0x0)
+            uint16_t* index = g_MessageContext->m_SocketTable.Get(socket);
+            if (index == 0x0)
             {
                 return RESULT_SOCKET_NOT_FOUND;
             }
 
-            g_MessageContext->m_Sockets.Erase(s->m_NameHash);
-            --s->m_RefCount;
-
-            if(s->m_RefCount > 0)
-            {
-                // Defer deletion
-                return RESULT_OK;
-            }
+            s = &g_MessageContext->m_Sockets[*index];
+            g_MessageContext->m_SocketTable.Erase(socket);
+            s->m_NameHash = 0;
         }
-        DisposeSocket(s);
+        // Deletion is deferred until the last reference is released
+        ReleaseSocket(s);
         return RESULT_OK;
     }
 
@@ -299,11 +390,10 @@ namespace dmMessage
         dmhash_t name_hash = dmHashString64(name);
         *out_socket = name_hash;
 
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-
-        MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(name_hash);
+        MessageSocket* message_socket = AcquireSocket(name_hash);
         if (message_socket)
         {
+            ReleaseSocket(message_socket);
             return RESULT_OK;
         }
         return RESULT_NAME_OK_SOCKET_NOT_FOUND;
@@ -311,12 +401,12 @@ namespace dmMessage
 
     const char* GetSocketName(HSocket socket)
     {
-        DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-
-        MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(socket);
+        MessageSocket* message_socket = AcquireSocket(socket);
         if (message_socket != 0x0)
         {
-            return message_socket->m_Name;
+            const char* name = message_socket->m_Name;
+            ReleaseSocket(message_socket);
+            return name;
         }
         else
         {
@@ -326,11 +416,11 @@ namespace dmMessage
 
     bool IsSocketValid(HSocket socket)
     {
-        if (socket != 0)
+        MessageSocket* message_socket = AcquireSocket(socket);
+        if (message_socket != 0x0)
         {
-            DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
-            MessageSocket* message_socket = g_MessageContext->m_Sockets.Get(socket);
-            return message_socket != 0;
+            ReleaseSocket(message_socket);
+            return true;
         }
         return false;
     }
@@ -343,11 +433,7 @@ namespace dmMessage
         MessageSocket* s = AcquireSocket(socket);
         if (s != 0)
         {
-            bool has_messages;
-            {
-                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
-                has_messages = s->m_Header != 0;
-            }
+            bool has_messages = s->m_Head != 0;
             ReleaseSocket(s);
             return has_messages;
         }
@@ -375,11 +461,13 @@ namespace dmMessage
             return RESULT_SOCKET_NOT_FOUND;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
         uint32_t data_size = sizeof(Message) + message_data_size;
-        Message *new_message = (Message *) AllocateMessage(allocator, data_size);
+        MemoryPage* page;
+        Message *new_message;
+        {
+            DM_SPINLOCK_SCOPED_LOCK(s->m_AllocatorLock);
+            new_message = (Message *) AllocateMessage(&s->m_Allocator, data_size, &page);
+        }
         if (sender != 0x0)
         {
             new_message->m_Sender = *sender;
@@ -393,28 +481,30 @@ namespace dmMessage
         new_message->m_UserData = user_data;
         new_message->m_Descriptor = descriptor;
         new_message->m_DataSize = message_data_size;
-        new_message->m_Next = 0;
         new_message->m_DestroyCallback = destroy_callback;
         memcpy(&new_message->m_Data[0], message_data, message_data_size);
 
-        bool is_first_message = !s->m_Header;
-
-        if (!s->m_Header)
-        {
-            s->m_Header = new_message;
-            s->m_Tail = new_message;
-        }
-        else
+        Message* head = s->m_Head;
+        while (true)
         {
-            s->m_Tail->m_Next = new_message;
-            s->m_Tail = new_message;
+            new_message->m_Next = head;
+            Message* prev = AtomicCompareStorePointer(&s->m_Head, new_message, head);
+            if (prev == head)
+            {
+                break;
+            }
+            head = prev;
         }
 
-        if (is_first_message)
+        // The message is reachable by the dispatcher, which is now free to recycle the page once it's full
+        dmAtomicDecrement32(&page->m_Pending);
+
+        bool is_first_message = head == 0;
+        if (is_first_message && s->m_Waiting > 0)
         {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
             dmConditionVariable::Signal(s->m_Condition);
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
@@ -461,16 +551,20 @@ namespace dmMessage
             return 0;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
         MemoryAllocator* allocator = &s->m_Allocator;
 
-        if (!s->m_Header)
+        if (!s->m_Head)
         {
             if (blocking) {
-                dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                // The waiting count is raised before checking for messages, so that a post either sees it or is seen here
+                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+                dmAtomicIncrement32(&s->m_Waiting);
+                while (!s->m_Head)
+                {
+                    dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                }
+                dmAtomicDecrement32(&s->m_Waiting);
             } else {
-                dmMutex::Unlock(s->m_Mutex);
                 ReleaseSocket(s);
                 return 0;
             }
@@ -482,16 +576,41 @@ namespace dmMessage
 
         uint32_t dispatch_count = 0;
 
-        Message *message_object = s->m_Header;
-        s->m_Header = 0;
-        s->m_Tail = 0;
-
-        // Unlink full pages
-        MemoryPage* full_pages = allocator->m_FullPages;
-        allocator->m_FullPages = 0;
+        // Unlink the full pages with all their messages posted. Pages with messages
+        // still being posted are kept until a later dispatch.
+        MemoryPage* full_pages = 0;
+        {
+            DM_SPINLOCK_SCOPED_LOCK(s->m_AllocatorLock);
+            MemoryPage** page_ptr = &allocator->m_FullPages;
+            while (*page_ptr)
+            {
+                MemoryPage* p = *page_ptr;
+                if (p->m_Pending == 0)
+                {
+                    *page_ptr = p->m_NextPage;
+                    p->m_NextPage = full_pages;
+                    full_pages = p;
+                }
+                else
+                {
+                    page_ptr = &p->m_NextPage;
+                }
+            }
+        }
 
-        dmMutex::Unlock(s->m_Mutex);
+        // Take all messages, which includes every message in the unlinked pages
+        Message* head = s->m_Head;
+        while (true)
+        {
+            Message* prev = AtomicCompareStorePointer(&s->m_Head, 0, head);
+            if (prev == head)
+            {
+                break;
+            }
+            head = prev;
+        }
 
+        Message *message_object = ReverseMessages(head);
         while (message_object)
         {
             dispatch_callback(message_object, user_ptr);
@@ -502,17 +621,19 @@ namespace dmMessage
             dispatch_count++;
         }
 
-        // Reclaim all full pages active when dispatch started
-        dmMutex::Lock(s->m_Mutex);
-        MemoryPage* p = full_pages;
-        while (p)
+        // Reclaim the full pages unlinked when dispatch started
+        if (full_pages)
         {
-            MemoryPage* next = p->m_NextPage;
-            p->m_NextPage = allocator->m_FreePages;
-            allocator->m_FreePages = p;
-            p = next;
+            DM_SPINLOCK_SCOPED_LOCK(s->m_AllocatorLock);
+            MemoryPage* p = full_pages;
+            while (p)
+            {
+                MemoryPage* next = p->m_NextPage;
+                p->m_NextPage = allocator->m_FreePages;
+                allocator->m_FreePages = p;
+                p = next;
+            }
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
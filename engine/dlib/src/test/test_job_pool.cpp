@@ -0,0 +1,105 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <dlib/array.h>
+#include <dlib/atomic.h>
+#include <dlib/job_pool.h>
+
+struct JobContext
+{
+    dmArray<uint32_t> m_Visits;
+    int32_atomic_t    m_ChunkCount;
+};
+
+static void CountVisits(void* context, uint32_t begin, uint32_t end)
+{
+    JobContext* ctx = (JobContext*)context;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        ctx->m_Visits[i]++;
+    }
+    dmAtomicIncrement32(&ctx->m_ChunkCount);
+}
+
+static void RunJobs(dmJobPool::HJobPool pool, uint32_t count, uint32_t chunk_size, uint32_t iterations)
+{
+    JobContext ctx;
+    ctx.m_Visits.SetCapacity(count);
+    ctx.m_Visits.SetSize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ctx.m_Visits[i] = 0;
+    }
+    ctx.m_ChunkCount = 0;
+
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        dmJobPool::Run(pool, CountVisits, &ctx, count, chunk_size);
+    }
+
+    // Each item is processed exactly once per job
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(iterations, ctx.m_Visits[i]);
+    }
+    // Empty jobs aren't run at all
+    uint32_t expected_chunks = count > 0 ? 1 : 0;
+    if (dmJobPool::GetWorkerCount(pool) > 0 && count > chunk_size)
+    {
+        expected_chunks = (count + chunk_size - 1) / chunk_size;
+    }
+    ASSERT_EQ((int32_t)(expected_chunks * iterations), ctx.m_ChunkCount);
+}
+
+TEST(dmJobPool, NoPool)
+{
+    ASSERT_EQ(0U, dmJobPool::GetWorkerCount(0));
+    RunJobs(0, 1000, 64, 2);
+}
+
+TEST(dmJobPool, NoWorkers)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New(0, "test_worker");
+    ASSERT_EQ(0U, dmJobPool::GetWorkerCount(pool));
+    RunJobs(pool, 1000, 64, 2);
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, Workers)
+{
+    dmJobPool::HJobPool pool = dmJobPool::New(4, "test_worker");
+    ASSERT_EQ(4U, dmJobPool::GetWorkerCount(pool));
+    RunJobs(pool, 0, 64, 10);
+    RunJobs(pool, 1, 64, 10);
+    RunJobs(pool, 64, 64, 10);
+    RunJobs(pool, 65, 64, 10);
+    RunJobs(pool, 100000, 64, 100);
+    RunJobs(pool, 100000, 1, 2);
+    dmJobPool::Delete(pool);
+}
+
+TEST(dmJobPool, ManyJobs)
+{
+    // Many small jobs in a row, where workers are likely to wake up late
+    dmJobPool::HJobPool pool = dmJobPool::New(8, "test_worker");
+    RunJobs(pool, 16, 2, 10000);
+    dmJobPool::Delete(pool);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
@@ -355,6 +356,125 @@ TEST(dmMessage, ThreadTest2)
     ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
 }
 
+struct ContentionProducer
+{
+    dmMessage::URL* m_Receiver;
+    uint32_t        m_Producer;
+    uint32_t        m_MessageCount;
+};
+
+struct ContentionMessage
+{
+    uint32_t m_Producer;
+    uint32_t m_Sequence;
+};
+
+struct ContentionConsumer
+{
+    uint32_t m_NextSequence[8];
+    uint32_t m_Count;
+};
+
+void ContentionPostThread(void* arg)
+{
+    ContentionProducer* producer = (ContentionProducer*) arg;
+    ContentionMessage m;
+    m.m_Producer = producer->m_Producer;
+    for (uint32_t i = 0; i < producer->m_MessageCount; ++i)
+    {
+        m.m_Sequence = i;
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, producer->m_Receiver, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+    }
+}
+
+void HandleContentionMessage(dmMessage::Message *message_object, void *user_ptr)
+{
+    ContentionConsumer* consumer = (ContentionConsumer*) user_ptr;
+    ContentionMessage* m = (ContentionMessage*) message_object->m_Data;
+    // Messages from each producer are dispatched in the order they were posted
+    assert(m->m_Sequence == consumer->m_NextSequence[m->m_Producer]);
+    consumer->m_NextSequence[m->m_Producer]++;
+    consumer->m_Count++;
+}
+
+static void RunContention(uint32_t producer_count)
+{
+    const uint32_t message_count = 1024 * 64;
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    ContentionProducer producers[8];
+    dmThread::Thread threads[8];
+    ContentionConsumer consumer;
+    memset(&consumer, 0, sizeof(consumer));
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        producers[i].m_Receiver = &receiver;
+        producers[i].m_Producer = i;
+        producers[i].m_MessageCount = message_count / producer_count;
+        threads[i] = dmThread::New(&ContentionPostThread, 0xf0000, (void*) &producers[i], "post");
+    }
+
+    // Dispatch while the producers are posting
+    uint32_t total = (message_count / producer_count) * producer_count;
+    while (consumer.m_Count < total)
+    {
+        dmMessage::Dispatch(receiver.m_Socket, HandleContentionMessage, &consumer);
+    }
+    uint64_t end = dmTime::GetTime();
+
+    for (uint32_t i = 0; i < producer_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+        ASSERT_EQ(message_count / producer_count, consumer.m_NextSequence[i]);
+    }
+    ASSERT_EQ(total, consumer.m_Count);
+    ASSERT_EQ(0u, dmMessage::Dispatch(receiver.m_Socket, HandleContentionMessage, &consumer));
+
+    printf("Contention %u producers: %f ms (%f us per message)\n", producer_count, (end-start) / 1000.0f, (end-start) / float(total));
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
+TEST(dmMessage, BenchContention)
+{
+    RunContention(1);
+    RunContention(4);
+    RunContention(8);
+}
+
+TEST(dmMessage, DeletedSocketLookup)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+    uint32_t m = 0;
+    // Caches the socket lookup
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+
+    ASSERT_FALSE(dmMessage::IsSocketValid(receiver.m_Socket));
+    ASSERT_EQ(dmMessage::RESULT_SOCKET_NOT_FOUND, dmMessage::Post(0x0, &receiver, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+
+    // Another socket reusing the storage of the deleted one
+    dmMessage::URL other;
+    dmMessage::ResetURL(other);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("other_socket", &other.m_Socket));
+    ASSERT_EQ(dmMessage::RESULT_SOCKET_NOT_FOUND, dmMessage::Post(0x0, &receiver, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &other, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+    ASSERT_EQ(1u, dmMessage::Dispatch(other.m_Socket, HandleMessage, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(other.m_Socket));
+
+    // Recreating the socket makes the old handle valid again
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, m_HashMessage1, 0, 0x0, &m, sizeof(m), 0));
+    ASSERT_EQ(1u, dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
 void HandleIntegrityMessage(dmMessage::Message *message_object, void *user_ptr)
 {
     dmhash_t hash = dmHashBuffer64(message_object->m_Data, message_object->m_DataSize);
@@ -193,6 +193,7 @@ namespace dmEngine
     , m_MouseSensitivity(1.0f)
     , m_GraphicsContext(0)
     , m_RenderContext(0)
+    , m_JobPool(0x0)
     , m_SharedScriptContext(0x0)
     , m_GOScriptContext(0x0)
     , m_RenderScriptContext(0x0)
@@ -269,6 +270,11 @@ namespace dmEngine
 
         dmGameObject::DeleteRegister(engine->m_Register);
 
+        if (engine->m_JobPool)
+        {
+            dmJobPool::Delete(engine->m_JobPool);
+        }
+
         UnloadBootstrapContent(engine);
 
         dmSound::Finalize();
@@ -426,6 +432,26 @@ namespace dmEngine
         }
     }
 
+    static void* NewRenderArena(void* context)
+    {
+        return dmRender::NewRenderListArena();
+    }
+
+    static void DeleteRenderArena(void* context, void* arena)
+    {
+        dmRender::DeleteRenderListArena((dmRender::HRenderListArena)arena);
+    }
+
+    static void BindRenderArena(void* context, void* arena)
+    {
+        dmRender::RenderListBindArena((dmRender::HRenderContext)context, (dmRender::HRenderListArena)arena);
+    }
+
+    static void MergeRenderArena(void* context, void* arena)
+    {
+        dmRender::RenderListMergeArena((dmRender::HRenderContext)context, (dmRender::HRenderListArena)arena);
+    }
+
     static void SetUpdateFrequency(HEngine engine, uint32_t frequency)
     {
         engine->m_UpdateFrequency = frequency;
@@ -694,6 +720,23 @@ namespace dmEngine
         params.m_MaxResources = max_resources;
         params.m_Flags = 0;
 
+        int32_t load_worker_count = dmConfigFile::GetInt(engine->m_Config, dmResource::LOAD_WORKER_COUNT_KEY, 1);
+        if (load_worker_count <= 0)
+        {
+            dmLogWarning("%s must be larger than 0, using 1", dmResource::LOAD_WORKER_COUNT_KEY);
+            load_worker_count = 1;
+        }
+        params.m_LoadWorkerCount = (uint32_t)load_worker_count;
+
+        // In kilobytes
+        int32_t load_budget = dmConfigFile::GetInt(engine->m_Config, dmResource::LOAD_BUDGET_KEY, 4096);
+        if (load_budget <= 0)
+        {
+            dmLogWarning("%s must be larger than 0, using 4096", dmResource::LOAD_BUDGET_KEY);
+            load_budget = 4096;
+        }
+        params.m_LoadBudget = (uint32_t)dmMath::Min((uint64_t)load_budget * 1024, (uint64_t)0xFFFFFFFF);
+
         dmResourceArchive::ClearArchiveLoaders(); // in case we've rebooted
         dmResourceArchive::RegisterDefaultArchiveLoader();
 
@@ -807,6 +850,13 @@ namespace dmEngine
         }
         dmGameObject::SetInputStackDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY, dmGameObject::DEFAULT_MAX_INPUT_STACK_CAPACITY));
 
+        int32_t worker_count = dmConfigFile::GetInt(engine->m_Config, "engine.worker_count", 0);
+        if (worker_count > 0)
+        {
+            engine->m_JobPool = dmJobPool::New((uint32_t)worker_count, "worker");
+            dmGameObject::SetJobPool(engine->m_Register, engine->m_JobPool);
+        }
+
         dmRender::RenderContextParams render_params;
         render_params.m_MaxRenderTypes = 16;
         render_params.m_MaxInstances = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_draw_calls", 1024);
@@ -819,14 +869,28 @@ namespace dmEngine
         render_params.m_CommandBufferSize = 1024;
         render_params.m_ScriptContext = engine->m_RenderScriptContext;
         render_params.m_MaxDebugVertexCount = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_debug_vertices", 10000);
+        render_params.m_FrustumCulling = dmConfigFile::GetInt(engine->m_Config, "graphics.frustum_culling", 0) != 0;
         engine->m_RenderContext = dmRender::NewRenderContext(engine->m_GraphicsContext, render_params);
 
+        // Build the render lists of the thread safe component types on the workers
+        if (engine->m_JobPool && dmConfigFile::GetInt(engine->m_Config, "engine.parallel_render", 0))
+        {
+            dmGameObject::RenderArenaCallbacks render_arena_callbacks;
+            render_arena_callbacks.m_NewArena = NewRenderArena;
+            render_arena_callbacks.m_DeleteArena = DeleteRenderArena;
+            render_arena_callbacks.m_BindArena = BindRenderArena;
+            render_arena_callbacks.m_MergeArena = MergeRenderArena;
+            render_arena_callbacks.m_Context = engine->m_RenderContext;
+            dmGameObject::SetRenderArenaCallbacks(engine->m_Register, &render_arena_callbacks);
+        }
+
         dmGameObject::Initialize(engine->m_Register, engine->m_GOScriptContext);
 
         engine->m_ParticleFXContext.m_Factory = engine->m_Factory;
         engine->m_ParticleFXContext.m_RenderContext = engine->m_RenderContext;
         engine->m_ParticleFXContext.m_MaxParticleFXCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_INSTANCE_COUNT_KEY, 64);
         engine->m_ParticleFXContext.m_MaxParticleCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_PARTICLE_COUNT_KEY, 1024);
+        engine->m_ParticleFXContext.m_JobPool = engine->m_JobPool;
         engine->m_ParticleFXContext.m_Debug = false;
 
         dmInput::NewContextParams input_params;
@@ -868,6 +932,8 @@ namespace dmEngine
         engine->m_GuiContext.m_MaxParticleFXCount = dmConfigFile::GetInt(engine->m_Config, "gui.max_particlefx_count", 64);
         engine->m_GuiContext.m_MaxParticleCount = dmConfigFile::GetInt(engine->m_Config, "gui.max_particle_count", 1024);
         engine->m_GuiContext.m_MaxSpineCount = dmConfigFile::GetInt(engine->m_Config, "gui.max_spine_count", max_spine_count);
+        engine->m_GuiContext.m_JobPool = engine->m_JobPool;
+        engine->m_GuiContext.m_CullClippers = dmConfigFile::GetInt(engine->m_Config, "gui.cull_clippers", 0) != 0;
 
         dmPhysics::NewContextParams physics_params;
         physics_params.m_WorldCount = dmConfigFile::GetInt(engine->m_Config, "physics.world_count", 4);
@@ -17,6 +17,7 @@
 
 #include <dlib/configfile.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_pool.h>
 #include <dlib/message.h>
 
 #include <resource/resource.h>
@@ -124,6 +125,8 @@ namespace dmEngine
 
         dmGraphics::HContext                        m_GraphicsContext;
         dmRender::HRenderContext                    m_RenderContext;
+        // Worker threads shared by the engine systems, 0x0 if disabled (engine.worker_count)
+        dmJobPool::HJobPool                         m_JobPool;
         dmGameSystem::PhysicsContext                m_PhysicsContext;
         dmGameSystem::ParticleFXContext             m_ParticleFXContext;
         /// If the shared context is set, the three environment specific contexts below will point to the same context
@@ -18,6 +18,7 @@
 
 #include <script/script.h>
 
+#include "gameobject_private.h"
 #include "gameobject_script.h"
 #include "gameobject_props_lua.h"
 
@@ -304,6 +305,11 @@ namespace dmGameObject
                 if (anim.m_Value != 0x0)
                 {
                     *anim.m_Value = v;
+                    // Transform properties are written in place, bypassing SetProperty
+                    if (anim.m_ComponentId == 0)
+                    {
+                        SetDirtyTransform(anim.m_Instance);
+                    }
                 }
                 else
                 {
@@ -291,7 +291,15 @@ namespace dmGameObject
             dmScript::PushHash(L, params.m_Message->m_Id);
 
             const char* message_name = 0;
-            if (params.m_Message->m_Descriptor != 0)
+            if (dmScript::IsSharedPayloadMessage(params.m_Message->m_Descriptor))
+            {
+                if (dmProfile::g_IsInitialized)
+                {
+                    message_name = (const char*)dmHashReverse64(params.m_Message->m_Id, 0);
+                }
+                dmScript::PushSharedPayload(L, (const char*)params.m_Message->m_Data, params.m_Message->m_DataSize);
+            }
+            else if (params.m_Message->m_Descriptor != 0)
             {
                 // TODO: setjmp/longjmp here... how to handle?!!! We are not running "from lua" here
                 // lua_cpcall?
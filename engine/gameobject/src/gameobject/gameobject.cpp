@@ -19,6 +19,7 @@
 #include <dlib/message.h>
 #include <dlib/hash.h>
 #include <dlib/array.h>
+#include <dlib/atomic.h>
 #include <dlib/index_pool.h>
 #include <dlib/profile.h>
 #include <dlib/math.h>
@@ -29,6 +30,7 @@
 #include "gameobject_script.h"
 #include "gameobject_private.h"
 #include "gameobject_props_lua.h"
+#include "gameobject_transform.h"
 #include "gameobject_props_ddf.h"
 
 #include "res_collection.h"
@@ -162,6 +164,9 @@ namespace dmGameObject
         m_ComponentTypeCount = 0;
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_DefaultInputStackCapacity = DEFAULT_MAX_INPUT_STACK_CAPACITY;
+        m_JobPool = 0;
+        memset(&m_RenderArenaCallbacks, 0, sizeof(m_RenderArenaCallbacks));
+        memset(m_RenderArenas, 0, sizeof(m_RenderArenas));
         m_Mutex = dmMutex::New();
         m_SocketToCollection.SetCapacity(15, 17);
     }
@@ -194,8 +199,12 @@ namespace dmGameObject
         m_Instances.SetCapacity(max_instances);
         m_Instances.SetSize(max_instances);
         m_InstanceIndices.SetCapacity(max_instances);
+        m_LocalTransforms.SetCapacity(max_instances);
+        m_LocalTransforms.SetSize(max_instances);
         m_WorldTransforms.SetCapacity(max_instances);
         m_WorldTransforms.SetSize(max_instances);
+        m_TransformGenerations.SetCapacity(max_instances);
+        m_TransformGenerations.SetSize(max_instances);
         m_IDToInstance.SetCapacity(dmMath::Max(1U, max_instances/3), max_instances);
         m_InputFocusStack.SetCapacity(max_input_stack_entries);
         m_NameHash = 0;
@@ -212,6 +221,7 @@ namespace dmGameObject
         m_ScaleAlongZ = 0;
         m_DirtyTransforms = 1;
         m_Initialized = 0;
+        m_TransformGeneration = 0;
 
         m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
         m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
@@ -220,7 +230,8 @@ namespace dmGameObject
         m_InstancesToAddTail = INVALID_INSTANCE_INDEX;
 
         memset(&m_Instances[0], 0, sizeof(Instance*) * max_instances);
-        memset(&m_WorldTransforms[0], 0xcc, sizeof(dmTransform::Transform) * max_instances);
+        memset(&m_WorldTransforms[0], 0xcc, sizeof(Matrix4) * max_instances);
+        memset(&m_TransformGenerations[0], 0, sizeof(uint32_t) * max_instances);
         memset(&m_LevelIndices[0], 0, sizeof(m_LevelIndices));
         memset(&m_ComponentInstanceCount[0], 0, sizeof(uint32_t) * MAX_COMPONENT_TYPES);
     }
@@ -246,6 +257,39 @@ namespace dmGameObject
         regist->m_DefaultInputStackCapacity = capacity;
     }
 
+    void SetJobPool(HRegister regist, dmJobPool::HJobPool job_pool)
+    {
+        assert(regist != 0x0);
+        regist->m_JobPool = job_pool;
+    }
+
+    static void DeleteRenderArenas(HRegister regist)
+    {
+        RenderArenaCallbacks& callbacks = regist->m_RenderArenaCallbacks;
+        for (uint32_t i = 0; i < MAX_COMPONENT_TYPES; ++i)
+        {
+            if (regist->m_RenderArenas[i])
+            {
+                callbacks.m_DeleteArena(callbacks.m_Context, regist->m_RenderArenas[i]);
+                regist->m_RenderArenas[i] = 0;
+            }
+        }
+    }
+
+    void SetRenderArenaCallbacks(HRegister regist, const RenderArenaCallbacks* callbacks)
+    {
+        assert(regist != 0x0);
+        DeleteRenderArenas(regist);
+        if (callbacks)
+        {
+            regist->m_RenderArenaCallbacks = *callbacks;
+        }
+        else
+        {
+            memset(&regist->m_RenderArenaCallbacks, 0, sizeof(regist->m_RenderArenaCallbacks));
+        }
+    }
+
     static uint32_t GetInputStackDefaultCapacity(HRegister regist)
     {
         assert(regist != 0x0);
@@ -263,6 +307,7 @@ namespace dmGameObject
             FinalCollection(collection);
             DeleteCollection(collection);
         }
+        DeleteRenderArenas(regist);
         delete regist;
     }
 
@@ -576,6 +621,10 @@ namespace dmGameObject
         if (ret != dmResource::RESULT_OK)
             return ret;
 
+        // Collections and game objects reveal more resources to load, so load them first
+        dmResource::SetTypeLoadPriority(factory, "collectionc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetTypeLoadPriority(factory, "goc", dmResource::LOAD_PRIORITY_HIGH);
+
         return ret;
     }
 
@@ -585,12 +634,12 @@ namespace dmGameObject
          * Remove instance from m_LevelIndices using an erase-swap operation
          */
 
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<LevelIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         assert(level.Size() > 0);
         assert(instance->m_LevelIndex < level.Size());
 
-        uint16_t level_index = instance->m_LevelIndex;
-        uint16_t swap_in_index = level.EraseSwap(level_index);
+        InstanceIndex level_index = instance->m_LevelIndex;
+        InstanceIndex swap_in_index = level.EraseSwap(level_index).m_Index;
         HInstance swap_in_instance = collection->m_Instances[swap_in_index];
         assert(swap_in_instance->m_Index == swap_in_index);
         swap_in_instance->m_LevelIndex = level_index;
@@ -602,7 +651,7 @@ namespace dmGameObject
      * ** 10 elements as min
      * ** Up to max_instances as max
      */
-    static void ExpandLevel(dmArray<uint16_t>& level, uint32_t max_instances)
+    static void ExpandLevel(dmArray<LevelIndex>& level, uint32_t max_instances)
     {
         const uint32_t min_offset = 10;
         const uint32_t max_offset = max_instances - level.Capacity();
@@ -615,14 +664,15 @@ namespace dmGameObject
         /*
          * Insert instance in m_LevelIndices at level set in instance->m_Depth
          */
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<LevelIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         if (level.Full())
             ExpandLevel(level, collection->m_MaxInstances);
         assert(!level.Full());
 
-        uint16_t level_index = (uint16_t)level.Size();
+        InstanceIndex level_index = (InstanceIndex)level.Size();
         level.SetSize(level_index + 1);
-        level[level_index] = instance->m_Index;
+        level[level_index].m_Index = instance->m_Index;
+        level[level_index].m_Parent = instance->m_Parent;
         instance->m_LevelIndex = level_index;
     }
 
@@ -670,10 +720,12 @@ namespace dmGameObject
         HInstance instance = AllocInstance(proto, prototype_name);
         instance->m_Collection = collection;
         instance->m_ScaleAlongZ = collection->m_ScaleAlongZ;
-        uint16_t instance_index = collection->m_InstanceIndices.Pop();
+        InstanceIndex instance_index = collection->m_InstanceIndices.Pop();
         instance->m_Index = instance_index;
         assert(collection->m_Instances[instance_index] == 0);
         collection->m_Instances[instance_index] = instance;
+        collection->m_LocalTransforms[instance_index].SetIdentity();
+        collection->m_TransformGenerations[instance_index] = 0;
 
         InsertInstanceInLevelIndex(collection, instance);
 
@@ -695,7 +747,7 @@ namespace dmGameObject
             Unlink(collection, instance);
         }
 
-        uint16_t instance_index = instance->m_Index;
+        InstanceIndex instance_index = instance->m_Index;
         operator delete ((void*)instance);
         collection->m_Instances[instance_index] = 0x0;
         collection->m_InstanceIndices.Push(instance_index);
@@ -944,8 +996,8 @@ namespace dmGameObject
             return;
         }
         instance->m_ToBeAdded = 1;
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToAddTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToAddTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToAdd = index;
@@ -1004,7 +1056,7 @@ namespace dmGameObject
             dmLogError("Instances can not be added to update during the update.");
             return false;
         }
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         bool result = true;
         while (index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[index];
@@ -1076,7 +1128,7 @@ namespace dmGameObject
         SetPosition(instance, position);
         SetRotation(instance, rotation);
         SetScale(instance, scale);
-        collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(instance->m_Transform);
+        collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(GetLocalTransform(instance));
 
         dmHashInit64(&instance->m_CollectionPathHashState, true);
         dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
@@ -1163,7 +1215,7 @@ namespace dmGameObject
             if (scale.getX() == 0 && scale.getY() == 0 && scale.getZ() == 0)
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
 
-            instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+            GetLocalTransform(instance) = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
             dmHashClone64(&instance->m_CollectionPathHashState, &prefixHashState, true);
 
             const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -1243,11 +1295,11 @@ namespace dmGameObject
             {
                 if (!GetParent(new_instances[i]))
                 {
-                    new_instances[i]->m_Transform = dmTransform::Mul(transform, new_instances[i]->m_Transform);
+                    GetLocalTransform(new_instances[i]) = dmTransform::Mul(transform, GetLocalTransform(new_instances[i]));
                 }
 
                 // world transforms need to be up to date in time for the script init calls
-                collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(new_instances[i]->m_Transform);
+                collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(GetLocalTransform(new_instances[i]));
             }
         }
 
@@ -1600,18 +1652,18 @@ namespace dmGameObject
             Matrix4* trans = &collection->m_WorldTransforms[instance->m_Index];
             if (instance->m_Parent == INVALID_INSTANCE_INDEX)
             {
-                *trans = dmTransform::ToMatrix4(instance->m_Transform);
+                *trans = dmTransform::ToMatrix4(GetLocalTransform(instance));
             }
             else
             {
                 const Matrix4* parent_trans = &collection->m_WorldTransforms[instance->m_Parent];
                 if (instance->m_ScaleAlongZ)
                 {
-                    *trans = (*parent_trans) * dmTransform::ToMatrix4(instance->m_Transform);
+                    *trans = (*parent_trans) * dmTransform::ToMatrix4(GetLocalTransform(instance));
                 }
                 else
                 {
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(instance->m_Transform));
+                    *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(GetLocalTransform(instance)));
                 }
             }
             return InitComponents(collection, instance);
@@ -1770,8 +1822,8 @@ namespace dmGameObject
         // Delete instance
         instance->m_ToBeDeleted = 1;
 
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToDeleteTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToDeleteTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToDelete = index;
@@ -1788,10 +1840,10 @@ namespace dmGameObject
 
     static void RemoveFromAddToUpdate(Collection* collection, HInstance instance)
     {
-        uint16_t index = instance->m_Index;
+        InstanceIndex index = instance->m_Index;
         assert(collection->m_InstancesToAddTail == index || instance->m_NextToAdd != INVALID_INSTANCE_INDEX);
-        uint16_t* prev_index_ptr = &collection->m_InstancesToAddHead;
-        uint16_t prev_index = *prev_index_ptr;
+        InstanceIndex* prev_index_ptr = &collection->m_InstancesToAddHead;
+        InstanceIndex prev_index = *prev_index_ptr;
         while (prev_index != index) {
             prev_index_ptr = &collection->m_Instances[prev_index]->m_NextToAdd;
             if (collection->m_InstancesToAddTail == *prev_index_ptr) {
@@ -1842,6 +1894,7 @@ namespace dmGameObject
             Instance* child = collection->m_Instances[index];
             assert(child->m_Parent == instance->m_Index);
             child->m_Parent = instance->m_Parent;
+            SetDirtyTransform(child);
             index = collection->m_Instances[index]->m_SiblingIndex;
         }
 
@@ -2012,11 +2065,11 @@ namespace dmGameObject
         return instance->m_Bone;
     }
 
-    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, uint16_t first_index, dmTransform::Transform* transforms, uint32_t transform_count)
+    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, InstanceIndex first_index, dmTransform::Transform* transforms, uint32_t transform_count)
     {
         if (transform_count == 0)
             return 0;
-        uint16_t current_index = first_index;
+        InstanceIndex current_index = first_index;
         uint32_t count = 0;
         Collection* collection = hcollection->m_Collection;
         while (current_index != INVALID_INSTANCE_INDEX)
@@ -2024,10 +2077,11 @@ namespace dmGameObject
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone)
             {
-                instance->m_Transform = transforms[count++];
+                GetLocalTransform(instance) = transforms[count++];
                 if (component_transform && count == 1) {
-                    instance->m_Transform = dmTransform::Mul(*component_transform, instance->m_Transform);
+                    GetLocalTransform(instance) = dmTransform::Mul(*component_transform, GetLocalTransform(instance));
                 }
+                SetDirtyTransform(instance);
                 if (count < transform_count)
                 {
                     count += DoSetBoneTransforms(hcollection, 0x0, instance->m_FirstChildIndex, &transforms[count], transform_count - count);
@@ -2047,8 +2101,8 @@ namespace dmGameObject
         return DoSetBoneTransforms(instance->m_Collection->m_HCollection, &component_transform, instance->m_Index, transforms, transform_count);
     }
 
-    static void DeleteBones(Collection* collection, uint16_t first_index) {
-        uint16_t current_index = first_index;
+    static void DeleteBones(Collection* collection, InstanceIndex first_index) {
+        InstanceIndex current_index = first_index;
         while (current_index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone && instance->m_ToBeDeleted == 0) {
@@ -2167,23 +2221,23 @@ namespace dmGameObject
                     Matrix4& world = collection->m_WorldTransforms[instance->m_Index];
                     if (instance->m_ScaleAlongZ)
                     {
-                        world = parent_t * dmTransform::ToMatrix4(instance->m_Transform);
+                        world = parent_t * dmTransform::ToMatrix4(GetLocalTransform(instance));
                     }
                     else
                     {
-                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(instance->m_Transform));
+                        world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(GetLocalTransform(instance)));
                     }
                 }
                 else
                 {
                     if (instance->m_ScaleAlongZ)
                     {
-                        instance->m_Transform = dmTransform::ToTransform(inverse(parent_t) * collection->m_WorldTransforms[instance->m_Index]);
+                        GetLocalTransform(instance) = dmTransform::ToTransform(inverse(parent_t) * collection->m_WorldTransforms[instance->m_Index]);
                     }
                     else
                     {
                         Matrix4 tmp = dmTransform::MulNoScaleZ(inverse(parent_t), collection->m_WorldTransforms[instance->m_Index]);
-                        instance->m_Transform = dmTransform::ToTransform(tmp);
+                        GetLocalTransform(instance) = dmTransform::ToTransform(tmp);
                     }
                 }
 
@@ -2353,67 +2407,140 @@ namespace dmGameObject
         }
     }
 
-    void UpdateTransforms(Collection* collection)
+    // Number of world transforms gathered before they are calculated in one batch
+    static const uint32_t TRANSFORM_BATCH_SIZE = 64;
+    // Levels with fewer instances than this are updated on the calling thread only
+    static const uint32_t PARALLEL_TRANSFORMS_MIN_LEVEL_SIZE = 2048;
+    // Number of instances per job chunk when a level is updated in parallel
+    static const uint32_t PARALLEL_TRANSFORMS_CHUNK_SIZE = 512;
+
+    struct TransformBatch
     {
-        DM_PROFILE(GameObject, "UpdateTransforms");
+        const dmTransform::Transform*   m_Local[TRANSFORM_BATCH_SIZE];
+        const Matrix4*                  m_ParentWorld[TRANSFORM_BATCH_SIZE];
+        Matrix4*                        m_World[TRANSFORM_BATCH_SIZE];
+        uint32_t                        m_Count;
+    };
 
-        // Calculate world transforms
-        // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
-        uint32_t root_count = root_level.Size();
-        for (uint32_t i = 0; i < root_count; ++i)
+    static inline void FlushTransformBatch(TransformBatch& batch, bool root, bool scale_along_z)
+    {
+        if (batch.m_Count > 0)
         {
-            uint16_t index = root_level[i];
-            Instance* instance = collection->m_Instances[index];
-            CheckEuler(instance);
-            collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
-            assert(parent_index == INVALID_INSTANCE_INDEX);
+            CalculateWorldTransforms(batch.m_Local, root ? 0x0 : batch.m_ParentWorld, batch.m_World, batch.m_Count, scale_along_z);
+            batch.m_Count = 0;
         }
+    }
 
+    struct UpdateLevelTransformsContext
+    {
+        Collection*         m_Collection;
+        const LevelIndex*   m_Level;
+        uint32_t            m_Generation;
+        bool                m_Root;
+        int32_atomic_t      m_UpdatedCount;
+    };
 
-        if (collection->m_ScaleAlongZ) {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
-            {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+    // Updates the instances [begin, end) of a level. Instances within a level are independent
+    // of each other, so ranges of the same level can be updated concurrently.
+    static void UpdateLevelTransforms(void* _context, uint32_t begin, uint32_t end)
+    {
+        UpdateLevelTransformsContext* context = (UpdateLevelTransformsContext*)_context;
+        Collection* collection = context->m_Collection;
+        const LevelIndex* entries = context->m_Level;
+        uint32_t generation = context->m_Generation;
+        bool root = context->m_Root;
+        bool scale_along_z = collection->m_ScaleAlongZ;
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+        uint32_t* generations = collection->m_TransformGenerations.Begin();
+        dmTransform::Transform* local_transforms = collection->m_LocalTransforms.Begin();
+        Matrix4* world_transforms = collection->m_WorldTransforms.Begin();
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = *parent_trans * own;
-                }
+        TransformBatch batch;
+        batch.m_Count = 0;
+        uint32_t updated_count = 0;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            InstanceIndex index = entries[i].m_Index;
+            InstanceIndex parent_index = entries[i].m_Parent;
+            assert(root == (parent_index == INVALID_INSTANCE_INDEX));
+
+            bool changed = generations[index] == 0;
+            if (!changed && (root || generations[parent_index] != generation))
+            {
+                continue;
             }
-        } else {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+
+            if (changed)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+                CheckEuler(collection->m_Instances[index]);
+            }
+            generations[index] = generation;
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+            batch.m_Local[batch.m_Count] = &local_transforms[index];
+            batch.m_ParentWorld[batch.m_Count] = root ? 0x0 : &world_transforms[parent_index];
+            batch.m_World[batch.m_Count] = &world_transforms[index];
+            if (++batch.m_Count == TRANSFORM_BATCH_SIZE)
+            {
+                FlushTransformBatch(batch, root, scale_along_z);
+            }
+            ++updated_count;
+        }
+        FlushTransformBatch(batch, root, scale_along_z);
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, own);
-                }
+        dmAtomicAdd32(&context->m_UpdatedCount, (int32_t)updated_count);
+    }
+
+    void UpdateTransforms(Collection* collection)
+    {
+        DM_PROFILE(GameObject, "UpdateTransforms");
+
+        // Only instances with a changed local transform, or with a parent whose world transform
+        // was recalculated in this pass, are updated. The generation stamp is used to propagate
+        // the change to the children without having to clear any flags afterwards.
+        uint32_t generation = ++collection->m_TransformGeneration;
+        if (generation == 0)
+        {
+            // Zero is reserved for changed transforms
+            generation = ++collection->m_TransformGeneration;
+        }
+
+        dmJobPool::HJobPool job_pool = collection->m_Register->m_JobPool;
+
+        UpdateLevelTransformsContext context;
+        context.m_Collection = collection;
+        context.m_Generation = generation;
+        context.m_UpdatedCount = 0;
+        uint32_t total_count = 0;
+
+        // Calculate world transforms, level by level starting with the root-level instances.
+        // Large levels are split into chunks that are updated by the job pool. The next level
+        // isn't started until all chunks of the current level are done, since it reads their
+        // world transforms.
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<LevelIndex>& level = collection->m_LevelIndices[level_i];
+            uint32_t instance_count = level.Size();
+            if (instance_count == 0)
+            {
+                continue;
+            }
+            total_count += instance_count;
+            context.m_Level = level.Begin();
+            context.m_Root = level_i == 0;
+            if (instance_count >= PARALLEL_TRANSFORMS_MIN_LEVEL_SIZE)
+            {
+                dmJobPool::Run(job_pool, UpdateLevelTransforms, &context, instance_count, PARALLEL_TRANSFORMS_CHUNK_SIZE);
+            }
+            else
+            {
+                UpdateLevelTransforms(&context, 0, instance_count);
             }
         }
 
+        uint32_t updated_count = (uint32_t)context.m_UpdatedCount;
+        DM_COUNTER("TransformsUpdated", updated_count);
+        DM_COUNTER("TransformsSkipped", total_count - updated_count);
+
         collection->m_DirtyTransforms = false;
     }
 
@@ -2486,6 +2613,40 @@ namespace dmGameObject
         return Update(hcollection->m_Collection, update_context);
     }
 
+    static UpdateResult RenderComponentType(HCollection hcollection, uint16_t update_index)
+    {
+        Collection* collection = hcollection->m_Collection;
+        ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
+        DM_PROFILE_DYN(GameObject, component_type->m_Name, component_type->m_NameHash);
+        ComponentsRenderParams params;
+        params.m_Collection = hcollection;
+        params.m_World = collection->m_ComponentWorlds[update_index];
+        params.m_Context = component_type->m_Context;
+        return component_type->m_RenderFunction(params);
+    }
+
+    struct RenderParallelContext
+    {
+        HCollection     m_Collection;
+        // Update indices of the component types to render in parallel
+        uint16_t        m_UpdateIndices[MAX_COMPONENT_TYPES];
+        UpdateResult    m_Results[MAX_COMPONENT_TYPES];
+    };
+
+    static void RenderParallel(void* _context, uint32_t begin, uint32_t end)
+    {
+        RenderParallelContext* context = (RenderParallelContext*)_context;
+        Register* regist = context->m_Collection->m_Collection->m_Register;
+        RenderArenaCallbacks& callbacks = regist->m_RenderArenaCallbacks;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            uint16_t update_index = context->m_UpdateIndices[i];
+            callbacks.m_BindArena(callbacks.m_Context, regist->m_RenderArenas[update_index]);
+            context->m_Results[i] = RenderComponentType(context->m_Collection, update_index);
+            callbacks.m_BindArena(callbacks.m_Context, 0x0);
+        }
+    }
+
     bool Render(HCollection hcollection)
     {
         DM_PROFILE(GameObject, "Render");
@@ -2493,23 +2654,63 @@ namespace dmGameObject
         Collection* collection = hcollection->m_Collection;
         assert(collection != 0x0);
 
+        Register* regist = collection->m_Register;
+        RenderArenaCallbacks& callbacks = regist->m_RenderArenaCallbacks;
         bool ret = true;
-        uint32_t component_types = collection->m_Register->m_ComponentTypeCount;
+        uint32_t component_types = regist->m_ComponentTypeCount;
+
+        // Component types that can be rendered in parallel are rendered first, into one arena each
+        RenderParallelContext parallel_context;
+        uint32_t parallel_count = 0;
+        if (callbacks.m_NewArena && dmJobPool::GetWorkerCount(regist->m_JobPool) > 0)
+        {
+            parallel_context.m_Collection = hcollection;
+            for (uint32_t i = 0; i < component_types; ++i)
+            {
+                uint16_t update_index = regist->m_ComponentTypesOrder[i];
+                ComponentType* component_type = &regist->m_ComponentTypes[update_index];
+                if (component_type->m_RenderFunction && component_type->m_RenderParallel)
+                {
+                    parallel_context.m_UpdateIndices[parallel_count++] = update_index;
+                }
+            }
+            // A single component type would be rendered on this thread anyway
+            if (parallel_count < 2)
+            {
+                parallel_count = 0;
+            }
+            for (uint32_t i = 0; i < parallel_count; ++i)
+            {
+                uint16_t update_index = parallel_context.m_UpdateIndices[i];
+                if (!regist->m_RenderArenas[update_index])
+                {
+                    regist->m_RenderArenas[update_index] = callbacks.m_NewArena(callbacks.m_Context);
+                }
+            }
+            dmJobPool::Run(regist->m_JobPool, RenderParallel, &parallel_context, parallel_count, 1);
+        }
+
+        // The arenas are merged in update order, so that the render list is the same as when rendered serially
+        uint32_t parallel_i = 0;
         for (uint32_t i = 0; i < component_types; ++i)
         {
-            uint16_t update_index = collection->m_Register->m_ComponentTypesOrder[i];
-            ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
-            if (component_type->m_RenderFunction)
+            uint16_t update_index = regist->m_ComponentTypesOrder[i];
+            ComponentType* component_type = &regist->m_ComponentTypes[update_index];
+            if (!component_type->m_RenderFunction)
+                continue;
+
+            UpdateResult res;
+            if (parallel_i < parallel_count && parallel_context.m_UpdateIndices[parallel_i] == update_index)
             {
-                DM_PROFILE_DYN(GameObject, component_type->m_Name, component_type->m_NameHash);
-                ComponentsRenderParams params;
-                params.m_Collection = hcollection;
-                params.m_World = collection->m_ComponentWorlds[update_index];
-                params.m_Context = component_type->m_Context;
-                UpdateResult res = component_type->m_RenderFunction(params);
-                if (res != UPDATE_RESULT_OK)
-                    ret = false;
+                callbacks.m_MergeArena(callbacks.m_Context, regist->m_RenderArenas[update_index]);
+                res = parallel_context.m_Results[parallel_i++];
+            }
+            else
+            {
+                res = RenderComponentType(hcollection, update_index);
             }
+            if (res != UPDATE_RESULT_OK)
+                ret = false;
         }
         return ret;
     }
@@ -2565,11 +2766,11 @@ namespace dmGameObject
             while (collection->m_InstancesToDeleteHead != INVALID_INSTANCE_INDEX && pass_count < max_pass_count) {
                 ++pass_count;
                 // Save the list and clear the head and tail
-                uint16_t head = collection->m_InstancesToDeleteHead;
+                InstanceIndex head = collection->m_InstancesToDeleteHead;
                 collection->m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
                 collection->m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
 
-                uint16_t index = head;
+                InstanceIndex index = head;
                 while (index != INVALID_INSTANCE_INDEX) {
                     Instance* instance = collection->m_Instances[index];
 
@@ -2810,42 +3011,46 @@ namespace dmGameObject
 
     void SetPosition(HInstance instance, Point3 position)
     {
-        instance->m_Transform.SetTranslation(Vector3(position));
+        GetLocalTransform(instance).SetTranslation(Vector3(position));
+        SetDirtyTransform(instance);
     }
 
     Point3 GetPosition(HInstance instance)
     {
-        return Point3(instance->m_Transform.GetTranslation());
+        return Point3(GetLocalTransform(instance).GetTranslation());
     }
 
     void SetRotation(HInstance instance, Quat rotation)
     {
-        instance->m_Transform.SetRotation(rotation);
+        GetLocalTransform(instance).SetRotation(rotation);
+        SetDirtyTransform(instance);
     }
 
     Quat GetRotation(HInstance instance)
     {
-        return instance->m_Transform.GetRotation();
+        return GetLocalTransform(instance).GetRotation();
     }
 
     void SetScale(HInstance instance, float scale)
     {
-        instance->m_Transform.SetUniformScale(scale);
+        GetLocalTransform(instance).SetUniformScale(scale);
+        SetDirtyTransform(instance);
     }
 
     void SetScale(HInstance instance, Vector3 scale)
     {
-        instance->m_Transform.SetScale(scale);
+        GetLocalTransform(instance).SetScale(scale);
+        SetDirtyTransform(instance);
     }
 
     float GetUniformScale(HInstance instance)
     {
-        return instance->m_Transform.GetUniformScale();
+        return GetLocalTransform(instance).GetUniformScale();
     }
 
     Vector3 GetScale(HInstance instance)
     {
-        return instance->m_Transform.GetScale();
+        return GetLocalTransform(instance).GetScale();
     }
 
     Point3 GetWorldPosition(HInstance instance)
@@ -2959,6 +3164,7 @@ namespace dmGameObject
             child->m_Depth = 0;
         }
         InsertInstanceInLevelIndex(collection, child);
+        SetDirtyTransform(child);
 
         int32_t n_steps =  (int32_t) original_child_depth - (int32_t) child->m_Depth;
         if (n_steps < 0)
@@ -3027,7 +3233,7 @@ namespace dmGameObject
 
     static void UpdateRotationToEuler(HInstance instance)
     {
-        Quat q = instance->m_Transform.GetRotation();
+        Quat q = GetLocalTransform(instance).GetRotation();
         instance->m_EulerRotation = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
         instance->m_PrevEulerRotation = instance->m_EulerRotation;
     }
@@ -3035,7 +3241,7 @@ namespace dmGameObject
     static void UpdateEulerToRotation(HInstance instance)
     {
         instance->m_PrevEulerRotation = instance->m_EulerRotation;
-        instance->m_Transform.SetRotation(dmVMath::EulerToQuat(instance->m_EulerRotation));
+        GetLocalTransform(instance).SetRotation(dmVMath::EulerToQuat(instance->m_EulerRotation));
     }
 
     PropertyResult GetProperty(HInstance instance, dmhash_t component_id, dmhash_t property_id, PropertyDesc& out_value)
@@ -3049,89 +3255,89 @@ namespace dmGameObject
             // Scale used to be a uniform scalar, but is now a non-uniform 3-component scale
             if (property_id == PROP_SCALE)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = GetLocalTransform(instance).GetScalePtr();
                 out_value.m_ValuePtr = scale;
                 out_value.m_ElementIds[0] = PROP_SCALE_X;
                 out_value.m_ElementIds[1] = PROP_SCALE_Y;
                 out_value.m_ElementIds[2] = PROP_SCALE_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetScale());
+                out_value.m_Variant = PropertyVar(GetLocalTransform(instance).GetScale());
             }
             else if (property_id == PROP_SCALE_X)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = GetLocalTransform(instance).GetScalePtr();
                 out_value.m_ValuePtr = scale;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_SCALE_Y)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = GetLocalTransform(instance).GetScalePtr();
                 out_value.m_ValuePtr = scale + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_SCALE_Z)
             {
-                float* scale = instance->m_Transform.GetScalePtr();
+                float* scale = GetLocalTransform(instance).GetScalePtr();
                 out_value.m_ValuePtr = scale + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = GetLocalTransform(instance).GetPositionPtr();
                 out_value.m_ValuePtr = position;
                 out_value.m_ElementIds[0] = PROP_POSITION_X;
                 out_value.m_ElementIds[1] = PROP_POSITION_Y;
                 out_value.m_ElementIds[2] = PROP_POSITION_Z;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetTranslation());
+                out_value.m_Variant = PropertyVar(GetLocalTransform(instance).GetTranslation());
             }
             else if (property_id == PROP_POSITION_X)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = GetLocalTransform(instance).GetPositionPtr();
                 out_value.m_ValuePtr = position;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION_Y)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = GetLocalTransform(instance).GetPositionPtr();
                 out_value.m_ValuePtr = position + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_POSITION_Z)
             {
-                float* position = instance->m_Transform.GetPositionPtr();
+                float* position = GetLocalTransform(instance).GetPositionPtr();
                 out_value.m_ValuePtr = position + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_ROTATION)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = GetLocalTransform(instance).GetRotationPtr();
                 out_value.m_ValuePtr = rotation;
                 out_value.m_ElementIds[0] = PROP_ROTATION_X;
                 out_value.m_ElementIds[1] = PROP_ROTATION_Y;
                 out_value.m_ElementIds[2] = PROP_ROTATION_Z;
                 out_value.m_ElementIds[3] = PROP_ROTATION_W;
-                out_value.m_Variant = PropertyVar(instance->m_Transform.GetRotation());
+                out_value.m_Variant = PropertyVar(GetLocalTransform(instance).GetRotation());
             }
             else if (property_id == PROP_ROTATION_X)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = GetLocalTransform(instance).GetRotationPtr();
                 out_value.m_ValuePtr = rotation;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_ROTATION_Y)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = GetLocalTransform(instance).GetRotationPtr();
                 out_value.m_ValuePtr = rotation + 1;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_ROTATION_Z)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = GetLocalTransform(instance).GetRotationPtr();
                 out_value.m_ValuePtr = rotation + 2;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
             else if (property_id == PROP_ROTATION_W)
             {
-                float* rotation = instance->m_Transform.GetRotationPtr();
+                float* rotation = GetLocalTransform(instance).GetRotationPtr();
                 out_value.m_ValuePtr = rotation + 3;
                 out_value.m_Variant = PropertyVar(*out_value.m_ValuePtr);
             }
@@ -3224,9 +3430,10 @@ namespace dmGameObject
             return PROPERTY_RESULT_INVALID_INSTANCE;
         if (component_id == 0)
         {
-            float* position = instance->m_Transform.GetPositionPtr();
-            float* rotation = instance->m_Transform.GetRotationPtr();
-            float* scale = instance->m_Transform.GetScalePtr();
+            SetDirtyTransform(instance);
+            float* position = GetLocalTransform(instance).GetPositionPtr();
+            float* rotation = GetLocalTransform(instance).GetRotationPtr();
+            float* scale = GetLocalTransform(instance).GetScalePtr();
             if (property_id == PROP_POSITION)
             {
                 if (value.m_Type != PROPERTY_TYPE_VECTOR3)
@@ -3420,7 +3627,7 @@ namespace dmGameObject
     //  - patch data structures for identification and input stack
     //  - copy the rest of the fields
     // The old instance is destroyed.
-    static void RecreateInstance(Collection* collection, uint16_t index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
+    static void RecreateInstance(Collection* collection, InstanceIndex index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
         HInstance instance = collection->m_Instances[index];
         // We don't support recreating instances that are 'transitioning'
         assert(instance->m_ToBeAdded == 0);
@@ -3438,8 +3645,7 @@ namespace dmGameObject
         new_instance->m_Parent = instance->m_Parent;
         new_instance->m_FirstChildIndex = instance->m_FirstChildIndex;
         new_instance->m_SiblingIndex = instance->m_SiblingIndex;
-        // transform-related
-        new_instance->m_Transform = instance->m_Transform;
+        // transform-related, the local transform is kept in the collection
         new_instance->m_EulerRotation = instance->m_EulerRotation;
         new_instance->m_PrevEulerRotation = instance->m_PrevEulerRotation;
         new_instance->m_ScaleAlongZ = instance->m_ScaleAlongZ;
@@ -3487,11 +3693,11 @@ namespace dmGameObject
         Collection* collection = (Collection*) params.m_UserData;
         for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
         {
-            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            dmArray<LevelIndex>& level = collection->m_LevelIndices[level_i];
             uint32_t instance_count = level.Size();
             for (uint32_t i = 0; i < instance_count; ++i)
             {
-                uint16_t index = level[i];
+                InstanceIndex index = level[i].m_Index;
                 Instance* instance = collection->m_Instances[index];
                 if (instance->m_Prototype == params.m_Resource->m_Resource) {
                     RecreateInstance(collection, index, (Prototype*)params.m_Resource->m_PrevResource, (Prototype*)params.m_Resource->m_Resource, params.m_Name);
@@ -3534,7 +3740,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToAdd;
             ++count;
@@ -3546,7 +3752,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToDeleteHead;
+        InstanceIndex index = collection->m_InstancesToDeleteHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToDelete;
             ++count;
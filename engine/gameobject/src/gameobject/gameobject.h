@@ -19,6 +19,7 @@
 
 #include <dlib/easing.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_pool.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -571,7 +572,11 @@ namespace dmGameObject
         FIteratorProperties     m_IterProperties; // for debug/testing
         uint32_t                m_InstanceHasUserData : 1;
         uint32_t                m_ReadsTransforms : 1;
-        uint32_t                : 30;
+        /// The render function only touches the component world and the render list, and may be
+        /// called on a worker thread at the same time as the render functions of other component types.
+        /// See SetRenderArenaCallbacks
+        uint32_t                m_RenderParallel : 1;
+        uint32_t                : 29;
         uint16_t                m_UpdateOrderPrio;
     };
 
@@ -591,7 +596,7 @@ namespace dmGameObject
     /**
      * Set default capacity of collections in this register. This does not affect existing collections.
      * @param regist Register
-     * @param capacity Default capacity of collections in this register (0-32766).
+     * @param capacity Default capacity of collections in this register (0-32766, or 0-2147483646 when built with DM_GAMEOBJECT_LARGE_COLLECTIONS).
      * @return RESULT_OK on success or RESULT_INVALID_OPERATION if max_count is not within range
      */
     Result SetCollectionDefaultCapacity(HRegister regist, uint32_t capacity);
@@ -610,6 +615,43 @@ namespace dmGameObject
      */
     void SetInputStackDefaultCapacity(HRegister regist, uint32_t capacity);
 
+    /**
+     * Set the job pool used to update the collections in this register in parallel.
+     * The job pool is not owned by the register, and must outlive it.
+     * @param regist Register
+     * @param job_pool Job pool, or 0x0 to update on the calling thread only
+     */
+    void SetJobPool(HRegister regist, dmJobPool::HJobPool job_pool);
+
+    /**
+     * Callbacks used to build the render lists of component types in parallel, without making the
+     * register depend on the renderer. An arena holds the render list entries of one component type.
+     */
+    struct RenderArenaCallbacks
+    {
+        /// Create an arena
+        void* (*m_NewArena)(void* context);
+        /// Delete an arena
+        void  (*m_DeleteArena)(void* context, void* arena);
+        /// Bind an arena to the calling thread, or unbind it if arena is 0x0
+        void  (*m_BindArena)(void* context, void* arena);
+        /// Append the contents of an arena to the render list, and clear the arena
+        void  (*m_MergeArena)(void* context, void* arena);
+        void* m_Context;
+    };
+
+    /**
+     * Enable parallel rendering of the component types that have m_RenderParallel set. Their render
+     * functions are called on the job pool (see SetJobPool), each with its own arena bound. The arenas
+     * are merged in component type order, interleaved with the component types that are rendered on the
+     * calling thread, so the render list is the same as when all component types are rendered serially.
+     * Only the render list entries are built in parallel. The vertex data is still generated by the render
+     * list dispatch functions, on the thread that draws the render list.
+     * @param regist Register
+     * @param callbacks Arena callbacks, or 0x0 to render all component types on the calling thread
+     */
+    void SetRenderArenaCallbacks(HRegister regist, const RenderArenaCallbacks* callbacks);
+
     /**
      * Delete a component type register
      * @param regist Register to delete
@@ -82,8 +82,21 @@ namespace dmGameObject
         dmArray<void*> m_PropertyResources;
     };
 
-    // Invalid instance index. Implies that maximum number of instances is 32766 (ie 0x7fff - 1)
-    const uint32_t INVALID_INSTANCE_INDEX = 0x7fff;
+#if defined(DM_GAMEOBJECT_LARGE_COLLECTIONS)
+    // 32-bit instance indices. Adds 16 bytes to each Instance and doubles the size of the
+    // index pool and level tables of a collection (see CalcSize in res_collection.cpp)
+    typedef uint32_t InstanceIndex;
+    typedef dmIndexPool32 InstanceIndexPool;
+    const uint32_t INSTANCE_INDEX_BITS = 31;
+#else
+    typedef uint16_t InstanceIndex;
+    typedef dmIndexPool16 InstanceIndexPool;
+    const uint32_t INSTANCE_INDEX_BITS = 15;
+#endif
+
+    // Invalid instance index. Implies that maximum number of instances is 32766 (ie 0x7fff - 1),
+    // or 2147483646 (ie 0x7fffffff - 1) with DM_GAMEOBJECT_LARGE_COLLECTIONS
+    const uint32_t INVALID_INSTANCE_INDEX = (1U << INSTANCE_INDEX_BITS) - 1;
 
     // NOTE: Actual size of Instance is sizeof(Instance) + sizeof(uintptr_t) * m_UserDataCount
     struct Instance
@@ -91,7 +104,6 @@ namespace dmGameObject
         Instance(Prototype* prototype)
         {
             m_Collection = 0;
-            m_Transform.SetIdentity();
             m_EulerRotation = Vector3(0.0f, 0.0f, 0.0f);
             m_PrevEulerRotation = Vector3(0.0f, 0.0f, 0.0f);
             m_Prototype = prototype;
@@ -118,7 +130,7 @@ namespace dmGameObject
         {
         }
 
-        dmTransform::Transform m_Transform;
+        // NOTE: The local transform is stored in Collection::m_LocalTransforms, see GetLocalTransform()
 
         // Shadowed rotation expressed in euler coordinates
         Vector3 m_EulerRotation;
@@ -150,18 +162,18 @@ namespace dmGameObject
         uint16_t        m_Pad : 4;
 
         // Index to parent
-        uint16_t        m_Parent : 16;
+        InstanceIndex   m_Parent;
 
         // Index to Collection::m_Instances
-        uint16_t        m_Index : 15;
+        InstanceIndex   m_Index : INSTANCE_INDEX_BITS;
         // Used for deferred deletion
-        uint16_t        m_ToBeDeleted : 1;
+        InstanceIndex   m_ToBeDeleted : 1;
 
         // Index to Collection::m_LevelIndex. Index is relative to current level (m_Depth), eg first object in level L always has level-index 0
         // Level-index is used to reorder Collection::m_LevelIndex entries in O(1). Given an instance we need to find where the
         // instance index is located in Collection::m_LevelIndex
-        uint16_t        m_LevelIndex : 15;
-        uint16_t        m_Pad2 : 1;
+        InstanceIndex   m_LevelIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_Pad2 : 1;
 
 #ifdef __EMSCRIPTEN__
         // TODO: FIX!! Workaround for LLVM/Clang bug when compiling with any optimization level > 0.
@@ -177,23 +189,32 @@ namespace dmGameObject
 #endif
 
         // Index to next instance to delete or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToDelete : 16;
+        InstanceIndex   m_NextToDelete;
 
         // Index to next instance to add-to-update or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToAdd;
+        InstanceIndex   m_NextToAdd;
 
         // Next sibling index. Index to Collection::m_Instances
-        uint16_t        m_SiblingIndex : 15;
-        uint16_t        m_ToBeAdded : 1;
+        InstanceIndex   m_SiblingIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_ToBeAdded : 1;
 
         // First child index. Index to Collection::m_Instances
-        uint16_t        m_FirstChildIndex : 15;
-        uint16_t        m_Pad4 : 1;
+        InstanceIndex   m_FirstChildIndex : INSTANCE_INDEX_BITS;
+        InstanceIndex   m_Pad4 : 1;
 
         uint32_t        m_ComponentInstanceUserDataCount;
         uintptr_t       m_ComponentInstanceUserData[0];
     };
 
+    // Entry in Collection::m_LevelIndices
+    struct LevelIndex
+    {
+        // Index to Collection::m_Instances
+        InstanceIndex m_Index;
+        // Copy of Instance::m_Parent, so that the transform update only needs to read the level tables
+        InstanceIndex m_Parent;
+    };
+
     // Max component types could not be larger than 255 since the index is stored as a uint8_t
     const uint32_t MAX_COMPONENT_TYPES = 255;
 
@@ -214,6 +235,14 @@ namespace dmGameObject
 
         dmHashTable64<Collection*>  m_SocketToCollection;
 
+        // Workers used for data parallel updates, not owned by the register. May be 0x0
+        dmJobPool::HJobPool         m_JobPool;
+
+        // Used to render component types in parallel, see SetRenderArenaCallbacks
+        RenderArenaCallbacks        m_RenderArenaCallbacks;
+        // Arenas by component type index, created on demand
+        void*                       m_RenderArenas[MAX_COMPONENT_TYPES];
+
         Register();
         ~Register();
     };
@@ -249,7 +278,7 @@ namespace dmGameObject
         dmArray<Instance*>       m_Instances;
 
         // Index pool for mapping Instance::m_Index to m_Instances
-        dmIndexPool16            m_InstanceIndices;
+        InstanceIndexPool        m_InstanceIndices;
 
         // Resources referenced through property overrides inside the collection
         dmArray<void*>           m_PropertyResources;
@@ -259,10 +288,20 @@ namespace dmGameObject
         // Two dimensional table of indices with stride "max_instances"
         // Level 0 contains root-nodes in [0..m_LevelIndices[0].Size()-1]
         // Level 1 contains level 1 indices in [0..m_LevelIndices[1].Size()-1]
-        dmArray<uint16_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
+        dmArray<LevelIndex>      m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
 
+        // Transform data is kept in flat arrays indexed by Instance::m_Index, rather than in the
+        // instances, so that UpdateTransforms can process it without touching the instances.
+        // Array of local transforms
+        dmArray<dmTransform::Transform> m_LocalTransforms;
         // Array of world transforms. Calculated using m_LevelIndices above
         dmArray<Matrix4>         m_WorldTransforms;
+        // Value of m_TransformGeneration when the world transform was last calculated, or zero if
+        // the local transform has changed since. Used to propagate changes down the hierarchy
+        dmArray<uint32_t>        m_TransformGenerations;
+
+        // Incremented for each call to UpdateTransforms, never zero after the first call
+        uint32_t                 m_TransformGeneration;
 
         // Identifier to Instance mapping
         dmHashTable64<Instance*> m_IDToInstance;
@@ -286,14 +325,14 @@ namespace dmGameObject
         dmIndexPool32            m_InstanceIdPool;
 
         // Head of linked list of instances scheduled for deferred deletion
-        uint16_t                 m_InstancesToDeleteHead;
+        InstanceIndex            m_InstancesToDeleteHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToDeleteTail;
+        InstanceIndex            m_InstancesToDeleteTail;
 
         // Head of linked list of instances scheduled to be added to update
-        uint16_t                 m_InstancesToAddHead;
+        InstanceIndex            m_InstancesToAddHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToAddTail;
+        InstanceIndex            m_InstancesToAddTail;
 
         // Set to 1 if in update-loop
         uint32_t                 m_InUpdate : 1;
@@ -310,6 +349,20 @@ namespace dmGameObject
         Collection* m_Collection;
     };
 
+    // Flag the local transform of the instance as changed. The world transforms of the instance and
+    // all its descendants are recalculated in the next call to UpdateTransforms
+    inline void SetDirtyTransform(Instance* instance)
+    {
+        Collection* collection = instance->m_Collection;
+        collection->m_TransformGenerations[instance->m_Index] = 0;
+        collection->m_DirtyTransforms = 1;
+    }
+
+    inline dmTransform::Transform& GetLocalTransform(Instance* instance)
+    {
+        return instance->m_Collection->m_LocalTransforms[instance->m_Index];
+    }
+
     ComponentType* FindComponentType(Register* regist, uint32_t resource_type, uint32_t* index);
 
     // Used by res_collection.cpp
@@ -398,6 +398,49 @@ namespace dmGameObject
         return instance;
     }
 
+    // The transform getters take an optional value to write the result to, after the optional id.
+    // The out value is moved to the bottom of the stack so that the id is the last argument, as
+    // expected by ResolveInstance. out_index is set to the stack index of the out value, or 0.
+    static Instance* ResolveInstanceAndOut(lua_State* L, int* out_index)
+    {
+        if (lua_gettop(L) >= 2 && !lua_isnil(L, 2))
+        {
+            lua_settop(L, 2);
+            lua_insert(L, 1);
+            *out_index = 1;
+            return ResolveInstance(L, 2);
+        }
+        lua_settop(L, 1);
+        *out_index = 0;
+        return ResolveInstance(L, 1);
+    }
+
+    static void PushVector3Out(lua_State* L, int out_index, const Vectormath::Aos::Vector3& v)
+    {
+        if (out_index)
+        {
+            *dmScript::CheckVector3(L, out_index) = v;
+            lua_pushvalue(L, out_index);
+        }
+        else
+        {
+            dmScript::PushVector3(L, v);
+        }
+    }
+
+    static void PushQuatOut(lua_State* L, int out_index, const Vectormath::Aos::Quat& q)
+    {
+        if (out_index)
+        {
+            *dmScript::CheckQuat(L, out_index) = q;
+            lua_pushvalue(L, out_index);
+        }
+        else
+        {
+            dmScript::PushQuat(L, q);
+        }
+    }
+
     static Result GetComponentUserData(HInstance instance, dmhash_t component_id, uint32_t* component_type, uintptr_t* user_data)
     {
         // TODO: We should probably not store user-data sparse.
@@ -724,7 +767,8 @@ namespace dmGameObject
      * @name go.get_position
      * @replaces request_transform transform_response
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the position for, by default the instance of the calling script
-     * @return position [type:vector3] instance position
+     * @param [out] [type:vector3] optional vector3 to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return position [type:vector3] instance position, the `out` value if given
      * @examples
      *
      * Get the position of the game object instance the script is attached to:
@@ -738,11 +782,18 @@ namespace dmGameObject
      * ```lua
      * local pos = go.get_position("my_gameobject")
      * ```
+     *
+     * Get the position into an existing vector, without allocating a new one:
+     *
+     * ```lua
+     * go.get_position(nil, self.pos)
+     * ```
      */
     int Script_GetPosition(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, Vectormath::Aos::Vector3(dmGameObject::GetPosition(instance)));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushVector3Out(L, out_index, Vectormath::Aos::Vector3(dmGameObject::GetPosition(instance)));
         return 1;
     }
 
@@ -751,7 +802,8 @@ namespace dmGameObject
      *
      * @name go.get_rotation
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the rotation for, by default the instance of the calling script
-     * @return rotation [type:quaternion] instance rotation
+     * @param [out] [type:quaternion] optional quaternion to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return rotation [type:quaternion] instance rotation, the `out` value if given
      * @examples
      *
      * Get the rotation of the game object instance the script is attached to:
@@ -768,8 +820,9 @@ namespace dmGameObject
      */
     int Script_GetRotation(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushQuat(L, dmGameObject::GetRotation(instance));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushQuatOut(L, out_index, dmGameObject::GetRotation(instance));
         return 1;
     }
 
@@ -778,7 +831,8 @@ namespace dmGameObject
      *
      * @name go.get_scale
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the scale for, by default the instance of the calling script
-     * @return scale [type:vector3] instance scale factor
+     * @param [out] [type:vector3] optional vector3 to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return scale [type:vector3] instance scale factor, the `out` value if given
      * @examples
      *
      * Get the scale of the game object instance the script is attached to:
@@ -795,8 +849,9 @@ namespace dmGameObject
      */
     int Script_GetScale(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, dmGameObject::GetScale(instance));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushVector3Out(L, out_index, dmGameObject::GetScale(instance));
         return 1;
     }
 
@@ -1069,7 +1124,8 @@ namespace dmGameObject
      *
      * @name go.get_world_position
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the world position for, by default the instance of the calling script
-     * @return position [type:vector3] instance world position
+     * @param [out] [type:vector3] optional vector3 to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return position [type:vector3] instance world position, the `out` value if given
      * @examples
      *
      * Get the world position of the game object instance the script is attached to:
@@ -1086,8 +1142,9 @@ namespace dmGameObject
      */
     int Script_GetWorldPosition(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, Vectormath::Aos::Vector3(dmGameObject::GetWorldPosition(instance)));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushVector3Out(L, out_index, Vectormath::Aos::Vector3(dmGameObject::GetWorldPosition(instance)));
         return 1;
     }
 
@@ -1096,7 +1153,8 @@ namespace dmGameObject
      *
      * @name go.get_world_rotation
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the world rotation for, by default the instance of the calling script
-     * @return rotation [type:quaternion] instance world rotation
+     * @param [out] [type:quaternion] optional quaternion to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return rotation [type:quaternion] instance world rotation, the `out` value if given
      * @examples
      *
      * Get the world rotation of the game object instance the script is attached to:
@@ -1113,8 +1171,9 @@ namespace dmGameObject
      */
     int Script_GetWorldRotation(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushQuat(L, dmGameObject::GetWorldRotation(instance));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushQuatOut(L, out_index, dmGameObject::GetWorldRotation(instance));
         return 1;
     }
 
@@ -1125,7 +1184,8 @@ namespace dmGameObject
      *
      * @name go.get_world_scale
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the world scale for, by default the instance of the calling script
-     * @return scale [type:vector3] instance world 3D scale factor
+     * @param [out] [type:vector3] optional vector3 to store the result in, instead of allocating a new one. Pass `nil` as id to use the calling script instance
+     * @return scale [type:vector3] instance world 3D scale factor, the `out` value if given
      * @examples
      *
      * Get the world 3D scale of the game object instance the script is attached to:
@@ -1142,8 +1202,9 @@ namespace dmGameObject
      */
     int Script_GetWorldScale(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, dmGameObject::GetWorldScale(instance));
+        int out_index;
+        Instance* instance = ResolveInstanceAndOut(L, &out_index);
+        PushVector3Out(L, out_index, dmGameObject::GetWorldScale(instance));
         return 1;
     }
 
@@ -0,0 +1,256 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <math.h>
+#include <string.h>
+#include <dlib/align.h>
+
+#include "gameobject_transform.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DM_TRANSFORM_SSE
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define DM_TRANSFORM_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace dmGameObject
+{
+    using namespace Vectormath::Aos;
+
+    // Four lanes of floats, one lane per instance
+#if defined(DM_TRANSFORM_SSE)
+    typedef __m128 Vec4f;
+    static inline Vec4f Load(const float* p)                { return _mm_load_ps(p); }
+    static inline void  Store(float* p, Vec4f v)            { _mm_store_ps(p, v); }
+    static inline Vec4f Splat(float v)                      { return _mm_set1_ps(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return _mm_add_ps(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return _mm_sub_ps(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return _mm_mul_ps(a, b); }
+    static inline Vec4f MulAdd(Vec4f a, Vec4f b, Vec4f c)   { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#elif defined(DM_TRANSFORM_NEON)
+    typedef float32x4_t Vec4f;
+    static inline Vec4f Load(const float* p)                { return vld1q_f32(p); }
+    static inline void  Store(float* p, Vec4f v)            { vst1q_f32(p, v); }
+    static inline Vec4f Splat(float v)                      { return vdupq_n_f32(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return vaddq_f32(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return vsubq_f32(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return vmulq_f32(a, b); }
+    static inline Vec4f MulAdd(Vec4f a, Vec4f b, Vec4f c)   { return vmlaq_f32(c, a, b); }
+#else
+    struct Vec4f
+    {
+        float v[4];
+    };
+    static inline Vec4f Load(const float* p)                { Vec4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    static inline void  Store(float* p, Vec4f v)            { memcpy(p, v.v, sizeof(v.v)); }
+    static inline Vec4f Splat(float v)                      { Vec4f r = {{v, v, v, v}}; return r; }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+    static inline Vec4f MulAdd(Vec4f a, Vec4f b, Vec4f c)   { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i] + c.v[i]; return r; }
+#endif
+
+    static const uint32_t LANE_COUNT = 4;
+
+    // Structure-of-arrays view of four instances
+    struct TransformLanes
+    {
+        float DM_ALIGNED(16) m_Rotation[4][LANE_COUNT];
+        float DM_ALIGNED(16) m_Translation[3][LANE_COUNT];
+        float DM_ALIGNED(16) m_Scale[3][LANE_COUNT];
+        // Parent matrix, column major
+        float DM_ALIGNED(16) m_Parent[16][LANE_COUNT];
+        // Resulting matrix, column major
+        float DM_ALIGNED(16) m_World[16][LANE_COUNT];
+    };
+
+    static inline void GatherLocal(TransformLanes& lanes, uint32_t lane, const dmTransform::Transform* t)
+    {
+        const Quat& r = t->GetRotation();
+        const Vector3& p = t->GetTranslation();
+        const Vector3& s = t->GetScale();
+        lanes.m_Rotation[0][lane] = r.getX();
+        lanes.m_Rotation[1][lane] = r.getY();
+        lanes.m_Rotation[2][lane] = r.getZ();
+        lanes.m_Rotation[3][lane] = r.getW();
+        lanes.m_Translation[0][lane] = p.getX();
+        lanes.m_Translation[1][lane] = p.getY();
+        lanes.m_Translation[2][lane] = p.getZ();
+        lanes.m_Scale[0][lane] = s.getX();
+        lanes.m_Scale[1][lane] = s.getY();
+        lanes.m_Scale[2][lane] = s.getZ();
+    }
+
+    static inline void GatherParent(TransformLanes& lanes, uint32_t lane, const Matrix4* m, bool scale_along_z)
+    {
+        const float* src = (const float*)m;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            lanes.m_Parent[i][lane] = src[i];
+        }
+        if (!scale_along_z)
+        {
+            // The translation uses the parent without z-scale, see dmTransform::MulNoScaleZ.
+            // The normalized z-column is stored in the result lanes of the z-column, which are
+            // read before they are overwritten.
+            float x = src[8], y = src[9], z = src[10], w = src[11];
+            float length_sq = x*x + y*y + z*z + w*w;
+            float f = length_sq > 0.0f ? 1.0f / sqrtf(length_sq) : 1.0f;
+            lanes.m_World[8][lane] = x * f;
+            lanes.m_World[9][lane] = y * f;
+            lanes.m_World[10][lane] = z * f;
+            lanes.m_World[11][lane] = w * f;
+        }
+    }
+
+    static inline void ScatterWorld(const TransformLanes& lanes, uint32_t lane, Matrix4* m)
+    {
+        float* dst = (float*)m;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            dst[i] = lanes.m_World[i][lane];
+        }
+    }
+
+    // Calculates the local matrices of the lanes, each column (c0, c1, c2, c3) as xyz(w) lanes
+    static inline void CalculateLocal(const TransformLanes& lanes, Vec4f local[12])
+    {
+        Vec4f qx = Load(lanes.m_Rotation[0]);
+        Vec4f qy = Load(lanes.m_Rotation[1]);
+        Vec4f qz = Load(lanes.m_Rotation[2]);
+        Vec4f qw = Load(lanes.m_Rotation[3]);
+        Vec4f qx2 = Add(qx, qx);
+        Vec4f qy2 = Add(qy, qy);
+        Vec4f qz2 = Add(qz, qz);
+        Vec4f qxqx2 = Mul(qx, qx2);
+        Vec4f qxqy2 = Mul(qx, qy2);
+        Vec4f qxqz2 = Mul(qx, qz2);
+        Vec4f qxqw2 = Mul(qw, qx2);
+        Vec4f qyqy2 = Mul(qy, qy2);
+        Vec4f qyqz2 = Mul(qy, qz2);
+        Vec4f qyqw2 = Mul(qw, qy2);
+        Vec4f qzqz2 = Mul(qz, qz2);
+        Vec4f qzqw2 = Mul(qw, qz2);
+        Vec4f one = Splat(1.0f);
+
+        Vec4f sx = Load(lanes.m_Scale[0]);
+        Vec4f sy = Load(lanes.m_Scale[1]);
+        Vec4f sz = Load(lanes.m_Scale[2]);
+
+        local[0] = Mul(Sub(Sub(one, qyqy2), qzqz2), sx);
+        local[1] = Mul(Add(qxqy2, qzqw2), sx);
+        local[2] = Mul(Sub(qxqz2, qyqw2), sx);
+        local[3] = Mul(Sub(qxqy2, qzqw2), sy);
+        local[4] = Mul(Sub(Sub(one, qxqx2), qzqz2), sy);
+        local[5] = Mul(Add(qyqz2, qxqw2), sy);
+        local[6] = Mul(Add(qxqz2, qyqw2), sz);
+        local[7] = Mul(Sub(qyqz2, qxqw2), sz);
+        local[8] = Mul(Sub(Sub(one, qxqx2), qyqy2), sz);
+        local[9] = Load(lanes.m_Translation[0]);
+        local[10] = Load(lanes.m_Translation[1]);
+        local[11] = Load(lanes.m_Translation[2]);
+    }
+
+    static void CalculateLanes(TransformLanes& lanes, bool root, bool scale_along_z)
+    {
+        Vec4f local[12];
+        CalculateLocal(lanes, local);
+
+        Vec4f zero = Splat(0.0f);
+        Vec4f one = Splat(1.0f);
+        if (root)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                Store(lanes.m_World[c*4+0], local[c*3+0]);
+                Store(lanes.m_World[c*4+1], local[c*3+1]);
+                Store(lanes.m_World[c*4+2], local[c*3+2]);
+                Store(lanes.m_World[c*4+3], c == 3 ? one : zero);
+            }
+            return;
+        }
+
+        // Parent columns, four rows each
+        Vec4f p[16];
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            p[i] = Load(lanes.m_Parent[i]);
+        }
+
+        // Column used for the z-translation
+        Vec4f pz[4] = { p[8], p[9], p[10], p[11] };
+        if (!scale_along_z)
+        {
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                pz[r] = Load(lanes.m_World[8 + r]);
+            }
+        }
+
+        // world.col[c] = parent * local.col[c], where local.col[c].w is 0 for c < 3
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            Vec4f lx = local[c*3+0];
+            Vec4f ly = local[c*3+1];
+            Vec4f lz = local[c*3+2];
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                Vec4f v = Mul(p[r], lx);
+                v = MulAdd(p[4 + r], ly, v);
+                v = MulAdd(p[8 + r], lz, v);
+                Store(lanes.m_World[c*4 + r], v);
+            }
+        }
+
+        // world.col[3] = parent * (t, 1)
+        Vec4f tx = local[9];
+        Vec4f ty = local[10];
+        Vec4f tz = local[11];
+        for (uint32_t r = 0; r < 4; ++r)
+        {
+            Vec4f v = MulAdd(p[r], tx, p[12 + r]);
+            v = MulAdd(p[4 + r], ty, v);
+            v = MulAdd(pz[r], tz, v);
+            Store(lanes.m_World[12 + r], v);
+        }
+    }
+
+    void CalculateWorldTransforms(const dmTransform::Transform* const* local, const Matrix4* const* parent_world,
+                                  Matrix4** world, uint32_t count, bool scale_along_z)
+    {
+        bool root = parent_world == 0x0;
+        TransformLanes lanes;
+        for (uint32_t i = 0; i < count; i += LANE_COUNT)
+        {
+            uint32_t n = count - i < LANE_COUNT ? count - i : LANE_COUNT;
+            for (uint32_t lane = 0; lane < LANE_COUNT; ++lane)
+            {
+                // Unused lanes repeat the first instance, and are never written back
+                uint32_t index = i + (lane < n ? lane : 0);
+                GatherLocal(lanes, lane, local[index]);
+                if (!root)
+                {
+                    GatherParent(lanes, lane, parent_world[index], scale_along_z);
+                }
+            }
+
+            CalculateLanes(lanes, root, scale_along_z);
+
+            for (uint32_t lane = 0; lane < n; ++lane)
+            {
+                ScatterWorld(lanes, lane, world[i + lane]);
+            }
+        }
+    }
+}
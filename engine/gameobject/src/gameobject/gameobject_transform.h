@@ -0,0 +1,36 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef GAMEOBJECT_TRANSFORM_H
+#define GAMEOBJECT_TRANSFORM_H
+
+#include <stdint.h>
+
+#include <dlib/transform.h>
+#include <dlib/vmath.h>
+
+namespace dmGameObject
+{
+    /**
+     * Calculate world transforms for a batch of instances.
+     * The instances are processed four at a time, using SSE or NEON when available.
+     * @param local local transforms
+     * @param parent_world world transforms of the parents, or 0x0 when all instances are root-level instances
+     * @param world world transforms to write, must not alias any of the parent world transforms
+     * @param count number of instances
+     * @param scale_along_z if the translation should be scaled by the z-scale of the parent (see dmTransform::MulNoScaleZ)
+     */
+    void CalculateWorldTransforms(const dmTransform::Transform* const* local, const Vectormath::Aos::Matrix4* const* parent_world,
+                                  Vectormath::Aos::Matrix4** world, uint32_t count, bool scale_along_z);
+}
+
+#endif // GAMEOBJECT_TRANSFORM_H
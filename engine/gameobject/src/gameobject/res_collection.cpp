@@ -75,7 +75,7 @@ namespace dmGameObject
                     scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
                 }
 
-                instance->m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+                GetLocalTransform(instance) = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
 
                 dmHashInit64(&instance->m_CollectionPathHashState, true);
                 const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
@@ -242,8 +242,14 @@ bail:
     static size_t CalcSize(Collection* collection)
     {
         size_t size = sizeof(Collection) + sizeof(CollectionHandle);
-        size += collection->m_InstanceIndices.Capacity()*sizeof(uint16_t);
+        size += collection->m_InstanceIndices.Capacity()*sizeof(InstanceIndex);
+        for (uint32_t i = 0; i < MAX_HIERARCHICAL_DEPTH; ++i)
+        {
+            size += collection->m_LevelIndices[i].Capacity()*sizeof(LevelIndex);
+        }
+        size += collection->m_LocalTransforms.Capacity()*sizeof(dmTransform::Transform);
         size += collection->m_WorldTransforms.Capacity()*sizeof(Matrix4);
+        size += collection->m_TransformGenerations.Capacity()*sizeof(uint32_t);
         size += collection->m_IDToInstance.Capacity()*(sizeof(Instance*)+sizeof(dmhash_t));
         size += collection->m_InputFocusStack.Capacity()*sizeof(Instance*);
         size += collection->m_Instances.Capacity()*sizeof(Instance*);
@@ -447,7 +447,7 @@ TEST_F(CollectionTest, DefaultValues)
     ASSERT_EQ(2U, instance_count);
     for (uint32_t i = 0; i < instance_count; ++i)
     {
-        dmGameObject::HInstance instance = hcollection->m_Collection->m_Instances[hcollection->m_Collection->m_LevelIndices[0][i]];
+        dmGameObject::HInstance instance = hcollection->m_Collection->m_Instances[hcollection->m_Collection->m_LevelIndices[0][i].m_Index];
         ASSERT_NE((void*)0, instance);
         Vectormath::Aos::Point3 p = dmGameObject::GetPosition(instance);
         ASSERT_EQ(0.0f, p.getX());
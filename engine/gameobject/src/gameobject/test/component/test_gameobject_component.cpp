@@ -14,9 +14,13 @@
 #include <jc_test/jc_test.h>
 
 #include <map>
+#include <string.h>
 
+#include <dlib/atomic.h>
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
+#include <dlib/job_pool.h>
+#include <dlib/thread.h>
 
 #include <resource/resource.h>
 
@@ -533,6 +537,143 @@ TEST_F(ComponentTest, FinalCallsFinal)
     dmGameObject::PostUpdate(m_Register);
 }
 
+// Fake render list, where each render function appends the name of its component type
+struct TestRenderList
+{
+    char     m_Names[16];
+    uint32_t m_Count;
+};
+
+struct TestRenderArenaContext
+{
+    TestRenderList      m_RenderList;
+    dmThread::TlsKey    m_BoundArena;
+    int32_atomic_t      m_ParallelRenderCount;
+    uint32_t            m_ArenaCount;
+    uint32_t            m_MergeCount;
+};
+
+static TestRenderArenaContext* g_RenderArenaContext = 0;
+
+static void* TestNewArena(void* context)
+{
+    TestRenderArenaContext* ctx = (TestRenderArenaContext*)context;
+    ctx->m_ArenaCount++;
+    TestRenderList* arena = new TestRenderList;
+    arena->m_Count = 0;
+    return arena;
+}
+
+static void TestDeleteArena(void* context, void* arena)
+{
+    TestRenderArenaContext* ctx = (TestRenderArenaContext*)context;
+    ctx->m_ArenaCount--;
+    delete (TestRenderList*)arena;
+}
+
+static void TestBindArena(void* context, void* arena)
+{
+    TestRenderArenaContext* ctx = (TestRenderArenaContext*)context;
+    dmThread::SetTlsValue(ctx->m_BoundArena, arena);
+}
+
+static void TestMergeArena(void* context, void* _arena)
+{
+    TestRenderArenaContext* ctx = (TestRenderArenaContext*)context;
+    TestRenderList* arena = (TestRenderList*)_arena;
+    for (uint32_t i = 0; i < arena->m_Count; ++i)
+    {
+        ctx->m_RenderList.m_Names[ctx->m_RenderList.m_Count++] = arena->m_Names[i];
+    }
+    arena->m_Count = 0;
+    ctx->m_MergeCount++;
+}
+
+template <char name>
+static dmGameObject::UpdateResult TestComponentsRender(const dmGameObject::ComponentsRenderParams& params)
+{
+    TestRenderArenaContext* ctx = g_RenderArenaContext;
+    TestRenderList* render_list = (TestRenderList*)dmThread::GetTlsValue(ctx->m_BoundArena);
+    if (render_list)
+    {
+        dmAtomicIncrement32(&ctx->m_ParallelRenderCount);
+    }
+    else
+    {
+        render_list = &ctx->m_RenderList;
+    }
+    render_list->m_Names[render_list->m_Count++] = name;
+    return dmGameObject::UPDATE_RESULT_OK;
+}
+
+TEST_F(ComponentTest, TestRenderParallel)
+{
+    TestRenderArenaContext ctx;
+    ctx.m_RenderList.m_Count = 0;
+    ctx.m_BoundArena = dmThread::AllocTls();
+    ctx.m_ParallelRenderCount = 0;
+    ctx.m_ArenaCount = 0;
+    ctx.m_MergeCount = 0;
+    g_RenderArenaContext = &ctx;
+
+    // Update order is c, b, a, where a and c are rendered in parallel
+    for (uint32_t i = 0; i < m_Register->m_ComponentTypeCount; ++i)
+    {
+        dmGameObject::ComponentType* type = &m_Register->m_ComponentTypes[i];
+        if (strcmp(type->m_Name, "a") == 0)
+        {
+            type->m_RenderFunction = TestComponentsRender<'a'>;
+            type->m_RenderParallel = 1;
+        }
+        else if (strcmp(type->m_Name, "b") == 0)
+        {
+            type->m_RenderFunction = TestComponentsRender<'b'>;
+        }
+        else if (strcmp(type->m_Name, "c") == 0)
+        {
+            type->m_RenderFunction = TestComponentsRender<'c'>;
+            type->m_RenderParallel = 1;
+        }
+    }
+
+    dmGameObject::RenderArenaCallbacks callbacks;
+    callbacks.m_NewArena = TestNewArena;
+    callbacks.m_DeleteArena = TestDeleteArena;
+    callbacks.m_BindArena = TestBindArena;
+    callbacks.m_MergeArena = TestMergeArena;
+    callbacks.m_Context = &ctx;
+    dmGameObject::SetRenderArenaCallbacks(m_Register, &callbacks);
+
+    // Without workers, everything is rendered on this thread
+    ASSERT_TRUE(dmGameObject::Render(m_Collection));
+    ASSERT_EQ(3U, ctx.m_RenderList.m_Count);
+    ASSERT_EQ(0, memcmp("cba", ctx.m_RenderList.m_Names, 3));
+    ASSERT_EQ(0U, ctx.m_ArenaCount);
+
+    dmJobPool::HJobPool job_pool = dmJobPool::New(2, "test_worker");
+    dmGameObject::SetJobPool(m_Register, job_pool);
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        ctx.m_RenderList.m_Count = 0;
+        ASSERT_TRUE(dmGameObject::Render(m_Collection));
+        // Same order as when rendered serially
+        ASSERT_EQ(3U, ctx.m_RenderList.m_Count);
+        ASSERT_EQ(0, memcmp("cba", ctx.m_RenderList.m_Names, 3));
+    }
+    ASSERT_EQ(200, ctx.m_ParallelRenderCount);
+    ASSERT_EQ(200U, ctx.m_MergeCount);
+    ASSERT_EQ(2U, ctx.m_ArenaCount);
+
+    dmGameObject::SetRenderArenaCallbacks(m_Register, 0x0);
+    ASSERT_EQ(0U, ctx.m_ArenaCount);
+
+    dmGameObject::SetJobPool(m_Register, 0x0);
+    dmJobPool::Delete(job_pool);
+    dmThread::FreeTls(ctx.m_BoundArena);
+    g_RenderArenaContext = 0;
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
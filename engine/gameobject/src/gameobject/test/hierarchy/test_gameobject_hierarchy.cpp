@@ -20,6 +20,8 @@
 #include <dlib/dstrings.h>
 #include <dlib/time.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/static_assert.h>
 #include <resource/resource.h>
 #include "../gameobject.h"
 #include "../gameobject_private.h"
@@ -566,6 +568,61 @@ TEST_F(HierarchyTest, TestMultiReparent)
     dmGameObject::Delete(m_Collection, child2, false);
 }
 
+TEST_F(HierarchyTest, TestDirtyTransforms)
+{
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance grandchild = dmGameObject::New(m_Collection, "/go.goc");
+    dmGameObject::HInstance other = dmGameObject::New(m_Collection, "/go.goc");
+
+    dmGameObject::SetParent(child, parent);
+    dmGameObject::SetParent(grandchild, child);
+
+    dmGameObject::SetPosition(parent, Point3(1, 0, 0));
+    dmGameObject::SetPosition(child, Point3(0, 2, 0));
+    dmGameObject::SetPosition(grandchild, Point3(0, 0, 3));
+
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_EQ(collection->m_TransformGeneration, collection->m_TransformGenerations[parent->m_Index]);
+    ASSERT_EQ(collection->m_TransformGeneration, collection->m_TransformGenerations[grandchild->m_Index]);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grandchild) - Point3(1, 2, 3)), EPSILON);
+
+    // Only the leaf changed, the rest of the hierarchy is left untouched
+    dmGameObject::SetPosition(grandchild, Point3(0, 0, 4));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NE(collection->m_TransformGeneration, collection->m_TransformGenerations[parent->m_Index]);
+    ASSERT_NE(collection->m_TransformGeneration, collection->m_TransformGenerations[child->m_Index]);
+    ASSERT_NE(collection->m_TransformGeneration, collection->m_TransformGenerations[other->m_Index]);
+    ASSERT_EQ(collection->m_TransformGeneration, collection->m_TransformGenerations[grandchild->m_Index]);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grandchild) - Point3(1, 2, 4)), EPSILON);
+
+    // A changed root propagates to all descendants
+    dmGameObject::SetPosition(parent, Point3(5, 0, 0));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_EQ(collection->m_TransformGeneration, collection->m_TransformGenerations[child->m_Index]);
+    ASSERT_EQ(collection->m_TransformGeneration, collection->m_TransformGenerations[grandchild->m_Index]);
+    ASSERT_NE(collection->m_TransformGeneration, collection->m_TransformGenerations[other->m_Index]);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(5, 2, 0)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grandchild) - Point3(5, 2, 4)), EPSILON);
+
+    // Properties set through the generic property interface also mark the transform as changed
+    dmGameObject::SetProperty(child, 0, dmHashString64("position.y"), dmGameObject::PropertyVar(6.0f));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NE(collection->m_TransformGeneration, collection->m_TransformGenerations[parent->m_Index]);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grandchild) - Point3(5, 6, 4)), EPSILON);
+
+    // Reparenting to the root level
+    dmGameObject::SetParent(grandchild, 0);
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grandchild) - Point3(0, 0, 4)), EPSILON);
+
+    dmGameObject::Delete(m_Collection, parent, false);
+    dmGameObject::Delete(m_Collection, child, false);
+    dmGameObject::Delete(m_Collection, grandchild, false);
+    dmGameObject::Delete(m_Collection, other, false);
+}
+
 TEST_F(HierarchyTest, TestHierarchyScale)
 {
     dmGameObject::HInstance parent = dmGameObject::New(m_Collection, "/go.goc");
@@ -871,6 +928,103 @@ TEST_F(HierarchyTest, TestHierarchyFromScript)
     dmGameObject::Delete(m_Collection, child, false);
 }
 
+// The collection capacity is limited by the width of the instance indices,
+// 200k instances are only reached when built with DM_GAMEOBJECT_LARGE_COLLECTIONS (test_gameobject_hierarchy_large_collections)
+static const uint32_t LARGE_COLLECTION_CAPACITY = dmMath::Min(200000U, dmGameObject::INVALID_INSTANCE_INDEX - 1);
+
+#if defined(DM_GAMEOBJECT_LARGE_COLLECTIONS)
+DM_STATIC_ASSERT(sizeof(dmGameObject::InstanceIndex) == sizeof(uint32_t), Invalid_Instance_Index_Size);
+
+TEST_F(HierarchyTest, TestInstanceIndexWidth)
+{
+    ASSERT_EQ(0x7fffffffU, dmGameObject::INVALID_INSTANCE_INDEX);
+    ASSERT_EQ(200000U, LARGE_COLLECTION_CAPACITY);
+
+    // Indices above the 16-bit range are stored and read back unchanged
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("wide_collection", m_Factory, m_Register, 70000);
+    ASSERT_NE((void*)0, collection);
+    dmGameObject::HInstance parent = 0;
+    dmGameObject::HInstance child = 0;
+    for (uint32_t i = 0; i < 70000; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::New(collection, 0x0);
+        ASSERT_NE((void*)0, go);
+        if (go->m_Index > 0xffff)
+        {
+            if (parent == 0)
+                parent = go;
+            else if (child == 0)
+                child = go;
+        }
+    }
+    ASSERT_NE((void*)0, child);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, parent));
+    ASSERT_EQ(parent, dmGameObject::GetParent(child));
+    ASSERT_EQ((uint32_t)parent->m_Index, (uint32_t)child->m_Parent);
+
+    dmGameObject::DeleteCollection(collection);
+}
+#else
+DM_STATIC_ASSERT(sizeof(dmGameObject::InstanceIndex) == sizeof(uint16_t), Invalid_Instance_Index_Size);
+#endif
+
+TEST_F(HierarchyTest, TestHierarchyLarge)
+{
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("large_collection", m_Factory, m_Register, LARGE_COLLECTION_CAPACITY);
+    ASSERT_NE((void*)0, collection);
+
+    // One deep chain at maximum depth, the rest of the instances as root/child pairs
+    const uint32_t chain_length = dmGameObject::MAX_HIERARCHICAL_DEPTH;
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(LARGE_COLLECTION_CAPACITY);
+    for (uint32_t i = 0; i < LARGE_COLLECTION_CAPACITY; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::New(collection, 0x0);
+        ASSERT_NE((void*)0, go);
+        dmGameObject::SetPosition(go, Point3(1.0f, 0.0f, 0.0f));
+        if (i > 0 && i < chain_length)
+        {
+            ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(go, instances[i - 1]));
+        }
+        else if (i > chain_length && (i - chain_length) % 2 == 1)
+        {
+            ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(go, instances[i - 1]));
+        }
+        instances.Push(go);
+    }
+    ASSERT_EQ((void*)0, dmGameObject::New(collection, 0x0));
+
+    ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+
+    ASSERT_EQ(chain_length - 1, dmGameObject::GetDepth(instances[chain_length - 1]));
+    ASSERT_NEAR((float)chain_length, dmGameObject::GetWorldPosition(instances[chain_length - 1]).getX(), EPSILON);
+    dmGameObject::HInstance last = instances.Back();
+    ASSERT_EQ(dmGameObject::GetParent(last) != 0 ? 2.0f : 1.0f, dmGameObject::GetWorldPosition(last).getX());
+
+    // Delete the roots non-recursively, moving all children up one level
+    for (uint32_t i = chain_length; i < LARGE_COLLECTION_CAPACITY; ++i)
+    {
+        if (dmGameObject::GetParent(instances[i]) == 0 && dmGameObject::GetChildCount(instances[i]) > 0)
+        {
+            dmGameObject::Delete(collection, instances[i], false);
+        }
+    }
+    dmGameObject::Delete(collection, instances[0], false);
+    ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    ASSERT_EQ(0u, dmGameObject::GetDepth(last));
+    ASSERT_EQ(chain_length - 2, dmGameObject::GetDepth(instances[chain_length - 1]));
+
+    ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+    ASSERT_NEAR((float)(chain_length - 1), dmGameObject::GetWorldPosition(instances[chain_length - 1]).getX(), EPSILON);
+    ASSERT_EQ(1.0f, dmGameObject::GetWorldPosition(last).getX());
+
+    dmGameObject::DeleteAll(collection);
+    ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    ASSERT_EQ(0u, collection->m_Collection->m_InstanceIndices.Size());
+
+    dmGameObject::DeleteCollection(collection);
+}
+
 TEST_F(HierarchyTest, TestEmptyInstance)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, 0x0);
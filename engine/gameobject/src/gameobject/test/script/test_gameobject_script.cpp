@@ -369,6 +369,19 @@ TEST_F(ScriptTest, TestURLNilId)
     ASSERT_FALSE(dmGameObject::Init(m_Collection));
 }
 
+TEST_F(ScriptTest, TestGetOut)
+{
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/get_out.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+    dmGameObject::Delete(m_Collection, go, false);
+}
+
 #define REF_VALUE "__ref_value"
 
 int TestRef(lua_State* L)
@@ -20,6 +20,8 @@
 #include <dlib/dstrings.h>
 #include <dlib/time.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/static_assert.h>
 #include <resource/resource.h>
 #include "../gameobject.h"
 #include "../gameobject_private.h"
@@ -630,6 +632,69 @@ TEST_F(SpawnDeleteTest, CollectionUpdate_SpawnDeleteMulti2)
     PostUpdate();
 }
 
+// The collection capacity is limited by the width of the instance indices,
+// 200k instances are only reached when built with DM_GAMEOBJECT_LARGE_COLLECTIONS (test_gameobject_spawn_delete_large_collections)
+static const uint32_t LARGE_COLLECTION_CAPACITY = dmMath::Min(200000U, dmGameObject::INVALID_INSTANCE_INDEX - 1);
+
+#if defined(DM_GAMEOBJECT_LARGE_COLLECTIONS)
+DM_STATIC_ASSERT(sizeof(dmGameObject::InstanceIndex) == sizeof(uint32_t), Invalid_Instance_Index_Size);
+#else
+DM_STATIC_ASSERT(sizeof(dmGameObject::InstanceIndex) == sizeof(uint16_t), Invalid_Instance_Index_Size);
+#endif
+
+TEST_F(SpawnDeleteTest, CollectionUpdate_SpawnDeleteLarge)
+{
+    // Temp swap collections to delete at end
+    dmGameObject::HCollection old_collection = m_Collection;
+    m_Collection = dmGameObject::NewCollection("large_collection", m_Factory, m_Register, LARGE_COLLECTION_CAPACITY);
+    ASSERT_NE((void*)0, m_Collection);
+
+    Init();
+
+    dmGameObject::HPrototype prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/a.goc", (void**)&prototype));
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(LARGE_COLLECTION_CAPACITY);
+    for (uint32_t i = 0; i < LARGE_COLLECTION_CAPACITY; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::Spawn(m_Collection, prototype, "/a.goc", i + 1, 0x0, 0, Point3((float)i, 0.0f, 0.0f), Quat::identity(), Vector3(1, 1, 1));
+        ASSERT_NE((void*)0, go);
+        instances.Push(go);
+    }
+
+    // The collection is full
+    ASSERT_EQ((void*)0, dmGameObject::Spawn(m_Collection, prototype, "/a.goc", LARGE_COLLECTION_CAPACITY + 1, 0x0, 0, Point3(0.0f, 0.0f, 0.0f), Quat::identity(), Vector3(1, 1, 1)));
+
+    Update();
+
+    ASSERT_ADD_TO_UPDATE(LARGE_COLLECTION_CAPACITY);
+    ASSERT_EQ(LARGE_COLLECTION_CAPACITY - 1, dmGameObject::GetWorldPosition(instances.Back()).getX());
+
+    // Delete every other instance, then the rest, to exercise the deferred delete list
+    for (uint32_t i = 0; i < LARGE_COLLECTION_CAPACITY; i += 2)
+    {
+        Delete(instances[i]);
+    }
+    ASSERT_EQ((LARGE_COLLECTION_CAPACITY + 1) / 2, dmGameObject::GetRemoveFromUpdateCount(m_Collection));
+    PostUpdate();
+
+    for (uint32_t i = 1; i < LARGE_COLLECTION_CAPACITY; i += 2)
+    {
+        Delete(instances[i]);
+    }
+    PostUpdate();
+
+    ASSERT_FINAL(LARGE_COLLECTION_CAPACITY);
+    ASSERT_EQ(0u, m_Collection->m_Collection->m_InstanceIndices.Size());
+
+    dmResource::Release(m_Factory, prototype);
+    dmGameObject::DeleteCollection(m_Collection);
+    dmGameObject::PostUpdate(m_Register);
+
+    m_Collection = old_collection;
+}
+
 
 #undef ASSERT_INIT
 #undef ASSERT_ADD_TO_UPDATE
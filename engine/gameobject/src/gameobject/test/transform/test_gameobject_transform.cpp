@@ -0,0 +1,326 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlib/array.h>
+#include <dlib/hash.h>
+#include <dlib/job_pool.h>
+#include <dlib/math.h>
+#include <dlib/time.h>
+#include <dlib/transform.h>
+#include <resource/resource.h>
+#include "../gameobject.h"
+#include "../gameobject_private.h"
+#include "../gameobject_transform.h"
+
+#define EPSILON 0.0001f
+
+using namespace Vectormath::Aos;
+
+static const uint32_t BENCHMARK_ITERATIONS = 20;
+
+static float RandomFloat(float min, float max)
+{
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+static dmTransform::Transform RandomTransform()
+{
+    Quat rotation = normalize(Quat(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1)));
+    Vector3 translation(RandomFloat(-10, 10), RandomFloat(-10, 10), RandomFloat(-10, 10));
+    Vector3 scale(RandomFloat(0.5f, 2.0f), RandomFloat(0.5f, 2.0f), RandomFloat(0.5f, 2.0f));
+    return dmTransform::Transform(translation, rotation, scale);
+}
+
+static void AssertMatrixNear(const Matrix4& expected, const Matrix4& actual, float epsilon)
+{
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        for (uint32_t r = 0; r < 4; ++r)
+        {
+            ASSERT_NEAR(expected.getElem(c, r), actual.getElem(c, r), epsilon);
+        }
+    }
+}
+
+// The scalar calculation of the world transforms, used as reference
+static void CalculateWorldTransformsReference(dmGameObject::Collection* collection, dmArray<Matrix4>& world)
+{
+    const dmTransform::Transform* local = collection->m_LocalTransforms.Begin();
+    bool scale_along_z = collection->m_ScaleAlongZ;
+    for (uint32_t level_i = 0; level_i < dmGameObject::MAX_HIERARCHICAL_DEPTH; ++level_i)
+    {
+        dmArray<dmGameObject::LevelIndex>& level = collection->m_LevelIndices[level_i];
+        uint32_t count = level.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmGameObject::InstanceIndex index = level[i].m_Index;
+            Matrix4 own = dmTransform::ToMatrix4(local[index]);
+            if (level_i == 0)
+            {
+                world[index] = own;
+            }
+            else if (scale_along_z)
+            {
+                world[index] = world[level[i].m_Parent] * own;
+            }
+            else
+            {
+                world[index] = dmTransform::MulNoScaleZ(world[level[i].m_Parent], own);
+            }
+        }
+    }
+}
+
+class TransformTest : public jc_test_base_class
+{
+protected:
+    virtual void SetUp()
+    {
+        dmResource::NewFactoryParams params;
+        params.m_MaxResources = 16;
+        params.m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+        m_Factory = dmResource::NewFactory(&params, "build/default/src/gameobject/test/transform");
+        m_ScriptContext = dmScript::NewContext(0, 0, true);
+        dmScript::Initialize(m_ScriptContext);
+        m_Register = dmGameObject::NewRegister();
+        dmGameObject::Initialize(m_Register, m_ScriptContext);
+        dmGameObject::RegisterResourceTypes(m_Factory, m_Register, m_ScriptContext, &m_ModuleContext);
+        dmGameObject::RegisterComponentTypes(m_Factory, m_Register, m_ScriptContext);
+        m_Collection = 0;
+        m_JobPool = 0;
+    }
+
+    virtual void TearDown()
+    {
+        if (m_Collection)
+        {
+            dmGameObject::DeleteCollection(m_Collection);
+        }
+        dmGameObject::PostUpdate(m_Register);
+        dmScript::Finalize(m_ScriptContext);
+        dmScript::DeleteContext(m_ScriptContext);
+        dmResource::DeleteFactory(m_Factory);
+        dmGameObject::DeleteRegister(m_Register);
+        if (m_JobPool)
+        {
+            dmJobPool::Delete(m_JobPool);
+        }
+    }
+
+    void SetWorkerCount(uint32_t worker_count)
+    {
+        m_JobPool = dmJobPool::New(worker_count, "test_worker");
+        dmGameObject::SetJobPool(m_Register, m_JobPool);
+    }
+
+    // Creates count instances in chains of chain_length instances. In a deep hierarchy, each instance
+    // of a chain is parented to the previous one. In a wide hierarchy, they are parented to the first one.
+    void CreateHierarchy(uint32_t count, uint32_t chain_length, bool wide)
+    {
+        m_Collection = dmGameObject::NewCollection("collection", m_Factory, m_Register, count);
+        dmGameObject::HInstance parent = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmGameObject::HInstance instance = dmGameObject::New(m_Collection, 0x0);
+            ASSERT_NE((dmGameObject::HInstance)0, instance);
+            dmGameObject::GetLocalTransform(instance) = RandomTransform();
+            dmGameObject::SetDirtyTransform(instance);
+            if (i % chain_length != 0)
+            {
+                ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(instance, parent));
+            }
+            if (!wide || i % chain_length == 0)
+            {
+                parent = instance;
+            }
+        }
+    }
+
+    void MarkAllDirty()
+    {
+        dmGameObject::Collection* collection = m_Collection->m_Collection;
+        for (uint32_t level_i = 0; level_i < dmGameObject::MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<dmGameObject::LevelIndex>& level = collection->m_LevelIndices[level_i];
+            for (uint32_t i = 0; i < level.Size(); ++i)
+            {
+                dmGameObject::SetDirtyTransform(collection->m_Instances[level[i].m_Index]);
+            }
+        }
+    }
+
+    void RunBenchmark(const char* name, uint32_t count, uint32_t chain_length, bool wide)
+    {
+        CreateHierarchy(count, chain_length, wide);
+        dmGameObject::Collection* collection = m_Collection->m_Collection;
+        dmGameObject::UpdateTransforms(collection);
+
+        dmArray<Matrix4> reference;
+        reference.SetCapacity(collection->m_WorldTransforms.Size());
+        reference.SetSize(collection->m_WorldTransforms.Size());
+        CalculateWorldTransformsReference(collection, reference);
+        for (uint32_t i = 0; i < collection->m_Instances.Size(); ++i)
+        {
+            dmGameObject::Instance* instance = collection->m_Instances[i];
+            if (instance)
+            {
+                AssertMatrixNear(reference[instance->m_Index], collection->m_WorldTransforms[instance->m_Index], EPSILON);
+            }
+        }
+
+        uint64_t reference_time = 0;
+        uint64_t dirty_time = 0;
+        uint64_t clean_time = 0;
+        for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i)
+        {
+            uint64_t start = dmTime::GetTime();
+            CalculateWorldTransformsReference(collection, reference);
+            reference_time += dmTime::GetTime() - start;
+
+            MarkAllDirty();
+            start = dmTime::GetTime();
+            dmGameObject::UpdateTransforms(collection);
+            dirty_time += dmTime::GetTime() - start;
+
+            start = dmTime::GetTime();
+            dmGameObject::UpdateTransforms(collection);
+            clean_time += dmTime::GetTime() - start;
+        }
+
+        printf("UpdateTransforms %-5s %6u instances, %u workers: reference %7.3f ms, all dirty %7.3f ms, none dirty %7.3f ms\n", name, count, dmJobPool::GetWorkerCount(m_JobPool),
+            reference_time / (BENCHMARK_ITERATIONS * 1000.0f),
+            dirty_time / (BENCHMARK_ITERATIONS * 1000.0f),
+            clean_time / (BENCHMARK_ITERATIONS * 1000.0f));
+    }
+
+public:
+
+    dmScript::HContext m_ScriptContext;
+    dmGameObject::HRegister m_Register;
+    dmGameObject::HCollection m_Collection;
+    dmResource::HFactory m_Factory;
+    dmGameObject::ModuleContext m_ModuleContext;
+    dmJobPool::HJobPool m_JobPool;
+};
+
+static void TestCalculateWorldTransforms(bool scale_along_z)
+{
+    const uint32_t max_count = 9;
+    dmTransform::Transform local[max_count];
+    Matrix4 parent_world[max_count];
+    Matrix4 world[max_count];
+    const dmTransform::Transform* local_ptrs[max_count];
+    const Matrix4* parent_world_ptrs[max_count];
+    Matrix4* world_ptrs[max_count];
+    for (uint32_t i = 0; i < max_count; ++i)
+    {
+        local[i] = RandomTransform();
+        parent_world[i] = dmTransform::ToMatrix4(RandomTransform());
+        local_ptrs[i] = &local[i];
+        parent_world_ptrs[i] = &parent_world[i];
+        world_ptrs[i] = &world[i];
+    }
+
+    // All counts, to cover partially filled batches
+    for (uint32_t count = 1; count <= max_count; ++count)
+    {
+        dmGameObject::CalculateWorldTransforms(local_ptrs, 0x0, world_ptrs, count, scale_along_z);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            AssertMatrixNear(dmTransform::ToMatrix4(local[i]), world[i], EPSILON);
+        }
+
+        dmGameObject::CalculateWorldTransforms(local_ptrs, parent_world_ptrs, world_ptrs, count, scale_along_z);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Matrix4 own = dmTransform::ToMatrix4(local[i]);
+            Matrix4 expected = scale_along_z ? parent_world[i] * own : dmTransform::MulNoScaleZ(parent_world[i], own);
+            AssertMatrixNear(expected, world[i], EPSILON);
+        }
+    }
+}
+
+TEST_F(TransformTest, CalculateWorldTransforms)
+{
+    TestCalculateWorldTransforms(false);
+}
+
+TEST_F(TransformTest, CalculateWorldTransformsScaleAlongZ)
+{
+    TestCalculateWorldTransforms(true);
+}
+
+// Instance count of the larger benchmarks, limited by the instance index size
+static const uint32_t LARGE_BENCHMARK_COUNT = dmMath::Min(50000U, dmGameObject::INVALID_INSTANCE_INDEX - 1);
+
+TEST_F(TransformTest, BenchmarkFlat10k)
+{
+    RunBenchmark("flat", 10000, 1, false);
+}
+
+TEST_F(TransformTest, BenchmarkFlat50k)
+{
+    RunBenchmark("flat", LARGE_BENCHMARK_COUNT, 1, false);
+}
+
+TEST_F(TransformTest, BenchmarkDeep10k)
+{
+    RunBenchmark("deep", 10000, dmGameObject::MAX_HIERARCHICAL_DEPTH, false);
+}
+
+TEST_F(TransformTest, BenchmarkDeep50k)
+{
+    RunBenchmark("deep", LARGE_BENCHMARK_COUNT, dmGameObject::MAX_HIERARCHICAL_DEPTH, false);
+}
+
+TEST_F(TransformTest, BenchmarkWide10k)
+{
+    RunBenchmark("wide", 10000, 100, true);
+}
+
+TEST_F(TransformTest, BenchmarkWide50k)
+{
+    RunBenchmark("wide", LARGE_BENCHMARK_COUNT, 100, true);
+}
+
+TEST_F(TransformTest, BenchmarkFlat50kParallel)
+{
+    SetWorkerCount(4);
+    RunBenchmark("flat", LARGE_BENCHMARK_COUNT, 1, false);
+}
+
+TEST_F(TransformTest, BenchmarkDeep50kParallel)
+{
+    SetWorkerCount(4);
+    RunBenchmark("deep", LARGE_BENCHMARK_COUNT, dmGameObject::MAX_HIERARCHICAL_DEPTH, false);
+}
+
+TEST_F(TransformTest, BenchmarkWide50kParallel)
+{
+    SetWorkerCount(4);
+    RunBenchmark("wide", LARGE_BENCHMARK_COUNT, 100, true);
+}
+
+#undef EPSILON
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+
+    int ret = jc_test_run_all();
+    return ret;
+}
@@ -143,6 +143,7 @@ namespace dmGameSystem
         gui_world->m_MaxParticleFXCount = gui_context->m_MaxParticleFXCount;
         gui_world->m_MaxParticleCount = gui_context->m_MaxParticleCount;
         gui_world->m_ParticleContext = dmParticle::CreateContext(gui_world->m_MaxParticleFXCount, gui_world->m_MaxParticleCount);
+        dmParticle::SetJobPool(gui_world->m_ParticleContext, gui_context->m_JobPool);
 
         gui_world->m_ScriptWorld = dmScript::NewScriptWorld(gui_context->m_ScriptContext);
 
@@ -553,6 +554,15 @@ namespace dmGameSystem
         return result;
     }
 
+    static void DeleteNodeVertexCache(GuiComponent* gui_component)
+    {
+        for (uint32_t i = 0; i < gui_component->m_NodeVertexCache.Size(); ++i)
+        {
+            free(gui_component->m_NodeVertexCache[i].m_Vertices);
+        }
+        gui_component->m_NodeVertexCache.SetCapacity(0);
+    }
+
     dmGameObject::CreateResult CompGuiCreate(const dmGameObject::ComponentCreateParams& params)
     {
         GuiWorld* gui_world = (GuiWorld*)params.m_World;
@@ -646,6 +656,7 @@ namespace dmGameSystem
                     dmResource::Release(dmGameObject::GetFactory(params.m_Instance), gui_component->m_Material);
                 }
                 dmGui::DeleteScene(gui_component->m_Scene);
+                DeleteNodeVertexCache(gui_component);
                 delete gui_component;
                 gui_world->m_Components.EraseSwap(i);
                 break;
@@ -685,6 +696,7 @@ namespace dmGameSystem
         dmRender::HRenderContext    m_RenderContext;
         dmRender::HMaterial         m_Material;
         GuiWorld*                   m_GuiWorld;
+        GuiComponent*               m_Component;
 
         // This order value is increased during rendering for each
         // render object generated, then used to make sure the final
@@ -1056,6 +1068,118 @@ namespace dmGameSystem
         gui_world->m_ClientVertexBuffer.SetSize(vb_end - gui_world->m_ClientVertexBuffer.Begin());
     }
 
+    enum NodeDirtyFlags
+    {
+        NODE_DIRTY_TRANSFORM = 1 << 0,
+        NODE_DIRTY_COLOR     = 1 << 1,
+        NODE_DIRTY_SIZE      = 1 << 2,
+        NODE_DIRTY_TEXTURE   = 1 << 3,
+        NODE_DIRTY_SHAPE     = 1 << 4,
+        NODE_DIRTY_ALL       = 0xff,
+    };
+
+    static inline bool Equals(const Vector4& a, const Vector4& b)
+    {
+        return a.getX() == b.getX() && a.getY() == b.getY() && a.getZ() == b.getZ() && a.getW() == b.getW();
+    }
+
+    static inline bool Equals(const Matrix4& a, const Matrix4& b)
+    {
+        return Equals(a.getCol0(), b.getCol0()) && Equals(a.getCol1(), b.getCol1()) && Equals(a.getCol2(), b.getCol2()) && Equals(a.getCol3(), b.getCol3());
+    }
+
+    static GuiNodeVertexCache* GetNodeVertexCache(GuiComponent* component, dmGui::HScene scene, dmGui::HNode node)
+    {
+        dmArray<GuiNodeVertexCache>& caches = component->m_NodeVertexCache;
+        uint32_t index = dmGui::GetNodeIndex(scene, node);
+        if (index >= caches.Size())
+        {
+            uint32_t size = caches.Size();
+            if (index >= caches.Capacity())
+            {
+                caches.SetCapacity(dmMath::Max(index + 1, caches.Capacity() * 2));
+            }
+            caches.SetSize(index + 1);
+            memset(caches.Begin() + size, 0, (index + 1 - size) * sizeof(GuiNodeVertexCache));
+        }
+        return &caches[index];
+    }
+
+    // Compares the state of the node with the state its cached vertices were generated from, and stores the new state.
+    // A node that was not rendered last frame, or whose index was previously used by a deleted node, is entirely dirty.
+    static uint32_t UpdateNodeVertexCacheState(GuiNodeVertexCache* cache, dmGui::HNode node, const Matrix4& transform, const Vector4& color,
+                                               const Vector4& size, const Vector4& shape, dmGraphics::HTexture texture, const float* tc, uint32_t flags)
+    {
+        uint32_t dirty = 0;
+        if (cache->m_Node != node || cache->m_VertexCount == 0)
+        {
+            dirty = NODE_DIRTY_ALL;
+        }
+        else
+        {
+            dirty |= Equals(cache->m_Transform, transform) ? 0 : NODE_DIRTY_TRANSFORM;
+            dirty |= Equals(cache->m_Color, color) ? 0 : NODE_DIRTY_COLOR;
+            dirty |= Equals(cache->m_Size, size) ? 0 : NODE_DIRTY_SIZE;
+            dirty |= Equals(cache->m_Shape, shape) ? 0 : NODE_DIRTY_SHAPE;
+            dirty |= (cache->m_Texture != texture || cache->m_TexCoords != tc || cache->m_Flags != flags) ? NODE_DIRTY_TEXTURE : 0;
+        }
+        if (dirty)
+        {
+            cache->m_Node = node;
+            cache->m_Transform = transform;
+            cache->m_Color = color;
+            cache->m_Size = size;
+            cache->m_Shape = shape;
+            cache->m_Texture = texture;
+            cache->m_TexCoords = tc;
+            cache->m_Flags = flags;
+        }
+        return dirty;
+    }
+
+    static BoxVertex* ReserveNodeVertices(GuiNodeVertexCache* cache, uint32_t vertex_count)
+    {
+        if (cache->m_VertexCapacity < vertex_count)
+        {
+            cache->m_Vertices = (BoxVertex*)realloc(cache->m_Vertices, vertex_count * sizeof(BoxVertex));
+            cache->m_VertexCapacity = vertex_count;
+        }
+        return cache->m_Vertices;
+    }
+
+    // Copies the cached vertices of a node to the vertex buffer. Vertices only need to be generated
+    // when anything but the color of the node has changed, in which case false is returned.
+    static bool ReuseNodeVertices(GuiWorld* gui_world, GuiNodeVertexCache* cache, uint32_t dirty)
+    {
+        if (dirty & ~NODE_DIRTY_COLOR)
+        {
+            ++gui_world->m_RebuiltNodeCount;
+            return false;
+        }
+        if (dirty & NODE_DIRTY_COLOR)
+        {
+            for (uint32_t i = 0; i < cache->m_VertexCount; ++i)
+            {
+                cache->m_Vertices[i].SetColor(cache->m_Color);
+            }
+        }
+        if (gui_world->m_ClientVertexBuffer.Remaining() < cache->m_VertexCount) {
+            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, cache->m_VertexCount));
+        }
+        gui_world->m_ClientVertexBuffer.PushArray(cache->m_Vertices, cache->m_VertexCount);
+        ++gui_world->m_ReusedNodeCount;
+        return true;
+    }
+
+    static void PushNodeVertices(GuiWorld* gui_world, GuiNodeVertexCache* cache, const BoxVertex* vertices_end)
+    {
+        cache->m_VertexCount = vertices_end - cache->m_Vertices;
+        if (gui_world->m_ClientVertexBuffer.Remaining() < cache->m_VertexCount) {
+            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, cache->m_VertexCount));
+        }
+        gui_world->m_ClientVertexBuffer.PushArray(cache->m_Vertices, cache->m_VertexCount);
+    }
+
     void RenderBoxNodes(dmGui::HScene scene,
                         const dmGui::RenderEntry* entries,
                         const Matrix4* node_transforms,
@@ -1113,7 +1237,7 @@ namespace dmGameSystem
         float org_height = (float)dmGraphics::GetOriginalTextureHeight(ro.m_Textures[0]);
         assert(org_width > 0 && org_height > 0);
 
-        int rendered_vert_count = 0;
+        GuiComponent* component = gui_context->m_Component;
         for (uint32_t i = 0; i < node_count; ++i)
         {
             const dmGui::HNode node = entries[i].m_Node;
@@ -1132,16 +1256,38 @@ namespace dmGameSystem
 
             // tc equals 0 when texture is set from lua script directly with gui.set_texture(...) method
             bool manually_set_texture = tc == 0;
-            if (manually_set_texture) {
-                tc = default_tc;
-            }
 
             Vector4 slice9 = dmGui::GetNodeSlice9(scene, node);
             bool use_slice_nine = sum(slice9) != 0;
 
+            Point3 size = dmGui::GetNodeSize(scene, node);
+
+            bool flip_u = false;
+            bool flip_v = false;
+            int32_t frame_index = 0;
+            if (!manually_set_texture)
+            {
+                GetNodeFlipbookAnimUVFlip(scene, node, flip_u, flip_v);
+                frame_index = dmGui::GetNodeAnimationFrame(scene, node);
+            }
+
+            GuiNodeVertexCache* cache = GetNodeVertexCache(component, scene, node);
+            uint32_t flags = (uint32_t)flip_u | ((uint32_t)flip_v << 1) | ((uint32_t)frame_index << 2);
+            uint32_t dirty = UpdateNodeVertexCacheState(cache, node, node_transforms[i], pm_color, Vector4(size.getX(), size.getY(), org_width, org_height),
+                                                        slice9, texture, tc, flags);
+            if (ReuseNodeVertices(gui_world, cache, dirty)) {
+                continue;
+            }
+
+            if (manually_set_texture) {
+                tc = default_tc;
+            }
+
             // render simple quad ignoring 9-slicing
             if ((!use_slice_nine && manually_set_texture) || !texture)
             {
+                BoxVertex* v = ReserveNodeVertices(cache, 6);
+
                 BoxVertex v00;
                 v00.SetColor(pm_color);
                 v00.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(0, 0, 0));
@@ -1162,14 +1308,14 @@ namespace dmGameSystem
                 v11.SetPosition(node_transforms[i] * Vectormath::Aos::Point3(1, 1, 0));
                 v11.SetUV(1, 1);
 
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v10);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v01);
+                *v++ = v00;
+                *v++ = v10;
+                *v++ = v11;
+                *v++ = v00;
+                *v++ = v11;
+                *v++ = v01;
 
-                rendered_vert_count += 6;
+                PushNodeVertices(gui_world, cache, v);
                 continue;
             }
 
@@ -1177,15 +1323,9 @@ namespace dmGameSystem
             dmGameSystemDDF::TextureSet* texture_set_ddf = anim_desc ? (dmGameSystemDDF::TextureSet*)anim_desc->m_TextureSet : 0;
             bool use_geometries = texture_set_ddf && texture_set_ddf->m_Geometries.m_Count > 0;
 
-            bool flip_u = false;
-            bool flip_v = false;
-            if (!manually_set_texture)
-                GetNodeFlipbookAnimUVFlip(scene, node, flip_u, flip_v);
-
             // render using geometries without 9-slicing
             if (!use_slice_nine && use_geometries)
             {
-                int32_t frame_index = dmGui::GetNodeAnimationFrame(scene, node);
                 frame_index = texture_set_ddf->m_FrameIndices[frame_index];
 
                 const dmGameSystemDDF::SpriteGeometry* geometry = &texture_set_ddf->m_Geometries.m_Data[frame_index];
@@ -1208,6 +1348,7 @@ namespace dmGameSystem
 
                 // Since we don't use an index buffer, we duplicate the vertices manually
                 uint32_t index_count = geometry->m_Indices.m_Count;
+                BoxVertex* v = ReserveNodeVertices(cache, index_count);
                 for (uint32_t index = 0; index < index_count; ++index)
                 {
                     uint32_t i = geometry->m_Indices.m_Data[index];
@@ -1220,11 +1361,10 @@ namespace dmGameSystem
                     float y = point[1] * scaleY + 0.5f;
 
                     Vector4 p = w * Point3(x, y, 0.0f);
-                    BoxVertex v(p, uv[0], uv[1], pm_color);
-                    gui_world->m_ClientVertexBuffer.Push(v);
+                    *v++ = BoxVertex(p, uv[0], uv[1], pm_color);
                 }
 
-                rendered_vert_count += index_count;
+                PushNodeVertices(gui_world, cache, v);
                 continue;
             }
 
@@ -1253,7 +1393,6 @@ namespace dmGameSystem
             const float su = 1.0f / org_width;
             const float sv = 1.0f / org_height;
 
-            Point3 size = dmGui::GetNodeSize(scene, node);
             const float sx = size.getX() > s9_min_dim ? 1.0f / size.getX() : 0;
             const float sy = size.getY() > s9_min_dim ? 1.0f / size.getY() : 0;
 
@@ -1301,6 +1440,7 @@ namespace dmGameSystem
                 }
             }
 
+            BoxVertex* v = ReserveNodeVertices(cache, verts_per_node);
             BoxVertex v00, v10, v01, v11;
             v00.SetColor(pm_color);
             v10.SetColor(pm_color);
@@ -1332,18 +1472,18 @@ namespace dmGameSystem
                         v01.SetUV(us[x0], vs[y1]);
                         v11.SetUV(us[x1], vs[y1]);
                     }
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v10);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v01);
+                    *v++ = v00;
+                    *v++ = v10;
+                    *v++ = v11;
+                    *v++ = v00;
+                    *v++ = v11;
+                    *v++ = v01;
                 }
             }
-            rendered_vert_count += verts_per_node;
+            PushNodeVertices(gui_world, cache, v);
         }
 
-        ro.m_VertexCount = rendered_vert_count;
+        ro.m_VertexCount = gui_world->m_ClientVertexBuffer.Size() - ro.m_VertexStart;
     }
 
     // Computes max vertices required in the vertex buffer to draw a pie node with a
@@ -1417,6 +1557,7 @@ namespace dmGameSystem
             gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, max_total_vertices));
         }
 
+        GuiComponent* component = gui_context->m_Component;
         for (uint32_t i = 0; i < node_count; ++i)
         {
             const dmGui::HNode node = entries[i].m_Node;
@@ -1431,13 +1572,27 @@ namespace dmGameSystem
             Vector4 pm_color(color.getXYZ(), node_opacities[i]);
 
             const uint32_t perimeterVertices = dmMath::Max<uint32_t>(4, dmGui::GetNodePerimeterVertices(scene, node));
-            const float innerMultiplier = dmGui::GetNodeInnerRadius(scene, node) / size.getX();
+            const float innerRadius = dmGui::GetNodeInnerRadius(scene, node);
+            const float innerMultiplier = innerRadius / size.getX();
             const dmGui::PieBounds outerBounds = dmGui::GetNodeOuterBounds(scene, node);
+            float stopAngle = dmGui::GetNodePieFillAngle(scene, node);
+
+            const float* tc = dmGui::GetNodeFlipbookAnimUV(scene, node);
+            bool flip_u = false;
+            bool flip_v = false;
+            if (tc)
+                GetNodeFlipbookAnimUVFlip(scene, node, flip_u, flip_v);
+
+            GuiNodeVertexCache* cache = GetNodeVertexCache(component, scene, node);
+            uint32_t flags = (uint32_t)flip_u | ((uint32_t)flip_v << 1);
+            uint32_t dirty = UpdateNodeVertexCacheState(cache, node, node_transforms[i], pm_color, Vector4(size.getX(), size.getY(), 0.0f, 0.0f),
+                                                        Vector4(innerRadius, stopAngle, (float)perimeterVertices, (float)outerBounds), texture, tc, flags);
+            if (ReuseNodeVertices(gui_world, cache, dirty))
+                continue;
 
             const float PI = 3.1415926535f;
             const float ad = PI * 2.0f / (float)perimeterVertices;
 
-            float stopAngle = dmGui::GetNodePieFillAngle(scene, node);
             bool backwards = false;
             if (stopAngle < 0)
             {
@@ -1460,11 +1615,8 @@ namespace dmGameSystem
 
             float u0,su,v0,sv;
             bool uv_rotated;
-            const float* tc = dmGui::GetNodeFlipbookAnimUV(scene, node);
             if(tc)
             {
-                bool flip_u, flip_v;
-                GetNodeFlipbookAnimUVFlip(scene, node, flip_u, flip_v);
                 uv_rotated = tc[0] != tc[2] && tc[3] != tc[5];
                 if(uv_rotated ? flip_v : flip_u)
                 {
@@ -1498,7 +1650,8 @@ namespace dmGameSystem
                 sv = -1.0f;
             }
 
-            uint32_t sizeBefore = gui_world->m_ClientVertexBuffer.Size();
+            BoxVertex* vb = ReserveNodeVertices(cache, ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, node)));
+            BoxVertex* vb_end = vb;
             for (uint32_t j = 0; j != generate; j++)
             {
                 float a;
@@ -1544,18 +1697,19 @@ namespace dmGameSystem
                 // drawcall.
                 if (first)
                 {
-                    gui_world->m_ClientVertexBuffer.Push(vInner);
+                    *vb_end++ = vInner;
                     first = false;
                 }
 
-                gui_world->m_ClientVertexBuffer.Push(vInner);
-                gui_world->m_ClientVertexBuffer.Push(vOuter);
+                *vb_end++ = vInner;
+                *vb_end++ = vOuter;
 
                 if (j == generate-1)
-                    gui_world->m_ClientVertexBuffer.Push(vOuter);
+                    *vb_end++ = vOuter;
             }
 
-            assert((gui_world->m_ClientVertexBuffer.Size() - sizeBefore) <= ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, entries[i].m_Node)));
+            assert((uint32_t)(vb_end - vb) <= ComputeRequiredVertices(dmGui::GetNodePerimeterVertices(scene, entries[i].m_Node)));
+            PushNodeVertices(gui_world, cache, vb_end);
         }
 
         ro.m_VertexCount = gui_world->m_ClientVertexBuffer.Size() - ro.m_VertexStart;
@@ -1854,10 +2008,12 @@ namespace dmGameSystem
         rp.m_NewTexture = &NewTexture;
         rp.m_DeleteTexture = &DeleteTexture;
         rp.m_SetTextureData = &SetTextureData;
+        rp.m_CullClippers = gui_context->m_CullClippers;
 
         RenderGuiContext render_gui_context;
         render_gui_context.m_RenderContext = gui_context->m_RenderContext;
         render_gui_context.m_GuiWorld = gui_world;
+        render_gui_context.m_Component = 0;
         render_gui_context.m_NextSortOrder = 0;
 
         uint32_t total_node_count = 0;
@@ -1877,6 +2033,8 @@ namespace dmGameSystem
 
         gui_world->m_GuiRenderObjects.SetSize(0);
         gui_world->m_ClientVertexBuffer.SetSize(0);
+        gui_world->m_RebuiltNodeCount = 0;
+        gui_world->m_ReusedNodeCount = 0;
 
         uint32_t lastEnd = 0;
 
@@ -1888,6 +2046,7 @@ namespace dmGameSystem
 
             // Render scene and see how many render objects it added, then we add those individually.
             render_gui_context.m_Material = GetMaterial(c, c->m_Resource);
+            render_gui_context.m_Component = c;
             dmGui::RenderScene(c->m_Scene, rp, &render_gui_context);
             const uint32_t count = gui_world->m_GuiRenderObjects.Size() - lastEnd;
 
@@ -1913,6 +2072,9 @@ namespace dmGameSystem
             dmRender::RenderListSubmit(gui_context->m_RenderContext, render_list, write_ptr);
         }
 
+        DM_COUNTER("Gui.RebuiltNodes", gui_world->m_RebuiltNodeCount);
+        DM_COUNTER("Gui.ReusedNodes", gui_world->m_ReusedNodeCount);
+
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
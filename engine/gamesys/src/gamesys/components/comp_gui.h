@@ -25,16 +25,35 @@ namespace dmGameSystem
     extern dmRender::HRenderType g_GuiRenderType;
 
     struct GuiSceneResource;
+    struct BoxVertex;
+
+    // The vertices of a box or pie node, and the state they were generated from.
+    // The vertices are reused as long as the state of the node is unchanged.
+    struct GuiNodeVertexCache
+    {
+        Vectormath::Aos::Matrix4    m_Transform;
+        Vectormath::Aos::Vector4    m_Color;
+        Vectormath::Aos::Vector4    m_Size;     // Node size, and the original size of the texture
+        Vectormath::Aos::Vector4    m_Shape;    // Slice9 of box nodes, fill parameters of pie nodes
+        dmGraphics::HTexture        m_Texture;
+        const float*                m_TexCoords;
+        BoxVertex*                  m_Vertices;
+        dmGui::HNode                m_Node;
+        uint32_t                    m_Flags;    // Flip and frame state
+        uint32_t                    m_VertexCount;
+        uint32_t                    m_VertexCapacity;
+    };
 
     struct GuiComponent
     {
-        GuiSceneResource*       m_Resource;
-        dmGui::HScene           m_Scene;
-        dmGameObject::HInstance m_Instance;
-        dmRender::HMaterial     m_Material;
-        uint16_t                m_ComponentIndex;
-        uint8_t                 m_Enabled : 1;
-        uint8_t                 m_AddedToUpdate : 1;
+        GuiSceneResource*           m_Resource;
+        dmGui::HScene               m_Scene;
+        dmGameObject::HInstance     m_Instance;
+        dmRender::HMaterial         m_Material;
+        dmArray<GuiNodeVertexCache> m_NodeVertexCache; // Indexed by node index
+        uint16_t                    m_ComponentIndex;
+        uint8_t                     m_Enabled : 1;
+        uint8_t                     m_AddedToUpdate : 1;
     };
 
     struct BoxVertex
@@ -94,6 +113,8 @@ namespace dmGameSystem
         float                            m_DT;
         dmRig::HRigContext               m_RigContext;
         dmScript::ScriptWorld*           m_ScriptWorld;
+        uint32_t                         m_RebuiltNodeCount; // Nodes whose vertices were generated the last frame
+        uint32_t                         m_ReusedNodeCount;  // Nodes whose cached vertices were used the last frame
     };
 
     typedef BoxVertex ParticleGuiVertex;
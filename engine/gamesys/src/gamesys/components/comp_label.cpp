@@ -64,13 +64,16 @@ namespace dmGameSystem
         dmRender::HFontMap          m_FontMap;
 
         const char*                 m_Text;
+        // Radius around the text origin that contains the text, in label space. See CalculateTextRadius
+        float                       m_TextRadius;
 
         uint16_t                    m_ComponentIndex;
         uint16_t                    m_Enabled : 1;
         uint16_t                    m_AddedToUpdate : 1;
         uint16_t                    m_UserAllocatedText : 1;
         uint16_t                    m_ReHash : 1;
-        uint16_t                    m_Padding : 4;
+        uint16_t                    m_TextRadiusDirty : 1;
+        uint16_t                    m_Padding : 3;
     };
 
     struct LabelWorld
@@ -230,6 +233,7 @@ namespace dmGameSystem
         component->m_Text = ddf->m_Text;
         component->m_UserAllocatedText = 0;
         component->m_ReHash = 1;
+        component->m_TextRadiusDirty = 1;
 
         *params.m_UserData = (uintptr_t)index;
         return dmGameObject::CREATE_RESULT_OK;
@@ -405,6 +409,19 @@ namespace dmGameSystem
         }
     }
 
+    // The text is aligned around the origin, and may overflow the text area. The sphere around the
+    // origin that contains the text area and the laid out text also contains the text for any pivot.
+    static float CalculateTextRadius(LabelComponent* component)
+    {
+        dmGameSystemDDF::LabelDesc* ddf = component->m_Resource->m_DDF;
+        dmRender::TextMetrics metrics;
+        dmRender::GetTextMetrics(GetFontMap(component, component->m_Resource), component->m_Text, component->m_Size.getX(),
+                                    ddf->m_LineBreak, ddf->m_Leading, ddf->m_Tracking, &metrics);
+        float width = dmMath::Max(metrics.m_Width, (float)component->m_Size.getX());
+        float height = dmMath::Max(metrics.m_Height, (float)component->m_Size.getY()) + metrics.m_MaxAscent + metrics.m_MaxDescent;
+        return sqrtf(width * width + height * height);
+    }
+
     dmGameObject::UpdateResult CompLabelRender(const dmGameObject::ComponentsRenderParams& params)
     {
         LabelContext* label_context = (LabelContext*)params.m_Context;
@@ -430,8 +447,16 @@ namespace dmGameSystem
                 ReHash(component);
             }
 
+            if (component->m_TextRadiusDirty)
+            {
+                component->m_TextRadius = CalculateTextRadius(component);
+                component->m_TextRadiusDirty = 0;
+            }
+
             dmRender::DrawTextParams params;
             CreateDrawTextParams(component, params);
+            const Matrix4& w = component->m_World;
+            params.m_BoundRadius = component->m_TextRadius * sqrtf(dmMath::Max(lengthSqr(w.getCol(0).getXYZ()), lengthSqr(w.getCol(1).getXYZ())));
 
             assert( component->m_RenderConstants.m_ConstantCount <= dmRender::MAX_FONT_RENDER_CONSTANTS );
             params.m_NumRenderConstants = component->m_RenderConstants.m_ConstantCount;
@@ -486,6 +511,7 @@ namespace dmGameSystem
             }
             component->m_Text = strdup(textmsg->m_Text);
             component->m_UserAllocatedText = 1;
+            component->m_TextRadiusDirty = 1;
         }
 
         return dmGameObject::UPDATE_RESULT_OK;
@@ -569,6 +595,7 @@ namespace dmGameSystem
         }
         else if (IsReferencingProperty(LABEL_PROP_SIZE, set_property))
         {
+            component->m_TextRadiusDirty = 1;
             return SetProperty(set_property, params.m_Value, component->m_Size, LABEL_PROP_SIZE);
         }
         else if (IsReferencingProperty(LABEL_PROP_COLOR, set_property))
@@ -593,6 +620,7 @@ namespace dmGameSystem
         {
             dmGameObject::PropertyResult res = SetResourceProperty(dmGameObject::GetFactory(params.m_Instance), params.m_Value, FONT_EXT_HASH, (void**)&component->m_FontMap);
             component->m_ReHash |= res == dmGameObject::PROPERTY_RESULT_OK;
+            component->m_TextRadiusDirty |= res == dmGameObject::PROPERTY_RESULT_OK;
             return res;
         }
         return SetMaterialConstant(GetMaterial(component, component->m_Resource), set_property, params.m_Value, CompLabelSetConstantCallback, component);
@@ -693,6 +693,19 @@ namespace dmGameSystem
         }
     }
 
+    // Radius of a sphere around the model position that contains the mesh, or zero if it's unknown
+    static float CalculateBoundRadius(const ModelComponent* component)
+    {
+        const RigSceneResource* rig_scene = component->m_Resource->m_RigScene;
+        // Skinned meshes may be deformed outside of the bind pose bounds
+        if (rig_scene->m_SkeletonRes || rig_scene->m_AnimationSetRes)
+            return 0.0f;
+
+        const Matrix4& w = component->m_World;
+        float max_scale_sq = dmMath::Max(lengthSqr(w.getCol(0).getXYZ()), dmMath::Max(lengthSqr(w.getCol(1).getXYZ()), lengthSqr(w.getCol(2).getXYZ())));
+        return rig_scene->m_MeshSetRes->m_BoundRadius * sqrtf(max_scale_sq);
+    }
+
     dmGameObject::UpdateResult CompModelRender(const dmGameObject::ComponentsRenderParams& params)
     {
         ModelContext* context = (ModelContext*)params.m_Context;
@@ -728,6 +741,7 @@ namespace dmGameSystem
 
             const Vector4 trans = component.m_World.getCol(3);
             write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
+            write_ptr->m_BoundRadius = CalculateBoundRadius(&component);
             write_ptr->m_UserData = (uintptr_t) &component;
             write_ptr->m_BatchKey = component.m_MixedHash;
             write_ptr->m_TagMask = dmRender::GetMaterialTagMask(GetMaterial(&component, component.m_Resource));
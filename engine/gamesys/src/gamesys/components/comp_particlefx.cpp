@@ -67,6 +67,8 @@ namespace dmGameSystem
         dmParticle::HParticleContext m_ParticleContext;
         dmGraphics::HVertexBuffer m_VertexBuffer;
         dmArray<dmParticle::Vertex> m_VertexBufferData;
+        // Emitters of the batch being rendered
+        dmArray<const dmParticle::EmitterRenderData*> m_BatchEmitters;
         dmGraphics::HVertexDeclaration m_VertexDeclaration;
         uint32_t m_EmitterCount;
         float m_DT;
@@ -82,6 +84,7 @@ namespace dmGameSystem
         world->m_Context = ctx;
         uint32_t particle_fx_count = ctx->m_MaxParticleFXCount;
         world->m_ParticleContext = dmParticle::CreateContext(particle_fx_count, ctx->m_MaxParticleCount);
+        dmParticle::SetJobPool(world->m_ParticleContext, ctx->m_JobPool);
         world->m_Components.SetCapacity(particle_fx_count);
         world->m_RenderObjects.SetCapacity(particle_fx_count);
         world->m_Prototypes.SetCapacity(particle_fx_count);
@@ -236,11 +239,18 @@ namespace dmGameSystem
         uint32_t vb_size = vb_size_init;
         uint32_t vb_max_size =  dmParticle::GetVertexBufferSize(pfx_context->m_MaxParticleCount, dmParticle::PARTICLE_GO);
 
+        dmArray<const dmParticle::EmitterRenderData*>& batch_emitters = pfx_world->m_BatchEmitters;
+        uint32_t batch_count = end - begin;
+        batch_emitters.SetSize(0);
+        if (batch_emitters.Capacity() < batch_count)
+        {
+            batch_emitters.SetCapacity(batch_count);
+        }
         for (uint32_t *i = begin; i != end; ++i)
         {
-            const dmParticle::EmitterRenderData* emitter_render_data = (dmParticle::EmitterRenderData*) buf[*i].m_UserData;
-            dmParticle::GenerateVertexData(particle_context, pfx_world->m_DT, emitter_render_data->m_Instance, emitter_render_data->m_EmitterIndex, Vector4(1,1,1,1), (void*)vertex_buffer.Begin(), vb_max_size, &vb_size, dmParticle::PARTICLE_GO);
+            batch_emitters.Push((const dmParticle::EmitterRenderData*) buf[*i].m_UserData);
         }
+        dmParticle::GenerateVertexDataBatch(particle_context, pfx_world->m_DT, batch_emitters.Begin(), batch_count, Vector4(1,1,1,1), (void*)vertex_buffer.Begin(), vb_max_size, &vb_size, dmParticle::PARTICLE_GO);
 
         vb_end = (vb_begin + (vb_size - vb_size_init) / sizeof(dmParticle::Vertex));
 
@@ -318,6 +328,7 @@ namespace dmGameSystem
                     dmParticle::GetEmitterRenderData(particle_context, c.m_ParticleInstance, j, &render_data);
 
                     write_ptr->m_WorldPosition = Point3(render_data->m_Transform.getTranslation());
+                    write_ptr->m_BoundRadius = render_data->m_BoundRadius;
                     write_ptr->m_UserData = (uintptr_t) render_data;
                     write_ptr->m_BatchKey = render_data->m_MixedHash;
                     write_ptr->m_TagMask = dmRender::GetMaterialTagMask((dmRender::HMaterial)render_data->m_Material);
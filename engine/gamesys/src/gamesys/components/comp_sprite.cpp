@@ -16,6 +16,7 @@
 #include <float.h>
 #include <algorithm>
 
+#include <dlib/align.h>
 #include <dlib/array.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
@@ -24,6 +25,7 @@
 #include <dlib/dstrings.h>
 #include <dlib/object_pool.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <graphics/graphics.h>
 #include <render/render.h>
 #include <gameobject/gameobject_ddf.h>
@@ -36,6 +38,14 @@
 #include "sprite_ddf.h"
 #include "gamesys_ddf.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DM_SPRITE_SSE
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define DM_SPRITE_NEON
+    #include <arm_neon.h>
+#endif
+
 using namespace Vectormath::Aos;
 namespace dmGameSystem
 {
@@ -47,6 +57,12 @@ namespace dmGameSystem
         Vector3                     m_Scale;
         Vector3                     m_Size;     // The current size of the animation frame (in texels)
         Matrix4                     m_World;
+        /// What the vertices of the sprite were last written from, where and in which frame.
+        /// The vertices are reused as long as none of it has changed, see CreateVertexData
+        const void*                 m_VertexSource;
+        uint32_t                    m_VertexOffset;
+        uint32_t                    m_IndexOffset;
+        uint32_t                    m_VertexCycle;
         // Hash of the m_Resource-pointer. Hash is used to be compatible with 64-bit arch as a 32-bit value is used for sorting
         // See GenerateKeys
         uint32_t                    m_MixedHash;
@@ -74,7 +90,11 @@ namespace dmGameSystem
         uint16_t                    m_FlipVertical : 1;
         uint16_t                    m_AddedToUpdate : 1;
         uint16_t                    m_ReHash : 1;
-        uint16_t                    m_Padding : 7;
+        /// If m_World has changed since the vertices were last written
+        uint16_t                    m_WorldChanged : 1;
+        /// Flip flags the vertices were last written with
+        uint16_t                    m_VertexFlip : 2;
+        uint16_t                    m_Padding : 4;
     };
 
     struct SpriteVertex
@@ -86,20 +106,55 @@ namespace dmGameSystem
         float v;
     };
 
+    /// Range of vertices, [m_Begin, m_End)
+    struct SpriteVertexRange
+    {
+        uint32_t m_Begin;
+        uint32_t m_End;
+    };
+
+    // The frames in flight may still read from the vertex buffers of the previous frames, so every frame writes
+    // into the next one of these. It needs to be at least the number of frames in flight of any graphics backend.
+    static const uint32_t VERTEX_BUFFER_COUNT = 3;
+
+    struct SpriteVertexBuffer
+    {
+        dmGraphics::HVertexBuffer       m_Buffer;
+        /// Vertices written since the buffer was last uploaded
+        dmArray<SpriteVertexRange>      m_DirtyRanges;
+        /// If the whole buffer needs to be uploaded, e.g. after it was created
+        uint8_t                         m_FullUpload : 1;
+    };
+
     struct SpriteWorld
     {
         dmObjectPool<SpriteComponent>   m_Components;
         dmArray<dmRender::RenderObject> m_RenderObjects;
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
-        dmGraphics::HVertexBuffer       m_VertexBuffer;
+        SpriteVertexBuffer              m_VertexBuffers[VERTEX_BUFFER_COUNT];
+        /// The vertex buffer of the current frame
+        uint32_t                        m_VertexBufferIndex;
+        /// Number of vertices the buffers have room for
+        uint32_t                        m_VertexBufferCapacity;
         SpriteVertex*                   m_VertexBufferData;
+        /// The render list dispatches of a frame write after each other, and the write pointers are reset every frame
         SpriteVertex*                   m_VertexBufferWritePtr;
+        /// The most vertices a render list dispatch can write in the current frame
+        uint32_t                        m_DispatchVertexCount;
+        /// Number of render list dispatches per frame that the buffers have room for
+        uint32_t                        m_MaxDispatchCount;
+        /// Incremented every frame
+        uint32_t                        m_VertexCycle;
+        /// Bytes of vertex data uploaded in the current frame
+        uint32_t                        m_VertexUploadSize;
         dmGraphics::HIndexBuffer        m_IndexBuffer;
         uint8_t*                        m_IndexBufferData;
         uint8_t*                        m_IndexBufferWritePtr;
         uint8_t                         m_Is16BitIndex : 1;
         uint8_t                         m_UseGeometries : 1;
         uint8_t                         m_ReallocBuffers : 1;
+        /// If the current render list dispatch has written any sprites
+        uint8_t                         m_DispatchStarted : 1;
     };
 
     DM_GAMESYS_PROP_VECTOR3(SPRITE_PROP_SCALE, scale, false);
@@ -108,6 +163,9 @@ namespace dmGameSystem
     static const dmhash_t SPRITE_PROP_CURSOR = dmHashString64("cursor");
     static const dmhash_t SPRITE_PROP_PLAYBACK_RATE = dmHashString64("playback_rate");
 
+    // Above this, the dirty ranges of a vertex buffer are merged into a single range
+    static const uint32_t MAX_DIRTY_RANGE_COUNT = 16;
+
     static float GetCursor(SpriteComponent* component);
     static void SetCursor(SpriteComponent* component, float cursor);
     static float GetPlaybackRate(SpriteComponent* component);
@@ -127,17 +185,41 @@ namespace dmGameSystem
     }
 
     static void ReAllocateBuffers(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, uint32_t max_sprite_count, uint32_t num_vertices_per_sprite, uint32_t num_indices_per_sprite) {
-        if (sprite_world->m_VertexBuffer) {
-            dmGraphics::DeleteVertexBuffer(sprite_world->m_VertexBuffer);
-            sprite_world->m_VertexBuffer = 0;
+        for (uint32_t i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+        {
+            if (sprite_world->m_VertexBuffers[i].m_Buffer) {
+                dmGraphics::DeleteVertexBuffer(sprite_world->m_VertexBuffers[i].m_Buffer);
+                sprite_world->m_VertexBuffers[i].m_Buffer = 0;
+            }
         }
 
-        if (sprite_world->m_VertexBuffer == 0)
-            sprite_world->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(render_context), 0, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
-
         {
+            // The vertex buffers are allocated up front, and only the vertices that changed are uploaded
             uint32_t memsize = sizeof(SpriteVertex) * num_vertices_per_sprite * max_sprite_count;
-            sprite_world->m_VertexBufferData = (SpriteVertex*) malloc(memsize);
+            dmMemory::AlignedFree(sprite_world->m_VertexBufferData);
+            sprite_world->m_VertexBufferData = 0;
+            // Every quad starts 16 byte aligned, and is written with aligned stores, see StoreQuad
+            dmMemory::Result r = dmMemory::AlignedMalloc((void**)&sprite_world->m_VertexBufferData, 16, memsize);
+            if (r != dmMemory::RESULT_OK)
+            {
+                dmLogError("Could not allocate sprite vertex buffer of size %u (%d).", memsize, r);
+                // The sprites aren't rendered until the buffers could be allocated, see CompSpriteRender
+                sprite_world->m_VertexBufferData = 0;
+                sprite_world->m_VertexBufferCapacity = 0;
+                return;
+            }
+            // The vertex buffers are uploaded whole the first time
+            memset(sprite_world->m_VertexBufferData, 0, memsize);
+            for (uint32_t i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+            {
+                SpriteVertexBuffer& vertex_buffer = sprite_world->m_VertexBuffers[i];
+                vertex_buffer.m_Buffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(render_context), memsize, 0x0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                vertex_buffer.m_DirtyRanges.SetSize(0);
+                vertex_buffer.m_FullUpload = 1;
+            }
+            sprite_world->m_VertexBufferCapacity = num_vertices_per_sprite * max_sprite_count;
+            // None of the previously written vertices are valid, skip a cycle so that they aren't reused
+            sprite_world->m_VertexCycle++;
         }
 
         {
@@ -187,13 +269,28 @@ namespace dmGameSystem
 
         sprite_world->m_VertexDeclaration = dmGraphics::NewVertexDeclaration(dmRender::GetGraphicsContext(render_context), ve, sizeof(ve) / sizeof(dmGraphics::VertexElement));
 
-        sprite_world->m_VertexBuffer = 0;
+        for (uint32_t i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+        {
+            sprite_world->m_VertexBuffers[i].m_Buffer = 0;
+            sprite_world->m_VertexBuffers[i].m_DirtyRanges.SetCapacity(MAX_DIRTY_RANGE_COUNT);
+            sprite_world->m_VertexBuffers[i].m_FullUpload = 1;
+        }
+        sprite_world->m_VertexBufferIndex = 0;
+        sprite_world->m_VertexBufferCapacity = 0;
         sprite_world->m_VertexBufferData = 0;
+        sprite_world->m_VertexBufferWritePtr = 0;
+        sprite_world->m_DispatchVertexCount = 0;
+        sprite_world->m_MaxDispatchCount = 1;
+        // Components start at cycle 0, which must not look like the cycle before the first frame
+        sprite_world->m_VertexCycle = 1;
+        sprite_world->m_VertexUploadSize = 0;
         sprite_world->m_IndexBuffer = 0;
         sprite_world->m_IndexBufferData = 0;
+        sprite_world->m_IndexBufferWritePtr = 0;
 
         sprite_world->m_UseGeometries = 0;
         sprite_world->m_ReallocBuffers = 1;
+        sprite_world->m_DispatchStarted = 0;
 
         *params.m_World = sprite_world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -203,8 +300,11 @@ namespace dmGameSystem
     {
         SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
         dmGraphics::DeleteVertexDeclaration(sprite_world->m_VertexDeclaration);
-        dmGraphics::DeleteVertexBuffer(sprite_world->m_VertexBuffer);
-        free(sprite_world->m_VertexBufferData);
+        for (uint32_t i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+        {
+            dmGraphics::DeleteVertexBuffer(sprite_world->m_VertexBuffers[i].m_Buffer);
+        }
+        dmMemory::AlignedFree(sprite_world->m_VertexBufferData);
         dmGraphics::DeleteIndexBuffer(sprite_world->m_IndexBuffer);
         free(sprite_world->m_IndexBufferData);
 
@@ -384,6 +484,162 @@ namespace dmGameSystem
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    // The vertices written in the previous frame can be reused if the sprite is written to the same place,
+    // from the same texture coordinates or geometry, and hasn't moved since.
+    static inline bool IsVertexDataValid(const SpriteWorld* sprite_world, const SpriteComponent* component, const void* source, uint32_t flip, uint32_t vertex_offset, uint32_t index_offset)
+    {
+        return component->m_VertexCycle + 1 == sprite_world->m_VertexCycle
+            && component->m_VertexOffset == vertex_offset
+            && component->m_IndexOffset == index_offset
+            && component->m_VertexSource == source
+            && component->m_VertexFlip == flip
+            && !component->m_WorldChanged;
+    }
+
+    static inline void SetVertexDataValid(const SpriteWorld* sprite_world, SpriteComponent* component, const void* source, uint32_t flip, uint32_t vertex_offset, uint32_t index_offset)
+    {
+        component->m_VertexCycle = sprite_world->m_VertexCycle;
+        component->m_VertexOffset = vertex_offset;
+        component->m_IndexOffset = index_offset;
+        component->m_VertexSource = source;
+        component->m_VertexFlip = flip;
+        component->m_WorldChanged = 0;
+    }
+
+    static void AddDirtyRange(dmArray<SpriteVertexRange>& ranges, uint32_t begin, uint32_t end)
+    {
+        // The ranges of a frame follow each other, but the buffers also keep the ranges of the previous frames
+        if (!ranges.Empty() && begin <= ranges.Back().m_End && ranges.Back().m_Begin <= end)
+        {
+            ranges.Back().m_Begin = dmMath::Min(begin, ranges.Back().m_Begin);
+            ranges.Back().m_End = dmMath::Max(end, ranges.Back().m_End);
+            return;
+        }
+        if (ranges.Full())
+        {
+            // Many small uploads cost more than a single larger one
+            for (uint32_t i = 0; i < ranges.Size(); ++i)
+            {
+                begin = dmMath::Min(begin, ranges[i].m_Begin);
+                end = dmMath::Max(end, ranges[i].m_End);
+            }
+            ranges.SetSize(0);
+        }
+        SpriteVertexRange range;
+        range.m_Begin = begin;
+        range.m_End = end;
+        ranges.Push(range);
+    }
+
+    // The vertices need to be uploaded to all the vertex buffers, as each of them is used in turn
+    static void AddDirtyRange(SpriteWorld* sprite_world, uint32_t begin, uint32_t end)
+    {
+        if (begin == end)
+        {
+            return;
+        }
+        for (uint32_t i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+        {
+            SpriteVertexBuffer& vertex_buffer = sprite_world->m_VertexBuffers[i];
+            if (!vertex_buffer.m_FullUpload)
+            {
+                AddDirtyRange(vertex_buffer.m_DirtyRanges, begin, end);
+            }
+        }
+    }
+
+    // Four floats, the xyz of the corners of a quad
+#if defined(DM_SPRITE_SSE)
+    typedef __m128 Vec4f;
+    // The world matrices aren't necessarily 16 byte aligned
+    static inline Vec4f Load(const float* p)                { return _mm_loadu_ps(p); }
+    static inline Vec4f Splat(float v)                      { return _mm_set1_ps(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return _mm_add_ps(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return _mm_sub_ps(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return _mm_mul_ps(a, b); }
+
+    // Interleaves the corners with their texture coordinates into the five vectors of the quad.
+    // The vertices are uploaded in the same frame, so they are written with regular stores that stay in the cache.
+    static inline void StoreQuad(SpriteVertex* vertices, const Vec4f* p, const float* const* uv)
+    {
+        Vec4f uv01 = _mm_setr_ps(uv[0][0], uv[0][1], uv[1][0], uv[1][1]);
+        Vec4f uv23 = _mm_setr_ps(uv[2][0], uv[2][1], uv[3][0], uv[3][1]);
+        float* out = (float*) vertices;
+        // x0 y0 z0 u0
+        _mm_store_ps(out + 0, _mm_shuffle_ps(p[0], _mm_shuffle_ps(p[0], uv01, _MM_SHUFFLE(0, 0, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0)));
+        // v0 x1 y1 z1
+        _mm_store_ps(out + 4, _mm_shuffle_ps(_mm_shuffle_ps(uv01, p[1], _MM_SHUFFLE(0, 0, 1, 1)), p[1], _MM_SHUFFLE(2, 1, 2, 0)));
+        // u1 v1 x2 y2
+        _mm_store_ps(out + 8, _mm_shuffle_ps(uv01, p[2], _MM_SHUFFLE(1, 0, 3, 2)));
+        // z2 u2 v2 x3
+        _mm_store_ps(out + 12, _mm_shuffle_ps(_mm_shuffle_ps(p[2], uv23, _MM_SHUFFLE(0, 0, 2, 2)), _mm_shuffle_ps(uv23, p[3], _MM_SHUFFLE(0, 0, 1, 1)), _MM_SHUFFLE(2, 0, 2, 0)));
+        // y3 z3 u3 v3
+        _mm_store_ps(out + 16, _mm_shuffle_ps(p[3], uv23, _MM_SHUFFLE(3, 2, 2, 1)));
+    }
+#else
+    #if defined(DM_SPRITE_NEON)
+    typedef float32x4_t Vec4f;
+    static inline Vec4f Load(const float* p)                { return vld1q_f32(p); }
+    static inline void  Store(float* p, Vec4f v)            { vst1q_f32(p, v); }
+    static inline Vec4f Splat(float v)                      { return vdupq_n_f32(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return vaddq_f32(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return vsubq_f32(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return vmulq_f32(a, b); }
+    #else
+    struct Vec4f
+    {
+        float v[4];
+    };
+    static inline Vec4f Load(const float* p)                { Vec4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    static inline void  Store(float* p, Vec4f v)            { memcpy(p, v.v, sizeof(v.v)); }
+    static inline Vec4f Splat(float v)                      { Vec4f r = {{v, v, v, v}}; return r; }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+    #endif
+
+    static inline void StoreQuad(SpriteVertex* vertices, const Vec4f* p, const float* const* uv)
+    {
+        float DM_ALIGNED(16) corners[4][4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            Store(corners[i], p[i]);
+        }
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            vertices[i].x = corners[i][0];
+            vertices[i].y = corners[i][1];
+            vertices[i].z = corners[i][2];
+            vertices[i].u = uv[i][0];
+            vertices[i].v = uv[i][1];
+        }
+    }
+#endif
+
+    // The texture coordinates of the two triangles of a quad, for each of the flip flags
+    static const int TEX_COORD_ORDER[] = {
+        0,1,2,2,3,0,
+        3,2,1,1,0,3,    //h
+        1,0,3,3,2,1,    //v
+        2,3,0,0,1,2     //hv
+    };
+
+    // Writes the four vertices of a quad, at the corners (-0.5,-0.5), (-0.5,0.5), (0.5,0.5) and (0.5,-0.5).
+    // The corners are offset from the translation by half the x and y axes of the world transform, which leaves out
+    // the z axis altogether. The sums are ordered as in Matrix4 * Point3, which gives the same result.
+    static inline void WriteQuad(SpriteVertex* vertices, const Matrix4& w, const float* tc, const int* tex_lookup)
+    {
+        const float* m = (const float*) &w;
+        Vec4f half = Splat(0.5f);
+        Vec4f a = Mul(Load(m), half);
+        Vec4f b = Mul(Load(m + 4), half);
+        Vec4f t = Load(m + 12);
+        Vec4f sum = Add(a, b);
+        Vec4f diff = Sub(b, a);
+        Vec4f p[4] = { Sub(t, sum), Add(diff, t), Add(sum, t), Sub(t, diff) };
+        const float* uv[4] = { &tc[tex_lookup[0] * 2], &tc[tex_lookup[1] * 2], &tc[tex_lookup[2] * 2], &tc[tex_lookup[4] * 2] };
+        StoreQuad(vertices, p, uv);
+    }
 
     static void CreateVertexData(SpriteWorld* sprite_world, SpriteVertex** vb_where, uint8_t** ib_where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
     {
@@ -407,7 +663,7 @@ namespace dmGameSystem
 
             for (uint32_t* i = begin; i != end; ++i)
             {
-                const SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
+                SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
 
                 const dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
 
@@ -428,6 +684,19 @@ namespace dmGameSystem
                 int flipy = animation_ddf->m_FlipVertical ^ component->m_FlipVertical;
                 int reverse = flipx ^ flipy;
 
+                uint32_t flip_flag = flipx | (flipy << 1);
+                uint32_t index_offset = indices - sprite_world->m_IndexBufferData;
+                bool valid = IsVertexDataValid(sprite_world, component, geometry, flip_flag, vertex_offset, index_offset);
+                SetVertexDataValid(sprite_world, component, geometry, flip_flag, vertex_offset, index_offset);
+                if (valid)
+                {
+                    vertices += num_points;
+                    indices += index_type_size * geometry->m_Indices.m_Count;
+                    vertex_offset += num_points;
+                    continue;
+                }
+                AddDirtyRange(sprite_world, vertex_offset, vertex_offset + num_points);
+
                 float scaleX = flipx ? -1 : 1;
                 float scaleY = flipy ? -1 : 1;
 
@@ -472,18 +741,13 @@ namespace dmGameSystem
         }
         else // original path using quads
         {
-            static int tex_coord_order[] = {
-                0,1,2,2,3,0,
-                3,2,1,1,0,3,    //h
-                1,0,3,3,2,1,    //v
-                2,3,0,0,1,2     //hv
-            };
-
             const float* tex_coords = (const float*) texture_set->m_TextureSet->m_TexCoords.m_Data;
 
+            uint32_t vertex_offset = *vb_where - sprite_world->m_VertexBufferData;
+
             for (uint32_t *i = begin;i != end; ++i)
             {
-                const SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
+                SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
 
                 dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
 
@@ -502,43 +766,25 @@ namespace dmGameSystem
                     flip_flag |= 2;
                 }
 
-                const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+                uint32_t index_offset = indices - sprite_world->m_IndexBufferData;
+                bool valid = IsVertexDataValid(sprite_world, component, tc, flip_flag, vertex_offset, index_offset);
+                SetVertexDataValid(sprite_world, component, tc, flip_flag, vertex_offset, index_offset);
+                if (valid)
+                {
+                    vertices += 4;
+                    indices += 6 * index_type_size;
+                    vertex_offset += 4;
+                    continue;
+                }
+                AddDirtyRange(sprite_world, vertex_offset, vertex_offset + 4);
 
-                const Matrix4& w = component->m_World;
+                const int* tex_lookup = &TEX_COORD_ORDER[flip_flag * 6];
 
-                Vector4 p0 = w * Point3(-0.5f, -0.5f, 0.0f);
-                vertices[0].x = p0.getX();
-                vertices[0].y = p0.getY();
-                vertices[0].z = p0.getZ();
-                vertices[0].u = tc[tex_lookup[0] * 2];
-                vertices[0].v = tc[tex_lookup[0] * 2 + 1];
-
-                Vector4 p1 = w * Point3(-0.5f, 0.5f, 0.0f);
-                vertices[1].x = p1.getX();
-                vertices[1].y = p1.getY();
-                vertices[1].z = p1.getZ();
-                vertices[1].u = tc[tex_lookup[1] * 2];
-                vertices[1].v = tc[tex_lookup[1] * 2 + 1];
-
-                Vector4 p2 = w * Point3(0.5f, 0.5f, 0.0f);
-                vertices[2].x = p2.getX();
-                vertices[2].y = p2.getY();
-                vertices[2].z = p2.getZ();
-                vertices[2].u = tc[tex_lookup[2] * 2];
-                vertices[2].v = tc[tex_lookup[2] * 2 + 1];
-
-                Vector4 p3 = w * Point3(0.5f, -0.5f, 0.0f);
-                vertices[3].x = p3.getX();
-                vertices[3].y = p3.getY();
-                vertices[3].z = p3.getZ();
-                vertices[3].u = tc[tex_lookup[4] * 2];
-                vertices[3].v = tc[tex_lookup[4] * 2 + 1];
-
-                // for (int f = 0; f < 4; ++f)
-                //     printf("  %u: %.2f, %.2f\t%.2f, %.2f\n", f, vertices[f].x, vertices[f].y, vertices[f].u, vertices[f].v );
+                WriteQuad(vertices, component->m_World, tc, tex_lookup);
 
                 vertices += 4;
                 indices += 6 * index_type_size;
+                vertex_offset += 4;
             }
         }
 
@@ -560,6 +806,25 @@ namespace dmGameSystem
         dmRender::RenderObject& ro = *sprite_world->m_RenderObjects.End();
         sprite_world->m_RenderObjects.SetSize(sprite_world->m_RenderObjects.Size()+1);
 
+        if (!sprite_world->m_DispatchStarted)
+        {
+            sprite_world->m_DispatchStarted = 1;
+            uint32_t vertex_offset = sprite_world->m_VertexBufferWritePtr - sprite_world->m_VertexBufferData;
+            if (vertex_offset + sprite_world->m_DispatchVertexCount > sprite_world->m_VertexBufferCapacity)
+            {
+                // The sprites are drawn more times this frame than the buffers have room for. Start over from the
+                // beginning, and upload the whole buffer, since the previous draw calls still read the old contents.
+                sprite_world->m_VertexBufferWritePtr = sprite_world->m_VertexBufferData;
+                sprite_world->m_IndexBufferWritePtr = sprite_world->m_IndexBufferData;
+                sprite_world->m_VertexBuffers[sprite_world->m_VertexBufferIndex].m_FullUpload = 1;
+                // The vertices written so far this frame are overwritten
+                sprite_world->m_VertexCycle++;
+                // Make room for one more dispatch from the next frame
+                sprite_world->m_MaxDispatchCount++;
+                sprite_world->m_ReallocBuffers = 1;
+            }
+        }
+
         // Fill in vertex buffer
         SpriteVertex* vb_begin = sprite_world->m_VertexBufferWritePtr;
         uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
@@ -572,7 +837,7 @@ namespace dmGameSystem
 
         ro.Init();
         ro.m_VertexDeclaration = sprite_world->m_VertexDeclaration;
-        ro.m_VertexBuffer = sprite_world->m_VertexBuffer;
+        ro.m_VertexBuffer = sprite_world->m_VertexBuffers[sprite_world->m_VertexBufferIndex].m_Buffer;
         ro.m_IndexBuffer = sprite_world->m_IndexBuffer;
         ro.m_Material = GetMaterial(first, resource);
         ro.m_Textures[0] = texture_set->m_Texture;
@@ -641,38 +906,32 @@ namespace dmGameSystem
             scale_along_z = dmGameObject::ScaleAlongZ(dmGameObject::GetCollection(c->m_Instance));
         }
 
-        // Note: We update all sprites, even though they might be disabled, or not added to update
-
-        if (scale_along_z) {
-            for (uint32_t i = 0; i < n; ++i)
-            {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = appendScale(world * local, size);
-            }
-        } else
+        // Disabled sprites, and sprites not added to update, are not rendered so their transforms are left as they are
+        for (uint32_t i = 0; i < n; ++i)
         {
-            for (uint32_t i = 0; i < n; ++i)
-            {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Matrix4 w = dmTransform::MulNoScaleZ(world, local);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = appendScale(w, size);
-            }
-        }
+            SpriteComponent* c = &components[i];
+            if (!c->m_Enabled || !c->m_AddedToUpdate)
+                continue;
 
-        // The "sub_pixels" is set by default
-        if (!sub_pixels) {
-            for (uint32_t i = 0; i < n; ++i) {
-                SpriteComponent* c = &components[i];
-                Vector4 position = c->m_World.getCol3();
+            Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
+            Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
+            Matrix4 w = scale_along_z ? world * local : dmTransform::MulNoScaleZ(world, local);
+            Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
+            w = appendScale(w, size);
+
+            // The "sub_pixels" is set by default
+            if (!sub_pixels) {
+                Vector4 position = w.getCol3();
                 position.setX((int) position.getX());
                 position.setY((int) position.getY());
-                c->m_World.setCol3(position);
+                w.setCol3(position);
+            }
+
+            // Static sprites keep their vertices from the previous frame
+            if (memcmp(&w, &c->m_World, sizeof(Matrix4)) != 0)
+            {
+                c->m_World = w;
+                c->m_WorldChanged = 1;
             }
         }
     }
@@ -840,6 +1099,37 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    static void UploadVertexData(SpriteWorld* sprite_world)
+    {
+        DM_PROFILE(Sprite, "UploadVertexData");
+
+        SpriteVertexBuffer& vertex_buffer = sprite_world->m_VertexBuffers[sprite_world->m_VertexBufferIndex];
+        dmArray<SpriteVertexRange>& ranges = vertex_buffer.m_DirtyRanges;
+
+        uint32_t upload_size = 0;
+        if (vertex_buffer.m_FullUpload)
+        {
+            // Creates a new buffer on backends that would otherwise have to wait for the previous draw calls
+            upload_size = sprite_world->m_VertexBufferCapacity * sizeof(SpriteVertex);
+            dmGraphics::SetVertexBufferData(vertex_buffer.m_Buffer, upload_size, sprite_world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+            vertex_buffer.m_FullUpload = 0;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < ranges.Size(); ++i)
+            {
+                uint32_t offset = ranges[i].m_Begin * sizeof(SpriteVertex);
+                uint32_t size = (ranges[i].m_End - ranges[i].m_Begin) * sizeof(SpriteVertex);
+                dmGraphics::SetVertexBufferSubData(vertex_buffer.m_Buffer, offset, size, (uint8_t*)sprite_world->m_VertexBufferData + offset);
+                upload_size += size;
+            }
+        }
+        ranges.SetSize(0);
+
+        sprite_world->m_VertexUploadSize += upload_size;
+        DM_COUNTER("SpriteVertexBuffer", upload_size);
+    }
+
     static void RenderListDispatch(dmRender::RenderListDispatchParams const &params)
     {
         SpriteWorld* world = (SpriteWorld*) params.m_UserData;
@@ -847,15 +1137,15 @@ namespace dmGameSystem
         switch (params.m_Operation)
         {
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
-                world->m_VertexBufferWritePtr = world->m_VertexBufferData;
-                world->m_IndexBufferWritePtr = world->m_IndexBufferData;
                 world->m_RenderObjects.SetSize(0);
+                world->m_DispatchStarted = 0;
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
-                dmGraphics::SetVertexBufferData(world->m_VertexBuffer, sizeof(SpriteVertex) * (world->m_VertexBufferWritePtr - world->m_VertexBufferData),
-                                                world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
-
-                DM_COUNTER("SpriteVertexBuffer", (world->m_VertexBufferWritePtr - world->m_VertexBufferData) * sizeof(SpriteVertex));
+                if (!world->m_DispatchStarted)
+                {
+                    break;
+                }
+                UploadVertexData(world);
 
                 if (world->m_UseGeometries)
                 {
@@ -891,9 +1181,19 @@ namespace dmGameSystem
             // We will allocate for this upper bound
             uint32_t num_vertices_per_sprite = sprite_world->m_UseGeometries ? 8 : 4;
             uint32_t num_indices_per_sprite = (num_vertices_per_sprite - 2) * 3;
-            ReAllocateBuffers(sprite_world, render_context, sprite_context->m_MaxSpriteCount, num_vertices_per_sprite, num_indices_per_sprite);
+            ReAllocateBuffers(sprite_world, render_context, sprite_context->m_MaxSpriteCount * sprite_world->m_MaxDispatchCount, num_vertices_per_sprite, num_indices_per_sprite);
         }
 
+        if (!sprite_world->m_VertexBufferData)
+            return dmGameObject::UPDATE_RESULT_OK;
+
+        // The vertices of this frame go into the next vertex buffer, which the GPU is done reading from
+        sprite_world->m_VertexBufferIndex = (sprite_world->m_VertexBufferIndex + 1) % VERTEX_BUFFER_COUNT;
+        sprite_world->m_VertexBufferWritePtr = sprite_world->m_VertexBufferData;
+        sprite_world->m_IndexBufferWritePtr = sprite_world->m_IndexBufferData;
+        sprite_world->m_VertexCycle++;
+        sprite_world->m_VertexUploadSize = 0;
+
         // Submit all sprites as entries in the render list for sorting.
         dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, sprite_count);
         dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, sprite_world);
@@ -912,6 +1212,8 @@ namespace dmGameSystem
 
             const Vector4 trans = component.m_World.getCol(3);
             write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
+            // The quad spans [-0.5, 0.5] along the (scaled) x and y axes
+            write_ptr->m_BoundRadius = 0.5f * (length(component.m_World.getCol(0).getXYZ()) + length(component.m_World.getCol(1).getXYZ()));
             write_ptr->m_UserData = (uintptr_t) &component;
             write_ptr->m_BatchKey = component.m_MixedHash;
             write_ptr->m_TagMask = dmRender::GetMaterialTagMask(GetMaterial(&component, component.m_Resource));
@@ -921,6 +1223,9 @@ namespace dmGameSystem
             ++write_ptr;
         }
 
+        // Every render list dispatch draws each sprite at most once
+        sprite_world->m_DispatchVertexCount = (write_ptr - render_list) * (sprite_world->m_UseGeometries ? 8 : 4);
+
         dmRender::RenderListSubmit(render_context, render_list, write_ptr);
         return dmGameObject::UPDATE_RESULT_OK;
     }
@@ -1050,6 +1355,8 @@ namespace dmGameSystem
         SpriteComponent* component = &sprite_world->m_Components.Get(*params.m_UserData);
         if (component->m_Playing)
             PlayAnimation(component, component->m_CurrentAnimation, component->m_AnimTimer, component->m_PlaybackRate);
+        // The texture set might have changed
+        component->m_VertexCycle = 0;
     }
 
     dmGameObject::PropertyResult CompSpriteGetProperty(const dmGameObject::ComponentGetPropertyParams& params, dmGameObject::PropertyDesc& out_value)
@@ -1187,4 +1494,15 @@ namespace dmGameSystem
         pit->m_Next = 0;
         pit->m_FnIterateNext = CompSpriteIterPropertiesGetNext;
     }
+
+    void CompSpriteGetStatistics(void* world, SpriteStatistics* stats)
+    {
+        SpriteWorld* sprite_world = (SpriteWorld*)world;
+        stats->m_VertexUploadSize = sprite_world->m_VertexUploadSize;
+    }
+
+    void CompSpriteWriteQuad(float* vertices, const Matrix4& world, const float* tex_coords, uint32_t flip_flag)
+    {
+        WriteQuad((SpriteVertex*)vertices, world, tex_coords, &TEX_COORD_ORDER[flip_flag * 6]);
+    }
 }
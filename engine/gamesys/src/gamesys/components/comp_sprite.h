@@ -40,6 +40,18 @@ namespace dmGameSystem
     dmGameObject::PropertyResult CompSpriteSetProperty(const dmGameObject::ComponentSetPropertyParams& params);
 
     void CompSpriteIterProperties(dmGameObject::SceneNodePropertyIterator* pit, dmGameObject::SceneNode* node);
+
+    struct SpriteStatistics
+    {
+        /// Bytes of vertex data uploaded in the current frame
+        uint32_t m_VertexUploadSize;
+    };
+
+    void CompSpriteGetStatistics(void* world, SpriteStatistics* stats);
+
+    /// Writes the four corners of a sprite quad as x, y, z, u and v. The vertices need to be 16 byte aligned.
+    /// The flip flag has horizontal flip in the first bit, and vertical flip in the second.
+    void CompSpriteWriteQuad(float* vertices, const Vectormath::Aos::Matrix4& world, const float* tex_coords, uint32_t flip_flag);
 }
 
 #endif // DM_GAMESYS_COMP_SPRITE_H
@@ -715,6 +715,28 @@ namespace dmGameSystem
         return num_render_entries;
     }
 
+    // Radius of a sphere around position that contains all cells of the region
+    static float CalculateRegionBoundRadius(const TileGridComponent* component, uint32_t region_x, uint32_t region_y, float z,
+                                            uint32_t tile_width, uint32_t tile_height, const Point3& position)
+    {
+        const TileGridResource* resource = component->m_Resource;
+        int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
+        int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
+        int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)resource->m_ColumnCount);
+        int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)resource->m_RowCount);
+
+        const Matrix4& w = component->m_World;
+        const float x0 = (float)(min_x * (int32_t)tile_width);
+        const float y0 = (float)(min_y * (int32_t)tile_height);
+        const float x1 = (float)(max_x * (int32_t)tile_width);
+        const float y1 = (float)(max_y * (int32_t)tile_height);
+        float radius_sq = lengthSqr(Point3((w * Point3(x0, y0, z)).getXYZ()) - position);
+        radius_sq = dmMath::Max(radius_sq, lengthSqr(Point3((w * Point3(x1, y0, z)).getXYZ()) - position));
+        radius_sq = dmMath::Max(radius_sq, lengthSqr(Point3((w * Point3(x0, y1, z)).getXYZ()) - position));
+        radius_sq = dmMath::Max(radius_sq, lengthSqr(Point3((w * Point3(x1, y1, z)).getXYZ()) - position));
+        return sqrtf(radius_sq);
+    }
+
     dmGameObject::UpdateResult CompTileGridRender(const dmGameObject::ComponentsRenderParams& params)
     {
         TilemapContext* context = (TilemapContext*)params.m_Context;
@@ -771,6 +793,7 @@ namespace dmGameSystem
                         Vector4 trans = component->m_World * Point3(x * tile_width, y * tile_height, layer_ddf->m_Z);
 
                         write_ptr->m_WorldPosition = Point3(trans.getXYZ());
+                        write_ptr->m_BoundRadius = CalculateRegionBoundRadius(component, x, y, layer_ddf->m_Z, tile_width, tile_height, write_ptr->m_WorldPosition);
                         write_ptr->m_UserData = EncodeRegionInfo(i, l, x, y);
                         write_ptr->m_TagMask = dmRender::GetMaterialTagMask(GetMaterial(component));
                         write_ptr->m_BatchKey = component->m_MixedHash;
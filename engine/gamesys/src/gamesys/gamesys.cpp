@@ -85,6 +85,8 @@ namespace dmGameSystem
     , m_GuiContext(0)
     , m_ScriptContext(0)
     , m_MaxGuiComponents(64)
+    , m_JobPool(0x0)
+    , m_CullClippers(0)
     {
         m_Worlds.SetCapacity(128);
     }
@@ -144,6 +146,18 @@ namespace dmGameSystem
 
 #undef REGISTER_RESOURCE_TYPE
 
+        // Large resources without dependencies are loaded after the resources that reveal more resources to load
+        dmResource::SetTypeLoadPriority(factory, "texturec", dmResource::LOAD_PRIORITY_LOW);
+        dmResource::SetTypeLoadPriority(factory, "bufferc", dmResource::LOAD_PRIORITY_LOW);
+        dmResource::SetTypeLoadPriority(factory, "wavc", dmResource::LOAD_PRIORITY_LOW);
+        dmResource::SetTypeLoadPriority(factory, "oggc", dmResource::LOAD_PRIORITY_LOW);
+
+        // Only parses data, without dependencies, so these are created on the loader threads
+        dmResource::SetTypeThreadSafeCreate(factory, "skeletonc", true);
+        dmResource::SetTypeThreadSafeCreate(factory, "camerac", true);
+        dmResource::SetTypeThreadSafeCreate(factory, "lightc", true);
+        dmResource::SetTypeThreadSafeCreate(factory, "gamepadsc", true);
+
         return e;
     }
 
@@ -174,7 +188,7 @@ namespace dmGameSystem
                                 update_func, render_func, post_update_func, on_message_func, on_input_func, \
                                 on_reload_func, get_property_func, set_property_func, \
                                 iter_child_func, iter_property_func, \
-                                set_reads_transforms)\
+                                set_reads_transforms, render_parallel)\
     factory_result = dmResource::GetTypeFromExtension(factory, extension, &type);\
     if (factory_result != dmResource::RESULT_OK)\
     {\
@@ -204,6 +218,7 @@ namespace dmGameSystem
     component_type.m_IterChildren = iter_child_func;\
     component_type.m_IterProperties = iter_property_func;\
     component_type.m_ReadsTransforms = set_reads_transforms;\
+    component_type.m_RenderParallel = render_parallel;\
     component_type.m_InstanceHasUserData = (uint32_t)true;\
     component_type.m_UpdateOrderPrio = prio;\
     go_result = dmGameObject::RegisterComponentType(regist, component_type);\
@@ -213,6 +228,11 @@ namespace dmGameSystem
         /*
          * About update priority. Component types below have priority evenly spaced with increments by 100
          *
+         * About parallel rendering (the last argument). Only component types whose render function just adds
+         * render list entries may opt in. They still generate their vertex data in the render list dispatch,
+         * on the main thread. Sprites are excluded since their render function writes the vertex buffers and may
+         * (re)create the graphics buffers, which has to happen on the graphics thread.
+         *
          */
 
         REGISTER_COMPONENT_TYPE("collectionproxyc", 100, collection_proxy_context,
@@ -221,7 +241,7 @@ namespace dmGameSystem
                 &CompCollectionProxyUpdate, &CompCollectionProxyRender, &CompCollectionProxyPostUpdate, &CompCollectionProxyOnMessage, &CompCollectionProxyOnInput,
                 0, 0, 0,
                 &CompCollectionProxyIterChildren, 0,
-                0);
+                0, 0);
 
         // See gameobject_comp.cpp for these two component types:
         // Priority 200 is reserved for scriptc (read+write transforms)
@@ -233,7 +253,7 @@ namespace dmGameSystem
                 CompGuiUpdate, CompGuiRender, 0, CompGuiOnMessage, CompGuiOnInput,
                 CompGuiOnReload, CompGuiGetProperty, CompGuiSetProperty,
                 CompGuiIterChildren, CompGuiIterProperties,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("collisionobjectc", 400, physics_context,
                 &CompCollisionObjectNewWorld, &CompCollisionObjectDeleteWorld,
@@ -241,7 +261,7 @@ namespace dmGameSystem
                 &CompCollisionObjectUpdate, 0, &CompCollisionObjectPostUpdate, &CompCollisionObjectOnMessage, 0,
                 &CompCollisionObjectOnReload, CompCollisionObjectGetProperty, CompCollisionObjectSetProperty,
                 0, 0,
-                1);
+                1, 0);
 
         REGISTER_COMPONENT_TYPE("camerac", 500, render_context,
                 &CompCameraNewWorld, &CompCameraDeleteWorld,
@@ -249,7 +269,7 @@ namespace dmGameSystem
                 &CompCameraUpdate, 0, 0, &CompCameraOnMessage, 0,
                 &CompCameraOnReload, 0, 0,
                 0, 0,
-                1);
+                1, 0);
 
         REGISTER_COMPONENT_TYPE("soundc", 600, sound_context,
                 CompSoundNewWorld, CompSoundDeleteWorld,
@@ -257,7 +277,7 @@ namespace dmGameSystem
                 CompSoundUpdate, 0, 0, CompSoundOnMessage, 0,
                 0, CompSoundGetProperty, CompSoundSetProperty,
                 0, 0,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("modelc", 700, model_context,
                 CompModelNewWorld, CompModelDeleteWorld,
@@ -265,7 +285,7 @@ namespace dmGameSystem
                 CompModelUpdate, CompModelRender, 0, CompModelOnMessage, 0,
                 0, CompModelGetProperty, CompModelSetProperty,
                 0, 0,
-                0);
+                0, 1);
 
         REGISTER_COMPONENT_TYPE("meshc", 725, mesh_context,
                 CompMeshNewWorld, CompMeshDeleteWorld,
@@ -273,7 +293,7 @@ namespace dmGameSystem
                 CompMeshUpdate, CompMeshRender, 0, CompMeshOnMessage, 0,
                 0, CompMeshGetProperty, CompMeshSetProperty,
                 0, 0,
-                0);
+                0, 1);
 
         REGISTER_COMPONENT_TYPE("emitterc", 750, 0x0,
                 &CompEmitterNewWorld, &CompEmitterDeleteWorld,
@@ -281,7 +301,7 @@ namespace dmGameSystem
                 0, 0, 0, CompEmitterOnMessage, 0,
                 0, 0, 0,
                 0, 0,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("particlefxc", 800, particlefx_context,
                 &CompParticleFXNewWorld, &CompParticleFXDeleteWorld,
@@ -289,7 +309,7 @@ namespace dmGameSystem
                 &CompParticleFXUpdate, &CompParticleFXRender, 0, &CompParticleFXOnMessage, 0,
                 &CompParticleFXOnReload, 0, 0,
                 0, 0,
-                1);
+                1, 0);
 
         REGISTER_COMPONENT_TYPE("factoryc", 900, factory_context,
                 CompFactoryNewWorld, CompFactoryDeleteWorld,
@@ -297,7 +317,7 @@ namespace dmGameSystem
                 CompFactoryUpdate, 0, 0, CompFactoryOnMessage, 0,
                 0, 0, 0,
                 0, 0,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("collectionfactoryc", 950, collectionfactory_context,
                 CompCollectionFactoryNewWorld, CompCollectionFactoryDeleteWorld,
@@ -305,7 +325,7 @@ namespace dmGameSystem
                 CompCollectionFactoryUpdate, 0, 0, 0, 0,
                 0, 0, 0,
                 0, 0,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("lightc", 1000, render_context,
                 CompLightNewWorld, CompLightDeleteWorld,
@@ -313,7 +333,7 @@ namespace dmGameSystem
                 CompLightUpdate, 0, 0, CompLightOnMessage, 0,
                 0, 0, 0,
                 0, 0,
-                1);
+                1, 0);
 
         REGISTER_COMPONENT_TYPE("spritec", 1100, sprite_context,
                 CompSpriteNewWorld, CompSpriteDeleteWorld,
@@ -321,7 +341,7 @@ namespace dmGameSystem
                 CompSpriteUpdate, CompSpriteRender, 0, CompSpriteOnMessage, 0,
                 CompSpriteOnReload, CompSpriteGetProperty, CompSpriteSetProperty,
                 0, CompSpriteIterProperties,
-                1);
+                1, 0);
 
         REGISTER_COMPONENT_TYPE(TILE_MAP_EXT, 1200, tilemap_context,
                 CompTileGridNewWorld, CompTileGridDeleteWorld,
@@ -329,7 +349,7 @@ namespace dmGameSystem
                 CompTileGridUpdate, CompTileGridRender, 0, CompTileGridOnMessage, 0,
                 CompTileGridOnReload, CompTileGridGetProperty, CompTileGridSetProperty,
                 0, 0,
-                1);
+                1, 1);
 
         REGISTER_COMPONENT_TYPE(SPINE_MODEL_EXT, 1300, spine_model_context,
                 CompSpineModelNewWorld, CompSpineModelDeleteWorld,
@@ -337,7 +357,7 @@ namespace dmGameSystem
                 CompSpineModelUpdate, CompSpineModelRender, 0, CompSpineModelOnMessage, 0,
                 CompSpineModelOnReload, CompSpineModelGetProperty, CompSpineModelSetProperty,
                 0, 0,
-                0);
+                0, 0);
 
         REGISTER_COMPONENT_TYPE("labelc", 1400, label_context,
                 CompLabelNewWorld, CompLabelDeleteWorld,
@@ -345,7 +365,7 @@ namespace dmGameSystem
                 CompLabelUpdate, CompLabelRender, 0, CompLabelOnMessage, 0,
                 CompLabelOnReload, CompLabelGetProperty, CompLabelSetProperty,
                 0, 0,
-                1);
+                1, 0);
 
         #undef REGISTER_COMPONENT_TYPE
 
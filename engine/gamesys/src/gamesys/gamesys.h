@@ -14,6 +14,7 @@
 #define DM_GAMESYS_H
 
 #include <dlib/configfile.h>
+#include <dlib/job_pool.h>
 
 #include <script/script.h>
 
@@ -86,6 +87,7 @@ namespace dmGameSystem
         dmRender::HRenderContext m_RenderContext;
         uint32_t m_MaxParticleFXCount;
         uint32_t m_MaxParticleCount;
+        dmJobPool::HJobPool m_JobPool;
         bool m_Debug;
     };
 
@@ -109,6 +111,9 @@ namespace dmGameSystem
         uint32_t                    m_MaxParticleFXCount;
         uint32_t                    m_MaxParticleCount;
         uint32_t                    m_MaxSpineCount;
+        dmJobPool::HJobPool         m_JobPool;
+        // Skip clippers outside the physical screen, see dmGui::RenderSceneParams::m_CullClippers
+        uint32_t                    m_CullClippers : 1;
     };
 
     struct SpriteContext
@@ -33,6 +33,7 @@
 #include "scripts/script_window.h"
 #include "scripts/script_collectionproxy.h"
 #include "scripts/script_buffer.h"
+#include "scripts/script_gameobject.h"
 #include <liveupdate/liveupdate.h>
 
 extern "C"
@@ -72,6 +73,7 @@ namespace dmGameSystem
         ScriptModelRegister(context);
         ScriptWindowRegister(context);
         ScriptCollectionProxyRegister(context);
+        ScriptGameObjectRegister(context);
 
         assert(top == lua_gettop(L));
         return result;
@@ -12,14 +12,34 @@
 
 #include "res_meshset.h"
 
+#include <math.h>
 #include <dlib/log.h>
 
 namespace dmGameSystem
 {
     using namespace Vectormath::Aos;
 
+    static float CalculateBoundRadius(const dmRigDDF::MeshSet* mesh_set)
+    {
+        float radius_sq = 0.0f;
+        for (uint32_t i = 0; i < mesh_set->m_MeshAttachments.m_Count; ++i)
+        {
+            const dmRigDDF::Mesh& mesh = mesh_set->m_MeshAttachments[i];
+            const float* positions = mesh.m_Positions.m_Data;
+            uint32_t position_count = mesh.m_Positions.m_Count / 3;
+            for (uint32_t p = 0; p < position_count; ++p, positions += 3)
+            {
+                float length_sq = positions[0]*positions[0] + positions[1]*positions[1] + positions[2]*positions[2];
+                if (length_sq > radius_sq)
+                    radius_sq = length_sq;
+            }
+        }
+        return sqrtf(radius_sq);
+    }
+
     dmResource::Result AcquireResources(dmResource::HFactory factory, MeshSetResource* resource, const char* filename)
     {
+        resource->m_BoundRadius = CalculateBoundRadius(resource->m_MeshSet);
         return dmResource::RESULT_OK;
     }
 
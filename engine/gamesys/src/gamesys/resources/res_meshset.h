@@ -23,6 +23,8 @@ namespace dmGameSystem
     struct MeshSetResource
     {
         dmRigDDF::MeshSet* m_MeshSet;
+        /// Radius of a sphere around the origin that contains all mesh positions (in the bind pose)
+        float              m_BoundRadius;
     };
 
     dmResource::Result ResMeshSetPreload(const dmResource::ResourcePreloadParams& params);
@@ -0,0 +1,203 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <dlib/buffer.h>
+#include <dlib/hash.h>
+#include <gameobject/gameobject.h>
+#include <script/script.h>
+
+#include "script_gameobject.h"
+#include "../resources/res_buffer.h"
+#include "../gamesys.h"
+#include "../gamesys_private.h"
+
+extern "C"
+{
+#include <lua/lauxlib.h>
+#include <lua/lualib.h>
+}
+
+namespace dmGameSystem
+{
+    static const dmhash_t POSITION_STREAM = dmHashString64("position");
+
+    // Gets the float stream of a batch function, with one vector3 per id
+    static float* CheckPositionStream(lua_State* L, int buffer_index, int stream_index, uint32_t count, uint32_t* stride, const char* function_name)
+    {
+        dmScript::LuaHBuffer* luabuf = dmScript::CheckBuffer(L, buffer_index);
+        dmBuffer::HBuffer buffer = luabuf->m_Buffer;
+        if (luabuf->m_Owner == dmScript::OWNER_RES) {
+            buffer = ((BufferResource*)luabuf->m_BufferRes)->m_Buffer;
+        }
+
+        dmhash_t stream_name = POSITION_STREAM;
+        if (!lua_isnoneornil(L, stream_index))
+        {
+            stream_name = dmScript::CheckHashOrString(L, stream_index);
+        }
+
+        dmBuffer::ValueType type;
+        uint32_t components;
+        if (dmBuffer::GetStreamType(buffer, stream_name, &type, &components) != dmBuffer::RESULT_OK)
+        {
+            luaL_error(L, "go.%s: the buffer has no stream '%s'", function_name, dmHashReverseSafe64(stream_name));
+        }
+        if (type != dmBuffer::VALUE_TYPE_FLOAT32 || components < 3)
+        {
+            luaL_error(L, "go.%s: the stream '%s' must have at least 3 components of type float32", function_name, dmHashReverseSafe64(stream_name));
+        }
+
+        float* data = 0;
+        uint32_t stream_count = 0;
+        dmBuffer::GetStream(buffer, stream_name, (void**)&data, &stream_count, &components, stride);
+        if (stream_count < count)
+        {
+            luaL_error(L, "go.%s: the stream '%s' has %u elements, but there are %u ids", function_name, dmHashReverseSafe64(stream_name), stream_count, count);
+        }
+        return data;
+    }
+
+    // Resolves the id at the top of the stack. Hashes are looked up directly, other ids are resolved as urls.
+    static dmGameObject::HInstance ResolveBatchInstance(lua_State* L, dmGameObject::HCollection collection, dmMessage::HSocket socket)
+    {
+        int index = lua_gettop(L);
+        dmhash_t id;
+        if (dmScript::IsHash(L, index))
+        {
+            id = dmScript::CheckHash(L, index);
+        }
+        else
+        {
+            dmMessage::URL url;
+            dmScript::ResolveURL(L, index, &url, 0x0);
+            if (url.m_Socket != socket)
+            {
+                luaL_error(L, "function called can only access instances within the same collection.");
+            }
+            id = url.m_Path;
+        }
+
+        dmGameObject::HInstance instance = dmGameObject::GetInstanceFromIdentifier(collection, id);
+        if (!instance)
+        {
+            luaL_error(L, "Instance %s not found", dmHashReverseSafe64(id));
+        }
+        return instance;
+    }
+
+    /*# sets the position of many game object instances
+     * Sets the positions of a list of game object instances in one call, from a stream of a buffer.
+     * This is considerably faster than calling [ref:go.set_position] for each instance when
+     * moving thousands of instances. Element i of the stream is the position of the i:th id.
+     * The positions are relative to the parents (if any).
+     *
+     * @namespace go
+     * @name go.set_positions
+     * @param ids [type:table] list of ids of the game object instances, as [type:hash|string|url]. Hashes are the fastest to resolve.
+     * @param buffer [type:buffer] buffer with the positions
+     * @param [stream] [type:hash|string] name of a float32 stream with at least 3 components, "position" by default
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.ids = {}
+     *     for i = 1, 1000 do
+     *         self.ids[i] = factory.create("#factory")
+     *     end
+     *     self.positions = buffer.create(#self.ids, { {name=hash("position"), type=buffer.VALUE_TYPE_FLOAT32, count=3} })
+     * end
+     *
+     * function update(self, dt)
+     *     local positions = buffer.get_stream(self.positions, hash("position"))
+     *     -- update positions[1] .. positions[3 * #self.ids]
+     *     go.set_positions(self.ids, self.positions)
+     * end
+     * ```
+     */
+    static int GameObject_SetPositions(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        luaL_checktype(L, 1, LUA_TTABLE);
+        uint32_t count = (uint32_t)lua_objlen(L, 1);
+        uint32_t stride;
+        const float* positions = CheckPositionStream(L, 2, 3, count, &stride, "set_positions");
+
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(CheckGoInstance(L));
+        dmMessage::HSocket socket = dmGameObject::GetMessageSocket(collection);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            lua_rawgeti(L, 1, i + 1);
+            dmGameObject::HInstance instance = ResolveBatchInstance(L, collection, socket);
+            lua_pop(L, 1);
+            dmGameObject::SetPosition(instance, Vectormath::Aos::Point3(positions[0], positions[1], positions[2]));
+            positions += stride;
+        }
+        return 0;
+    }
+
+    /*# gets the world position of many game object instances
+     * Gets the world positions of a list of game object instances in one call, into a stream of a buffer.
+     * This is considerably faster than calling [ref:go.get_world_position] for each instance.
+     * Element i of the stream is set to the world position of the i:th id.
+     *
+     * @namespace go
+     * @name go.get_world_positions
+     * @param ids [type:table] list of ids of the game object instances, as [type:hash|string|url]. Hashes are the fastest to resolve.
+     * @param buffer [type:buffer] buffer to store the world positions in
+     * @param [stream] [type:hash|string] name of a float32 stream with at least 3 components, "position" by default
+     * @examples
+     *
+     * ```lua
+     * go.get_world_positions(self.ids, self.positions)
+     * local positions = buffer.get_stream(self.positions, hash("position"))
+     * print(positions[1], positions[2], positions[3]) -- world position of self.ids[1]
+     * ```
+     */
+    static int GameObject_GetWorldPositions(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        luaL_checktype(L, 1, LUA_TTABLE);
+        uint32_t count = (uint32_t)lua_objlen(L, 1);
+        uint32_t stride;
+        float* positions = CheckPositionStream(L, 2, 3, count, &stride, "get_world_positions");
+
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(CheckGoInstance(L));
+        dmMessage::HSocket socket = dmGameObject::GetMessageSocket(collection);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            lua_rawgeti(L, 1, i + 1);
+            dmGameObject::HInstance instance = ResolveBatchInstance(L, collection, socket);
+            lua_pop(L, 1);
+            Vectormath::Aos::Point3 p = dmGameObject::GetWorldPosition(instance);
+            positions[0] = p.getX();
+            positions[1] = p.getY();
+            positions[2] = p.getZ();
+            positions += stride;
+        }
+        return 0;
+    }
+
+    static const luaL_reg GAMEOBJECT_FUNCTIONS[] =
+    {
+        {"set_positions",       GameObject_SetPositions},
+        {"get_world_positions", GameObject_GetWorldPositions},
+        {0, 0}
+    };
+
+    void ScriptGameObjectRegister(const ScriptLibContext& context)
+    {
+        lua_State* L = context.m_LuaState;
+        // Adds the functions to the "go" table registered by the gameobject library
+        luaL_register(L, "go", GAMEOBJECT_FUNCTIONS);
+        lua_pop(L, 1);
+    }
+}
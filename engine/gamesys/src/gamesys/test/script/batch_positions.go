@@ -0,0 +1,4 @@
+components {
+  id: "script"
+  component: "/script/batch_positions.script"
+}
@@ -0,0 +1,40 @@
+components {
+  id: "sprite0"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite1"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite2"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite3"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite4"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite5"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite6"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite7"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite8"
+  component: "/sprite/valid.sprite"
+}
+components {
+  id: "sprite9"
+  component: "/sprite/valid.sprite"
+}
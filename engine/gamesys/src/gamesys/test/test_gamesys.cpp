@@ -29,6 +29,7 @@
 #include "../proto/gamesys_ddf.h"
 #include "../proto/sprite_ddf.h"
 #include "../components/comp_label.h"
+#include "../components/comp_sprite.h"
 
 namespace dmGameSystem
 {
@@ -558,6 +559,118 @@ TEST_F(SpriteAnimTest, GoDeletion)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+// The sprite quads are written with vector math, which needs to give the same vertices as transforming the corners
+TEST(SpriteTest, WriteQuad)
+{
+    const float epsilon = 0.0001f;
+    // The corners of the quad, in the order they are written
+    const float corners[4][2] = { {-0.5f, -0.5f}, {-0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, -0.5f} };
+    // The texture coordinates of each corner, with no flip, flipped horizontally, vertically and both
+    const uint32_t corner_tex_coords[4][4] = { {0, 1, 2, 3}, {3, 2, 1, 0}, {1, 0, 3, 2}, {2, 3, 0, 1} };
+    const float tex_coords[8] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f };
+
+    Matrix4 worlds[4];
+    // Rotated
+    worlds[0] = Matrix4::rotationZ(0.7f);
+    worlds[0].setTranslation(Vector3(10.0f, -20.0f, 0.5f));
+    // Scaled
+    worlds[1] = Matrix4::scale(Vector3(64.0f, 32.0f, 1.0f));
+    worlds[1].setTranslation(Vector3(-3.0f, 5.0f, 0.0f));
+    // Rotated and scaled out of the xy plane
+    worlds[2] = Matrix4::rotation(1.3f, normalize(Vector3(1.0f, 2.0f, 3.0f))) * Matrix4::scale(Vector3(16.0f, 48.0f, 2.0f));
+    worlds[2].setTranslation(Vector3(100.0f, 200.0f, -1.0f));
+    // Mirrored by a negative scale
+    worlds[3] = Matrix4::rotationZ(-2.1f) * Matrix4::scale(Vector3(-20.0f, 10.0f, 1.0f));
+
+    float DM_ALIGNED(16) vertices[4 * 5];
+    for (uint32_t w = 0; w < sizeof(worlds) / sizeof(worlds[0]); ++w)
+    {
+        for (uint32_t flip_flag = 0; flip_flag < 4; ++flip_flag)
+        {
+            dmGameSystem::CompSpriteWriteQuad(vertices, worlds[w], tex_coords, flip_flag);
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                const float* vertex = &vertices[i * 5];
+                Vector4 p = worlds[w] * Point3(corners[i][0], corners[i][1], 0.0f);
+                ASSERT_NEAR(p.getX(), vertex[0], epsilon);
+                ASSERT_NEAR(p.getY(), vertex[1], epsilon);
+                ASSERT_NEAR(p.getZ(), vertex[2], epsilon);
+                const float* uv = &tex_coords[corner_tex_coords[flip_flag][i] * 2];
+                ASSERT_EQ(uv[0], vertex[3]);
+                ASSERT_EQ(uv[1], vertex[4]);
+            }
+        }
+    }
+}
+
+// Renders a large number of sprites, to track the cost of writing and uploading their vertices
+TEST_P(SpriteBenchmarkTest, Throughput)
+{
+    const uint32_t sprite_count = GetParam();
+    const uint32_t frame_count = 30;
+    // The game objects have ten sprites each, to stay within the instance count of a collection
+    const uint32_t go_count = sprite_count / 10;
+
+    uint32_t max_sprite_count = m_SpriteContext.m_MaxSpriteCount;
+    m_SpriteContext.m_MaxSpriteCount = sprite_count;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("sprite_collection", m_Factory, m_Register, go_count);
+    m_SpriteContext.m_MaxSpriteCount = max_sprite_count;
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(go_count);
+    for (uint32_t i = 0; i < go_count; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::New(collection, "/sprite/bench_sprites.goc");
+        ASSERT_NE((void*)0, go);
+        dmGameObject::SetRotation(go, Quat::rotationZ(i * 0.01f));
+        instances.Push(go);
+    }
+    ASSERT_TRUE(dmGameObject::Init(collection));
+
+    // Every sprite is moved in the first half of the frames, and none in the second
+    uint64_t moving_time = 0;
+    uint64_t static_time = 0;
+    for (uint32_t frame = 0; frame < frame_count * 2; ++frame)
+    {
+        bool moving = frame < frame_count;
+        if (moving)
+        {
+            for (uint32_t i = 0; i < go_count; ++i)
+            {
+                float x = (i % 100) * 0.018f - 0.9f;
+                float y = ((i / 100) % 100) * 0.018f - 0.9f + frame * 0.001f;
+                dmGameObject::SetPosition(instances[i], Point3(x, y, 0));
+            }
+        }
+        ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+
+        uint64_t start = dmTime::GetTime();
+        dmRender::RenderListBegin(m_RenderContext);
+        dmGameObject::Render(collection);
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+        uint64_t time = dmTime::GetTime() - start;
+        if (moving)
+        {
+            moving_time += time;
+        }
+        else
+        {
+            static_time += time;
+        }
+
+        ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+        dmGraphics::Flip(m_GraphicsContext);
+    }
+
+    printf("Sprite throughput, %u sprites: moving %7.3f ms/frame, static %7.3f ms/frame\n", sprite_count,
+        moving_time / (1000.0f * frame_count), static_time / (1000.0f * frame_count));
+
+    ASSERT_TRUE(dmGameObject::Final(collection));
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
 static float GetFloatProperty(dmGameObject::HInstance go, dmhash_t component_id, dmhash_t property_id)
 {
     dmGameObject::PropertyDesc property_desc;
@@ -1127,6 +1240,322 @@ TEST_P(DrawCountTest, DrawCount)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+/* Frustum culling */
+
+static uint64_t DrawCollection(dmRender::HRenderContext render_context, dmGameObject::HCollection collection, dmGameObject::UpdateContext* update_context)
+{
+    if (!dmGameObject::Update(collection, update_context))
+        return ~0ULL;
+    dmRender::RenderListBegin(render_context);
+    dmGameObject::Render(collection);
+    dmRender::RenderListEnd(render_context);
+    dmRender::DrawRenderList(render_context, 0x0, 0x0);
+    if (!dmGameObject::PostUpdate(collection))
+        return ~0ULL;
+    // The null device only resets the count on the first draw after a flip
+    uint64_t draw_count = dmGraphics::GetDrawCount();
+    dmGraphics::Flip(dmRender::GetGraphicsContext(render_context));
+    return draw_count;
+}
+
+TEST_F(FrustumCullingTest, Sprite)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // The sprites use different tile sources, so every visible sprite is a draw call.
+    // The view projection is the identity, which makes the visible volume [-1, 1] on all axes.
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go1"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/cursor.goc", dmHashString64("/go2"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+
+    ASSERT_EQ(2U, DrawCollection(m_RenderContext, m_Collection, &m_UpdateContext));
+
+    // Off screen, but its bounds still reach into the visible volume
+    dmGameObject::SetPosition(go2, Point3(5.0f, 0, 0));
+    ASSERT_EQ(2U, DrawCollection(m_RenderContext, m_Collection, &m_UpdateContext));
+
+    dmGameObject::SetPosition(go2, Point3(100.0f, 0, 0));
+    ASSERT_EQ(1U, DrawCollection(m_RenderContext, m_Collection, &m_UpdateContext));
+
+    dmGameObject::SetPosition(go2, Point3(0, 0, 0));
+    ASSERT_EQ(2U, DrawCollection(m_RenderContext, m_Collection, &m_UpdateContext));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+/* Sprite vertex reuse */
+
+static void* GetSpriteWorld(dmResource::HFactory factory, dmGameObject::HRegister regist, dmGameObject::HCollection collection)
+{
+    dmResource::ResourceType resource_type;
+    if (dmResource::GetTypeFromExtension(factory, "spritec", &resource_type) != dmResource::RESULT_OK)
+        return 0;
+    uint32_t component_index;
+    if (!dmGameObject::FindComponentType(regist, resource_type, &component_index))
+        return 0;
+    return dmGameObject::GetWorld(collection, component_index);
+}
+
+// Renders a frame with draw_count draw calls, and returns the bytes of sprite vertices uploaded.
+// The draw calls use the predicates if there are any, otherwise they draw everything.
+static uint32_t DrawSpriteFrame(dmRender::HRenderContext render_context, dmGameObject::HCollection collection, dmGameObject::UpdateContext* update_context, void* sprite_world, dmRender::Predicate* predicates, uint32_t draw_count)
+{
+    if (!dmGameObject::Update(collection, update_context))
+        return ~0U;
+    dmRender::RenderListBegin(render_context);
+    dmGameObject::Render(collection);
+    dmRender::RenderListEnd(render_context);
+    for (uint32_t i = 0; i < draw_count; ++i)
+    {
+        dmRender::DrawRenderList(render_context, predicates ? &predicates[i] : 0x0, 0x0);
+    }
+    if (!dmGameObject::PostUpdate(collection))
+        return ~0U;
+    dmGraphics::Flip(dmRender::GetGraphicsContext(render_context));
+
+    dmGameSystem::SpriteStatistics stats;
+    dmGameSystem::CompSpriteGetStatistics(sprite_world, &stats);
+    return stats.m_VertexUploadSize;
+}
+
+// The sprite vertex buffers are drawn from in turn, so a change is uploaded once to each of them
+static bool SettleSpriteVertices(dmRender::HRenderContext render_context, dmGameObject::HCollection collection, dmGameObject::UpdateContext* update_context, void* sprite_world, dmRender::Predicate* predicates, uint32_t draw_count)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        if (DrawSpriteFrame(render_context, collection, update_context, sprite_world, predicates, draw_count) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool PostSpriteMessage(dmGameObject::HCollection collection, dmGameObject::HInstance go, const dmDDF::Descriptor* descriptor, void* message, uint32_t message_size)
+{
+    dmMessage::URL url;
+    dmMessage::ResetURL(url);
+    url.m_Socket = dmGameObject::GetMessageSocket(collection);
+    url.m_Path = dmGameObject::GetIdentifier(go);
+    url.m_Fragment = dmHashString64("sprite");
+    return dmMessage::RESULT_OK == dmMessage::Post(&url, &url, descriptor->m_NameHash, (uintptr_t)go, (uintptr_t)descriptor, message, message_size, 0);
+}
+
+// Four vertices of position and texture coordinates
+static const uint32_t SPRITE_QUAD_SIZE = 4 * 5 * sizeof(float);
+
+TEST_F(SpriteVertexTest, Move)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go1"));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go2"));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_EQ(0U, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    dmGameObject::SetPosition(go2, Point3(0.5f, 0, 0));
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+TEST_F(SpriteVertexTest, Flip)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go1"));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go2"));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    dmGameSystemDDF::SetFlipHorizontal flip_horizontal;
+    flip_horizontal.m_Flip = 1;
+    ASSERT_TRUE(PostSpriteMessage(m_Collection, go1, dmGameSystemDDF::SetFlipHorizontal::m_DDFDescriptor, &flip_horizontal, sizeof(flip_horizontal)));
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    dmGameSystemDDF::SetFlipVertical flip_vertical;
+    flip_vertical.m_Flip = 1;
+    ASSERT_TRUE(PostSpriteMessage(m_Collection, go2, dmGameSystemDDF::SetFlipVertical::m_DDFDescriptor, &flip_vertical, sizeof(flip_vertical)));
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+TEST_F(SpriteVertexTest, AnimationFrame)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // One frame per second
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/sprite/cursor.goc", dmHashString64("/go"));
+    ASSERT_NE((void*)0, go);
+
+    m_UpdateContext.m_DT = 0.0f;
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    m_UpdateContext.m_DT = 1.0f;
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    m_UpdateContext.m_DT = 0.0f;
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+TEST_F(SpriteVertexTest, Disable)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // The sprites are drawn in the order they were created
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go1"));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go2"));
+    dmGameObject::HInstance go3 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go3"));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+    ASSERT_NE((void*)0, go3);
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    // The sprites after it are written one quad earlier
+    dmGameObjectDDF::Disable disable;
+    ASSERT_TRUE(PostSpriteMessage(m_Collection, go1, dmGameObjectDDF::Disable::m_DDFDescriptor, &disable, sizeof(disable)));
+    ASSERT_EQ(2 * SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    dmGameObjectDDF::Enable enable;
+    ASSERT_TRUE(PostSpriteMessage(m_Collection, go1, dmGameObjectDDF::Enable::m_DDFDescriptor, &enable, sizeof(enable)));
+    ASSERT_EQ(3 * SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+TEST_F(SpriteVertexTest, Reload)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go1"));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/go2"));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::ReloadResource(m_Factory, "/sprite/valid.spritec", 0));
+    ASSERT_EQ(2 * SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// The draw calls of a frame write after each other, so the sprites of both can be reused
+TEST_F(SpriteVertexTest, DrawTwice)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::HInstance background = Spawn(m_Factory, m_Collection, "/sprite/background_sprite.goc", dmHashString64("/background"));
+    dmGameObject::HInstance foreground1 = Spawn(m_Factory, m_Collection, "/sprite/foreground_sprite.goc", dmHashString64("/foreground1"));
+    dmGameObject::HInstance foreground2 = Spawn(m_Factory, m_Collection, "/sprite/foreground_sprite.goc", dmHashString64("/foreground2"));
+    ASSERT_NE((void*)0, background);
+    ASSERT_NE((void*)0, foreground1);
+    ASSERT_NE((void*)0, foreground2);
+
+    dmRender::Predicate predicates[2];
+    predicates[0].m_Tags[0] = dmHashString64("background");
+    predicates[0].m_TagCount = 1;
+    predicates[1].m_Tags[0] = dmHashString64("foreground");
+    predicates[1].m_TagCount = 1;
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, predicates, 2));
+
+    dmGameObject::SetPosition(foreground2, Point3(0.5f, 0, 0));
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, predicates, 2));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, predicates, 2));
+
+    dmGameObject::SetPosition(background, Point3(0.5f, 0, 0));
+    ASSERT_EQ(SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, predicates, 2));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, predicates, 2));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+// A render script might draw the same sprites more than once in a frame, e.g. to a render target and then to the screen
+TEST_F(SpriteVertexTest, DrawSameTwice)
+{
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, m_Collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // 20 sprites, drawn twice is more than the 32 sprites the buffers first have room for
+    dmGameObject::HInstance go1 = Spawn(m_Factory, m_Collection, "/sprite/bench_sprites.goc", dmHashString64("/go1"));
+    dmGameObject::HInstance go2 = Spawn(m_Factory, m_Collection, "/sprite/bench_sprites.goc", dmHashString64("/go2"));
+    ASSERT_NE((void*)0, go1);
+    ASSERT_NE((void*)0, go2);
+
+    // The second draw starts over in a whole new buffer, and the buffers are reallocated to make room for it
+    const uint32_t buffer_size = m_SpriteContext.m_MaxSpriteCount * SPRITE_QUAD_SIZE;
+    ASSERT_EQ(2 * buffer_size, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 2));
+    // The first draw uploads the whole reallocated buffer, and the second draw writes after it
+    ASSERT_EQ(2 * buffer_size + 20 * SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, m_Collection, &m_UpdateContext, sprite_world, 0x0, 2));
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+TEST_F(SpriteVertexTest, MergeDirtyRanges)
+{
+    // Every other sprite is moved, which is more separate ranges than are uploaded one by one
+    const uint32_t go_count = 33;
+
+    uint32_t max_sprite_count = m_SpriteContext.m_MaxSpriteCount;
+    m_SpriteContext.m_MaxSpriteCount = go_count;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("sprite_collection", m_Factory, m_Register, go_count);
+    m_SpriteContext.m_MaxSpriteCount = max_sprite_count;
+
+    void* sprite_world = GetSpriteWorld(m_Factory, m_Register, collection);
+    ASSERT_NE((void*)0, sprite_world);
+    ASSERT_TRUE(dmGameObject::Init(collection));
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(go_count);
+    for (uint32_t i = 0; i < go_count; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::New(collection, "/sprite/valid_sprite.goc");
+        ASSERT_NE((void*)0, go);
+        instances.Push(go);
+    }
+
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    for (uint32_t i = 0; i < go_count; i += 2)
+    {
+        dmGameObject::SetPosition(instances[i], Point3(0.5f, 0, 0));
+    }
+    // Uploaded as a single range, from the first to the last moved sprite
+    ASSERT_EQ(go_count * SPRITE_QUAD_SIZE, DrawSpriteFrame(m_RenderContext, collection, &m_UpdateContext, sprite_world, 0x0, 1));
+    ASSERT_TRUE(SettleSpriteVertices(m_RenderContext, collection, &m_UpdateContext, sprite_world, 0x0, 1));
+
+    ASSERT_TRUE(dmGameObject::Final(collection));
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
 /* GUI Box Render */
 
 void AssertVertexEqual(const dmGameSystem::BoxVertex& lhs, const dmGameSystem::BoxVertex& rhs)
@@ -1169,6 +1598,26 @@ TEST_P(BoxRenderTest, BoxRender)
         AssertVertexEqual(world->m_ClientVertexBuffer[i], p.m_ExpectedVertices[p.m_ExpectedIndices[i]]);
     }
 
+    uint32_t rebuilt_node_count = world->m_RebuiltNodeCount;
+    ASSERT_LT(0U, rebuilt_node_count);
+    ASSERT_EQ(0U, world->m_ReusedNodeCount);
+
+    // Nothing has changed, so the vertices of the previous frame are reused
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    dmRender::RenderListBegin(m_RenderContext);
+    dmGameObject::Render(m_Collection);
+    dmRender::RenderListEnd(m_RenderContext);
+    dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+
+    ASSERT_EQ(0U, world->m_RebuiltNodeCount);
+    ASSERT_EQ(rebuilt_node_count, world->m_ReusedNodeCount);
+    ASSERT_EQ(world->m_ClientVertexBuffer.Size(), (uint32_t)p.m_ExpectedVerticesCount);
+
+    for (int i = 0; i < p.m_ExpectedVerticesCount; i++)
+    {
+        AssertVertexEqual(world->m_ClientVertexBuffer[i], p.m_ExpectedVertices[p.m_ExpectedIndices[i]]);
+    }
+
     ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
 
     dmGraphics::Flip(m_GraphicsContext);
@@ -1176,6 +1625,43 @@ TEST_P(BoxRenderTest, BoxRender)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+/* Batched game object functions */
+
+TEST_F(ScriptGameObjectTest, BatchPositions)
+{
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = dmScript::GetLuaState(m_ScriptContext);
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    // The script compares the batched functions with the per instance ones, on these instances
+    const uint32_t count = 10000;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("batch_collection", m_Factory, m_Register, count + 1);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmGameObject::HInstance instance = dmGameObject::New(collection, 0x0);
+        ASSERT_NE((void*)0, instance);
+        char id[32];
+        dmSnPrintf(id, sizeof(id), "/batch%u", i);
+        ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(collection, instance, dmHashString64(id)));
+    }
+    dmGameObject::HInstance go = dmGameObject::New(collection, "/script/batch_positions.goc");
+    ASSERT_NE((void*)0, go);
+
+    ASSERT_TRUE(dmGameObject::Init(collection));
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    }
+    ASSERT_TRUE(dmGameObject::Final(collection));
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+    dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
+}
+
 /* Gamepad connected */
 
 TEST_F(GamepadConnectedTest, TestGamepadConnectedInputEvent)
@@ -1656,6 +2142,9 @@ INSTANTIATE_TEST_CASE_P(Sprite, ComponentTest, jc_test_values_in(valid_sprite_go
 const char* invalid_sprite_gos[] = {"/sprite/invalid_sprite.goc"};
 INSTANTIATE_TEST_CASE_P(Sprite, ComponentFailTest, jc_test_values_in(invalid_sprite_gos));
 
+const uint32_t sprite_benchmark_counts[] = {10000, 50000};
+INSTANTIATE_TEST_CASE_P(Sprite, SpriteBenchmarkTest, jc_test_values_in(sprite_benchmark_counts));
+
 /* TileSet */
 const char* valid_tileset_resources[] = {"/tile/valid.texturesetc"};
 INSTANTIATE_TEST_CASE_P(TileSet, ResourceTest, jc_test_values_in(valid_tileset_resources));
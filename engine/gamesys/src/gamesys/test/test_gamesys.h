@@ -37,6 +37,8 @@ template<typename T>
 class GamesysTest : public jc_test_params_class<T>
 {
 protected:
+    GamesysTest() : m_FrustumCulling(false) {}
+
     virtual void SetUp();
     virtual void TearDown();
 
@@ -66,6 +68,8 @@ protected:
     dmGameSystem::SoundContext m_SoundContext;
     dmRig::HRigContext m_RigContext;
     dmGameObject::ModuleContext m_ModuleContext;
+    // Set by the fixture constructor to create the render context with frustum culling
+    bool m_FrustumCulling;
 };
 
 class ResourceTest : public GamesysTest<const char*>
@@ -149,6 +153,12 @@ public:
     virtual ~SpriteAnimTest() {}
 };
 
+class SpriteBenchmarkTest : public GamesysTest<uint32_t>
+{
+public:
+    virtual ~SpriteBenchmarkTest() {}
+};
+
 class WindowEventTest : public GamesysTest<const char*>
 {
 public:
@@ -167,6 +177,22 @@ public:
     virtual ~DrawCountTest() {}
 };
 
+class FrustumCullingTest : public GamesysTest<const char*>
+{
+public:
+    FrustumCullingTest()
+    {
+        m_FrustumCulling = true;
+    }
+    virtual ~FrustumCullingTest() {}
+};
+
+class SpriteVertexTest : public GamesysTest<const char*>
+{
+public:
+    virtual ~SpriteVertexTest() {}
+};
+
 struct BoxRenderParams
 {
     const static uint8_t MAX_VERTICES_IN_9_SLICED_QUAD = 16;
@@ -190,6 +216,12 @@ public:
     virtual ~GamepadConnectedTest() {}
 };
 
+class ScriptGameObjectTest : public GamesysTest<const char*>
+{
+public:
+    virtual ~ScriptGameObjectTest() {}
+};
+
 struct ResourcePropParams {
     const char* m_PropertyName;
     const char* m_ResourcePath;
@@ -264,6 +296,7 @@ void GamesysTest<T>::SetUp()
     render_params.m_MaxRenderTargets = 10;
     render_params.m_ScriptContext = m_ScriptContext;
     render_params.m_MaxCharacters = 256;
+    render_params.m_FrustumCulling = m_FrustumCulling;
     m_RenderContext = dmRender::NewRenderContext(m_GraphicsContext, render_params);
     m_GuiContext.m_RenderContext = m_RenderContext;
     m_GuiContext.m_ScriptContext = m_ScriptContext;
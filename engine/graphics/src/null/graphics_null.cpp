@@ -609,9 +609,11 @@ namespace dmGraphics
                 vs.m_Buffer = new char[vs.m_Size * count];
             }
         }
+        // The 'first' value is a byte offset into the index buffer
+        uint32_t index_offset = first / TYPE_SIZE[type - dmGraphics::TYPE_BYTE];
         for (uint32_t i = 0; i < count; ++i)
         {
-            uint32_t index = GetIndex(type, index_buffer, i + first);
+            uint32_t index = GetIndex(type, index_buffer, i + index_offset);
             for (uint32_t j = 0; j < MAX_VERTEX_STREAM_COUNT; ++j)
             {
                 VertexStream& vs = context->m_VertexStreams[j];
@@ -1470,7 +1470,7 @@ bail:
         return 0;
     }
 
-    static inline VkFormat GetVulkanFormatFromTypeAndSize(Type type, uint16_t size)
+    static inline VkFormat GetVulkanFormatFromTypeAndSize(Type type, uint16_t size, bool normalize)
     {
         if (type == TYPE_FLOAT)
         {
@@ -1479,6 +1479,20 @@ bail:
             else if(size == 3) return VK_FORMAT_R32G32B32_SFLOAT;
             else if(size == 4) return VK_FORMAT_R32G32B32A32_SFLOAT;
         }
+        else if (type == TYPE_UNSIGNED_BYTE && normalize)
+        {
+            if (size == 1)     return VK_FORMAT_R8_UNORM;
+            else if(size == 2) return VK_FORMAT_R8G8_UNORM;
+            else if(size == 3) return VK_FORMAT_R8G8B8_UNORM;
+            else if(size == 4) return VK_FORMAT_R8G8B8A8_UNORM;
+        }
+        else if (type == TYPE_UNSIGNED_SHORT && normalize)
+        {
+            if (size == 1)     return VK_FORMAT_R16_UNORM;
+            else if(size == 2) return VK_FORMAT_R16G16_UNORM;
+            else if(size == 3) return VK_FORMAT_R16G16B16_UNORM;
+            else if(size == 4) return VK_FORMAT_R16G16B16A16_UNORM;
+        }
         else if (type == TYPE_UNSIGNED_BYTE)
         {
             if (size == 1)     return VK_FORMAT_R8_UINT;
@@ -1520,7 +1534,7 @@ bail:
         {
             VertexElement& el           = element[i];
             vd->m_Streams[i].m_NameHash = dmHashString64(el.m_Name);
-            vd->m_Streams[i].m_Format   = GetVulkanFormatFromTypeAndSize(el.m_Type, el.m_Size);
+            vd->m_Streams[i].m_Format   = GetVulkanFormatFromTypeAndSize(el.m_Type, el.m_Size, el.m_Normalize);
             vd->m_Streams[i].m_Offset   = vd->m_Stride;
             vd->m_Streams[i].m_Location = 0;
             vd->m_Stride               += el.m_Size * GetGraphicsTypeSize(el.m_Type);
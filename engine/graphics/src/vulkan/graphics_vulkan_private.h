@@ -131,11 +131,7 @@ namespace dmGraphics
             uint64_t m_NameHash;
             uint16_t m_Location;
             uint16_t m_Offset;
-            VkFormat m_Format;
-
-            // TODO: Not sure how to deal with normalizing
-            //       a vertex stream in VK.
-            // bool        m_Normalize;
+            VkFormat m_Format; // Normalized streams use the UNORM formats
         };
 
         uint64_t    m_Hash;
@@ -399,6 +399,7 @@ namespace dmGui
         scene->m_RenderHead = INVALID_INDEX;
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NextVersionNumber = 0;
+        scene->m_EnabledVersion = 1;
         scene->m_RenderOrder = 0;
         scene->m_Width = context->m_DefaultProjectWidth;
         scene->m_Height = context->m_DefaultProjectHeight;
@@ -1281,7 +1282,33 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         }
     }
 
-    static uint16_t CollectRenderEntries(HScene scene, uint16_t start_index, uint16_t order, Scope* scope, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries) {
+    // A (non inverted) stencil clipper without any area on the screen hides its whole subtree.
+    // The screen is the physical resolution, which is what the gui is rendered to with the default projection.
+    static bool IsClipperCulled(HScene scene, InternalNode* n) {
+        const Node& node = n->m_Node;
+        if (node.m_ClippingInverted || (node.m_NodeType != NODE_TYPE_BOX && node.m_NodeType != NODE_TYPE_PIE)) {
+            return false;
+        }
+        CalculateNodeSize(n);
+        Matrix4 transform;
+        float opacity;
+        CalculateNodeTransformAndAlphaCached(scene, n, CalculateNodeTransformFlags(CALCULATE_NODE_INCLUDE_SIZE | CALCULATE_NODE_RESET_PIVOT), transform, opacity);
+        // Screen bounds of the quad (0,1),(0,1) which the clipper is rendered as
+        Vector4 origin = transform.getCol3();
+        Vector4 x_axis = transform.getCol0();
+        Vector4 y_axis = transform.getCol1();
+        float min_x = origin.getX() + dmMath::Min(0.0f, x_axis.getX()) + dmMath::Min(0.0f, y_axis.getX());
+        float max_x = origin.getX() + dmMath::Max(0.0f, x_axis.getX()) + dmMath::Max(0.0f, y_axis.getX());
+        float min_y = origin.getY() + dmMath::Min(0.0f, x_axis.getY()) + dmMath::Min(0.0f, y_axis.getY());
+        float max_y = origin.getY() + dmMath::Max(0.0f, x_axis.getY()) + dmMath::Max(0.0f, y_axis.getY());
+        float width = (float) scene->m_Context->m_PhysicalWidth;
+        float height = (float) scene->m_Context->m_PhysicalHeight;
+        return max_x <= min_x || max_y <= min_y
+            || max_x <= 0.0f || min_x >= width
+            || max_y <= 0.0f || min_y >= height;
+    }
+
+    static uint16_t CollectRenderEntries(HScene scene, uint16_t start_index, uint16_t order, Scope* scope, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries, bool cull_clippers) {
         uint16_t index = start_index;
         while (index != INVALID_INDEX) {
             InternalNode* n = &scene->m_Nodes[index];
@@ -1291,6 +1318,10 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                 if (n->m_ClipperIndex != INVALID_INDEX) {
                     InternalClippingNode& clipper = clippers[n->m_ClipperIndex];
                     if (clipper.m_NodeIndex == index) {
+                        if (cull_clippers && IsClipperCulled(scene, n)) {
+                            index = n->m_NextIndex;
+                            continue;
+                        }
                         bool root_clipper = scope == 0x0;
                         Scope tmp_scope(0, order);
                         Scope* current_scope = scope;
@@ -1302,7 +1333,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                         }
                         uint64_t clipping_key = CalcRenderKey(current_scope, 0, 0);
                         uint64_t render_key = CalcRenderKey(current_scope, layer, 1);
-                        CollectRenderEntries(scene, n->m_ChildHead, 2, current_scope, clippers, render_entries);
+                        CollectRenderEntries(scene, n->m_ChildHead, 2, current_scope, clippers, render_entries, cull_clippers);
                         if (layer > 0) {
                             render_key = CalcRenderKey(current_scope, layer, 1);
                         }
@@ -1377,17 +1408,17 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                     render_entries.Push(entry);
                 }
 
-                order = CollectRenderEntries(scene, n->m_ChildHead, order, scope, clippers, render_entries);
+                order = CollectRenderEntries(scene, n->m_ChildHead, order, scope, clippers, render_entries, cull_clippers);
             }
             index = n->m_NextIndex;
         }
         return order;
     }
 
-    static void CollectNodes(HScene scene, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries)
+    static void CollectNodes(HScene scene, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries, bool cull_clippers)
     {
         CollectClippers(scene, scene->m_RenderHead, 0, 0, clippers, INVALID_INDEX);
-        CollectRenderEntries(scene, scene->m_RenderHead, 0, 0x0, clippers, render_entries);
+        CollectRenderEntries(scene, scene->m_RenderHead, 0, 0x0, clippers, render_entries, cull_clippers);
     }
 
     void RenderScene(HScene scene, const RenderSceneParams& params, void* context)
@@ -1423,7 +1454,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         }
 
         Matrix4 node_transform;
-        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes);
+        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes, params.m_CullClippers);
         uint32_t node_count = c->m_RenderNodes.Size();
         std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortPred(scene));
         Matrix4 transform;
@@ -1481,17 +1512,21 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         RenderScene(scene, p, context);
     }
 
+    // The result is cached in the node until the enabled state or parent of any node in the scene changes
     static bool IsNodeEnabledRecursive(HScene scene, uint16_t node_index)
     {
         InternalNode* node = &scene->m_Nodes[node_index];
-        if (node->m_Node.m_Enabled && node->m_ParentIndex != INVALID_INDEX)
-        {
-            return IsNodeEnabledRecursive(scene, node->m_ParentIndex);
-        }
-        else
+        if (node->m_EnabledVersion != scene->m_EnabledVersion)
         {
-            return node->m_Node.m_Enabled;
+            bool enabled = node->m_Node.m_Enabled;
+            if (enabled && node->m_ParentIndex != INVALID_INDEX)
+            {
+                enabled = IsNodeEnabledRecursive(scene, node->m_ParentIndex);
+            }
+            node->m_EnabledRecursive = enabled;
+            node->m_EnabledVersion = scene->m_EnabledVersion;
         }
+        return node->m_EnabledRecursive;
     }
 
     #define OLD_VERSION false
@@ -1743,7 +1778,15 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                     dmMessage::Message* message = (dmMessage::Message*)args;
                     dmScript::PushHash(L, message->m_Id);
 
-                    if (message->m_Descriptor)
+                    if (dmScript::IsSharedPayloadMessage(message->m_Descriptor))
+                    {
+                        if (dmProfile::g_IsInitialized)
+                        {
+                            message_name = (const char*)dmHashReverse64(message->m_Id, 0);
+                        }
+                        dmScript::PushSharedPayload(L, (const char*) message->m_Data, message->m_DataSize);
+                    }
+                    else if (message->m_Descriptor)
                     {
                         message_name = ((const dmDDF::Descriptor*)message->m_Descriptor)->m_Name;
                         dmScript::PushDDF(L, (dmDDF::Descriptor*)message->m_Descriptor, (const char*) message->m_Data, true);
@@ -2326,6 +2369,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         node->m_ChildTail = INVALID_INDEX;
         node->m_SceneTraversalCacheVersion = INVALID_INDEX;
         node->m_ClipperIndex = INVALID_INDEX;
+        node->m_EnabledVersion = 0;
         scene->m_NextVersionNumber = (version + 1) % ((1 << 16) - 1);
 
         HNode hnode = GetNodeHandle(node);
@@ -2376,6 +2420,11 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         return scene->m_NodePool.Size();
     }
 
+    uint16_t GetNodeIndex(HScene scene, HNode node)
+    {
+        return GetNode(scene, node)->m_Index;
+    }
+
     uint32_t GetParticlefxCount(HScene scene)
     {
         return scene->m_AliveParticlefxs.Size();
@@ -2396,8 +2445,18 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         }
     }
 
+    static inline void InvalidateEnabledRecursive(HScene scene)
+    {
+        // Version 0 is never valid, since it's the version of newly created nodes
+        if (++scene->m_EnabledVersion == 0)
+        {
+            scene->m_EnabledVersion = 1;
+        }
+    }
+
     static void AddToNodeList(HScene scene, InternalNode* n, InternalNode* parent_n, InternalNode* prev_n)
     {
+        InvalidateEnabledRecursive(scene);
         uint16_t* head = &scene->m_RenderHead, * tail = &scene->m_RenderTail;
         uint16_t parent_index = INVALID_INDEX;
         if (parent_n != 0x0)
@@ -2676,6 +2735,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
                 n->m_State = n->m_ResetPointState;
             }
         }
+        InvalidateEnabledRecursive(scene);
         scene->m_Animations.SetSize(0);
     }
 
@@ -4147,6 +4207,10 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     void SetNodeEnabled(HScene scene, HNode node, bool enabled)
     {
         InternalNode* n = GetNode(scene, node);
+        if (n->m_Node.m_Enabled != enabled)
+        {
+            InvalidateEnabledRecursive(scene);
+        }
         n->m_Node.m_Enabled = enabled;
         if(enabled)
         {
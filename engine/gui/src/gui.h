@@ -812,6 +812,8 @@ namespace dmGui
         NewTexture                  m_NewTexture;
         DeleteTexture               m_DeleteTexture;
         SetTextureData              m_SetTextureData;
+        /// Skip the subtrees of stencil clippers that have no area within the physical screen
+        bool                        m_CullClippers;
     };
 
     void RenderScene(HScene scene, const RenderSceneParams& params, void* context);
@@ -895,6 +897,16 @@ namespace dmGui
     uint32_t GetNodeCount(HScene scene);
     uint32_t GetParticlefxCount(HScene scene);
 
+    /**
+     * Gets the index of a node within its scene.
+     * The index is stable during the lifetime of the node and less than the max node count of the scene.
+     * Indices of deleted nodes are reused by new nodes.
+     * @param scene scene
+     * @param node node
+     * @return index of the node
+     */
+    uint16_t GetNodeIndex(HScene scene, HNode node);
+
     void DeleteNode(HScene scene, HNode node, bool delete_headless_pfx);
 
     void ClearNodes(HScene scene);
@@ -180,7 +180,9 @@ namespace dmGui
         uint16_t        m_SceneTraversalCacheVersion;
         uint16_t        m_ClipperIndex;
         uint16_t        m_Deleted : 1; // Set to true for deferred deletion
-        uint16_t        m_Padding : 15;
+        uint16_t        m_EnabledRecursive : 1; // Cached result of IsNodeEnabledRecursive, valid when m_EnabledVersion matches the scene
+        uint16_t        m_Padding : 14;
+        uint32_t        m_EnabledVersion;
     };
 
     struct NodeProxy
@@ -302,6 +304,7 @@ namespace dmGui
         uint16_t                m_RenderOrder; // For the render-key
         uint16_t                m_NextLayerIndex;
         uint16_t                m_ResChanged : 1;
+        uint32_t                m_EnabledVersion; // Incremented when the enabled state or parent of any node changes
         uint32_t                m_Width;
         uint32_t                m_Height;
         dmScript::ScriptWorld*  m_ScriptWorld;
@@ -1743,6 +1743,50 @@ TEST_F(dmGuiTest, AnimateNodeOfDisabledParent)
     dmGui::DeleteNode(m_Scene, parent, true);
 }
 
+TEST_F(dmGuiTest, AnimateNodeEnabledChanges)
+{
+    const float EPSILON = 0.0001f;
+    dmGui::HNode parent = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX);
+    dmGui::HNode other_parent = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX);
+    dmGui::HNode child = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX);
+    dmGui::SetNodeParent(m_Scene, child, parent, false);
+    dmGui::SetNodeEnabled(m_Scene, other_parent, false);
+    dmhash_t property = dmGui::GetPropertyHash(dmGui::PROPERTY_POSITION);
+    dmGui::AnimateNodeHash(m_Scene, child, property, Vector4(1,0,0,0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0.0f, 0, 0, 0);
+
+    for (int i = 0; i < 10; ++i)
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    float x = dmGui::GetNodePosition(m_Scene, child).getX();
+    ASSERT_NEAR(x, 10.0f / 60.0f, EPSILON);
+
+    // The enabled state of the parents must be re-evaluated when it changes
+    dmGui::SetNodeEnabled(m_Scene, parent, false);
+    for (int i = 0; i < 10; ++i)
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    ASSERT_NEAR(dmGui::GetNodePosition(m_Scene, child).getX(), x, EPSILON);
+
+    dmGui::SetNodeEnabled(m_Scene, parent, true);
+    for (int i = 0; i < 10; ++i)
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    x = dmGui::GetNodePosition(m_Scene, child).getX();
+    ASSERT_NEAR(x, 20.0f / 60.0f, EPSILON);
+
+    // ...and when the parent changes
+    dmGui::SetNodeParent(m_Scene, child, other_parent, false);
+    for (int i = 0; i < 10; ++i)
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    ASSERT_NEAR(dmGui::GetNodePosition(m_Scene, child).getX(), x, EPSILON);
+
+    dmGui::SetNodeParent(m_Scene, child, dmGui::INVALID_HANDLE, false);
+    for (int i = 0; i < 10; ++i)
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+    ASSERT_NEAR(dmGui::GetNodePosition(m_Scene, child).getX(), 30.0f / 60.0f, EPSILON);
+
+    dmGui::DeleteNode(m_Scene, child, true);
+    dmGui::DeleteNode(m_Scene, other_parent, true);
+    dmGui::DeleteNode(m_Scene, parent, true);
+}
+
 TEST_F(dmGuiTest, Reset)
 {
     dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(10, 20, 30), Vector3(10,10,0), dmGui::NODE_TYPE_BOX);
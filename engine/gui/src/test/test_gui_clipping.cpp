@@ -215,15 +215,20 @@ public:
         return node;
     }
 
-    void Render() {
+    void Render(bool cull_clippers = false) {
         m_NodeToClipping.clear();
         m_NodeToRenderOrder.clear();
         m_Renderer.ClearBuffer();
         dmGui::RenderSceneParams params;
         params.m_RenderNodes = RenderNodes;
+        params.m_CullClippers = cull_clippers;
         dmGui::RenderScene(m_Scene, params, this);
     }
 
+    bool IsRendered(dmGui::HNode node) {
+        return m_NodeToRenderOrder.find(node) != m_NodeToRenderOrder.end() || m_NodeToClipping.find(node) != m_NodeToClipping.end();
+    }
+
     void SetLayers(const char* layer0) {
         dmGui::AddLayer(m_Scene, layer0);
     }
@@ -1146,6 +1151,65 @@ TEST_F(dmGuiClippingTest, TestOverflowClearEnd) {
     Render();
 }
 
+/**
+ * Verify that the subtrees of clippers without any area on the screen are culled
+ *
+ * - a (on screen)
+ *   - b
+ * - c (inverted, off screen)
+ *   - d
+ */
+TEST_F(dmGuiClippingTest, TestCullClippers) {
+    dmGui::SetPhysicalResolution(m_Context, 100, 100);
+    dmGui::SetSceneResolution(m_Scene, 100, 100);
+
+    dmGui::HNode a = AddClipperBox("a");
+    dmGui::HNode b = AddBox("b", a);
+    dmGui::SetNodePosition(m_Scene, a, Point3(50.0f, 50.0f, 0.0f));
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SIZE, Vector4(10.0f, 10.0f, 0.0f, 0.0f));
+    dmGui::SetNodeProperty(m_Scene, b, dmGui::PROPERTY_SIZE, Vector4(10.0f, 10.0f, 0.0f, 0.0f));
+    dmGui::HNode c = AddInvClipperBox("c");
+    dmGui::HNode d = AddBox("d", c);
+    dmGui::SetNodePosition(m_Scene, c, Point3(-50.0f, 50.0f, 0.0f));
+    dmGui::SetNodeProperty(m_Scene, c, dmGui::PROPERTY_SIZE, Vector4(10.0f, 10.0f, 0.0f, 0.0f));
+
+    Render(true);
+    ASSERT_TRUE(IsRendered(a));
+    ASSERT_TRUE(IsRendered(b));
+    // Inverted clippers only clip what's inside them
+    ASSERT_TRUE(IsRendered(c));
+    ASSERT_TRUE(IsRendered(d));
+
+    // Partly on screen
+    dmGui::SetNodePosition(m_Scene, a, Point3(-4.0f, 50.0f, 0.0f));
+    Render(true);
+    ASSERT_TRUE(IsRendered(a));
+    ASSERT_TRUE(IsRendered(b));
+
+    // Off screen
+    dmGui::SetNodePosition(m_Scene, a, Point3(-6.0f, 50.0f, 0.0f));
+    Render(true);
+    ASSERT_FALSE(IsRendered(a));
+    ASSERT_FALSE(IsRendered(b));
+    Render(false);
+    ASSERT_TRUE(IsRendered(a));
+    ASSERT_TRUE(IsRendered(b));
+
+    // Zero size
+    dmGui::SetNodePosition(m_Scene, a, Point3(50.0f, 50.0f, 0.0f));
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SIZE, Vector4(10.0f, 0.0f, 0.0f, 0.0f));
+    Render(true);
+    ASSERT_FALSE(IsRendered(a));
+    ASSERT_FALSE(IsRendered(b));
+
+    // Zero scale
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SIZE, Vector4(10.0f, 10.0f, 0.0f, 0.0f));
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SCALE, Vector4(0.0f, 1.0f, 1.0f, 0.0f));
+    Render(true);
+    ASSERT_FALSE(IsRendered(a));
+    ASSERT_FALSE(IsRendered(b));
+}
+
 #undef BITS
 
 int main(int argc, char **argv)
@@ -10,13 +10,14 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <math.h>
 #include <string.h>
 #include <stdint.h>
 #include <float.h>
-#include <algorithm>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/vmath.h>
 #include <dlib/profile.h>
 #include <dlib/time.h>
@@ -24,6 +25,14 @@
 #include "particle.h"
 #include "particle_private.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define DM_PARTICLE_SSE
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define DM_PARTICLE_NEON
+    #include <arm_neon.h>
+#endif
+
 namespace dmParticle
 {
     using namespace dmParticleDDF;
@@ -48,6 +57,332 @@ namespace dmParticle
     /// Simulate motion blur at 60 fps with a 180 deg shutter
     const static float STRETCH_SCALING = (1.0f/60.0f) * 0.5f;
 
+    /// Min number of particles in a context for the emitters to be updated on the job pool
+    const static uint32_t PARALLEL_MIN_PARTICLE_COUNT = 2048;
+    /// Number of particles per job when generating vertex data, must be a multiple of the lane count
+    const static uint32_t PARALLEL_VERTEX_CHUNK_SIZE = 1024;
+
+    // Four lanes of floats, one lane per particle
+#if defined(DM_PARTICLE_SSE)
+    typedef __m128 Vec4f;
+    static inline Vec4f Load(const float* p)                { return _mm_load_ps(p); }
+    static inline void  Store(float* p, Vec4f v)            { _mm_store_ps(p, v); }
+    static inline Vec4f Splat(float v)                      { return _mm_set1_ps(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return _mm_add_ps(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return _mm_sub_ps(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return _mm_mul_ps(a, b); }
+    static inline Vec4f Div(Vec4f a, Vec4f b)               { return _mm_div_ps(a, b); }
+    static inline Vec4f Sqrt(Vec4f a)                       { return _mm_sqrt_ps(a); }
+    static inline Vec4f Min(Vec4f a, Vec4f b)               { return _mm_min_ps(a, b); }
+    static inline Vec4f Max(Vec4f a, Vec4f b)               { return _mm_max_ps(a, b); }
+    // Same as dmMath::Select, a where x >= 0, b otherwise
+    static inline Vec4f Select(Vec4f x, Vec4f a, Vec4f b)
+    {
+        Vec4f mask = _mm_cmpge_ps(x, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+#elif defined(DM_PARTICLE_NEON)
+    typedef float32x4_t Vec4f;
+    static inline Vec4f Load(const float* p)                { return vld1q_f32(p); }
+    static inline void  Store(float* p, Vec4f v)            { vst1q_f32(p, v); }
+    static inline Vec4f Splat(float v)                      { return vdupq_n_f32(v); }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { return vaddq_f32(a, b); }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { return vsubq_f32(a, b); }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+    static inline Vec4f Div(Vec4f a, Vec4f b)               { return vdivq_f32(a, b); }
+    static inline Vec4f Sqrt(Vec4f a)                       { return vsqrtq_f32(a); }
+#else
+    // No vector division or square root on ARMv7, both need to be exact to match the scalar math
+    static inline Vec4f Div(Vec4f a, Vec4f b)
+    {
+        float r[4], d[4];
+        vst1q_f32(r, a);
+        vst1q_f32(d, b);
+        for (int i = 0; i < 4; ++i) r[i] /= d[i];
+        return vld1q_f32(r);
+    }
+    static inline Vec4f Sqrt(Vec4f a)
+    {
+        float r[4];
+        vst1q_f32(r, a);
+        for (int i = 0; i < 4; ++i) r[i] = sqrtf(r[i]);
+        return vld1q_f32(r);
+    }
+#endif
+    static inline Vec4f Min(Vec4f a, Vec4f b)               { return vminq_f32(a, b); }
+    static inline Vec4f Max(Vec4f a, Vec4f b)               { return vmaxq_f32(a, b); }
+    // Same as dmMath::Select, a where x >= 0, b otherwise
+    static inline Vec4f Select(Vec4f x, Vec4f a, Vec4f b)   { return vbslq_f32(vcgeq_f32(x, vdupq_n_f32(0.0f)), a, b); }
+#else
+    struct Vec4f
+    {
+        float v[4];
+    };
+    static inline Vec4f Load(const float* p)                { Vec4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    static inline void  Store(float* p, Vec4f v)            { memcpy(p, v.v, sizeof(v.v)); }
+    static inline Vec4f Splat(float v)                      { Vec4f r = {{v, v, v, v}}; return r; }
+    static inline Vec4f Add(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+    static inline Vec4f Sub(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+    static inline Vec4f Mul(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+    static inline Vec4f Div(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] / b.v[i]; return r; }
+    static inline Vec4f Sqrt(Vec4f a)                       { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = sqrtf(a.v[i]); return r; }
+    static inline Vec4f Min(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = dmMath::Min(a.v[i], b.v[i]); return r; }
+    static inline Vec4f Max(Vec4f a, Vec4f b)               { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = dmMath::Max(a.v[i], b.v[i]); return r; }
+    static inline Vec4f Select(Vec4f x, Vec4f a, Vec4f b)   { Vec4f r; for (int i = 0; i < 4; ++i) r.v[i] = dmMath::Select(x.v[i], a.v[i], b.v[i]); return r; }
+#endif
+
+    // The vector helpers below evaluate in the same order as the Vectormath functions they mirror,
+    // so that the lanes match the results of the scalar code exactly.
+    struct Vec3Lanes
+    {
+        Vec4f x, y, z;
+    };
+
+    struct QuatLanes
+    {
+        Vec4f x, y, z, w;
+    };
+
+    static inline Vec3Lanes LoadVec3(float* const* streams, uint32_t first_stream, uint32_t i)
+    {
+        Vec3Lanes r = { Load(streams[first_stream] + i), Load(streams[first_stream + 1] + i), Load(streams[first_stream + 2] + i) };
+        return r;
+    }
+
+    static inline void StoreVec3(float* const* streams, uint32_t first_stream, uint32_t i, const Vec3Lanes& v)
+    {
+        Store(streams[first_stream] + i, v.x);
+        Store(streams[first_stream + 1] + i, v.y);
+        Store(streams[first_stream + 2] + i, v.z);
+    }
+
+    static inline void StoreVec3Lanes(float out[3][PARTICLE_LANE_COUNT], const Vec3Lanes& v)
+    {
+        Store(out[0], v.x);
+        Store(out[1], v.y);
+        Store(out[2], v.z);
+    }
+
+    static inline QuatLanes LoadQuat(float* const* streams, uint32_t first_stream, uint32_t i)
+    {
+        QuatLanes r = { Load(streams[first_stream] + i), Load(streams[first_stream + 1] + i), Load(streams[first_stream + 2] + i), Load(streams[first_stream + 3] + i) };
+        return r;
+    }
+
+    static inline Vec3Lanes SplatVec3(const Vector3& v)
+    {
+        Vec3Lanes r = { Splat(v.getX()), Splat(v.getY()), Splat(v.getZ()) };
+        return r;
+    }
+
+    static inline QuatLanes SplatQuat(const Quat& q)
+    {
+        QuatLanes r = { Splat(q.getX()), Splat(q.getY()), Splat(q.getZ()), Splat(q.getW()) };
+        return r;
+    }
+
+    static inline Vec3Lanes Add(const Vec3Lanes& a, const Vec3Lanes& b)
+    {
+        Vec3Lanes r = { Add(a.x, b.x), Add(a.y, b.y), Add(a.z, b.z) };
+        return r;
+    }
+
+    static inline Vec3Lanes Sub(const Vec3Lanes& a, const Vec3Lanes& b)
+    {
+        Vec3Lanes r = { Sub(a.x, b.x), Sub(a.y, b.y), Sub(a.z, b.z) };
+        return r;
+    }
+
+    static inline Vec3Lanes Mul(const Vec3Lanes& a, Vec4f s)
+    {
+        Vec3Lanes r = { Mul(a.x, s), Mul(a.y, s), Mul(a.z, s) };
+        return r;
+    }
+
+    static inline Vec4f LengthSqr(const Vec3Lanes& v)
+    {
+        return Add(Add(Mul(v.x, v.x), Mul(v.y, v.y)), Mul(v.z, v.z));
+    }
+
+    static inline Vec4f Dot(const Vec3Lanes& a, const Vec3Lanes& b)
+    {
+        return Add(Add(Mul(a.x, b.x), Mul(a.y, b.y)), Mul(a.z, b.z));
+    }
+
+    static inline Vec3Lanes Normalize(const Vec3Lanes& v)
+    {
+        return Mul(v, Div(Splat(1.0f), Sqrt(LengthSqr(v))));
+    }
+
+    static inline Vec3Lanes Cross(const Vec3Lanes& a, const Vec3Lanes& b)
+    {
+        Vec3Lanes r = {
+            Sub(Mul(a.y, b.z), Mul(a.z, b.y)),
+            Sub(Mul(a.z, b.x), Mul(a.x, b.z)),
+            Sub(Mul(a.x, b.y), Mul(a.y, b.x))
+        };
+        return r;
+    }
+
+    // Selects the fallback where sq_length <= 0
+    static inline Vec3Lanes NonZero(const Vec3Lanes& v, Vec4f sq_length, const Vec3Lanes& fallback)
+    {
+        Vec4f neg_sq_length = Sub(Splat(0.0f), sq_length);
+        Vec3Lanes r = { Select(neg_sq_length, fallback.x, v.x), Select(neg_sq_length, fallback.y, v.y), Select(neg_sq_length, fallback.z, v.z) };
+        return r;
+    }
+
+    static inline QuatLanes Mul(const QuatLanes& a, const QuatLanes& b)
+    {
+        QuatLanes r = {
+            Sub(Add(Add(Mul(a.w, b.x), Mul(a.x, b.w)), Mul(a.y, b.z)), Mul(a.z, b.y)),
+            Sub(Add(Add(Mul(a.w, b.y), Mul(a.y, b.w)), Mul(a.z, b.x)), Mul(a.x, b.z)),
+            Sub(Add(Add(Mul(a.w, b.z), Mul(a.z, b.w)), Mul(a.x, b.y)), Mul(a.y, b.x)),
+            Sub(Sub(Sub(Mul(a.w, b.w), Mul(a.x, b.x)), Mul(a.y, b.y)), Mul(a.z, b.z))
+        };
+        return r;
+    }
+
+    static inline Vec3Lanes Rotate(const QuatLanes& q, const Vec3Lanes& v)
+    {
+        Vec4f tx = Sub(Add(Mul(q.w, v.x), Mul(q.y, v.z)), Mul(q.z, v.y));
+        Vec4f ty = Sub(Add(Mul(q.w, v.y), Mul(q.z, v.x)), Mul(q.x, v.z));
+        Vec4f tz = Sub(Add(Mul(q.w, v.z), Mul(q.x, v.y)), Mul(q.y, v.x));
+        Vec4f tw = Add(Add(Mul(q.x, v.x), Mul(q.y, v.y)), Mul(q.z, v.z));
+        Vec3Lanes r = {
+            Add(Sub(Add(Mul(tw, q.x), Mul(tx, q.w)), Mul(ty, q.z)), Mul(tz, q.y)),
+            Add(Sub(Add(Mul(tw, q.y), Mul(ty, q.w)), Mul(tz, q.x)), Mul(tx, q.z)),
+            Add(Sub(Add(Mul(tw, q.z), Mul(tz, q.w)), Mul(tx, q.y)), Mul(ty, q.x))
+        };
+        return r;
+    }
+
+    static inline uint32_t GetPaddedParticleCount(uint32_t count)
+    {
+        return (count + PARTICLE_LANE_COUNT - 1) & ~(PARTICLE_LANE_COUNT - 1);
+    }
+
+    void SetParticleCapacity(ParticleBuffer* buffer, uint32_t capacity)
+    {
+        if (capacity == buffer->m_Capacity)
+            return;
+
+        void* memory = 0x0;
+        uint32_t padded_capacity = GetPaddedParticleCount(capacity);
+        if (capacity > 0)
+        {
+            uint32_t memory_size = padded_capacity * ((PARTICLE_STREAM_COUNT + 1) * sizeof(float) + 2 * sizeof(SortKey));
+            dmMemory::AlignedMalloc(&memory, 16, memory_size);
+            // The padding lanes are simulated too, keep them at well defined values
+            memset(memory, 0, memory_size);
+        }
+
+        uint32_t size = dmMath::Min(buffer->m_Size, capacity);
+        float* stream = (float*)memory;
+        for (uint32_t i = 0; i < PARTICLE_STREAM_COUNT; ++i)
+        {
+            if (size > 0)
+                memcpy(stream, buffer->m_Streams[i], size * sizeof(float));
+            buffer->m_Streams[i] = capacity > 0 ? stream : 0x0;
+            stream += padded_capacity;
+        }
+        buffer->m_Scratch = capacity > 0 ? stream : 0x0;
+        buffer->m_SortKeys = capacity > 0 ? (SortKey*)(stream + padded_capacity) : 0x0;
+        buffer->m_SortKeysScratch = capacity > 0 ? buffer->m_SortKeys + padded_capacity : 0x0;
+
+        if (buffer->m_Memory)
+            dmMemory::AlignedFree(buffer->m_Memory);
+        buffer->m_Memory = memory;
+        buffer->m_Size = size;
+        buffer->m_Capacity = capacity;
+    }
+
+    void GetParticle(const ParticleBuffer* buffer, uint32_t index, Particle* particle)
+    {
+        float* const* s = buffer->m_Streams;
+        memset(particle, 0, sizeof(Particle));
+        particle->m_Position = Point3(s[PARTICLE_STREAM_POSITION_X][index], s[PARTICLE_STREAM_POSITION_Y][index], s[PARTICLE_STREAM_POSITION_Z][index]);
+        particle->m_SourceRotation = Quat(s[PARTICLE_STREAM_SOURCE_ROTATION_X][index], s[PARTICLE_STREAM_SOURCE_ROTATION_Y][index], s[PARTICLE_STREAM_SOURCE_ROTATION_Z][index], s[PARTICLE_STREAM_SOURCE_ROTATION_W][index]);
+        particle->m_Rotation = Quat(s[PARTICLE_STREAM_ROTATION_X][index], s[PARTICLE_STREAM_ROTATION_Y][index], s[PARTICLE_STREAM_ROTATION_Z][index], s[PARTICLE_STREAM_ROTATION_W][index]);
+        particle->m_Velocity = Vector3(s[PARTICLE_STREAM_VELOCITY_X][index], s[PARTICLE_STREAM_VELOCITY_Y][index], s[PARTICLE_STREAM_VELOCITY_Z][index]);
+        particle->m_TimeLeft = s[PARTICLE_STREAM_TIME_LEFT][index];
+        particle->m_MaxLifeTime = s[PARTICLE_STREAM_MAX_LIFE_TIME][index];
+        particle->m_ooMaxLifeTime = s[PARTICLE_STREAM_OO_MAX_LIFE_TIME][index];
+        particle->m_SpreadFactor = s[PARTICLE_STREAM_SPREAD_FACTOR][index];
+        particle->m_SourceSize = s[PARTICLE_STREAM_SOURCE_SIZE][index];
+        particle->m_SourceStretchFactorX = s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X][index];
+        particle->m_SourceStretchFactorY = s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y][index];
+        particle->m_SourceColor = Vector4(s[PARTICLE_STREAM_SOURCE_COLOR_R][index], s[PARTICLE_STREAM_SOURCE_COLOR_G][index], s[PARTICLE_STREAM_SOURCE_COLOR_B][index], s[PARTICLE_STREAM_SOURCE_COLOR_A][index]);
+        particle->m_Color = Vector4(s[PARTICLE_STREAM_COLOR_R][index], s[PARTICLE_STREAM_COLOR_G][index], s[PARTICLE_STREAM_COLOR_B][index], s[PARTICLE_STREAM_COLOR_A][index]);
+        particle->m_Scale = Vector3(s[PARTICLE_STREAM_SCALE_X][index], s[PARTICLE_STREAM_SCALE_Y][index], s[PARTICLE_STREAM_SCALE_Z][index]);
+        particle->m_StretchFactorX = s[PARTICLE_STREAM_STRETCH_FACTOR_X][index];
+        particle->m_StretchFactorY = s[PARTICLE_STREAM_STRETCH_FACTOR_Y][index];
+        particle->m_SourceAngularVelocity = s[PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY][index];
+    }
+
+    void SetParticle(ParticleBuffer* buffer, uint32_t index, const Particle* particle)
+    {
+        float* const* s = buffer->m_Streams;
+        s[PARTICLE_STREAM_POSITION_X][index] = particle->m_Position.getX();
+        s[PARTICLE_STREAM_POSITION_Y][index] = particle->m_Position.getY();
+        s[PARTICLE_STREAM_POSITION_Z][index] = particle->m_Position.getZ();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_X][index] = particle->m_SourceRotation.getX();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_Y][index] = particle->m_SourceRotation.getY();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_Z][index] = particle->m_SourceRotation.getZ();
+        s[PARTICLE_STREAM_SOURCE_ROTATION_W][index] = particle->m_SourceRotation.getW();
+        s[PARTICLE_STREAM_ROTATION_X][index] = particle->m_Rotation.getX();
+        s[PARTICLE_STREAM_ROTATION_Y][index] = particle->m_Rotation.getY();
+        s[PARTICLE_STREAM_ROTATION_Z][index] = particle->m_Rotation.getZ();
+        s[PARTICLE_STREAM_ROTATION_W][index] = particle->m_Rotation.getW();
+        s[PARTICLE_STREAM_VELOCITY_X][index] = particle->m_Velocity.getX();
+        s[PARTICLE_STREAM_VELOCITY_Y][index] = particle->m_Velocity.getY();
+        s[PARTICLE_STREAM_VELOCITY_Z][index] = particle->m_Velocity.getZ();
+        s[PARTICLE_STREAM_TIME_LEFT][index] = particle->m_TimeLeft;
+        s[PARTICLE_STREAM_MAX_LIFE_TIME][index] = particle->m_MaxLifeTime;
+        s[PARTICLE_STREAM_OO_MAX_LIFE_TIME][index] = particle->m_ooMaxLifeTime;
+        s[PARTICLE_STREAM_SPREAD_FACTOR][index] = particle->m_SpreadFactor;
+        s[PARTICLE_STREAM_SOURCE_SIZE][index] = particle->m_SourceSize;
+        s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X][index] = particle->m_SourceStretchFactorX;
+        s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y][index] = particle->m_SourceStretchFactorY;
+        s[PARTICLE_STREAM_SOURCE_COLOR_R][index] = particle->m_SourceColor.getX();
+        s[PARTICLE_STREAM_SOURCE_COLOR_G][index] = particle->m_SourceColor.getY();
+        s[PARTICLE_STREAM_SOURCE_COLOR_B][index] = particle->m_SourceColor.getZ();
+        s[PARTICLE_STREAM_SOURCE_COLOR_A][index] = particle->m_SourceColor.getW();
+        s[PARTICLE_STREAM_COLOR_R][index] = particle->m_Color.getX();
+        s[PARTICLE_STREAM_COLOR_G][index] = particle->m_Color.getY();
+        s[PARTICLE_STREAM_COLOR_B][index] = particle->m_Color.getZ();
+        s[PARTICLE_STREAM_COLOR_A][index] = particle->m_Color.getW();
+        s[PARTICLE_STREAM_SCALE_X][index] = particle->m_Scale.getX();
+        s[PARTICLE_STREAM_SCALE_Y][index] = particle->m_Scale.getY();
+        s[PARTICLE_STREAM_SCALE_Z][index] = particle->m_Scale.getZ();
+        s[PARTICLE_STREAM_STRETCH_FACTOR_X][index] = particle->m_StretchFactorX;
+        s[PARTICLE_STREAM_STRETCH_FACTOR_Y][index] = particle->m_StretchFactorY;
+        s[PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY][index] = particle->m_SourceAngularVelocity;
+    }
+
+    // Removes the dead particles from first_dead and onwards, the survivors keep their order so the buffer stays sorted
+    static void EraseDeadParticles(ParticleBuffer* buffer, uint32_t first_dead)
+    {
+        uint32_t size = buffer->m_Size;
+        const float* time_left = buffer->m_Streams[PARTICLE_STREAM_TIME_LEFT];
+        uint32_t new_size = first_dead;
+        for (uint32_t i = 0; i < PARTICLE_STREAM_COUNT; ++i)
+        {
+            // The time left stream decides which particles survive, compact it last
+            float* stream = buffer->m_Streams[(PARTICLE_STREAM_TIME_LEFT + 1 + i) % PARTICLE_STREAM_COUNT];
+            new_size = first_dead;
+            for (uint32_t j = first_dead + 1; j < size; ++j)
+            {
+                if (!(time_left[j] < 0.0f))
+                {
+                    stream[new_size++] = stream[j];
+                }
+            }
+        }
+        buffer->m_Size = new_size;
+    }
+
     AnimationData::AnimationData()
     {
         memset(this, 0, sizeof(*this));
@@ -97,6 +432,11 @@ namespace dmParticle
         context->m_MaxParticleCount = max_particle_count;
     }
 
+    void SetJobPool(HParticleContext context, dmJobPool::HJobPool job_pool)
+    {
+        context->m_JobPool = job_pool;
+    }
+
     static Instance* GetInstance(HParticleContext context, HInstance instance)
     {
         if (instance == INVALID_INSTANCE)
@@ -177,7 +517,7 @@ namespace dmParticle
     {
         emitter->m_Id = dmHashString64(emitter_ddf->m_Id);
         uint32_t particle_count = emitter_ddf->m_MaxParticleCount;
-        emitter->m_Particles.SetCapacity(particle_count);
+        SetParticleCapacity(&emitter->m_Particles, particle_count);
         emitter->m_OriginalSeed = original_seed;
 
         uint32_t seed = original_seed;
@@ -253,18 +593,15 @@ namespace dmParticle
         for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
         {
             Emitter* emitter = &i->m_Emitters[emitter_i];
-            emitter->m_Particles.SetCapacity(0);
+            SetParticleCapacity(&emitter->m_Particles, 0);
             emitter->m_RenderConstants.SetCapacity(0);
         }
         delete i;
     }
 
-    void SetEmitterState(Instance* instance, Emitter* emitter, EmitterState state)
+    static void NotifyEmitterStateChanged(Instance* instance, Emitter* emitter, EmitterState state)
     {
-        EmitterState old_emitter_state = emitter->m_State;
-        emitter->m_State = state;
-
-        if(state != old_emitter_state && instance->m_EmitterStateChangedData.m_UserData != 0x0)
+        if(instance->m_EmitterStateChangedData.m_UserData != 0x0)
         {
             if(state == EMITTER_STATE_PRESPAWN)
             {
@@ -278,11 +615,43 @@ namespace dmParticle
             instance->m_EmitterStateChangedData.m_StateChangedCallback(
                 instance->m_NumAwakeEmitters,
                 emitter->m_Id,
-                emitter->m_State,
+                state,
                 instance->m_EmitterStateChangedData.m_UserData);
         }
     }
 
+    void SetEmitterState(Instance* instance, Emitter* emitter, EmitterState state)
+    {
+        EmitterState old_emitter_state = emitter->m_State;
+        emitter->m_State = state;
+
+        if(state != old_emitter_state)
+        {
+            NotifyEmitterStateChanged(instance, emitter, state);
+        }
+    }
+
+    // Changes the state from within UpdateEmitter, which might run on a worker.
+    // The callback is called later on the main thread, by FlushEmitterStateChanges.
+    static void QueueEmitterState(Emitter* emitter, EmitterState state)
+    {
+        if(state != emitter->m_State)
+        {
+            assert(emitter->m_StateChangeCount < MAX_EMITTER_STATE_CHANGES);
+            emitter->m_StateChanges[emitter->m_StateChangeCount++] = state;
+            emitter->m_State = state;
+        }
+    }
+
+    static void FlushEmitterStateChanges(Instance* instance, Emitter* emitter)
+    {
+        for (uint32_t i = 0; i < emitter->m_StateChangeCount; ++i)
+        {
+            NotifyEmitterStateChanged(instance, emitter, emitter->m_StateChanges[i]);
+        }
+        emitter->m_StateChangeCount = 0;
+    }
+
     static bool IsSleeping(Emitter* emitter);
     static void UpdateEmitter(Prototype* prototype, Instance* instance, EmitterPrototype* emitter_prototype, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt);
 
@@ -321,6 +690,7 @@ namespace dmParticle
         while (timer < time)
         {
             UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
+            FlushEmitterStateChanges(instance, emitter);
             timer += dt;
         }
     }
@@ -359,7 +729,7 @@ namespace dmParticle
             {
                 for (uint32_t emitter_i = prototype_emitter_count; emitter_i < emitter_count; ++emitter_i)
                 {
-                    emitters[emitter_i].m_Particles.SetCapacity(0);
+                    SetParticleCapacity(&emitters[emitter_i].m_Particles, 0);
                 }
             }
             emitters.SetCapacity(prototype_emitter_count);
@@ -467,9 +837,8 @@ namespace dmParticle
 
     static void ResetEmitter(Emitter* emitter)
     {
-        // Save particles array and id
-        dmArray<Particle> tmp;
-        tmp.Swap(emitter->m_Particles);
+        // Save particles buffer and id
+        ParticleBuffer particles = emitter->m_Particles;
         dmhash_t id = emitter->m_Id;
         uint32_t original_seed = emitter->m_OriginalSeed;
         float duration = emitter->m_Duration;
@@ -480,11 +849,11 @@ namespace dmParticle
         memset(emitter, 0, sizeof(Emitter));
 
         // Restore particles and id
-        tmp.Swap(emitter->m_Particles);
+        emitter->m_Particles = particles;
         emitter->m_Id = id;
 
         // Remove living particles
-        emitter->m_Particles.SetSize(0);
+        emitter->m_Particles.m_Size = 0;
 
         // Restore values
         emitter->m_OriginalSeed = original_seed;
@@ -578,12 +947,16 @@ namespace dmParticle
     static void EvaluateEmitterProperties(Emitter* emitter, Property* emitter_properties, float duration, float properties[EMITTER_KEY_COUNT]);
     static void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static uint32_t UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t vertex_index, void* vertex_buffer, uint32_t vertex_buffer_size, float dt, ParticleVertexFormat format);
-    static void GenerateKeys(Emitter* emitter, float max_particle_life_time);
-    static void SortParticles(Emitter* emitter);
+    static uint32_t PrepareRenderData(HParticleContext context, Emitter* emitter, uint32_t vertex_index, uint32_t vertex_buffer_size, ParticleVertexFormat format);
+    static void WriteParticleVertices(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t particle_begin, uint32_t particle_end, uint32_t vertex_index, void* vertex_buffer, float dt, ParticleVertexFormat format);
+    static uint32_t GenerateKeys(Emitter* emitter, float max_particle_life_time);
+    static uint32_t SortParticles(Emitter* emitter, uint32_t run_end);
     static void Simulate(Instance* instance, Emitter* emitter, EmitterPrototype* prototype, dmParticleDDF::Emitter* ddf, float dt);
 
     static void UpdateEmitter(Prototype* prototype, Instance* instance, EmitterPrototype* emitter_prototype, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
+        emitter->m_SortedParticleCount = 0;
+
         // Don't update emitter if time is standing still
         if (IsSleeping(emitter) || dt <= 0.0f)
             return;
@@ -592,8 +965,8 @@ namespace dmParticle
 
         UpdateEmitterState(instance, emitter, emitter_prototype, emitter_ddf, dt);
 
-        GenerateKeys(emitter, emitter_prototype->m_MaxParticleLifeTime);
-        SortParticles(emitter);
+        uint32_t run_end = GenerateKeys(emitter, emitter_prototype->m_MaxParticleLifeTime);
+        emitter->m_SortedParticleCount = SortParticles(emitter, run_end);
 
         Simulate(instance, emitter, emitter_prototype, emitter_ddf, dt);
     }
@@ -654,12 +1027,115 @@ namespace dmParticle
         context->m_Stats.m_Particles = vertex_index / 6; // Debug data for editor playback
     }
 
+    struct GenerateVertexDataContext
+    {
+        VertexRange*            m_VertexRanges;
+        const Vector4*          m_Color;
+        void*                   m_VertexBuffer;
+        float                   m_DT;
+        ParticleVertexFormat    m_Format;
+    };
+
+    static void GenerateVertexRanges(void* _context, uint32_t begin, uint32_t end)
+    {
+        GenerateVertexDataContext* context = (GenerateVertexDataContext*)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const VertexRange& range = context->m_VertexRanges[i];
+            Instance* instance = range.m_Instance;
+            Emitter* emitter = &instance->m_Emitters[range.m_EmitterIndex];
+            dmParticleDDF::Emitter* emitter_ddf = &instance->m_Prototype->m_DDF->m_Emitters[range.m_EmitterIndex];
+            WriteParticleVertices(instance, emitter, emitter_ddf, *context->m_Color, range.m_ParticleBegin, range.m_ParticleEnd, range.m_VertexIndex, context->m_VertexBuffer, context->m_DT, context->m_Format);
+        }
+    }
+
+    void GenerateVertexDataBatch(HParticleContext context, float dt, const EmitterRenderData* const* emitters, uint32_t emitter_count, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format)
+    {
+        DM_PROFILE(Particle, "GenerateVertexData");
+        if (vertex_buffer == 0x0 || vertex_buffer_size == 0)
+            return;
+
+        uint32_t vertex_size = vertex_format == PARTICLE_GUI ? sizeof(ParticleGuiVertex) : sizeof(Vertex);
+        uint32_t vertex_index = *out_vertex_buffer_size / vertex_size;
+        uint32_t first_vertex_index = vertex_index;
+
+        // The particles of each emitter are split into ranges, and every range has its own part of the vertex buffer
+        dmArray<VertexRange>& vertex_ranges = context->m_VertexRanges;
+        vertex_ranges.SetSize(0);
+        for (uint32_t i = 0; i < emitter_count; ++i)
+        {
+            Instance* instance = GetInstance(context, emitters[i]->m_Instance);
+            if (instance == 0x0 || IsSleeping(instance))
+                continue;
+
+            uint32_t emitter_index = emitters[i]->m_EmitterIndex;
+            Emitter* emitter = &instance->m_Emitters[emitter_index];
+            uint32_t render_count = PrepareRenderData(context, emitter, vertex_index, vertex_buffer_size, vertex_format);
+            for (uint32_t begin = 0; begin < render_count; begin += PARALLEL_VERTEX_CHUNK_SIZE)
+            {
+                if (vertex_ranges.Full())
+                {
+                    vertex_ranges.OffsetCapacity(dmMath::Max(16u, vertex_ranges.Capacity()));
+                }
+                VertexRange range;
+                range.m_Instance = instance;
+                range.m_EmitterIndex = emitter_index;
+                range.m_ParticleBegin = begin;
+                range.m_ParticleEnd = dmMath::Min(begin + PARALLEL_VERTEX_CHUNK_SIZE, render_count);
+                range.m_VertexIndex = vertex_index + begin * 6;
+                vertex_ranges.Push(range);
+            }
+            vertex_index += render_count * 6;
+        }
+
+        GenerateVertexDataContext job_context;
+        job_context.m_VertexRanges = vertex_ranges.Begin();
+        job_context.m_Color = &color;
+        job_context.m_VertexBuffer = vertex_buffer;
+        job_context.m_DT = dt;
+        job_context.m_Format = vertex_format;
+        uint32_t range_count = vertex_ranges.Size();
+        if ((vertex_index - first_vertex_index) / 6 >= PARALLEL_MIN_PARTICLE_COUNT)
+        {
+            dmJobPool::Run(context->m_JobPool, GenerateVertexRanges, &job_context, range_count, 1);
+        }
+        else
+        {
+            GenerateVertexRanges(&job_context, 0, range_count);
+        }
+
+        *out_vertex_buffer_size = vertex_index * vertex_size;
+
+        context->m_Stats.m_Particles = vertex_index / 6; // Debug data for editor playback
+    }
+
+    struct UpdateEmittersContext
+    {
+        EmitterUpdate*  m_EmitterUpdates;
+        float           m_DT;
+    };
+
+    static void UpdateEmitters(void* _context, uint32_t begin, uint32_t end)
+    {
+        UpdateEmittersContext* context = (UpdateEmittersContext*)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Instance* instance = context->m_EmitterUpdates[i].m_Instance;
+            uint32_t emitter_i = context->m_EmitterUpdates[i].m_EmitterIndex;
+            Prototype* prototype = instance->m_Prototype;
+            UpdateEmitter(prototype, instance, &prototype->m_Emitters[emitter_i], &instance->m_Emitters[emitter_i], &prototype->m_DDF->m_Emitters[emitter_i], context->m_DT);
+        }
+    }
+
     void Update(HParticleContext context, float dt, FetchAnimationCallback fetch_animation_callback)
     {
         DM_PROFILE(Particle, "Update");
 
+        dmArray<EmitterUpdate>& emitter_updates = context->m_EmitterUpdates;
+        emitter_updates.SetSize(0);
+        uint32_t particle_count = 0;
+
         uint32_t size = context->m_Instances.Size();
-        uint32_t TotalAliveParticles = 0;
         for (uint32_t i = 0; i < size; i++)
         {
             Instance* instance = context->m_Instances[i];
@@ -684,24 +1160,65 @@ namespace dmParticle
             instance->m_PlayTime += dt;
             Prototype* prototype = instance->m_Prototype;
             uint32_t emitter_count = instance->m_Emitters.Size();
+            if (emitter_updates.Remaining() < emitter_count)
+            {
+                emitter_updates.OffsetCapacity(dmMath::Max(emitter_count, emitter_updates.Capacity()));
+            }
             for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
             {
                 Emitter* emitter = &instance->m_Emitters[emitter_i];
-                EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
                 dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
 
                 UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
-                UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
-                TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
-                FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
-                UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
 
-                if (emitter->m_ReHash)
-                    ReHashEmitter(emitter);
+                EmitterUpdate emitter_update;
+                emitter_update.m_Instance = instance;
+                emitter_update.m_InstanceHandle = instance_handle;
+                emitter_update.m_EmitterIndex = emitter_i;
+                emitter_updates.Push(emitter_update);
+                particle_count += emitter->m_Particles.Size();
             }
         }
 
+        // An emitter only touches its own particles and seed while updating, so the result doesn't
+        // depend on which thread updates it. The callbacks are made below, in the serial order.
+        UpdateEmittersContext update_context;
+        update_context.m_EmitterUpdates = emitter_updates.Begin();
+        update_context.m_DT = dt;
+        uint32_t update_count = emitter_updates.Size();
+        if (particle_count >= PARALLEL_MIN_PARTICLE_COUNT)
+        {
+            dmJobPool::Run(context->m_JobPool, UpdateEmitters, &update_context, update_count, 1);
+        }
+        else
+        {
+            UpdateEmitters(&update_context, 0, update_count);
+        }
+
+        uint32_t TotalAliveParticles = 0;
+        uint32_t TotalSortedParticles = 0;
+        for (uint32_t i = 0; i < update_count; ++i)
+        {
+            const EmitterUpdate& emitter_update = emitter_updates[i];
+            Instance* instance = emitter_update.m_Instance;
+            uint32_t emitter_i = emitter_update.m_EmitterIndex;
+            Prototype* prototype = instance->m_Prototype;
+            Emitter* emitter = &instance->m_Emitters[emitter_i];
+            EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
+            dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+
+            FlushEmitterStateChanges(instance, emitter);
+            TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
+            TotalSortedParticles += emitter->m_SortedParticleCount;
+            FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
+            UpdateEmitterRenderData(emitter_update.m_InstanceHandle, emitter_i, instance, emitter, emitter_ddf);
+
+            if (emitter->m_ReHash)
+                ReHashEmitter(emitter);
+        }
+
         DM_COUNTER("Particles alive", TotalAliveParticles);
+        DM_COUNTER("Particles sorted", TotalSortedParticles);
     }
 
     static void FetchAnimation(Emitter* emitter, EmitterPrototype* prototype, FetchAnimationCallback fetch_animation_callback)
@@ -732,24 +1249,27 @@ namespace dmParticle
         DM_PROFILE(Particle, "UpdateParticles");
 
         // Step particle life, prune dead particles
-        uint32_t particle_count = emitter->m_Particles.Size();
-        uint32_t j = 0;
-        while (j < particle_count)
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t particle_count = particles.Size();
+        float* time_left = particles.m_Streams[PARTICLE_STREAM_TIME_LEFT];
+        Vec4f dt_lanes = Splat(dt);
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
         {
-            Particle* p = &emitter->m_Particles[j];
-            p->SetTimeLeft(p->GetTimeLeft() - dt);
-            if (p->GetTimeLeft() < 0.0f)
-            {
-                // TODO Handle death-action
-                emitter->m_Particles.EraseSwap(j);
-                --particle_count;
-            } else {
-                ++j;
-            }
+            Store(time_left + i, Sub(Load(time_left + i), dt_lanes));
+        }
+        // TODO Handle death-action
+        uint32_t first_dead = 0;
+        while (first_dead < particle_count && !(time_left[first_dead] < 0.0f))
+        {
+            ++first_dead;
+        }
+        if (first_dead < particle_count)
+        {
+            EraseDeadParticles(&particles, first_dead);
         }
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
+    static void SpawnParticle(ParticleBuffer* particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
 
     static void UpdateEmitterState(Instance* instance, Emitter* emitter, EmitterPrototype* emitter_prototype, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
@@ -759,7 +1279,7 @@ namespace dmParticle
         {
             if (emitter->m_Timer >= emitter->m_StartDelay)
             {
-                SetEmitterState(instance, emitter, EMITTER_STATE_SPAWNING);
+                QueueEmitterState(emitter, EMITTER_STATE_SPAWNING);
                 emitter->m_Timer -= emitter->m_StartDelay;
             }
         }
@@ -805,16 +1325,19 @@ namespace dmParticle
                     float r = dmMath::Rand11(&emitter->m_Seed);
                     emitter_properties[i] = original_emitter_properties[i] + r * emitter_prototype->m_Properties[i].m_Spread;
                 }
-                SpawnParticle(emitter->m_Particles, &emitter->m_Seed, emitter_ddf, emitter_transform, emitter_velocity, emitter_properties, dt);
+                SpawnParticle(&emitter->m_Particles, &emitter->m_Seed, emitter_ddf, emitter_transform, emitter_velocity, emitter_properties, dt);
             }
 
             if (!IsEmitterLooping(emitter, emitter_ddf) && emitter->m_Timer >= emitter->m_Duration)
-                StopEmitter(instance, emitter);
+            {
+                QueueEmitterState(emitter, EMITTER_STATE_POSTSPAWN);
+                emitter->m_Retiring = 0;
+            }
         }
         if (emitter->m_State == EMITTER_STATE_POSTSPAWN)
         {
             if (emitter->m_Particles.Empty())
-                SetEmitterState(instance, emitter, EMITTER_STATE_SLEEPING);
+                QueueEmitterState(emitter, EMITTER_STATE_SLEEPING);
         }
     }
 
@@ -828,14 +1351,13 @@ namespace dmParticle
         return particle_count * vertices_per_particle;
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
+    static void SpawnParticle(ParticleBuffer* particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
     {
         DM_PROFILE(Particle, "Spawn");
 
-        uint32_t particle_count = particles.Size();
-        particles.SetSize(particle_count + 1);
-        Particle *particle = &particles[particle_count];
-        memset(particle, 0, sizeof(Particle));
+        Particle particle_data;
+        memset(&particle_data, 0, sizeof(Particle));
+        Particle* particle = &particle_data;
 
         // TODO Handle birth-action
 
@@ -998,6 +1520,8 @@ namespace dmParticle
         particle->m_SourceStretchFactorY = emitter_properties[EMITTER_KEY_PARTICLE_STRETCH_FACTOR_Y];
         particle->m_StretchFactorY = particle->m_SourceStretchFactorY;
         particle->m_SourceAngularVelocity = emitter_properties[EMITTER_KEY_PARTICLE_ANGULAR_VELOCITY];
+
+        SetParticle(particles, particles->m_Size++, particle);
     }
 
     static float unit_tex_coords[] =
@@ -1005,9 +1529,19 @@ namespace dmParticle
             0.0f,1.0f, 0.0f,0.0f, 1.0f,0.0f, 1.0f,1.0f
     };
 
-    static uint32_t UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t vertex_index, void* vertex_buffer, uint32_t vertex_buffer_size, float dt, ParticleVertexFormat format)
+    // Number of particles of the emitter that fit in the vertex buffer, starting at vertex_index
+    static uint32_t GetRenderParticleCount(Emitter* emitter, uint32_t vertex_index, uint32_t vertex_buffer_size, ParticleVertexFormat format)
+    {
+        uint32_t vertex_size = format == PARTICLE_GUI ? sizeof(ParticleGuiVertex) : sizeof(Vertex);
+        uint32_t max_vertex_count = vertex_buffer_size / vertex_size;
+        uint32_t particle_count = emitter->m_Particles.Size();
+        return vertex_index < max_vertex_count ? dmMath::Min(particle_count, (max_vertex_count - vertex_index) / 6) : 0;
+    }
+
+    // Writes the vertices of the particles [particle_begin, particle_end) of the emitter, starting at vertex_index.
+    // Only reads the emitter, so that ranges of the same emitter can be written in parallel.
+    static void WriteParticleVertices(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t particle_begin, uint32_t particle_end, uint32_t vertex_index, void* vertex_buffer, float dt, ParticleVertexFormat format)
     {
-        DM_PROFILE(Particle, "UpdateRenderData");
         static int tex_coord_order[] = {
             0,1,2,2,3,0,
             3,2,1,1,0,3,	//h
@@ -1015,14 +1549,6 @@ namespace dmParticle
             2,3,0,0,1,2		//hv
         };
 
-        uint32_t vertex_size = sizeof(Vertex);
-
-        if (format == PARTICLE_GUI)
-            vertex_size = sizeof(ParticleGuiVertex);
-
-        emitter->m_VertexIndex = vertex_index;
-        emitter->m_VertexCount = 0;
-
         const AnimationData& anim_data = emitter->m_AnimationData;
         // texture animation
         uint32_t start_tile = anim_data.m_StartTile;
@@ -1056,17 +1582,12 @@ namespace dmParticle
 
         // calculate emission space
         dmTransform::TransformS1 emission_transform;
-        dmTransform::Transform particle_transform;
         emission_transform.SetIdentity();
         if (ddf->m_Space == EMISSION_SPACE_EMITTER)
         {
             emission_transform = instance->m_WorldTransform;
         }
 
-        uint32_t max_vertex_count = vertex_buffer_size / vertex_size;
-        uint32_t particle_count = emitter->m_Particles.Size();
-        uint32_t j;
-
         float width_factor = 1.0f;
         float height_factor = 1.0f;
         if(!anim_auto_size)
@@ -1084,141 +1605,171 @@ namespace dmParticle
             height_factor *= 0.5f;
         }
 
-        for (j = 0; j < particle_count && vertex_index + 6 <= max_vertex_count; j++)
+        uint32_t flip_flag = 0;
+        if (hFlip)
         {
-            Particle* particle = &emitter->m_Particles[j];
-            // Evaluate anim frame
-            uint32_t tile = 0;
-            Vector3 size;
-            if (anim_playing)
+            flip_flag = 1;
+        }
+        if (vFlip)
+        {
+            flip_flag |= 2;
+        }
+        const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+
+        float* const* streams = emitter->m_Particles.m_Streams;
+        QuatLanes emission_rotation = SplatQuat(emission_transform.GetRotation());
+        Vec3Lanes emission_translation = SplatVec3(emission_transform.GetTranslation());
+        Vec4f emission_scale = Splat(emission_transform.GetScale());
+        Vec4f zero = Splat(0.0f);
+        Vec4f minus_one = Splat(-1.0f);
+
+        // Per particle values of the lanes
+        float DM_ALIGNED(16) lane_width[PARTICLE_LANE_COUNT];
+        float DM_ALIGNED(16) lane_height[PARTICLE_LANE_COUNT];
+        uint32_t lane_tile[PARTICLE_LANE_COUNT];
+        // Quad corners (xyz) and color (rgba) of the lanes
+        float DM_ALIGNED(16) corners[4][3][PARTICLE_LANE_COUNT];
+        float DM_ALIGNED(16) colors[4][PARTICLE_LANE_COUNT];
+
+        for (uint32_t j = particle_begin; j < particle_end; j += PARTICLE_LANE_COUNT)
+        {
+            uint32_t lane_count = dmMath::Min(particle_end - j, PARTICLE_LANE_COUNT);
+            for (uint32_t lane = 0; lane < PARTICLE_LANE_COUNT; ++lane)
             {
-                float anim_cursor = particle->GetMaxLifeTime() - particle->GetTimeLeft() - half_dt;
-                float anim_t = 0.0f;
-                if (anim_once) // stretch over particle life
-                {
-                    anim_t = anim_cursor * particle->GetooMaxLifeTime();
-                }
-                else // use anim FPS
+                // Evaluate anim frame
+                uint32_t tile = 0;
+                lane_width[lane] = width_factor;
+                lane_height[lane] = height_factor;
+                if (anim_playing && lane < lane_count)
                 {
-                    anim_t = anim_cursor * inv_anim_length;
-                }
-                tile = (uint32_t)(tile_count * anim_t);
-                tile = tile % tile_count;
-                if (tile >= interval) {
-                    tile = (interval-1) * 2 - tile;
-                }
-                if (anim_bwd)
-                    tile = tile_count - tile - 1;
+                    uint32_t index = j + lane;
+                    float anim_cursor = streams[PARTICLE_STREAM_MAX_LIFE_TIME][index] - streams[PARTICLE_STREAM_TIME_LEFT][index] - half_dt;
+                    float anim_t = 0.0f;
+                    if (anim_once) // stretch over particle life
+                    {
+                        anim_t = anim_cursor * streams[PARTICLE_STREAM_OO_MAX_LIFE_TIME][index];
+                    }
+                    else // use anim FPS
+                    {
+                        anim_t = anim_cursor * inv_anim_length;
+                    }
+                    tile = (uint32_t)(tile_count * anim_t);
+                    tile = tile % tile_count;
+                    if (tile >= interval) {
+                        tile = (interval-1) * 2 - tile;
+                    }
+                    if (anim_bwd)
+                        tile = tile_count - tile - 1;
 
-                size = particle->GetScale();
-                if(anim_auto_size)
-                {
-                    const float* td = &tex_dims[(start_tile + tile) << 1];
-                    width_factor = td[0] * 0.5;
-                    height_factor = td[1] * 0.5;
-                }
-                else
-                {
-                    size *= particle->GetSourceSize();
+                    if(anim_auto_size)
+                    {
+                        const float* td = &tex_dims[(start_tile + tile) << 1];
+                        lane_width[lane] = td[0] * 0.5;
+                        lane_height[lane] = td[1] * 0.5;
+                    }
                 }
+                lane_tile[lane] = tile + start_tile;
             }
-            else
-            {
-                size = particle->GetScale() * particle->GetSourceSize();
-            }
-            tile += start_tile;
-            float* tex_coord = &tex_coords[tile << 3];
-
-            particle_transform.SetTranslation(Vector3(particle->GetPosition()));
-            particle_transform.SetRotation(particle->GetRotation());
-            particle_transform.SetScale(size);
-            particle_transform.SetRotation(emission_transform.GetRotation() * particle_transform.GetRotation());
-            particle_transform.SetTranslation(Vector3(Apply(emission_transform, Point3(particle_transform.GetTranslation()))));
-            particle_transform.SetScale(emission_transform.GetScale() * particle_transform.GetScale());
-
-            Vector3 x = dmTransform::Apply(particle_transform, Vector3(width_factor, 0.0f, 0.0f));
-            Vector3 y = dmTransform::Apply(particle_transform, Vector3(0.0f, height_factor, 0.0f));
-
-            Vector3 p0 = -x - y + particle_transform.GetTranslation();
-            Vector3 p1 = -x + y + particle_transform.GetTranslation();
-            Vector3 p2 = x - y + particle_transform.GetTranslation();
-            Vector3 p3 = x + y + particle_transform.GetTranslation();
-
-            uint32_t flip_flag = 0;
-            if (hFlip)
-            {
-                flip_flag = 1;
-            }
-            if (vFlip)
+
+            Vec3Lanes size = LoadVec3(streams, PARTICLE_STREAM_SCALE_X, j);
+            if (!anim_auto_size)
             {
-                flip_flag |= 2;
+                size = Mul(size, Load(streams[PARTICLE_STREAM_SOURCE_SIZE] + j));
             }
-            const int* tex_lookup = &tex_coord_order[flip_flag * 6];
 
-            Vector4 c = particle->GetColor();
-            c = Vector4(mulPerElem(c.getXYZ(), color.getXYZ()), c.getW() * color.getW());
+            // Particle transform in emission space, see dmTransform::Apply
+            QuatLanes rotation = Mul(emission_rotation, LoadQuat(streams, PARTICLE_STREAM_ROTATION_X, j));
+            Vec3Lanes translation = Add(Rotate(emission_rotation, Mul(LoadVec3(streams, PARTICLE_STREAM_POSITION_X, j), emission_scale)), emission_translation);
+            Vec3Lanes scale = Mul(size, emission_scale);
+
+            Vec3Lanes x_extent = { Mul(Load(lane_width), scale.x), Mul(zero, scale.y), Mul(zero, scale.z) };
+            Vec3Lanes y_extent = { Mul(zero, scale.x), Mul(Load(lane_height), scale.y), Mul(zero, scale.z) };
+            Vec3Lanes x = Rotate(rotation, x_extent);
+            Vec3Lanes y = Rotate(rotation, y_extent);
+            Vec3Lanes neg_x = Mul(x, minus_one);
+
+            StoreVec3Lanes(corners[0], Add(Sub(neg_x, y), translation));
+            StoreVec3Lanes(corners[1], Add(Add(neg_x, y), translation));
+            StoreVec3Lanes(corners[2], Add(Sub(x, y), translation));
+            StoreVec3Lanes(corners[3], Add(Add(x, y), translation));
 
-            if (format == PARTICLE_GO)
+            Store(colors[0], Mul(Load(streams[PARTICLE_STREAM_COLOR_R] + j), Splat(color.getX())));
+            Store(colors[1], Mul(Load(streams[PARTICLE_STREAM_COLOR_G] + j), Splat(color.getY())));
+            Store(colors[2], Mul(Load(streams[PARTICLE_STREAM_COLOR_B] + j), Splat(color.getZ())));
+            Store(colors[3], Mul(Load(streams[PARTICLE_STREAM_COLOR_A] + j), Splat(color.getW())));
+
+            for (uint32_t lane = 0; lane < lane_count; ++lane)
             {
-                Vertex* vertex = &((Vertex*)vertex_buffer)[vertex_index];
-
-#define SET_VERTEX_GO(vertex, p, c, u, v)\
-    vertex->m_X = p.getX();\
-    vertex->m_Y = p.getY();\
-    vertex->m_Z = p.getZ();\
-    vertex->m_Red = c.getX();\
-    vertex->m_Green = c.getY();\
-    vertex->m_Blue = c.getZ();\
-    vertex->m_Alpha = c.getW();\
+                float* tex_coord = &tex_coords[lane_tile[lane] << 3];
+
+                if (format == PARTICLE_GO)
+                {
+                    Vertex* vertex = &((Vertex*)vertex_buffer)[vertex_index];
+
+#define SET_VERTEX_GO(vertex, p, u, v)\
+    vertex->m_X = corners[p][0][lane];\
+    vertex->m_Y = corners[p][1][lane];\
+    vertex->m_Z = corners[p][2][lane];\
+    vertex->m_Red = colors[0][lane];\
+    vertex->m_Green = colors[1][lane];\
+    vertex->m_Blue = colors[2][lane];\
+    vertex->m_Alpha = colors[3][lane];\
     vertex->m_U = u;\
     vertex->m_V = v;
 
-                SET_VERTEX_GO(vertex, p0, c, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p1, c, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p3, c, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p3, c, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p2, c, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p0, c, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
+                    SET_VERTEX_GO(vertex, 0, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 1, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 3, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 3, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 2, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 0, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
 
 #undef SET_VERTEX_GO
-            }
-            else if (format == PARTICLE_GUI)
-            {
-                ParticleGuiVertex* vertex = &((ParticleGuiVertex*)vertex_buffer)[vertex_index];
-
-#define SET_VERTEX_GUI(vertex, p, c, u, v)\
-    vertex->m_Position[0] = p.getX();\
-    vertex->m_Position[1] = p.getY();\
-    vertex->m_Position[2] = p.getZ();\
-    vertex->m_Color[0] = c.getX(); \
-    vertex->m_Color[1] = c.getY(); \
-    vertex->m_Color[2] = c.getZ(); \
-    vertex->m_Color[3] = c.getW(); \
+                }
+                else if (format == PARTICLE_GUI)
+                {
+                    ParticleGuiVertex* vertex = &((ParticleGuiVertex*)vertex_buffer)[vertex_index];
+
+#define SET_VERTEX_GUI(vertex, p, u, v)\
+    vertex->m_Position[0] = corners[p][0][lane];\
+    vertex->m_Position[1] = corners[p][1][lane];\
+    vertex->m_Position[2] = corners[p][2][lane];\
+    vertex->m_Color[0] = colors[0][lane];\
+    vertex->m_Color[1] = colors[1][lane];\
+    vertex->m_Color[2] = colors[2][lane];\
+    vertex->m_Color[3] = colors[3][lane];\
     vertex->m_UV[0] = u;\
     vertex->m_UV[1] = v;
 
-                SET_VERTEX_GUI(vertex, p0, c, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p1, c, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p3, c, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p3, c, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p2, c, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p0, c, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
+                    SET_VERTEX_GUI(vertex, 0, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 1, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 3, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 3, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 2, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 0, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
 #undef SET_VERTEX_GUI
-            }
+                }
 
-            vertex_index += 6;
+                vertex_index += 6;
+            }
         }
-        if (j < particle_count)
+    }
+
+    // Counts the particles that fit in the vertex buffer and warns when some of them don't
+    static uint32_t PrepareRenderData(HParticleContext context, Emitter* emitter, uint32_t vertex_index, uint32_t vertex_buffer_size, ParticleVertexFormat format)
+    {
+        uint32_t render_count = GetRenderParticleCount(emitter, vertex_index, vertex_buffer_size, format);
+        if (render_count < emitter->m_Particles.Size())
         {
             if (emitter->m_RenderWarning == 0)
             {
@@ -1231,47 +1782,136 @@ namespace dmParticle
                 emitter->m_RenderWarning = 1;
             }
         }
-        emitter->m_VertexCount = vertex_index - emitter->m_VertexIndex;
-        return emitter->m_VertexCount;
+        emitter->m_VertexIndex = vertex_index;
+        emitter->m_VertexCount = render_count * 6;
+        return render_count;
     }
 
-    struct SortPred
+    static uint32_t UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Vector4& color, uint32_t vertex_index, void* vertex_buffer, uint32_t vertex_buffer_size, float dt, ParticleVertexFormat format)
     {
-        inline bool operator () (const Particle& p1, const Particle& p2)
-        {
-            return p1.GetSortKey().m_Key < p2.GetSortKey().m_Key;
-        }
-
-    };
+        DM_PROFILE(Particle, "UpdateRenderData");
+        uint32_t render_count = PrepareRenderData(context, emitter, vertex_index, vertex_buffer_size, format);
+        WriteParticleVertices(instance, emitter, ddf, color, 0, render_count, vertex_index, vertex_buffer, dt, format);
+        return emitter->m_VertexCount;
+    }
 
-    void GenerateKeys(Emitter* emitter, float max_particle_life_time)
+    // Returns the index of the first particle that is out of order, or the particle count if they are all in order
+    uint32_t GenerateKeys(Emitter* emitter, float max_particle_life_time)
     {
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         uint32_t n = particles.Size();
 
         float range = 1.0f / max_particle_life_time;
 
-        Particle* first = particles.Begin();
+        const float* time_left = particles.m_Streams[PARTICLE_STREAM_TIME_LEFT];
+        SortKey* keys = particles.m_SortKeys;
+        uint32_t run_end = n;
+        uint32_t prev_lt = 0;
         for (uint32_t i = 0; i < n; ++i)
         {
-            Particle* p = &particles[i];
-            uint32_t index = p - first;
-
-            float life_time = (1.0f - p->GetTimeLeft() * range) * 65535;
+            float life_time = (1.0f - time_left[i] * range) * 65535;
             life_time = dmMath::Clamp(life_time, 0.0f, 65535.0f);
             uint16_t lt = (uint16_t) life_time;
             SortKey key;
             key.m_LifeTime = lt;
-            key.m_Index = index;
-            p->SetSortKey(key);
+            key.m_Index = i;
+            keys[i] = key;
+            if (lt < prev_lt && run_end == n)
+            {
+                run_end = i;
+            }
+            prev_lt = lt;
         }
+        return run_end;
     }
 
-    void SortParticles(Emitter* emitter)
+    // Sorts the particles on their keys and returns the number of particles that had to be sorted.
+    // The survivors of the last update are still in order, since they have all aged by the same amount,
+    // so only the particles spawned in this update can be out of place.
+    uint32_t SortParticles(Emitter* emitter, uint32_t run_end)
     {
         DM_PROFILE(Particle, "Sort");
 
-        std::sort(emitter->m_Particles.Begin(), emitter->m_Particles.End(), SortPred());
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t n = particles.Size();
+        if (run_end >= n)
+        {
+            return 0;
+        }
+
+        SortKey* keys = particles.m_SortKeys;
+        bool rotate = keys[n - 1].m_LifeTime < keys[0].m_LifeTime;
+        for (uint32_t i = run_end + 1; i < n && rotate; ++i)
+        {
+            rotate = keys[i - 1].m_LifeTime <= keys[i].m_LifeTime;
+        }
+        if (rotate)
+        {
+            // The particles from run_end and onwards are all younger than the ones before them,
+            // which is the case for constant life times, so they only need to be moved to the front
+            uint32_t count = n - run_end;
+            for (uint32_t s = 0; s < PARTICLE_STREAM_COUNT; ++s)
+            {
+                const float* src = particles.m_Streams[s];
+                float* dst = particles.m_Scratch;
+                memcpy(dst, src + run_end, count * sizeof(float));
+                memcpy(dst + count, src, run_end * sizeof(float));
+                particles.m_Scratch = particles.m_Streams[s];
+                particles.m_Streams[s] = dst;
+            }
+            return 0;
+        }
+
+        // LSD radix sort on the life time, 8 bits per pass. The keys are generated in index order and
+        // every pass is stable, which gives the same order as sorting on the full key.
+        // The life time is quantized to 16 bits, so two passes cover it.
+        SortKey* from = keys;
+        SortKey* to = particles.m_SortKeysScratch;
+        uint32_t offsets[256];
+        for (uint32_t shift = 0; shift < 16; shift += 8)
+        {
+            memset(offsets, 0, sizeof(offsets));
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                ++offsets[(from[i].m_LifeTime >> shift) & 0xff];
+            }
+            // Nothing moves if all keys share the digit
+            if (offsets[(from[0].m_LifeTime >> shift) & 0xff] == n)
+            {
+                continue;
+            }
+            uint32_t offset = 0;
+            for (uint32_t d = 0; d < 256; ++d)
+            {
+                uint32_t count = offsets[d];
+                offsets[d] = offset;
+                offset += count;
+            }
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                to[offsets[(from[i].m_LifeTime >> shift) & 0xff]++] = from[i];
+            }
+            SortKey* tmp = from;
+            from = to;
+            to = tmp;
+        }
+        particles.m_SortKeys = from;
+        particles.m_SortKeysScratch = to;
+        keys = from;
+
+        // Reorder one stream at a time into the scratch stream, which then takes its place
+        for (uint32_t s = 0; s < PARTICLE_STREAM_COUNT; ++s)
+        {
+            const float* src = particles.m_Streams[s];
+            float* dst = particles.m_Scratch;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                dst[i] = src[keys[i].m_Index];
+            }
+            particles.m_Scratch = particles.m_Streams[s];
+            particles.m_Streams[s] = dst;
+        }
+        return n;
     }
 
 #define SAMPLE_PROP(segment, x, target)\
@@ -1290,78 +1930,128 @@ namespace dmParticle
         }
     }
 
+    // Samples a property at the lanes of x, the segments are gathered one lane at a time
+    static inline Vec4f SampleProperty(const Property& property, Vec4f x, const uint32_t segment_indices[PARTICLE_LANE_COUNT])
+    {
+        float DM_ALIGNED(16) segment_x[PARTICLE_LANE_COUNT];
+        float DM_ALIGNED(16) segment_y[PARTICLE_LANE_COUNT];
+        float DM_ALIGNED(16) segment_k[PARTICLE_LANE_COUNT];
+        for (uint32_t lane = 0; lane < PARTICLE_LANE_COUNT; ++lane)
+        {
+            const LinearSegment* s = &property.m_Segments[segment_indices[lane]];
+            segment_x[lane] = s->m_X;
+            segment_y[lane] = s->m_Y;
+            segment_k[lane] = s->m_K;
+        }
+        return Add(Mul(Sub(x, Load(segment_x)), Load(segment_k)), Load(segment_y));
+    }
+
+    static inline Quat GetQuat(float* const* streams, uint32_t first_stream, uint32_t i)
+    {
+        return Quat(streams[first_stream][i], streams[first_stream + 1][i], streams[first_stream + 2][i], streams[first_stream + 3][i]);
+    }
+
+    static inline void SetQuat(float* const* streams, uint32_t first_stream, uint32_t i, const Quat& q)
+    {
+        streams[first_stream][i] = q.getX();
+        streams[first_stream + 1][i] = q.getY();
+        streams[first_stream + 2][i] = q.getZ();
+        streams[first_stream + 3][i] = q.getW();
+    }
+
+    static inline float GetParticleLifeRatio(float* const* streams, uint32_t i)
+    {
+        return dmMath::Select(-streams[PARTICLE_STREAM_MAX_LIFE_TIME][i], 0.0f, 1.0f - streams[PARTICLE_STREAM_TIME_LEFT][i] * streams[PARTICLE_STREAM_OO_MAX_LIFE_TIME][i]);
+    }
+
     void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
         float properties[PARTICLE_KEY_COUNT];
-        // TODO Optimize this
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
+        float* const* s = particles.m_Streams;
         uint32_t count = particles.Size();
-        for (uint32_t i = 0; i < count; ++i)
+
+        Vec4f zero = Splat(0.0f);
+        Vec4f one = Splat(1.0f);
+        uint32_t segment_indices[PARTICLE_LANE_COUNT];
+        float DM_ALIGNED(16) lane_x[PARTICLE_LANE_COUNT];
+        for (uint32_t i = 0; i < count; i += PARTICLE_LANE_COUNT)
         {
-            Particle* particle = &particles[i];
-            float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-            uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
-            Vector4 c = particle->GetSourceColor();
-            particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
-            particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
-            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
-            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
+            Vec4f max_life_time = Load(s[PARTICLE_STREAM_MAX_LIFE_TIME] + i);
+            Vec4f x = Select(Sub(zero, max_life_time), zero, Sub(one, Mul(Load(s[PARTICLE_STREAM_TIME_LEFT] + i), Load(s[PARTICLE_STREAM_OO_MAX_LIFE_TIME] + i))));
+            Store(lane_x, x);
+            for (uint32_t lane = 0; lane < PARTICLE_LANE_COUNT; ++lane)
+            {
+                // Padding lanes might hold any value, living particles are always within [0, 1]
+                float segment_x = (lane_x[lane] >= 0.0f && lane_x[lane] <= 1.0f) ? lane_x[lane] : 0.0f;
+                segment_indices[lane] = dmMath::Min((uint32_t)(segment_x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
+            }
+
+            Vec4f scale = SampleProperty(particle_properties[PARTICLE_KEY_SCALE], x, segment_indices);
+            Store(s[PARTICLE_STREAM_SCALE_X] + i, scale);
+            Store(s[PARTICLE_STREAM_SCALE_Y] + i, scale);
+            Store(s[PARTICLE_STREAM_SCALE_Z] + i, scale);
+
+            Vec4f red = SampleProperty(particle_properties[PARTICLE_KEY_RED], x, segment_indices);
+            Vec4f green = SampleProperty(particle_properties[PARTICLE_KEY_GREEN], x, segment_indices);
+            Vec4f blue = SampleProperty(particle_properties[PARTICLE_KEY_BLUE], x, segment_indices);
+            Vec4f alpha = SampleProperty(particle_properties[PARTICLE_KEY_ALPHA], x, segment_indices);
+            // Clamp to [0, 1], with the same result as dmMath::Clamp
+            Store(s[PARTICLE_STREAM_COLOR_R] + i, Min(one, Max(zero, Mul(Load(s[PARTICLE_STREAM_SOURCE_COLOR_R] + i), red))));
+            Store(s[PARTICLE_STREAM_COLOR_G] + i, Min(one, Max(zero, Mul(Load(s[PARTICLE_STREAM_SOURCE_COLOR_G] + i), green))));
+            Store(s[PARTICLE_STREAM_COLOR_B] + i, Min(one, Max(zero, Mul(Load(s[PARTICLE_STREAM_SOURCE_COLOR_B] + i), blue))));
+            Store(s[PARTICLE_STREAM_COLOR_A] + i, Min(one, Max(zero, Mul(Load(s[PARTICLE_STREAM_SOURCE_COLOR_A] + i), alpha))));
+
+            Vec4f stretch_x = SampleProperty(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X], x, segment_indices);
+            Vec4f stretch_y = SampleProperty(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y], x, segment_indices);
+            Store(s[PARTICLE_STREAM_STRETCH_FACTOR_X] + i, Add(Load(s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X] + i), stretch_x));
+            Store(s[PARTICLE_STREAM_STRETCH_FACTOR_Y] + i, Add(Load(s[PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y] + i), stretch_y));
         }
 
+        // The orientation needs trigonometry per particle and is evaluated one particle at a time
         if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION) {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+                float x = GetParticleLifeRatio(s, i);
                 uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
-                if (lengthSqr(particle->m_Velocity) > EPSILON)
+                Quat rotation = GetQuat(s, PARTICLE_STREAM_SOURCE_ROTATION_X, i) * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]);
+                Vector3 velocity(s[PARTICLE_STREAM_VELOCITY_X][i], s[PARTICLE_STREAM_VELOCITY_Y][i], s[PARTICLE_STREAM_VELOCITY_Z][i]);
+                if (lengthSqr(velocity) > EPSILON)
                 {
-                    Vector3 vel_norm = normalize(particle->m_Velocity);
+                    Vector3 vel_norm = normalize(velocity);
                     float y_dot = dot(Vector3::yAxis(), vel_norm);
                     // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
                     Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
-                    Quat q = particle->GetRotation() * q_vel;
-                    particle->SetRotation(q);
+                    rotation = rotation * q_vel;
                 }
+                SetQuat(s, PARTICLE_STREAM_ROTATION_X, i, rotation);
             }
 
         } else if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY) {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+                float x = GetParticleLifeRatio(s, i);
                 uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
-                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
+                Quat rotation = GetQuat(s, PARTICLE_STREAM_ROTATION_X, i) * Quat::rotationZ(DEG_RAD * (s[PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY][i] * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt);
+                SetQuat(s, PARTICLE_STREAM_ROTATION_X, i, rotation);
             }
 
         } else {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+                float x = GetParticleLifeRatio(s, i);
                 uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                Quat rotation = GetQuat(s, PARTICLE_STREAM_SOURCE_ROTATION_X, i) * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]);
+                SetQuat(s, PARTICLE_STREAM_ROTATION_X, i, rotation);
             }
         }
 
     }
 
-    void ApplyAcceleration(dmArray<Particle>& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyAcceleration(ParticleBuffer& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
@@ -1370,14 +2060,19 @@ namespace dmParticle
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
         float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        float* const* s = particles.m_Streams;
+        Vec3Lanes step = SplatVec3(acc_step);
+        Vec4f magnitude_lanes = Splat(magnitude);
+        Vec4f mag_spread_lanes = Splat(mag_spread);
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
         {
-            Particle* particle = &particles[i];
-            particle->SetVelocity(particle->GetVelocity() + acc_step * (magnitude + mag_spread * particle->GetSpreadFactor()));
+            Vec4f applied_magnitude = Add(magnitude_lanes, Mul(mag_spread_lanes, Load(s[PARTICLE_STREAM_SPREAD_FACTOR] + i)));
+            Vec3Lanes velocity = LoadVec3(s, PARTICLE_STREAM_VELOCITY_X, i);
+            StoreVec3(s, PARTICLE_STREAM_VELOCITY_X, i, Add(velocity, Mul(step, applied_magnitude)));
         }
     }
 
-    void ApplyDrag(dmArray<Particle>& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
+    void ApplyDrag(ParticleBuffer& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         Vector3 direction = rotate(rotation, DRAG_LOCAL_DIR);
@@ -1386,34 +2081,32 @@ namespace dmParticle
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
         float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 v = particle->GetVelocity();
-            if (modifier_ddf->m_UseDirection)
-                v = projection(Point3(particle->GetVelocity()), direction) * direction;
+        float* const* s = particles.m_Streams;
+        Vec3Lanes direction_lanes = SplatVec3(direction);
+        Vec4f magnitude_lanes = Splat(magnitude);
+        Vec4f mag_spread_lanes = Splat(mag_spread);
+        Vec4f dt_lanes = Splat(dt);
+        Vec4f one = Splat(1.0f);
+        bool use_direction = modifier_ddf->m_UseDirection != 0;
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
+        {
+            Vec3Lanes velocity = LoadVec3(s, PARTICLE_STREAM_VELOCITY_X, i);
+            Vec3Lanes v = velocity;
+            if (use_direction)
+                v = Mul(direction_lanes, Dot(velocity, direction_lanes));
             // Applied drag > 1 means the particle would travel in the reverse direction
-            float applied_drag = dmMath::Min((magnitude + mag_spread * particle->GetSpreadFactor()) * dt, 1.0f);
-            particle->SetVelocity(particle->GetVelocity() - v * applied_drag);
+            Vec4f applied_drag = Min(Mul(Add(magnitude_lanes, Mul(mag_spread_lanes, Load(s[PARTICLE_STREAM_SPREAD_FACTOR] + i))), dt_lanes), one);
+            StoreVec3(s, PARTICLE_STREAM_VELOCITY_X, i, Sub(velocity, Mul(v, applied_drag)));
         }
     }
 
-    static Vector3 GetParticleDir(Particle* particle)
+    // Direction of the particles, see PARTICLE_LOCAL_BASE_DIR
+    static inline Vec3Lanes GetParticleDir(float* const* streams, uint32_t i)
     {
-        return rotate(particle->GetRotation(), PARTICLE_LOCAL_BASE_DIR);
+        return Rotate(LoadQuat(streams, PARTICLE_STREAM_ROTATION_X, i), SplatVec3(PARTICLE_LOCAL_BASE_DIR));
     }
 
-    static Vector3 NonZeroVector3(Vector3 v, float sq_length, Vector3 fallback)
-    {
-        Vector3 result;
-        float neg_sq_length = -sq_length;
-        result.setX(dmMath::Select(neg_sq_length, fallback.getX(), v.getX()));
-        result.setY(dmMath::Select(neg_sq_length, fallback.getY(), v.getY()));
-        result.setZ(dmMath::Select(neg_sq_length, fallback.getZ(), v.getZ()));
-        return result;
-    }
-
-    void ApplyRadial(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
+    void ApplyRadial(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
@@ -1426,20 +2119,27 @@ namespace dmParticle
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
         float max_sq_distance = max_distance * max_distance;
         float applied_factor = dt * scale;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 delta = particle->GetPosition() - position;
-            float delta_sq_len = lengthSqr(delta);
-            float applied_magnitude = magnitude + mag_spread * particle->GetSpreadFactor();
+        float* const* s = particles.m_Streams;
+        Vec3Lanes position_lanes = SplatVec3(Vector3(position));
+        Vec4f magnitude_lanes = Splat(magnitude);
+        Vec4f mag_spread_lanes = Splat(mag_spread);
+        Vec4f max_sq_distance_lanes = Splat(max_sq_distance);
+        Vec4f applied_factor_lanes = Splat(applied_factor);
+        Vec4f zero = Splat(0.0f);
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
+        {
+            Vec3Lanes delta = Sub(LoadVec3(s, PARTICLE_STREAM_POSITION_X, i), position_lanes);
+            Vec4f delta_sq_len = LengthSqr(delta);
+            Vec4f applied_magnitude = Add(magnitude_lanes, Mul(mag_spread_lanes, Load(s[PARTICLE_STREAM_SPREAD_FACTOR] + i)));
             // 0 acc delta lies outside max dist
-            float a = dmMath::Select(max_sq_distance - delta_sq_len, applied_magnitude, 0.0f);
-            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particle)));
-            particle->SetVelocity(particle->GetVelocity() + dir * a * applied_factor);
+            Vec4f a = Select(Sub(max_sq_distance_lanes, delta_sq_len), applied_magnitude, zero);
+            Vec3Lanes dir = Normalize(NonZero(delta, delta_sq_len, GetParticleDir(s, i)));
+            Vec3Lanes velocity = LoadVec3(s, PARTICLE_STREAM_VELOCITY_X, i);
+            StoreVec3(s, PARTICLE_STREAM_VELOCITY_X, i, Add(velocity, Mul(Mul(dir, a), applied_factor_lanes)));
         }
     }
 
-    void ApplyVortex(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyVortex(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
@@ -1454,23 +2154,32 @@ namespace dmParticle
         Vector3 axis = rotate(rotation, VORTEX_LOCAL_AXIS);
         Vector3 start = rotate(rotation, VORTEX_LOCAL_START_DIR);
         float applied_factor = dt * scale;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        float* const* s = particles.m_Streams;
+        Vec3Lanes position_lanes = SplatVec3(Vector3(position));
+        Vec3Lanes axis_lanes = SplatVec3(axis);
+        Vec3Lanes start_lanes = SplatVec3(start);
+        Vec4f magnitude_lanes = Splat(magnitude);
+        Vec4f mag_spread_lanes = Splat(mag_spread);
+        Vec4f max_sq_distance_lanes = Splat(max_sq_distance);
+        Vec4f applied_factor_lanes = Splat(applied_factor);
+        Vec4f zero = Splat(0.0f);
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
         {
-            Particle* particle = &particles[i];
             // delta from vortex position
-            Vector3 delta = particle->GetPosition() - position;
+            Vec3Lanes delta = Sub(LoadVec3(s, PARTICLE_STREAM_POSITION_X, i), position_lanes);
             // normal from vortex axis (non-unit)
-            Vector3 normal = delta - projection(Point3(delta), axis) * axis;
+            Vec3Lanes normal = Sub(delta, Mul(axis_lanes, Dot(delta, axis_lanes)));
             // tangent is the direction of the vortex acceleration
-            Vector3 tangent = cross(axis, normal);
+            Vec3Lanes tangent = Cross(axis_lanes, normal);
             // In case the particle is directed along the axis, give it a guaranteed orthogonal start
-            tangent = NonZeroVector3(tangent, lengthSqr(tangent), start);
+            tangent = NonZero(tangent, LengthSqr(tangent), start_lanes);
             // tangent is now guaranteed to be non-zero
-            tangent = normalize(tangent);
+            tangent = Normalize(tangent);
             // use normal for max distance test
-            float normal_sq_len = lengthSqr(normal);
-            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particle->GetSpreadFactor(), 0.0f);
-            particle->SetVelocity(particle->GetVelocity() + tangent * acceleration * applied_factor);
+            Vec4f normal_sq_len = LengthSqr(normal);
+            Vec4f acceleration = Select(Sub(max_sq_distance_lanes, normal_sq_len), Add(magnitude_lanes, Mul(mag_spread_lanes, Load(s[PARTICLE_STREAM_SPREAD_FACTOR] + i))), zero);
+            Vec3Lanes velocity = LoadVec3(s, PARTICLE_STREAM_VELOCITY_X, i);
+            StoreVec3(s, PARTICLE_STREAM_VELOCITY_X, i, Add(velocity, Mul(Mul(tangent, acceleration), applied_factor_lanes)));
         }
     }
 
@@ -1499,7 +2208,7 @@ namespace dmParticle
     {
         DM_PROFILE(Particle, "Simulate");
 
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         EvaluateParticleProperties(emitter, prototype->m_ParticleProperties, ddf, dt);
         float emitter_t = dmMath::Select(-ddf->m_Duration, 0.0f, emitter->m_Timer / ddf->m_Duration);
         float scale = 1.0f;
@@ -1541,18 +2250,24 @@ namespace dmParticle
             }
         }
         uint32_t particle_count = particles.Size();
-        for (uint32_t i = 0; i < particle_count; ++i)
+        float* const* s = particles.m_Streams;
+        Vec4f dt_lanes = Splat(dt);
+        Vec4f stretch_scaling = Splat(STRETCH_SCALING);
+        bool stretch_with_velocity = ddf->m_StretchWithVelocity;
+        for (uint32_t i = 0; i < particle_count; i += PARTICLE_LANE_COUNT)
         {
-            Particle* p = &particles[i];
             // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
             // beginning of the frame, but it's ok since particle movement does not need to be very exact
-            p->SetPosition(p->GetPosition() + p->m_Velocity * dt);
+            Vec3Lanes velocity = LoadVec3(s, PARTICLE_STREAM_VELOCITY_X, i);
+            StoreVec3(s, PARTICLE_STREAM_POSITION_X, i, Add(LoadVec3(s, PARTICLE_STREAM_POSITION_X, i), Mul(velocity, dt_lanes)));
 
-            p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
-            if (!ddf->m_StretchWithVelocity)
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
-            else
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
+            Vec4f scale_x = Load(s[PARTICLE_STREAM_SCALE_X] + i);
+            Store(s[PARTICLE_STREAM_SCALE_X] + i, Add(scale_x, Mul(scale_x, Load(s[PARTICLE_STREAM_STRETCH_FACTOR_X] + i))));
+            Vec4f scale_y = Load(s[PARTICLE_STREAM_SCALE_Y] + i);
+            Vec4f stretch_y = Mul(scale_y, Load(s[PARTICLE_STREAM_STRETCH_FACTOR_Y] + i));
+            if (stretch_with_velocity)
+                stretch_y = Mul(Mul(stretch_y, Sqrt(LengthSqr(velocity))), stretch_scaling);
+            Store(s[PARTICLE_STREAM_SCALE_Y] + i, Add(scale_y, stretch_y));
         }
     }
 
@@ -1844,6 +2559,55 @@ namespace dmParticle
         render_emitter_callback(user_context, emitter_proto->m_Material, emitter->m_AnimationData.m_Texture, world, emitter_proto->m_BlendMode, emitter->m_VertexIndex, emitter->m_VertexCount, emitter->m_RenderConstants.Begin(), emitter->m_RenderConstants.Size());
     }
 
+    // Conservative bounding radius of the particle quads, around the emitter position
+    static float CalculateEmitterBoundRadius(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const Point3& emitter_position)
+    {
+        uint32_t particle_count = emitter->m_Particles.Size();
+        if (particle_count == 0)
+            return 0.0f;
+
+        // Max extent of a quad, relative to the particle size (see UpdateRenderData)
+        const AnimationData& anim_data = emitter->m_AnimationData;
+        bool anim_playing = anim_data.m_Playback != ANIM_PLAYBACK_NONE && anim_data.m_EndTile - anim_data.m_StartTile > 1;
+        bool anim_auto_size = (ddf->m_SizeMode == SIZE_MODE_AUTO) && (anim_data.m_TexDims != 0x0) && anim_playing;
+        float extent = 0.5f;
+        if (anim_auto_size)
+        {
+            for (uint32_t tile = anim_data.m_StartTile; tile < anim_data.m_EndTile; ++tile)
+            {
+                const float* td = &anim_data.m_TexDims[tile << 1];
+                extent = dmMath::Max(extent, dmMath::Max(td[0], td[1]) * 0.5f);
+            }
+        }
+
+        dmTransform::TransformS1 emission_transform;
+        emission_transform.SetIdentity();
+        if (ddf->m_Space == EMISSION_SPACE_EMITTER)
+        {
+            emission_transform = instance->m_WorldTransform;
+        }
+        // Half diagonal of the quad
+        extent *= fabsf(emission_transform.GetScale()) * 1.4143f;
+
+        float radius = 0.0f;
+        float* const* s = emitter->m_Particles.m_Streams;
+        for (uint32_t i = 0; i < particle_count; ++i)
+        {
+            float size_x = s[PARTICLE_STREAM_SCALE_X][i];
+            float size_y = s[PARTICLE_STREAM_SCALE_Y][i];
+            if (!anim_auto_size)
+            {
+                size_x *= s[PARTICLE_STREAM_SOURCE_SIZE][i];
+                size_y *= s[PARTICLE_STREAM_SOURCE_SIZE][i];
+            }
+            float particle_extent = dmMath::Max(fabsf(size_x), fabsf(size_y)) * extent;
+            Point3 position(s[PARTICLE_STREAM_POSITION_X][i], s[PARTICLE_STREAM_POSITION_Y][i], s[PARTICLE_STREAM_POSITION_Z][i]);
+            float distance = length(dmTransform::Apply(emission_transform, position) - emitter_position);
+            radius = dmMath::Max(radius, distance + particle_extent);
+        }
+        return radius;
+    }
+
     // Update render data for the emitter at the specified index
     void UpdateEmitterRenderData(HInstance instance, uint32_t emitter_index, Instance* inst, Emitter* emitter, dmParticleDDF::Emitter* ddf)
     {
@@ -1858,6 +2622,7 @@ namespace dmParticle
         dmParticle::EmitterPrototype* emitter_proto = &inst->m_Prototype->m_Emitters[emitter_index];
 
         render_data.m_Transform = world;
+        render_data.m_BoundRadius = CalculateEmitterBoundRadius(inst, emitter, ddf, Point3(world.getTranslation()));
         render_data.m_Material = emitter_proto->m_Material;
         render_data.m_BlendMode = emitter_proto->m_BlendMode;
         render_data.m_Texture = emitter->m_AnimationData.m_Texture;
@@ -16,6 +16,7 @@
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 #include <dlib/configfile.h>
 #include <dlib/hash.h>
+#include <dlib/job_pool.h>
 #include <ddf/ddf.h>
 #include "particle/particle_ddf.h"
 
@@ -149,6 +150,8 @@ namespace dmParticle
         uint32_t                    m_EmitterIndex;
         uint32_t                    m_MixedHash;
         uint32_t                    m_MixedHashNoMaterial;
+        /// Radius of a sphere around the emitter position (translation of m_Transform) that contains all particles
+        float                       m_BoundRadius;
     };
 
     /**
@@ -266,6 +269,14 @@ namespace dmParticle
      */
     DM_PARTICLE_PROTO(void, SetContextMaxParticleCount, HParticleContext context, uint32_t max_particle_count);
 
+    /**
+     * Set the job pool used to update the emitters and generate their vertex data in parallel.
+     * The emitters are seeded individually, so the result is the same regardless of the number of workers.
+     * @param context Context to update.
+     * @param job_pool Job pool, or 0x0 to update on the calling thread only
+     */
+    void SetJobPool(HParticleContext context, dmJobPool::HJobPool job_pool);
+
     /**
      * Create an instance from the supplied path and fetch resources using the supplied factory.
      * @param context Context in which to create the instance, must be valid.
@@ -380,6 +391,20 @@ namespace dmParticle
      */
     DM_PARTICLE_PROTO(void, GenerateVertexData, HParticleContext context, float dt, HInstance instance, uint32_t emitter_index, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format);
 
+    /**
+     * Generates vertex data for several emitters, in the same way as calling GenerateVertexData for each of them in order.
+     * Large batches are generated in parallel on the job pool of the context, see SetJobPool.
+     * @param context Particle context
+     * @param dt Time step.
+     * @param emitters Render data of the emitters to generate vertex data for
+     * @param emitter_count Number of emitters
+     * @param vertex_buffer Vertex buffer into which to store the particle vertex data. If this is 0x0, no data will be generated.
+     * @param vertex_buffer_size Size in bytes of the supplied vertex buffer.
+     * @param out_vertex_buffer_size Size in bytes of the total data written to vertex buffer.
+     * @param vertex_format Which vertex format to use
+     */
+    void GenerateVertexDataBatch(HParticleContext context, float dt, const EmitterRenderData* const* emitters, uint32_t emitter_count, const Vector4& color, void* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* out_vertex_buffer_size, ParticleVertexFormat vertex_format);
+
     /**
      * Debug render the status of the instances within the specified context.
      * @param context Context of the instances to render.
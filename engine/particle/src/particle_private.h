@@ -16,6 +16,7 @@
 
 #include <dlib/configfile.h>
 #include <dlib/index_pool.h>
+#include <dlib/job_pool.h>
 #include <dlib/transform.h>
 
 #include "particle/particle_ddf.h"
@@ -24,6 +25,8 @@ namespace dmParticle
 {
     /// Number of samples per property (spline => linear segments)
     static const uint32_t PROPERTY_SAMPLE_COUNT     = 64;
+    /// Max number of state changes of an emitter during one update (prespawn -> spawning -> postspawn -> sleeping)
+    static const uint32_t MAX_EMITTER_STATE_CHANGES = 3;
 
     struct EmitterPrototype;
     struct Prototype;
@@ -35,14 +38,61 @@ namespace dmParticle
     {
         struct
         {
-            uint32_t m_Index : 16;  // Index is used to ensure stable sort
-            uint32_t m_LifeTime : 16; // Quantified relative life time
+            uint32_t m_Index;       // Index is used to ensure stable sort
+            uint32_t m_LifeTime;    // Quantified relative life time
         };
-        uint32_t     m_Key;
+        uint64_t     m_Key;
     };
 
     /**
-     * Representation of a particle.
+     * Particle attributes, each one is stored in a separate stream of the particle buffer.
+     */
+    enum ParticleStream
+    {
+        PARTICLE_STREAM_POSITION_X,
+        PARTICLE_STREAM_POSITION_Y,
+        PARTICLE_STREAM_POSITION_Z,
+        PARTICLE_STREAM_SOURCE_ROTATION_X,
+        PARTICLE_STREAM_SOURCE_ROTATION_Y,
+        PARTICLE_STREAM_SOURCE_ROTATION_Z,
+        PARTICLE_STREAM_SOURCE_ROTATION_W,
+        PARTICLE_STREAM_ROTATION_X,
+        PARTICLE_STREAM_ROTATION_Y,
+        PARTICLE_STREAM_ROTATION_Z,
+        PARTICLE_STREAM_ROTATION_W,
+        PARTICLE_STREAM_VELOCITY_X,
+        PARTICLE_STREAM_VELOCITY_Y,
+        PARTICLE_STREAM_VELOCITY_Z,
+        PARTICLE_STREAM_TIME_LEFT,
+        PARTICLE_STREAM_MAX_LIFE_TIME,
+        PARTICLE_STREAM_OO_MAX_LIFE_TIME,
+        PARTICLE_STREAM_SPREAD_FACTOR,
+        PARTICLE_STREAM_SOURCE_SIZE,
+        PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_X,
+        PARTICLE_STREAM_SOURCE_STRETCH_FACTOR_Y,
+        PARTICLE_STREAM_SOURCE_COLOR_R,
+        PARTICLE_STREAM_SOURCE_COLOR_G,
+        PARTICLE_STREAM_SOURCE_COLOR_B,
+        PARTICLE_STREAM_SOURCE_COLOR_A,
+        PARTICLE_STREAM_COLOR_R,
+        PARTICLE_STREAM_COLOR_G,
+        PARTICLE_STREAM_COLOR_B,
+        PARTICLE_STREAM_COLOR_A,
+        PARTICLE_STREAM_SCALE_X,
+        PARTICLE_STREAM_SCALE_Y,
+        PARTICLE_STREAM_SCALE_Z,
+        PARTICLE_STREAM_STRETCH_FACTOR_X,
+        PARTICLE_STREAM_STRETCH_FACTOR_Y,
+        PARTICLE_STREAM_SOURCE_ANGULAR_VELOCITY,
+        PARTICLE_STREAM_COUNT
+    };
+
+    /// Number of particles simulated together, the stream capacity is padded to a multiple of this
+    static const uint32_t PARTICLE_LANE_COUNT = 4;
+
+    /**
+     * Representation of a single particle, gathered from or scattered into a particle buffer.
+     * Used when spawning particles and to inspect them.
      *
      * TODO Separate source state from current (chaining modifiers)
      */
@@ -64,7 +114,6 @@ namespace dmParticle
         GET_SET(Scale, Vector3)
         GET_SET(SourceColor, Vector4)
         GET_SET(Color, Vector4)
-        GET_SET(SortKey, SortKey)
 #undef GET_SET
 
         /// Position, which is defined in emitter space or world space depending on how the emitter which spawned the particles is tweaked.
@@ -92,8 +141,6 @@ namespace dmParticle
         Vector4     m_Color;
         /// Particle scale
         Vector3     m_Scale;
-        // Sorting
-        SortKey     m_SortKey;
         /// Particle stretch factor
         float       m_StretchFactorX;
         float       m_StretchFactorY;
@@ -101,6 +148,35 @@ namespace dmParticle
         float       m_SourceAngularVelocity;
     };
 
+    /**
+     * Particle storage in structure-of-arrays form.
+     *
+     * Every attribute is stored in its own float stream so that the simulation can process
+     * PARTICLE_LANE_COUNT particles at a time. The streams are padded to a multiple of
+     * PARTICLE_LANE_COUNT, the padding is simulated along with the particles but never read back.
+     * Dead particles are removed by compacting the streams, which keeps the survivors in order.
+     */
+    struct ParticleBuffer
+    {
+        inline uint32_t Size() const        { return m_Size; }
+        inline uint32_t Capacity() const    { return m_Capacity; }
+        inline uint32_t Remaining() const   { return m_Capacity - m_Size; }
+        inline bool     Empty() const       { return m_Size == 0; }
+
+        /// Attribute streams, indexed by ParticleStream
+        float*      m_Streams[PARTICLE_STREAM_COUNT];
+        /// Spare stream, swapped with the attribute streams when reordering the particles
+        float*      m_Scratch;
+        /// Sort keys, valid after the keys have been generated for the frame
+        SortKey*    m_SortKeys;
+        /// Spare sort keys, swapped with the sort keys between the radix sort passes
+        SortKey*    m_SortKeysScratch;
+        /// Single allocation holding all of the above
+        void*       m_Memory;
+        uint32_t    m_Size;
+        uint32_t    m_Capacity;
+    };
+
     /**
      * Representation of an emitter.
      */
@@ -113,7 +189,7 @@ namespace dmParticle
 
         AnimationData           m_AnimationData;
         /// Particle buffer.
-        dmArray<Particle>       m_Particles;
+        ParticleBuffer          m_Particles;
         dmArray<RenderConstant> m_RenderConstants;
         Vector3                 m_Velocity;
         Point3                  m_LastPosition;
@@ -132,6 +208,11 @@ namespace dmParticle
         uint32_t                m_Seed;
         /// Which state the emitter is currently in
         EmitterState            m_State;
+        /// State changes during the last update, reported to the state changed callback once the update is done.
+        EmitterState            m_StateChanges[MAX_EMITTER_STATE_CHANGES];
+        uint32_t                m_StateChangeCount;
+        /// Number of particles that had to be sorted during the last update.
+        uint32_t                m_SortedParticleCount;
         /// Duration with spread applied, calculated on emitter creation.
         float                   m_Duration;
         /// Start delay with spread applied, calculated on emitter creation.
@@ -181,13 +262,32 @@ namespace dmParticle
         uint16_t                m_ScaleAlongZ : 1;
     };
 
+    /// Emitter to update in a context update
+    struct EmitterUpdate
+    {
+        Instance*   m_Instance;
+        HInstance   m_InstanceHandle;
+        uint32_t    m_EmitterIndex;
+    };
+
+    /// Range of particles of an emitter to generate vertex data for
+    struct VertexRange
+    {
+        Instance*   m_Instance;
+        uint32_t    m_EmitterIndex;
+        uint32_t    m_ParticleBegin;
+        uint32_t    m_ParticleEnd;
+        uint32_t    m_VertexIndex;
+    };
+
     /**
      * Representation of a context to hold a set of emitters.
      */
     struct Context
     {
         Context(uint32_t max_instance_count, uint32_t max_particle_count)
-        : m_MaxParticleCount(max_particle_count)
+        : m_JobPool(0x0)
+        , m_MaxParticleCount(max_particle_count)
         , m_NextVersionNumber(1)
         , m_InstanceSeeding(0)
         {
@@ -210,6 +310,12 @@ namespace dmParticle
         dmArray<Instance*>  m_Instances;
         /// Index pool used to index the instance buffer.
         dmIndexPool16       m_InstanceIndexPool;
+        /// Job pool used to update emitters and generate vertex data in parallel, may be 0x0.
+        dmJobPool::HJobPool m_JobPool;
+        /// Emitters of the current update, in update order.
+        dmArray<EmitterUpdate> m_EmitterUpdates;
+        /// Particle ranges of the current vertex data generation.
+        dmArray<VertexRange> m_VertexRanges;
         /// Maximum number of particles allowed
         uint32_t            m_MaxParticleCount;
         /// Version number used to create new handles.
@@ -286,6 +392,16 @@ namespace dmParticle
     };
 
     void UpdateRenderData(HParticleContext context, HInstance instance, uint32_t emitter_index);
+
+    /**
+     * Reallocate the particle buffer, living particles that fit within the new capacity are kept.
+     * A capacity of 0 frees the buffer.
+     */
+    void SetParticleCapacity(ParticleBuffer* buffer, uint32_t capacity);
+    /// Gather the attributes of the particle at the index
+    void GetParticle(const ParticleBuffer* buffer, uint32_t index, Particle* particle);
+    /// Scatter the attributes of the particle into the streams at the index
+    void SetParticle(ParticleBuffer* buffer, uint32_t index, const Particle* particle);
 }
 
 #endif // DM_PARTICLE_PRIVATE_H
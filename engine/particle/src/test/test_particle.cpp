@@ -19,6 +19,7 @@
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/time.h>
 #include <dlib/vmath.h>
 
 #include <ddf/ddf.h>
@@ -168,6 +169,13 @@ uint32_t ParticleCount(dmParticle::Emitter* emitter)
     return emitter->m_Particles.Size();
 }
 
+dmParticle::Particle GetParticle(dmParticle::Emitter* emitter, uint32_t index)
+{
+    dmParticle::Particle particle;
+    dmParticle::GetParticle(&emitter->m_Particles, index, &particle);
+    return particle;
+}
+
 bool LoadPrototype(const char* filename, dmParticle::HPrototype* prototype)
 {
     char path[128];
@@ -703,8 +711,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(10.0f, p->GetPosition().getX());
+    dmParticle::Particle p = GetParticle(e, 0);
+    ASSERT_EQ(10.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
     dmParticle::Particle_DeletePrototype(m_Prototype);
@@ -720,8 +728,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     e = GetEmitter(m_Context, instance, 0);
-    p = &e->m_Particles[0];
-    ASSERT_EQ(0.0f, p->GetPosition().getX());
+    p = GetParticle(e, 0);
+    ASSERT_EQ(0.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -750,7 +758,7 @@ TEST_F(ParticleTest, ParticleLife)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, e->m_Particles[0].GetTimeLeft());
+    ASSERT_EQ(0.0f, GetParticle(e, 0).GetTimeLeft());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -797,10 +805,10 @@ TEST_F(ParticleTest, ParticleVelocityStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(3.5f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(3.5f, GetParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(1.0f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(1.0f, GetParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -819,12 +827,12 @@ TEST_F(ParticleTest, ParticleStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(4.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, GetParticle(e, 0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(4.f, GetParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, GetParticle(e, 0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(2.f, GetParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -844,7 +852,7 @@ TEST_F(ParticleTest, ParticleOrientationMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetParticle(e, 0).GetRotation();
 
     // Represents an euler rotation of 90 deg around Z
     ASSERT_EQ(0.0f, q.getX());
@@ -871,7 +879,7 @@ TEST_F(ParticleTest, ParticleApplyLifeRotationToMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetParticle(e, 0).GetRotation();
 
     // Represents an euler rotation of 90deg particle life rotation combined with 90deg rotation along direction
     ASSERT_EQ(0.0f, q.getX());
@@ -904,7 +912,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetParticle(e, 0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -912,7 +920,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     ASSERT_NEAR(0.70710677, q.getW(), EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetParticle(e, 0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -937,7 +945,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetParticle(e, 0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -945,7 +953,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
     ASSERT_EQ(90.0f, r.getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetParticle(e, 0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -970,7 +978,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetParticle(e, 0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -978,7 +986,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
     ASSERT_EQ(0.0f, r.getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetParticle(e, 0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -1154,36 +1162,43 @@ TEST_F(ParticleTest, EvaluateEmitterProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = GetParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = GetParticle(e, 0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1205,10 +1220,10 @@ TEST_F(ParticleTest, EvaluateEmitterPropertySpread)
         dmParticle::StartInstance(m_Context, instance);
 
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &emitter->m_Particles[0];
+        dmParticle::Particle particle = GetParticle(emitter, 0);
         // NOTE size could potentially be 0, but not likely
-        ASSERT_NE(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
-        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle->GetScale()) * particle->GetSourceSize()));
+        ASSERT_NE(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
+        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle.GetScale()) * particle.GetSourceSize()));
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1237,37 +1252,44 @@ TEST_F(ParticleTest, EvaluateParticleProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = GetParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     // Updating with a full dt here will make the emitter reach its duration
     dmParticle::Update(m_Context, dt - EPSILON, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = GetParticle(e, 0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1288,8 +1310,8 @@ TEST_F(ParticleTest, ParticleInstanceScale)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(2.0f, minElem(p->GetScale()) * p->GetSourceSize());
+    dmParticle::Particle p = GetParticle(e, 0);
+    ASSERT_EQ(2.0f, minElem(p.GetScale()) * p.GetSourceSize());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1475,25 +1497,29 @@ TEST_F(ParticleTest, StableSort)
     ASSERT_EQ(particle_count, i->m_Emitters[0].m_Particles.Size());
 
     float x[particle_count];
-    dmParticle::Particle* p = &i->m_Emitters[0].m_Particles[0];
+    dmParticle::Emitter* e = &i->m_Emitters[0];
     // Store x-positions
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
         float f = (float)pi + 1;
         x[pi] = f;
-        Point3 pos = p[pi].GetPosition();
+        dmParticle::Particle p = GetParticle(e, pi);
+        Point3 pos = p.GetPosition();
         pos.setX(f);
-        p[pi].SetPosition(pos);
+        p.SetPosition(pos);
+        dmParticle::SetParticle(&e->m_Particles, pi, &p);
     }
     // Disturb order by altering a few particles
     const uint32_t disturb_count = particle_count / 2;
     for (uint32_t d = 0; d < disturb_count; ++d)
     {
-        p[d].SetTimeLeft(p[d].GetTimeLeft() - dt);
+        dmParticle::Particle p = GetParticle(e, d);
+        p.SetTimeLeft(p.GetTimeLeft() - dt);
         x[d] += particle_count;
-        Point3 pos = p[d].GetPosition();
+        Point3 pos = p.GetPosition();
         pos.setX(x[d]);
-        p[d].SetPosition(pos);
+        p.SetPosition(pos);
+        dmParticle::SetParticle(&e->m_Particles, d, &p);
     }
     // Sort
     dmParticle::Update(m_Context, dt, 0x0);
@@ -1502,8 +1528,43 @@ TEST_F(ParticleTest, StableSort)
     // Verify order of undisturbed
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
-        ASSERT_EQ(x[pi], p[pi].GetPosition().getX());
+        ASSERT_EQ(x[pi], GetParticle(e, pi).GetPosition().getX());
+    }
+
+    dmParticle::DestroyInstance(m_Context, instance);
+}
+
+// Particles of emitters with a constant life time are spawned in order and never need to be sorted
+TEST_F(ParticleTest, SortSkip)
+{
+    float dt = 1.0f / 60.0f;
+
+    ASSERT_TRUE(LoadPrototype("sort_skip.particlefxc", &m_Prototype));
+    dmParticle::HInstance instance = dmParticle::CreateInstance(m_Context, m_Prototype, 0x0);
+    dmParticle::StartInstance(m_Context, instance);
+
+    uint32_t sorted_count[2] = {0, 0};
+    for (uint32_t frame = 0; frame < 120; ++frame)
+    {
+        dmParticle::Update(m_Context, dt, 0x0);
+        for (uint32_t ei = 0; ei < 2; ++ei)
+        {
+            dmParticle::Emitter* e = GetEmitter(m_Context, instance, ei);
+            sorted_count[ei] += e->m_SortedParticleCount;
+            ASSERT_LT(0u, e->m_Particles.Size());
+            // Youngest first, within the precision of the sort key which saturates at the max life time
+            float max_life_time = m_Prototype->m_Emitters[ei].m_MaxParticleLifeTime;
+            float prev_time_left = dmMath::Min(GetParticle(e, 0).GetTimeLeft(), max_life_time);
+            for (uint32_t pi = 1; pi < e->m_Particles.Size(); ++pi)
+            {
+                float time_left = dmMath::Min(GetParticle(e, pi).GetTimeLeft(), max_life_time);
+                ASSERT_GE(prev_time_left + 0.0001f, time_left);
+                prev_time_left = time_left;
+            }
+        }
     }
+    ASSERT_EQ(0u, sorted_count[0]);
+    ASSERT_LT(0u, sorted_count[1]);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1535,7 +1596,7 @@ TEST_F(ParticleTest, ReloadInstance)
     ASSERT_EQ(1u, e->m_Particles.Size());
 
     dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    original_particle = GetParticle(e, 0);
 
     uint32_t seed = e->m_Seed;
     float timer = e->m_Timer;
@@ -1546,8 +1607,8 @@ TEST_F(ParticleTest, ReloadInstance)
     ASSERT_EQ(timer, e->m_Timer);
     ASSERT_EQ(seed, e->m_Seed);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle = GetParticle(e, 0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::Emitter* e1 = GetEmitter(m_Context, instance, 1);
     ASSERT_EQ(1u, e1->m_Particles.Size());
@@ -1557,8 +1618,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(1u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     // Test reload with max_particle_count changed
     ASSERT_TRUE(ReloadPrototype("reload3.particlefxc", m_Prototype));
@@ -1566,8 +1627,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(2u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    particle = GetParticle(e, 0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1595,7 +1656,7 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     float emitter_timer = e->m_Timer;
 
     dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    original_particle = GetParticle(e, 0);
 
     ASSERT_TRUE(ReloadPrototype("reload_loop.particlefxc", m_Prototype));
     dmParticle::ReloadInstance(m_Context, instance, true);
@@ -1604,8 +1665,8 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     ASSERT_EQ(1u, e->m_Particles.Size());
     ASSERT_EQ(emitter_timer, e->m_Timer);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle = GetParticle(e, 0);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1662,19 +1723,19 @@ TEST_F(ParticleTest, AccelerationWorld)
 
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI * 0.5f));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1698,8 +1759,8 @@ TEST_F(ParticleTest, AccelerationScaledEmitter)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = GetParticle(&inst->m_Emitters[0], 0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1729,8 +1790,8 @@ TEST_F(ParticleTest, AccelerationScaledWorld)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = GetParticle(&inst->m_Emitters[0], 0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1752,19 +1813,19 @@ TEST_F(ParticleTest, AccelerationEmitter)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1780,22 +1841,22 @@ TEST_F(ParticleTest, AccelerationAnimated)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_LT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetParticle(emitter, 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_LT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetParticle(emitter, 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_GT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetParticle(emitter, 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_GT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1812,8 +1873,8 @@ TEST_F(ParticleTest, DragNoDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1830,8 +1891,8 @@ TEST_F(ParticleTest, DragDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    Vector3 velocity = particle->GetVelocity();
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    Vector3 velocity = particle.GetVelocity();
     ASSERT_NEAR(0.0f, velocity.getX(), EPSILON);
     ASSERT_LT(0.0f, velocity.getY());
     ASSERT_EQ(0.0f, velocity.getZ());
@@ -1851,8 +1912,8 @@ TEST_F(ParticleTest, DragBigMagnitude)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0u, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0u, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1869,9 +1930,9 @@ TEST_F(ParticleTest, Radial)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1888,16 +1949,16 @@ TEST_F(ParticleTest, RadialMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1915,8 +1976,8 @@ TEST_F(ParticleTest, RadialEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1933,10 +1994,10 @@ TEST_F(ParticleTest, Vortex)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1953,16 +2014,16 @@ TEST_F(ParticleTest, VortexMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1979,10 +2040,10 @@ TEST_F(ParticleTest, VortexEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2058,8 +2119,8 @@ TEST_F(ParticleTest, InheritVelocity)
     dmParticle::SetPosition(m_Context, instance, Point3(10, 0, 0));
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, lengthSqr(e1->m_Particles[0].GetVelocity()));
-    ASSERT_NE(0.0f, lengthSqr(e2->m_Particles[0].GetVelocity()));
+    ASSERT_EQ(0.0f, lengthSqr(GetParticle(e1, 0).GetVelocity()));
+    ASSERT_NE(0.0f, lengthSqr(GetParticle(e2, 0).GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2092,6 +2153,111 @@ TEST_F(ParticleTest, Stats)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+// Updating and generating vertex data on a job pool should give the same result as doing it on one thread
+TEST_F(ParticleTest, JobPool)
+{
+    const uint32_t instance_count = 2;
+    const uint32_t emitter_count = 2;
+    const uint32_t max_particle_count = instance_count * emitter_count * 3000;
+    float dt = 1.0f / 60.0f;
+
+    ASSERT_TRUE(LoadPrototype("job_pool.particlefxc", &m_Prototype));
+
+    dmJobPool::HJobPool job_pool = dmJobPool::New(3, "particle_test");
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(max_particle_count, dmParticle::PARTICLE_GO);
+    dmParticle::HParticleContext contexts[2];
+    uint8_t* vertex_buffers[2];
+    dmParticle::EmitterRenderData render_data[2][instance_count * emitter_count];
+    const dmParticle::EmitterRenderData* emitters[2][instance_count * emitter_count];
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        contexts[c] = dmParticle::CreateContext(instance_count, max_particle_count);
+        vertex_buffers[c] = new uint8_t[vertex_buffer_size];
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            dmParticle::HInstance instance = dmParticle::CreateInstance(contexts[c], m_Prototype, 0x0);
+            dmParticle::SetPosition(contexts[c], instance, Point3(i * 10.0f, 0.0f, 0.0f));
+            for (uint32_t e = 0; e < emitter_count; ++e)
+            {
+                uint32_t index = i * emitter_count + e;
+                // Same seeds in both contexts
+                GetEmitter(contexts[c], instance, e)->m_Seed = index + 1;
+                render_data[c][index].m_Instance = instance;
+                render_data[c][index].m_EmitterIndex = e;
+                emitters[c][index] = &render_data[c][index];
+            }
+            dmParticle::StartInstance(contexts[c], instance);
+        }
+    }
+    dmParticle::SetJobPool(contexts[1], job_pool);
+
+    for (uint32_t frame = 0; frame < 30; ++frame)
+    {
+        uint32_t out_vertex_buffer_sizes[2] = { 0, 0 };
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            dmParticle::Update(contexts[c], dt, 0x0);
+            dmParticle::GenerateVertexDataBatch(contexts[c], dt, emitters[c], instance_count * emitter_count, Vector4(1,1,1,1), vertex_buffers[c], vertex_buffer_size, &out_vertex_buffer_sizes[c], dmParticle::PARTICLE_GO);
+        }
+        ASSERT_NE(0U, out_vertex_buffer_sizes[0]);
+        ASSERT_EQ(out_vertex_buffer_sizes[0], out_vertex_buffer_sizes[1]);
+        ASSERT_EQ(0, memcmp(vertex_buffers[0], vertex_buffers[1], out_vertex_buffer_sizes[0]));
+    }
+
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            dmParticle::DestroyInstance(contexts[c], render_data[c][i * emitter_count].m_Instance);
+        }
+        dmParticle::DestroyContext(contexts[c]);
+        delete [] vertex_buffers[c];
+    }
+    dmJobPool::Delete(job_pool);
+}
+
+// Simulates and renders a full emitter with all modifier types, to track the particle throughput
+TEST_F(ParticleTest, Throughput)
+{
+    const uint32_t particle_count = 100000;
+    const uint32_t frame_count = 60;
+    float dt = 1.0f / 60.0f;
+
+    dmParticle::HParticleContext context = dmParticle::CreateContext(1, particle_count);
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(particle_count, dmParticle::PARTICLE_GO);
+    uint8_t* vertex_buffer = new uint8_t[vertex_buffer_size];
+
+    ASSERT_TRUE(LoadPrototype("throughput.particlefxc", &m_Prototype));
+    dmParticle::HInstance instance = dmParticle::CreateInstance(context, m_Prototype, 0x0);
+    dmParticle::StartInstance(context, instance);
+    dmParticle::Update(context, dt, 0x0);
+    ASSERT_EQ(particle_count, ParticleCount(GetEmitter(context, instance, 0)));
+
+    uint64_t update_time = 0;
+    uint64_t render_time = 0;
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        uint64_t start = dmTime::GetTime();
+        dmParticle::Update(context, dt, 0x0);
+        uint64_t end = dmTime::GetTime();
+        update_time += end - start;
+
+        uint32_t out_vertex_buffer_size = 0;
+        start = end;
+        dmParticle::GenerateVertexData(context, dt, instance, 0, Vector4(1,1,1,1), (void*)vertex_buffer, vertex_buffer_size, &out_vertex_buffer_size, dmParticle::PARTICLE_GO);
+        render_time += dmTime::GetTime() - start;
+        ASSERT_EQ(vertex_buffer_size, out_vertex_buffer_size);
+    }
+    ASSERT_EQ(particle_count, ParticleCount(GetEmitter(context, instance, 0)));
+
+    printf("Particle throughput, %u particles: update %7.3f ms/frame, vertex data %7.3f ms/frame\n", particle_count,
+        update_time / (1000.0f * frame_count), render_time / (1000.0f * frame_count));
+
+    dmParticle::DestroyInstance(context, instance);
+    dmParticle::DestroyContext(context);
+    delete [] vertex_buffer;
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
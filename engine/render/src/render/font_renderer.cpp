@@ -45,6 +45,27 @@ namespace dmRender
         SHADOW  = 0x4
     };
 
+    static const uint32_t INVALID_TEXT_LAYOUT = 0xffffffff;
+
+    // A segment of the top edge of the packed area in the glyph cache
+    struct GlyphCacheNode
+    {
+        uint32_t m_X;
+        uint32_t m_Y;
+        uint32_t m_Width;
+    };
+
+    struct GlyphCacheRect
+    {
+        uint32_t m_X;
+        uint32_t m_Y;
+        uint32_t m_Width;
+        uint32_t m_Height;
+    };
+
+    // Changed parts of the glyph cache that are uploaded at the end of the frame. Beyond this, the rects are merged.
+    const uint32_t MAX_GLYPH_CACHE_DIRTY_RECTS = 8;
+
     FontMapParams::FontMapParams()
     : m_Glyphs()
     , m_ShadowX(0.0f)
@@ -81,18 +102,24 @@ namespace dmRender
         , m_CacheWidth(0)
         , m_CacheHeight(0)
         , m_GlyphData(0)
-        , m_Cache(0)
-        , m_CacheCursor(0)
-        , m_CacheColumns(0)
-        , m_CacheRows(0)
+        , m_CacheData(0)
+        , m_CacheHead(0)
+        , m_CacheTail(0)
+        , m_DirtyTextContext(0)
+        , m_CacheHits(0)
+        , m_CacheMisses(0)
+        , m_CacheEvictions(0)
+        , m_CacheUploadSize(0)
         , m_CellTempData(0)
         , m_CacheCellWidth(0)
         , m_CacheCellHeight(0)
         , m_CacheCellMaxAscent(0)
         , m_CacheCellPadding(0)
+        , m_CacheChannels(1)
         , m_LayerMask(FACE)
+        , m_LayoutVersion(0)
         {
-
+            m_CacheDirtyRects.SetCapacity(MAX_GLYPH_CACHE_DIRTY_RECTS);
         }
 
         ~FontMap()
@@ -100,8 +127,8 @@ namespace dmRender
             if (m_GlyphData) {
                 free(m_GlyphData);
             }
-            if (m_Cache) {
-                free(m_Cache);
+            if (m_CacheData) {
+                free(m_CacheData);
             }
             if (m_CellTempData) {
                 free(m_CellTempData);
@@ -128,14 +155,23 @@ namespace dmRender
         uint32_t                m_CacheHeight;
         void*                   m_GlyphData;
 
-        Glyph**                 m_Cache;
-        uint32_t                m_CacheCursor;
         dmGraphics::TextureFormat m_CacheFormat;
         dmGraphics::TextureFilter m_MinFilter;
         dmGraphics::TextureFilter m_MagFilter;
 
-        uint32_t                m_CacheColumns;
-        uint32_t                m_CacheRows;
+        // The glyphs are packed into a copy of the cache texture, which is uploaded once per frame
+        uint8_t*                m_CacheData;
+        dmArray<GlyphCacheNode> m_CacheSkyline;
+        dmArray<GlyphCacheRect> m_CacheFreeRects; // Space left by evicted glyphs
+        Glyph*                  m_CacheHead; // Most recently used
+        Glyph*                  m_CacheTail; // Least recently used
+        dmArray<GlyphCacheRect> m_CacheDirtyRects;
+        // The text context that has the font map in its dirty list, if any
+        TextContext*            m_DirtyTextContext;
+        uint32_t                m_CacheHits;
+        uint32_t                m_CacheMisses;
+        uint32_t                m_CacheEvictions;
+        uint32_t                m_CacheUploadSize;
 
         uint8_t*                m_CellTempData; // a temporary unpack buffer for the compressed glyphs
 
@@ -143,24 +179,50 @@ namespace dmRender
         uint32_t                m_CacheCellHeight;
         uint32_t                m_CacheCellMaxAscent;
         uint8_t                 m_CacheCellPadding;
+        uint8_t                 m_CacheChannels;
         uint8_t                 m_LayerMask;
+        // Unique for each set of glyphs, and part of the key of the cached text layouts
+        uint32_t                m_LayoutVersion;
     };
 
+    static uint32_t g_FontMapLayoutVersion = 0;
+
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n);
 
-    static void InitFontmap(FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
+    static void PutGlyphs(FontMap* font_map, const dmArray<Glyph>& glyphs)
     {
-        uint8_t bpp = params.m_GlyphChannels;
-        uint32_t data_size = tex_params.m_Width * tex_params.m_Height * bpp;
-        tex_params.m_Data = malloc(data_size);
-        tex_params.m_DataSize = data_size;
-        memset((void*)tex_params.m_Data, init_val, tex_params.m_DataSize);
+        font_map->m_Glyphs.SetCapacity((3 * glyphs.Size()) / 2, glyphs.Size());
+        for (uint32_t i = 0; i < glyphs.Size(); ++i) {
+            Glyph g = glyphs[i];
+            g.m_InCache = false;
+            g.m_CachePrev = 0x0;
+            g.m_CacheNext = 0x0;
+            font_map->m_Glyphs.Put(g.m_Character, g);
+        }
     }
 
-    static void CleanupFontmap(dmGraphics::TextureParams& tex_params)
+    // Empties the glyph cache, without touching the glyphs
+    static void ResetGlyphCache(FontMap* font_map)
     {
-        free((void*)tex_params.m_Data);
-        tex_params.m_DataSize = 0;
+        if (font_map->m_CacheSkyline.Capacity() != font_map->m_CacheWidth + 1) {
+            // Every node is at least one pixel wide, plus one while inserting
+            font_map->m_CacheSkyline.SetCapacity(font_map->m_CacheWidth + 1);
+        }
+        font_map->m_CacheSkyline.SetSize(1);
+        GlyphCacheNode& node = font_map->m_CacheSkyline[0];
+        node.m_X = 0;
+        node.m_Y = 0;
+        node.m_Width = font_map->m_CacheWidth;
+        font_map->m_CacheFreeRects.SetSize(0);
+        font_map->m_CacheHead = 0x0;
+        font_map->m_CacheTail = 0x0;
+    }
+
+    static void InitGlyphCache(FontMap* font_map)
+    {
+        ResetGlyphCache(font_map);
+        font_map->m_CacheData = (uint8_t*)calloc(font_map->m_CacheWidth * font_map->m_CacheHeight, font_map->m_CacheChannels);
+        font_map->m_CacheDirtyRects.SetSize(0);
     }
 
     // Font maps have no mips, so we need to make sure we use a supported min filter
@@ -182,13 +244,8 @@ namespace dmRender
     {
         FontMap* font_map = new FontMap();
         font_map->m_Material = 0;
-
-        const dmArray<Glyph>& glyphs = params.m_Glyphs;
-        font_map->m_Glyphs.SetCapacity((3 * glyphs.Size()) / 2, glyphs.Size());
-        for (uint32_t i = 0; i < glyphs.Size(); ++i) {
-            const Glyph& g = glyphs[i];
-            font_map->m_Glyphs.Put(g.m_Character, g);
-        }
+        font_map->m_LayoutVersion = ++g_FontMapLayoutVersion;
+        PutGlyphs(font_map, params.m_Glyphs);
 
         font_map->m_ShadowX = params.m_ShadowX;
         font_map->m_ShadowY = params.m_ShadowY;
@@ -212,12 +269,9 @@ namespace dmRender
         font_map->m_CacheCellMaxAscent = params.m_CacheCellMaxAscent;
         font_map->m_CacheCellPadding = params.m_CacheCellPadding;
 
-        font_map->m_CacheColumns = params.m_CacheWidth / params.m_CacheCellWidth;
-        font_map->m_CacheRows = params.m_CacheHeight / params.m_CacheCellHeight;
-        uint32_t cell_count = font_map->m_CacheColumns * font_map->m_CacheRows;
-
         font_map->m_CellTempData = (uint8_t*)malloc(font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4);
 
+        font_map->m_CacheChannels = params.m_GlyphChannels;
         switch (params.m_GlyphChannels)
         {
             case 1:
@@ -247,8 +301,7 @@ namespace dmRender
             font_map->m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
         }
 
-        font_map->m_Cache = (Glyph**)malloc(sizeof(Glyph*) * cell_count);
-        memset(font_map->m_Cache, 0, sizeof(Glyph*) * cell_count);
+        InitGlyphCache(font_map);
 
         // create new texture to be used as a cache
         dmGraphics::TextureCreationParams tex_create_params;
@@ -267,34 +320,41 @@ namespace dmRender
         tex_params.m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
         font_map->m_Texture = dmGraphics::NewTexture(graphics_context, tex_create_params);
 
-        InitFontmap(params, tex_params, 0);
+        tex_params.m_Data = font_map->m_CacheData;
+        tex_params.m_DataSize = params.m_CacheWidth * params.m_CacheHeight * params.m_GlyphChannels;
         dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-        CleanupFontmap(tex_params);
 
         return font_map;
     }
 
     void DeleteFontMap(HFontMap font_map)
     {
+        // Don't leave a dangling pointer for the upload at the end of the frame
+        if (font_map->m_DirtyTextContext) {
+            dmArray<HFontMap>& dirty = font_map->m_DirtyTextContext->m_DirtyFontMaps;
+            for (uint32_t i = 0; i < dirty.Size(); ++i) {
+                if (dirty[i] == font_map) {
+                    dirty.EraseSwap(i);
+                    break;
+                }
+            }
+        }
         delete font_map;
     }
 
     void SetFontMap(HFontMap font_map, FontMapParams& params)
     {
-        const dmArray<Glyph>& glyphs = params.m_Glyphs;
+        font_map->m_LayoutVersion = ++g_FontMapLayoutVersion;
         font_map->m_Glyphs.Clear();
-        font_map->m_Glyphs.SetCapacity((3 * glyphs.Size()) / 2, glyphs.Size());
-        for (uint32_t i = 0; i < glyphs.Size(); ++i) {
-            const Glyph& g = glyphs[i];
-            font_map->m_Glyphs.Put(g.m_Character, g);
-        }
+        PutGlyphs(font_map, params.m_Glyphs);
 
         // release previous glyph data bank
         if (font_map->m_GlyphData) {
             free(font_map->m_GlyphData);
-            free(font_map->m_Cache);
-            free(font_map->m_CellTempData);
         }
+        free(font_map->m_CacheData);
+        free(font_map->m_CellTempData);
+        font_map->m_CacheData = 0x0;
 
         font_map->m_ShadowX = params.m_ShadowX;
         font_map->m_ShadowY = params.m_ShadowY;
@@ -318,12 +378,9 @@ namespace dmRender
         font_map->m_CacheCellMaxAscent = params.m_CacheCellMaxAscent;
         font_map->m_CacheCellPadding = params.m_CacheCellPadding;
 
-        font_map->m_CacheColumns = params.m_CacheWidth / params.m_CacheCellWidth;
-        font_map->m_CacheRows = params.m_CacheHeight / params.m_CacheCellHeight;
-        uint32_t cell_count = font_map->m_CacheColumns * font_map->m_CacheRows;
-
         font_map->m_CellTempData = (uint8_t*)malloc(font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4);
 
+        font_map->m_CacheChannels = params.m_GlyphChannels;
         switch (params.m_GlyphChannels)
         {
             case 1:
@@ -341,19 +398,16 @@ namespace dmRender
                 return;
         };
 
-        font_map->m_Cache = (Glyph**)malloc(sizeof(Glyph*) * cell_count);
-        memset(font_map->m_Cache, 0, sizeof(Glyph*) * cell_count);
+        InitGlyphCache(font_map);
 
         dmGraphics::TextureParams tex_params;
         tex_params.m_Format = font_map->m_CacheFormat;
-        tex_params.m_Data = 0x0;
-        tex_params.m_DataSize = 0x0;
+        tex_params.m_Data = font_map->m_CacheData;
+        tex_params.m_DataSize = params.m_CacheWidth * params.m_CacheHeight * params.m_GlyphChannels;
         tex_params.m_Width = params.m_CacheWidth;
         tex_params.m_Height = params.m_CacheHeight;
 
-        InitFontmap(params, tex_params, 0);
         dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-        CleanupFontmap(tex_params);
     }
 
     dmGraphics::HTexture GetFontMapTexture(HFontMap font_map)
@@ -371,15 +425,31 @@ namespace dmRender
         return font_map->m_Material;
     }
 
+    // The quads are laid out as left-bottom, left-top, right-bottom, right-top
+    template <typename T>
+    static void FillGlyphQuadIndices(T* indices, uint32_t quad_count)
+    {
+        for (uint32_t i = 0; i < quad_count; ++i)
+        {
+            T v = (T)(i * 4);
+            *indices++ = v + 0;
+            *indices++ = v + 1;
+            *indices++ = v + 2;
+            *indices++ = v + 2;
+            *indices++ = v + 1;
+            *indices++ = v + 3;
+        }
+    }
+
     void InitializeTextContext(HRenderContext render_context, uint32_t max_characters)
     {
-        DM_STATIC_ASSERT(sizeof(GlyphVertex) % 16 == 0, Invalid_Struct_Size);
+        DM_STATIC_ASSERT(sizeof(GlyphVertex) == 48, Invalid_Struct_Size);
         DM_STATIC_ASSERT( MAX_FONT_RENDER_CONSTANTS == MAX_TEXT_RENDER_CONSTANTS, Constant_Arrays_Must_Have_Same_Size );
         DM_STATIC_ASSERT( MAX_FONT_RENDER_CONSTANTS == dmRender::RenderObject::MAX_CONSTANT_COUNT, Constant_Count_Must_Be_Equal );
 
         TextContext& text_context = render_context->m_TextContext;
 
-        text_context.m_MaxVertexCount = max_characters * 6; // 6 vertices per character
+        text_context.m_MaxVertexCount = max_characters * 4; // 4 vertices per character
         uint32_t buffer_size = sizeof(GlyphVertex) * text_context.m_MaxVertexCount;
         text_context.m_ClientBuffer = 0x0;
         text_context.m_VertexIndex = 0;
@@ -395,18 +465,39 @@ namespace dmRender
 
         dmGraphics::VertexElement ve[] =
         {
-                {"position", 0, 4, dmGraphics::TYPE_FLOAT, false},
-                {"texcoord0", 1, 2, dmGraphics::TYPE_FLOAT, false},
-                {"face_color", 2, 4, dmGraphics::TYPE_FLOAT, true},
-                {"outline_color", 3, 4, dmGraphics::TYPE_FLOAT, true},
-                {"shadow_color", 4, 4, dmGraphics::TYPE_FLOAT, true},
-                {"sdf_params", 5, 4, dmGraphics::TYPE_FLOAT, false},
-                {"layer_mask", 6, 3, dmGraphics::TYPE_FLOAT, false},
+                {"position", 0, 3, dmGraphics::TYPE_FLOAT, false},
+                {"texcoord0", 1, 2, dmGraphics::TYPE_UNSIGNED_SHORT, true},
+                {"face_color", 2, 4, dmGraphics::TYPE_UNSIGNED_BYTE, true},
+                {"outline_color", 3, 4, dmGraphics::TYPE_UNSIGNED_BYTE, true},
+                {"shadow_color", 4, 4, dmGraphics::TYPE_UNSIGNED_BYTE, true},
+                {"layer_mask", 5, 4, dmGraphics::TYPE_UNSIGNED_BYTE, true},
+                {"sdf_params", 6, 4, dmGraphics::TYPE_FLOAT, false},
         };
 
         text_context.m_VertexDecl = dmGraphics::NewVertexDeclaration(render_context->m_GraphicsContext, ve, sizeof(ve) / sizeof(dmGraphics::VertexElement), sizeof(GlyphVertex));
         text_context.m_VertexBuffer = dmGraphics::NewVertexBuffer(render_context->m_GraphicsContext, buffer_size, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
 
+        uint32_t max_quad_count = text_context.m_MaxVertexCount / 4;
+        uint32_t index_count = max_quad_count * 6;
+        uint32_t index_size;
+        void* indices;
+        if (text_context.m_MaxVertexCount <= 65536)
+        {
+            text_context.m_IndexType = dmGraphics::TYPE_UNSIGNED_SHORT;
+            index_size = sizeof(uint16_t);
+            indices = malloc(index_count * index_size);
+            FillGlyphQuadIndices<uint16_t>((uint16_t*)indices, max_quad_count);
+        }
+        else
+        {
+            text_context.m_IndexType = dmGraphics::TYPE_UNSIGNED_INT;
+            index_size = sizeof(uint32_t);
+            indices = malloc(index_count * index_size);
+            FillGlyphQuadIndices<uint32_t>((uint32_t*)indices, max_quad_count);
+        }
+        text_context.m_IndexBuffer = dmGraphics::NewIndexBuffer(render_context->m_GraphicsContext, index_count * index_size, indices, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        free(indices);
+
         // Arbitrary number
         const uint32_t max_batches = 128;
         text_context.m_RenderObjects.SetCapacity(max_batches);
@@ -417,6 +508,15 @@ namespace dmRender
         // NOTE: 8 is "arbitrary" heuristic
         text_context.m_TextEntries.SetCapacity(max_characters / 8);
 
+        // Room for the layouts of all texts in a frame
+        uint32_t layout_count = dmMath::Max(1U, max_characters / 8);
+        text_context.m_TextLayouts.SetCapacity(layout_count);
+        text_context.m_TextLayoutIndices.SetCapacity(dmMath::Max(1U, (3 * layout_count) / 2), layout_count);
+        text_context.m_TextLayoutHead = INVALID_TEXT_LAYOUT;
+        text_context.m_TextLayoutTail = INVALID_TEXT_LAYOUT;
+        text_context.m_TextLayoutHits = 0;
+        text_context.m_TextLayoutMisses = 0;
+
         for (uint32_t i = 0; i < text_context.m_RenderObjects.Capacity(); ++i)
         {
             RenderObject ro;
@@ -425,6 +525,8 @@ namespace dmRender
             ro.m_SetBlendFactors = 1;
             ro.m_VertexBuffer = text_context.m_VertexBuffer;
             ro.m_VertexDeclaration = text_context.m_VertexDecl;
+            ro.m_IndexBuffer = text_context.m_IndexBuffer;
+            ro.m_IndexType = text_context.m_IndexType;
             ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
             text_context.m_RenderObjects.Push(ro);
         }
@@ -433,8 +535,22 @@ namespace dmRender
     void FinalizeTextContext(HRenderContext render_context)
     {
         TextContext& text_context = render_context->m_TextContext;
+        for (uint32_t i = 0; i < text_context.m_TextLayouts.Size(); ++i)
+        {
+            free(text_context.m_TextLayouts[i].m_Glyphs);
+        }
+        text_context.m_TextLayouts.SetSize(0);
+        text_context.m_TextLayoutIndices.Clear();
+        // The font maps may outlive the context
+        for (uint32_t i = 0; i < text_context.m_DirtyFontMaps.Size(); ++i)
+        {
+            text_context.m_DirtyFontMaps[i]->m_DirtyTextContext = 0;
+            text_context.m_DirtyFontMaps[i]->m_CacheDirtyRects.SetSize(0);
+        }
+        text_context.m_DirtyFontMaps.SetSize(0);
         dmMemory::AlignedFree(text_context.m_ClientBuffer);
         dmGraphics::DeleteVertexBuffer(text_context.m_VertexBuffer);
+        dmGraphics::DeleteIndexBuffer(text_context.m_IndexBuffer);
         dmGraphics::DeleteVertexDeclaration(text_context.m_VertexDecl);
     }
 
@@ -455,6 +571,7 @@ namespace dmRender
     , m_LineBreak(false)
     , m_Align(TEXT_ALIGN_LEFT)
     , m_VAlign(TEXT_VALIGN_TOP)
+    , m_BoundRadius(0.0f)
     , m_StencilTestParamsSet(0)
     {
         m_StencilTestParams.Init();
@@ -529,6 +646,7 @@ namespace dmRender
         te.m_Height = params.m_Height;
         te.m_Leading = params.m_Leading;
         te.m_Tracking = params.m_Tracking;
+        te.m_BoundRadius = params.m_BoundRadius;
         te.m_LineBreak = params.m_LineBreak;
         te.m_Align = params.m_Align;
         te.m_VAlign = params.m_VAlign;
@@ -544,7 +662,7 @@ namespace dmRender
         text_context->m_TextEntries.Push(te);
     }
 
-    static Glyph* GetGlyph(HFontMap font_map, uint32_t c) {
+    Glyph* GetGlyph(HFontMap font_map, uint32_t c) {
         Glyph* g = font_map->m_Glyphs.Get(c);
         if (!g)
             g = font_map->m_Glyphs.Get(126U); // Fallback to ~
@@ -556,94 +674,496 @@ namespace dmRender
         return g;
     }
 
-    void AddGlyphToCache(HFontMap font_map, TextContext& text_context, Glyph* g, int16_t g_offset_y) {
-        uint32_t prev_cache_cursor = font_map->m_CacheCursor;
-        dmGraphics::TextureParams tex_params;
-        tex_params.m_SubUpdate = true;
-        tex_params.m_MipMap = 0;
-        tex_params.m_Format = font_map->m_CacheFormat;
-        tex_params.m_MinFilter = font_map->m_MinFilter;
-        tex_params.m_MagFilter = font_map->m_MagFilter;
-
-        // Locate a cache cell candidate
-        do {
-            uint32_t cur = font_map->m_CacheCursor++;
-            Glyph* candidate = font_map->m_Cache[cur];
-            font_map->m_CacheCursor = font_map->m_CacheCursor % (font_map->m_CacheColumns * font_map->m_CacheRows);
-            if (candidate == 0x0 || text_context.m_Frame != candidate->m_Frame) {
-
-                if (candidate) {
-                    candidate->m_InCache = false;
+    // Returns the lowest y where a rectangle fits on top of the skyline, starting at the node, or -1 if it doesn't fit
+    static int32_t FitSkyline(FontMap* font_map, uint32_t index, uint32_t width, uint32_t height)
+    {
+        const dmArray<GlyphCacheNode>& skyline = font_map->m_CacheSkyline;
+        if (skyline[index].m_X + width > font_map->m_CacheWidth) {
+            return -1;
+        }
+
+        // The nodes span the full width, so there are always nodes left while width_left > 0
+        uint32_t y = 0;
+        int32_t width_left = (int32_t)width;
+        while (width_left > 0) {
+            const GlyphCacheNode& node = skyline[index++];
+            y = dmMath::Max(y, node.m_Y);
+            if (y + height > font_map->m_CacheHeight) {
+                return -1;
+            }
+            width_left -= (int32_t)node.m_Width;
+        }
+        return (int32_t)y;
+    }
+
+    // Bottom-left packing: picks the position where the top of the rectangle is lowest
+    static bool AllocateFromSkyline(FontMap* font_map, uint32_t width, uint32_t height, uint32_t* out_x, uint32_t* out_y)
+    {
+        dmArray<GlyphCacheNode>& skyline = font_map->m_CacheSkyline;
+        uint32_t best_index = 0xffffffff;
+        uint32_t best_top = 0xffffffff;
+        uint32_t best_width = 0xffffffff;
+        uint32_t best_y = 0;
+        for (uint32_t i = 0; i < skyline.Size(); ++i) {
+            int32_t y = FitSkyline(font_map, i, width, height);
+            if (y < 0) {
+                continue;
+            }
+            uint32_t top = (uint32_t)y + height;
+            if (top < best_top || (top == best_top && skyline[i].m_Width < best_width)) {
+                best_index = i;
+                best_top = top;
+                best_width = skyline[i].m_Width;
+                best_y = (uint32_t)y;
+            }
+        }
+
+        if (best_index == 0xffffffff) {
+            return false;
+        }
+
+        GlyphCacheNode node;
+        node.m_X = skyline[best_index].m_X;
+        node.m_Y = best_top;
+        node.m_Width = width;
+
+        skyline.SetSize(skyline.Size() + 1);
+        GlyphCacheNode* nodes = skyline.Begin();
+        memmove(nodes + best_index + 1, nodes + best_index, (skyline.Size() - best_index - 1) * sizeof(GlyphCacheNode));
+        nodes[best_index] = node;
+
+        // Cut away the parts of the following nodes that are now covered
+        uint32_t i = best_index + 1;
+        while (i < skyline.Size()) {
+            uint32_t prev_end = skyline[i - 1].m_X + skyline[i - 1].m_Width;
+            GlyphCacheNode& n = skyline[i];
+            if (n.m_X >= prev_end) {
+                break;
+            }
+            uint32_t covered = prev_end - n.m_X;
+            if (n.m_Width > covered) {
+                n.m_X += covered;
+                n.m_Width -= covered;
+                break;
+            }
+            memmove(skyline.Begin() + i, skyline.Begin() + i + 1, (skyline.Size() - i - 1) * sizeof(GlyphCacheNode));
+            skyline.SetSize(skyline.Size() - 1);
+        }
+
+        // Merge neighbours at the same height
+        i = 0;
+        while (i + 1 < skyline.Size()) {
+            if (skyline[i].m_Y == skyline[i + 1].m_Y) {
+                skyline[i].m_Width += skyline[i + 1].m_Width;
+                memmove(skyline.Begin() + i + 1, skyline.Begin() + i + 2, (skyline.Size() - i - 2) * sizeof(GlyphCacheNode));
+                skyline.SetSize(skyline.Size() - 1);
+            } else {
+                ++i;
+            }
+        }
+
+        *out_x = node.m_X;
+        *out_y = best_y;
+        return true;
+    }
+
+    // Best fit among the rectangles left by evicted glyphs
+    static bool AllocateFromFreeRects(FontMap* font_map, uint32_t width, uint32_t height, uint32_t* out_x, uint32_t* out_y)
+    {
+        dmArray<GlyphCacheRect>& rects = font_map->m_CacheFreeRects;
+        uint32_t best_index = 0xffffffff;
+        uint32_t best_area = 0xffffffff;
+        for (uint32_t i = 0; i < rects.Size(); ++i) {
+            const GlyphCacheRect& r = rects[i];
+            uint32_t area = r.m_Width * r.m_Height;
+            if (r.m_Width >= width && r.m_Height >= height && area < best_area) {
+                best_index = i;
+                best_area = area;
+            }
+        }
+
+        if (best_index == 0xffffffff) {
+            return false;
+        }
+
+        GlyphCacheRect r = rects[best_index];
+        rects.EraseSwap(best_index);
+
+        // Split the remainder into the space to the right of, and below, the glyph
+        if (rects.Remaining() < 2) {
+            rects.OffsetCapacity(64);
+        }
+        if (r.m_Width > width) {
+            GlyphCacheRect right = { r.m_X + width, r.m_Y, r.m_Width - width, height };
+            rects.Push(right);
+        }
+        if (r.m_Height > height) {
+            GlyphCacheRect below = { r.m_X, r.m_Y + height, r.m_Width, r.m_Height - height };
+            rects.Push(below);
+        }
+
+        *out_x = r.m_X;
+        *out_y = r.m_Y;
+        return true;
+    }
+
+    static void ReleaseCacheRect(FontMap* font_map, GlyphCacheRect r)
+    {
+        // Merge with free rectangles sharing a full edge, so that larger glyphs may fit
+        dmArray<GlyphCacheRect>& rects = font_map->m_CacheFreeRects;
+        uint32_t i = 0;
+        while (i < rects.Size()) {
+            const GlyphCacheRect& f = rects[i];
+            bool merge_x = f.m_Y == r.m_Y && f.m_Height == r.m_Height && (f.m_X + f.m_Width == r.m_X || r.m_X + r.m_Width == f.m_X);
+            bool merge_y = f.m_X == r.m_X && f.m_Width == r.m_Width && (f.m_Y + f.m_Height == r.m_Y || r.m_Y + r.m_Height == f.m_Y);
+            if (merge_x) {
+                r.m_X = dmMath::Min(r.m_X, f.m_X);
+                r.m_Width += f.m_Width;
+            } else if (merge_y) {
+                r.m_Y = dmMath::Min(r.m_Y, f.m_Y);
+                r.m_Height += f.m_Height;
+            } else {
+                ++i;
+                continue;
+            }
+            rects.EraseSwap(i);
+            i = 0;
+        }
+
+        if (rects.Full()) {
+            rects.OffsetCapacity(64);
+        }
+        rects.Push(r);
+    }
+
+    static GlyphCacheRect GetGlyphCacheRect(FontMap* font_map, const Glyph* g)
+    {
+        GlyphCacheRect r;
+        r.m_X = g->m_X;
+        r.m_Y = g->m_Y;
+        r.m_Width = g->m_Width + font_map->m_CacheCellPadding*2;
+        r.m_Height = g->m_Ascent + g->m_Descent + font_map->m_CacheCellPadding*2;
+        return r;
+    }
+
+    static void UnlinkCachedGlyph(FontMap* font_map, Glyph* g)
+    {
+        if (g->m_CachePrev)
+            g->m_CachePrev->m_CacheNext = g->m_CacheNext;
+        else
+            font_map->m_CacheHead = g->m_CacheNext;
+        if (g->m_CacheNext)
+            g->m_CacheNext->m_CachePrev = g->m_CachePrev;
+        else
+            font_map->m_CacheTail = g->m_CachePrev;
+        g->m_CachePrev = 0x0;
+        g->m_CacheNext = 0x0;
+    }
+
+    static void LinkCachedGlyphFirst(FontMap* font_map, Glyph* g)
+    {
+        g->m_CachePrev = 0x0;
+        g->m_CacheNext = font_map->m_CacheHead;
+        if (font_map->m_CacheHead)
+            font_map->m_CacheHead->m_CachePrev = g;
+        else
+            font_map->m_CacheTail = g;
+        font_map->m_CacheHead = g;
+    }
+
+    static void EvictGlyph(FontMap* font_map, Glyph* g)
+    {
+        UnlinkCachedGlyph(font_map, g);
+        g->m_InCache = false;
+        ReleaseCacheRect(font_map, GetGlyphCacheRect(font_map, g));
+        ++font_map->m_CacheEvictions;
+    }
+
+    static GlyphCacheRect UnionCacheRect(const GlyphCacheRect& a, const GlyphCacheRect& b)
+    {
+        GlyphCacheRect r;
+        r.m_X = dmMath::Min(a.m_X, b.m_X);
+        r.m_Y = dmMath::Min(a.m_Y, b.m_Y);
+        r.m_Width = dmMath::Max(a.m_X + a.m_Width, b.m_X + b.m_Width) - r.m_X;
+        r.m_Height = dmMath::Max(a.m_Y + a.m_Height, b.m_Y + b.m_Height) - r.m_Y;
+        return r;
+    }
+
+    static void MarkGlyphCacheDirty(FontMap* font_map, TextContext& text_context, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+    {
+        if (font_map->m_DirtyTextContext == 0) {
+            dmArray<HFontMap>& dirty = text_context.m_DirtyFontMaps;
+            if (dirty.Full()) {
+                dirty.OffsetCapacity(8);
+            }
+            dirty.Push(font_map);
+            font_map->m_DirtyTextContext = &text_context;
+        }
+
+        GlyphCacheRect rect;
+        rect.m_X = x;
+        rect.m_Y = y;
+        rect.m_Width = width;
+        rect.m_Height = height;
+
+        // Glyphs placed next to each other on the same skyline segment share a rect, so that a text
+        // with many new glyphs is uploaded in a few rects. Otherwise merge with the rect that grows the least.
+        dmArray<GlyphCacheRect>& rects = font_map->m_CacheDirtyRects;
+        uint32_t best = rects.Size();
+        uint32_t best_growth = 0xffffffff;
+        for (uint32_t i = 0; i < rects.Size(); ++i) {
+            const GlyphCacheRect& r = rects[i];
+            if (r.m_Y == y && r.m_Height == height && (r.m_X + r.m_Width == x || x + width == r.m_X)) {
+                best = i;
+                break;
+            }
+            if (rects.Full()) {
+                GlyphCacheRect u = UnionCacheRect(r, rect);
+                uint32_t growth = u.m_Width * u.m_Height - r.m_Width * r.m_Height;
+                if (growth < best_growth) {
+                    best = i;
+                    best_growth = growth;
                 }
-                font_map->m_Cache[cur] = g;
-
-                uint32_t col = cur % font_map->m_CacheColumns;
-                uint32_t row = cur / font_map->m_CacheColumns;
-
-                g->m_X = col * font_map->m_CacheCellWidth;
-                g->m_Y = row * font_map->m_CacheCellHeight;
-                g->m_Frame = text_context.m_Frame;
-                g->m_InCache = true;
-
-                // Upload glyph data to GPU
-                tex_params.m_Width = g->m_Width + font_map->m_CacheCellPadding*2;
-                tex_params.m_Height = g->m_Ascent + g->m_Descent + font_map->m_CacheCellPadding*2;
-
-                uint8_t* glyph_data = (uint8_t*)(uint8_t*)font_map->m_GlyphData + g->m_GlyphDataOffset;
-                uint32_t glyph_data_size = g->m_GlyphDataSize-1; // The first byte is a header
-                uint8_t is_compressed = *glyph_data++;
-
-                if (is_compressed) {
-
-                    uint32_t bytes_per_pixel;
-                    dmWebP::TextureEncodeFormat encode_format;
-                    switch (font_map->m_CacheFormat) {
-                        case dmGraphics::TEXTURE_FORMAT_RGB:        bytes_per_pixel = 3;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGB888;
-                                                                    break;
-                        case dmGraphics::TEXTURE_FORMAT_RGBA:       bytes_per_pixel = 4;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGBA8888;
-                                                                    break;
-                        case dmGraphics::TEXTURE_FORMAT_LUMINANCE:
-                        default:                                    bytes_per_pixel = 1;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_L8;
-                    };
-
-                    dmWebP::Result result = dmWebP::DecodeCompressedTexture(glyph_data,
-                                                glyph_data_size,
-                                                font_map->m_CellTempData,
-                                                font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4, // the max size
-                                                tex_params.m_Width*bytes_per_pixel,
-                                                encode_format);
-
-                    if (result != dmWebP::RESULT_OK) {
-                        dmLogWarning("Failed to decompress glyph: %d", result);
-                    }
-                    tex_params.m_Data = font_map->m_CellTempData;
-                } else {
-                    tex_params.m_Data = glyph_data;
+            }
+        }
+        if (best < rects.Size()) {
+            rects[best] = UnionCacheRect(rects[best], rect);
+        } else {
+            rects.Push(rect);
+        }
+    }
+
+    // Uploads the parts of the glyph cache that changed since the last upload, one rect at a time
+    static void UploadGlyphCache(FontMap* font_map, TextContext& text_context)
+    {
+        uint32_t bytes_per_pixel = font_map->m_CacheChannels;
+        uint32_t cache_row_size = font_map->m_CacheWidth * bytes_per_pixel;
+        uint32_t upload_size = 0;
+        dmArray<GlyphCacheRect>& rects = font_map->m_CacheDirtyRects;
+        for (uint32_t i = 0; i < rects.Size(); ++i)
+        {
+            const GlyphCacheRect& r = rects[i];
+            uint32_t row_size = r.m_Width * bytes_per_pixel;
+            uint32_t data_size = row_size * r.m_Height;
+            const uint8_t* cache_data = font_map->m_CacheData + r.m_Y * cache_row_size + r.m_X * bytes_per_pixel;
+
+            // Full rows are already contiguous in the cache, other rects are copied to the upload buffer first
+            const uint8_t* data = cache_data;
+            if (r.m_Width != font_map->m_CacheWidth) {
+                dmArray<uint8_t>& buffer = text_context.m_GlyphUploadBuffer;
+                if (buffer.Capacity() < data_size) {
+                    buffer.SetCapacity(data_size);
                 }
+                uint8_t* write = buffer.Begin();
+                for (uint32_t row = 0; row < r.m_Height; ++row) {
+                    memcpy(write, cache_data, row_size);
+                    write += row_size;
+                    cache_data += cache_row_size;
+                }
+                data = buffer.Begin();
+            }
 
-                tex_params.m_X = g->m_X;
-                tex_params.m_Y = g->m_Y + g_offset_y;
+            dmGraphics::TextureParams tex_params;
+            tex_params.m_SubUpdate = true;
+            tex_params.m_MipMap = 0;
+            tex_params.m_Format = font_map->m_CacheFormat;
+            tex_params.m_MinFilter = font_map->m_MinFilter;
+            tex_params.m_MagFilter = font_map->m_MagFilter;
+            tex_params.m_X = r.m_X;
+            tex_params.m_Y = r.m_Y;
+            tex_params.m_Width = r.m_Width;
+            tex_params.m_Height = r.m_Height;
+            tex_params.m_Data = data;
+            tex_params.m_DataSize = data_size;
+            dmGraphics::SetTexture(font_map->m_Texture, tex_params);
+            upload_size += data_size;
+        }
 
-                dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-                break;
+        DM_COUNTER("FontGlyphCacheUpload", upload_size);
+
+        font_map->m_CacheUploadSize += upload_size;
+        rects.SetSize(0);
+        font_map->m_DirtyTextContext = 0;
+    }
+
+    void UploadGlyphCaches(TextContext& text_context)
+    {
+        for (uint32_t i = 0; i < text_context.m_DirtyFontMaps.Size(); ++i)
+        {
+            UploadGlyphCache(text_context.m_DirtyFontMaps[i], text_context);
+        }
+        text_context.m_DirtyFontMaps.SetSize(0);
+    }
+
+    static bool AddGlyphToCache(HFontMap font_map, TextContext& text_context, Glyph* g) {
+        uint32_t width = g->m_Width + font_map->m_CacheCellPadding*2;
+        uint32_t height = g->m_Ascent + g->m_Descent + font_map->m_CacheCellPadding*2;
+
+        // Evict the least recently used glyphs until there is room, but never the ones used this frame
+        uint32_t x, y;
+        bool reset = false;
+        while (!AllocateFromFreeRects(font_map, width, height, &x, &y) && !AllocateFromSkyline(font_map, width, height, &x, &y)) {
+            Glyph* lru = font_map->m_CacheTail;
+            if (lru == 0x0 && !reset) {
+                // The cache is empty, so start over to get rid of the fragmentation
+                ResetGlyphCache(font_map);
+                reset = true;
+            } else if (lru == 0x0 || lru->m_Frame == text_context.m_Frame) {
+                dmLogError("Out of available cache cells! Consider increasing cache_width or cache_height for the font.");
+                return false;
+            } else {
+                EvictGlyph(font_map, lru);
+            }
+        }
+
+        g->m_X = x;
+        g->m_Y = y;
+        g->m_Frame = text_context.m_Frame;
+        g->m_InCache = true;
+        LinkCachedGlyphFirst(font_map, g);
+
+        uint8_t* glyph_data = (uint8_t*)font_map->m_GlyphData + g->m_GlyphDataOffset;
+        uint32_t glyph_data_size = g->m_GlyphDataSize-1; // The first byte is a header
+        uint8_t is_compressed = *glyph_data++;
+
+        uint32_t bytes_per_pixel = font_map->m_CacheChannels;
+        uint32_t glyph_row_size = width * bytes_per_pixel;
+        if (is_compressed) {
+
+            dmWebP::TextureEncodeFormat encode_format;
+            switch (font_map->m_CacheFormat) {
+                case dmGraphics::TEXTURE_FORMAT_RGB:        encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGB888;
+                                                            break;
+                case dmGraphics::TEXTURE_FORMAT_RGBA:       encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGBA8888;
+                                                            break;
+                case dmGraphics::TEXTURE_FORMAT_LUMINANCE:
+                default:                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_L8;
+            };
+
+            dmWebP::Result result = dmWebP::DecodeCompressedTexture(glyph_data,
+                                        glyph_data_size,
+                                        font_map->m_CellTempData,
+                                        font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4, // the max size
+                                        glyph_row_size,
+                                        encode_format);
+
+            if (result != dmWebP::RESULT_OK) {
+                dmLogWarning("Failed to decompress glyph: %d", result);
             }
+            glyph_data = font_map->m_CellTempData;
+        }
 
-        } while (prev_cache_cursor != font_map->m_CacheCursor);
+        // Copy the glyph into the cache, it is uploaded with the other changes at the end of the frame
+        uint32_t cache_row_size = font_map->m_CacheWidth * bytes_per_pixel;
+        uint8_t* cache_data = font_map->m_CacheData + y * cache_row_size + x * bytes_per_pixel;
+        for (uint32_t row = 0; row < height; ++row) {
+            memcpy(cache_data, glyph_data, glyph_row_size);
+            cache_data += cache_row_size;
+            glyph_data += glyph_row_size;
+        }
+        MarkGlyphCacheDirty(font_map, text_context, x, y, width, height);
+        return true;
+    }
 
-        if (prev_cache_cursor == font_map->m_CacheCursor) {
-            dmLogError("Out of available cache cells! Consider increasing cache_width or cache_height for the font.");
+    bool CacheGlyph(HFontMap font_map, TextContext& text_context, Glyph* g)
+    {
+        if (g->m_InCache) {
+            ++font_map->m_CacheHits;
+            UnlinkCachedGlyph(font_map, g);
+            LinkCachedGlyphFirst(font_map, g);
+        } else {
+            ++font_map->m_CacheMisses;
+            if (!AddGlyphToCache(font_map, text_context, g)) {
+                return false;
+            }
         }
+        g->m_Frame = text_context.m_Frame;
+        return true;
     }
 
-    static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
+    void GetFontMapCacheStats(HFontMap font_map, FontMapCacheStats* stats)
+    {
+        stats->m_Hits = font_map->m_CacheHits;
+        stats->m_Misses = font_map->m_CacheMisses;
+        stats->m_Evictions = font_map->m_CacheEvictions;
+        stats->m_UploadSize = font_map->m_CacheUploadSize;
+    }
+
+    static void UnlinkTextLayout(TextContext& text_context, uint32_t index)
+    {
+        TextLayout& layout = text_context.m_TextLayouts[index];
+        if (layout.m_Prev != INVALID_TEXT_LAYOUT)
+            text_context.m_TextLayouts[layout.m_Prev].m_Next = layout.m_Next;
+        else
+            text_context.m_TextLayoutHead = layout.m_Next;
+        if (layout.m_Next != INVALID_TEXT_LAYOUT)
+            text_context.m_TextLayouts[layout.m_Next].m_Prev = layout.m_Prev;
+        else
+            text_context.m_TextLayoutTail = layout.m_Prev;
+    }
+
+    static void LinkTextLayoutFirst(TextContext& text_context, uint32_t index)
+    {
+        TextLayout& layout = text_context.m_TextLayouts[index];
+        layout.m_Prev = INVALID_TEXT_LAYOUT;
+        layout.m_Next = text_context.m_TextLayoutHead;
+        if (text_context.m_TextLayoutHead != INVALID_TEXT_LAYOUT)
+            text_context.m_TextLayouts[text_context.m_TextLayoutHead].m_Prev = index;
+        else
+            text_context.m_TextLayoutTail = index;
+        text_context.m_TextLayoutHead = index;
+    }
+
+    TextLayout* GetTextLayout(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te)
     {
         float width = te.m_Width;
         if (!te.m_LineBreak) {
             width = FLT_MAX;
         }
+        uint32_t flags = te.m_Align | (te.m_VAlign << 2) | (te.m_LineBreak ? 1 << 4 : 0);
+
+        // The width is part of the key also without line breaks, since the alignment offset depends on it
+        HashState64 key_state;
+        dmHashInit64(&key_state, false);
+        dmHashUpdateBuffer64(&key_state, text, strlen(text));
+        dmHashUpdateBuffer64(&key_state, &font_map->m_LayoutVersion, sizeof(font_map->m_LayoutVersion));
+        dmHashUpdateBuffer64(&key_state, &te.m_Width, sizeof(te.m_Width));
+        dmHashUpdateBuffer64(&key_state, &te.m_Height, sizeof(te.m_Height));
+        dmHashUpdateBuffer64(&key_state, &te.m_Leading, sizeof(te.m_Leading));
+        dmHashUpdateBuffer64(&key_state, &te.m_Tracking, sizeof(te.m_Tracking));
+        dmHashUpdateBuffer64(&key_state, &flags, sizeof(flags));
+        uint64_t key = dmHashFinal64(&key_state);
+
+        uint32_t* cached_index = text_context.m_TextLayoutIndices.Get(key);
+        if (cached_index)
+        {
+            ++text_context.m_TextLayoutHits;
+            UnlinkTextLayout(text_context, *cached_index);
+            LinkTextLayoutFirst(text_context, *cached_index);
+            return &text_context.m_TextLayouts[*cached_index];
+        }
+        ++text_context.m_TextLayoutMisses;
+
+        // Reuse the least recently used layout when full
+        uint32_t index;
+        if (text_context.m_TextLayouts.Full())
+        {
+            index = text_context.m_TextLayoutTail;
+            text_context.m_TextLayoutIndices.Erase(text_context.m_TextLayouts[index].m_Key);
+            UnlinkTextLayout(text_context, index);
+        }
+        else
+        {
+            index = text_context.m_TextLayouts.Size();
+            text_context.m_TextLayouts.SetSize(index + 1);
+            memset(&text_context.m_TextLayouts[index], 0, sizeof(TextLayout));
+        }
+        LinkTextLayoutFirst(text_context, index);
+        text_context.m_TextLayoutIndices.Put(key, index);
+
+        TextLayout& layout = text_context.m_TextLayouts[index];
+        layout.m_Key = key;
+
         float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
         float leading = line_height * te.m_Leading;
         float tracking = line_height * te.m_Tracking;
@@ -657,9 +1177,71 @@ namespace dmRender
         float x_offset = OffsetX(te.m_Align, te.m_Width);
         float y_offset = OffsetY(te.m_VAlign, te.m_Height, font_map->m_MaxAscent, font_map->m_MaxDescent, te.m_Leading, line_count);
 
-        const Vectormath::Aos::Vector4 face_color    = dmGraphics::UnpackRGBA(te.m_FaceColor);
-        const Vectormath::Aos::Vector4 outline_color = dmGraphics::UnpackRGBA(te.m_OutlineColor);
-        const Vectormath::Aos::Vector4 shadow_color  = dmGraphics::UnpackRGBA(te.m_ShadowColor);
+        uint32_t max_glyph_count = 0;
+        for (int line = 0; line < line_count; ++line) {
+            max_glyph_count += lines[line].m_Count;
+        }
+        if (layout.m_GlyphCapacity < max_glyph_count) {
+            layout.m_Glyphs = (TextLayoutGlyph*)realloc(layout.m_Glyphs, max_glyph_count * sizeof(TextLayoutGlyph));
+            layout.m_GlyphCapacity = max_glyph_count;
+        }
+
+        // Only glyphs with a width produce vertices
+        TextLayoutGlyph* out = layout.m_Glyphs;
+        for (int line = 0; line < line_count; ++line) {
+            TextLine& l = lines[line];
+            int16_t x = (int16_t)(x_offset - OffsetX(te.m_Align, l.m_Width) + 0.5f);
+            int16_t y = (int16_t) (y_offset - line * leading + 0.5f);
+            const char* cursor = &text[l.m_Index];
+            int n = l.m_Count;
+            for (int j = 0; j < n; ++j)
+            {
+                uint32_t c = dmUtf8::NextChar(&cursor);
+
+                Glyph* g =  GetGlyph(font_map, c);
+                if (!g) {
+                    continue;
+                }
+
+                if (g->m_Width > 0)
+                {
+                    out->m_Glyph = g;
+                    out->m_X = x;
+                    out->m_Y = y;
+                    ++out;
+                }
+                x += (int16_t)(g->m_Advance + tracking);
+            }
+        }
+        layout.m_GlyphCount = out - layout.m_Glyphs;
+        return &layout;
+    }
+
+    static inline uint16_t PackUV(float uv)
+    {
+        return (uint16_t)(dmMath::Clamp(uv, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    static inline void SetGlyphPosition(GlyphVertex& v, const Vector4& p)
+    {
+        v.m_Position[0] = p.getX();
+        v.m_Position[1] = p.getY();
+        v.m_Position[2] = p.getZ();
+    }
+
+    static inline void SetGlyphLayerMask(GlyphVertex& v, uint8_t face, uint8_t outline, uint8_t shadow)
+    {
+        v.m_LayerMasks[0] = face;
+        v.m_LayerMasks[1] = outline;
+        v.m_LayerMasks[2] = shadow;
+    }
+
+    static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
+    {
+        // Only the transform and colors are applied to a cached layout
+        const TextLayout* layout = GetTextLayout(text_context, font_map, text, te);
+        const TextLayoutGlyph* glyphs = layout->m_Glyphs;
+        const uint32_t glyph_count = layout->m_GlyphCount;
 
         // No support for non-uniform scale with SDF so just peek at the first
         // row to extract scale factor. The purpose of this scaling is to have
@@ -673,9 +1255,20 @@ namespace dmRender
         // For anti-aliasing, 0.25 represents the single-axis radius of half a pixel.
         float sdf_smoothing = 0.25f / (font_map->m_SdfSpread * sdf_world_scale);
 
+        // The properties shared by all vertices of the text. The colors are packed in the same byte order as the vertex colors.
+        GlyphVertex text_vertex;
+        memcpy(text_vertex.m_FaceColor, &te.m_FaceColor, sizeof(text_vertex.m_FaceColor));
+        memcpy(text_vertex.m_OutlineColor, &te.m_OutlineColor, sizeof(text_vertex.m_OutlineColor));
+        memcpy(text_vertex.m_ShadowColor, &te.m_ShadowColor, sizeof(text_vertex.m_ShadowColor));
+        text_vertex.m_LayerMasks[3] = 0;
+        text_vertex.m_SdfParams[0] = sdf_edge_value;
+        text_vertex.m_SdfParams[1] = sdf_outline;
+        text_vertex.m_SdfParams[2] = sdf_smoothing;
+        text_vertex.m_SdfParams[3] = sdf_shadow;
+
         uint32_t vertexindex        = 0;
         uint32_t valid_glyph_count  = 0;
-        uint8_t  vertices_per_quad  = 6;
+        uint8_t  vertices_per_quad  = 4;
         uint8_t  layer_count        = 1;
         uint8_t  layer_mask         = font_map->m_LayerMask;
 
@@ -698,240 +1291,108 @@ namespace dmRender
             layer_count += HAS_LAYER(layer_mask,OUTLINE) + HAS_LAYER(layer_mask,SHADOW);
 
             // Calculate number of valid glyphs
-            for (int line = 0; line < line_count; ++line)
+            for (uint32_t i = 0; i < glyph_count; ++i)
             {
-                TextLine& l = lines[line];
-                const char* cursor = &text[l.m_Index];
-                bool inner_break = false;
+                Glyph* g = glyphs[i].m_Glyph;
 
-                for (int j = 0; j < l.m_Count; ++j)
+                if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
                 {
-                    uint32_t c = dmUtf8::NextChar(&cursor);
-                    Glyph* g   = GetGlyph(font_map, c);
-
-                    if (!g)
-                    {
-                        continue;
-                    }
-
-                    if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
-                    {
-                        inner_break = true;
-                        break;
-                    }
-
-                    if (g->m_Width > 0)
-                    {
-                        int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - (int16_t)g->m_Ascent;
-
-                        // Prepare the cache here aswell since we only count glyphs we definitely
-                        // will render.
-                        if (!g->m_InCache)
-                        {
-                            AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
-                        }
-
-                        if (g->m_InCache)
-                        {
-                            valid_glyph_count++;
-
-                            vertexindex += vertices_per_quad;
-                        }
-                    }
+                    break;
                 }
 
-                if (inner_break)
+                // Prepare the cache here aswell since we only count glyphs we definitely
+                // will render.
+                if (CacheGlyph(font_map, text_context, g))
                 {
-                    break;
+                    valid_glyph_count++;
+
+                    vertexindex += vertices_per_quad;
                 }
             }
 
             vertexindex = 0;
         }
 
-        for (int line = 0; line < line_count; ++line) {
-            TextLine& l = lines[line];
-            int16_t x = (int16_t)(x_offset - OffsetX(te.m_Align, l.m_Width) + 0.5f);
-            int16_t y = (int16_t) (y_offset - line * leading + 0.5f);
-            const char* cursor = &text[l.m_Index];
-            int n = l.m_Count;
-            for (int j = 0; j < n; ++j)
-            {
-                uint32_t c = dmUtf8::NextChar(&cursor);
+        for (uint32_t i = 0; i < glyph_count; ++i)
+        {
+            Glyph* g = glyphs[i].m_Glyph;
+            int16_t x = glyphs[i].m_X;
+            int16_t y = glyphs[i].m_Y;
 
-                Glyph* g =  GetGlyph(font_map, c);
-                if (!g) {
-                    continue;
-                }
+            // Look ahead and see if we can produce vertices for the next glyph or not
+            if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
+            {
+                dmLogWarning("Character buffer exceeded (size: %d), increase the \"graphics.max_characters\" property in your game.project file.", num_vertices / 4);
+                return vertexindex * layer_count;
+            }
 
-                // Look ahead and see if we can produce vertices for the next glyph or not
-                if ((vertexindex + vertices_per_quad) * layer_count > num_vertices)
+            int16_t width   = (int16_t) g->m_Width;
+            int16_t descent = (int16_t) g->m_Descent;
+            int16_t ascent  = (int16_t) g->m_Ascent;
+
+            // The layered fonts already cached the glyphs in the dry run
+            bool in_cache = layer_count > 1 ? g->m_InCache : CacheGlyph(font_map, text_context, g);
+
+            if (in_cache) {
+                uint32_t face_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-1);
+
+                // Quad corners, in the order left-bottom, left-top, right-bottom, right-top
+                float left   = x + g->m_LeftBearing;
+                float right  = left + width;
+                float bottom = y - descent;
+                float top    = y + ascent;
+                const float quad_x[] = { left, left, right, right };
+                const float quad_y[] = { bottom, top, bottom, top };
+
+                uint16_t uv_left   = PackUV((g->m_X + font_map->m_CacheCellPadding) * recip_w);
+                uint16_t uv_right  = PackUV((g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w);
+                uint16_t uv_bottom = PackUV((g->m_Y + font_map->m_CacheCellPadding + ascent + descent) * recip_h);
+                uint16_t uv_top    = PackUV((g->m_Y + font_map->m_CacheCellPadding) * recip_h);
+                const uint16_t quad_u[] = { uv_left, uv_left, uv_right, uv_right };
+                const uint16_t quad_v[] = { uv_bottom, uv_top, uv_bottom, uv_top };
+
+                // If we only have one layer, we need to set the mask to (1,1,1)
+                // so that we can use the same calculations for both single and multi.
+                uint8_t is_one_layer = layer_count > 1 ? 0 : 255;
+
+                // Set face vertices first, this will always hold since we can't have less than 1 layer
+                GlyphVertex* face = &vertices[face_index];
+                for (uint32_t v = 0; v < 4; ++v)
                 {
-                    dmLogWarning("Character buffer exceeded (size: %d), increase the \"graphics.max_characters\" property in your game.project file.", num_vertices / 6);
-                    return vertexindex * layer_count;
+                    face[v] = text_vertex;
+                    SetGlyphPosition(face[v], te.m_Transform * Vector4(quad_x[v], quad_y[v], 0, 1));
+                    face[v].m_UV[0] = quad_u[v];
+                    face[v].m_UV[1] = quad_v[v];
+                    SetGlyphLayerMask(face[v], 255, is_one_layer, is_one_layer);
                 }
 
-                if (g->m_Width > 0)
+                // Set outline vertices
+                if (HAS_LAYER(layer_mask,OUTLINE))
                 {
-                    int16_t width   = (int16_t) g->m_Width;
-                    int16_t descent = (int16_t) g->m_Descent;
-                    int16_t ascent  = (int16_t) g->m_Ascent;
-
-                    // Calculate y-offset in cache-cell space by moving glyphs down to baseline
-                    int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - ascent;
-
-                    if (!g->m_InCache) {
-                        AddGlyphToCache(font_map, text_context, g, px_cell_offset_y);
+                    GlyphVertex* outline = &vertices[vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-2)];
+                    for (uint32_t v = 0; v < 4; ++v)
+                    {
+                        outline[v] = face[v];
+                        SetGlyphLayerMask(outline[v], 0, 255, 0);
                     }
+                }
 
-                    if (g->m_InCache) {
-                        g->m_Frame = text_context.m_Frame;
-
-                        uint32_t face_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-1);
-
-                        // Set face vertices first, this will always hold since we can't have less than 1 layer
-                        GlyphVertex& v1_layer_face = vertices[face_index];
-                        GlyphVertex& v2_layer_face = vertices[face_index + 1];
-                        GlyphVertex& v3_layer_face = vertices[face_index + 2];
-                        GlyphVertex& v4_layer_face = vertices[face_index + 3];
-                        GlyphVertex& v5_layer_face = vertices[face_index + 4];
-                        GlyphVertex& v6_layer_face = vertices[face_index + 5];
-
-                        (Vector4&) v1_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y - descent, 0, 1);
-                        (Vector4&) v2_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing, y + ascent, 0, 1);
-                        (Vector4&) v3_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y - descent, 0, 1);
-                        (Vector4&) v6_layer_face.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + width, y + ascent, 0, 1);
-
-                        v1_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
-                        v1_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
-
-                        v2_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding) * recip_w;
-                        v2_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
-
-                        v3_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
-                        v3_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
-
-                        v6_layer_face.m_UV[0] = (g->m_X + font_map->m_CacheCellPadding + g->m_Width) * recip_w;
-                        v6_layer_face.m_UV[1] = (g->m_Y + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
-
-                        #define SET_VERTEX_FONT_PROPERTIES(v) \
-                            v.m_FaceColor[0]    = face_color[0]; \
-                            v.m_FaceColor[1]    = face_color[1]; \
-                            v.m_FaceColor[2]    = face_color[2]; \
-                            v.m_FaceColor[3]    = face_color[3]; \
-                            v.m_OutlineColor[0] = outline_color[0]; \
-                            v.m_OutlineColor[1] = outline_color[1]; \
-                            v.m_OutlineColor[2] = outline_color[2]; \
-                            v.m_OutlineColor[3] = outline_color[3]; \
-                            v.m_ShadowColor[0]  = shadow_color[0]; \
-                            v.m_ShadowColor[1]  = shadow_color[1]; \
-                            v.m_ShadowColor[2]  = shadow_color[2]; \
-                            v.m_ShadowColor[3]  = shadow_color[3]; \
-                            v.m_FaceColor[0]    = face_color[0]; \
-                            v.m_FaceColor[1]    = face_color[1]; \
-                            v.m_FaceColor[2]    = face_color[2]; \
-                            v.m_FaceColor[3]    = face_color[3]; \
-                            v.m_SdfParams[0]    = sdf_edge_value; \
-                            v.m_SdfParams[1]    = sdf_outline; \
-                            v.m_SdfParams[2]    = sdf_smoothing; \
-                            v.m_SdfParams[3]    = sdf_shadow;
-
-                        SET_VERTEX_FONT_PROPERTIES(v1_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v2_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v3_layer_face)
-                        SET_VERTEX_FONT_PROPERTIES(v6_layer_face)
-
-                        #undef SET_VERTEX_FONT_PROPERTIES
-
-                        v4_layer_face = v3_layer_face;
-                        v5_layer_face = v2_layer_face;
-
-                        #define SET_VERTEX_LAYER_MASK(v,f,o,s) \
-                            v.m_LayerMasks[0] = f; \
-                            v.m_LayerMasks[1] = o; \
-                            v.m_LayerMasks[2] = s;
-
-                        // Set outline vertices
-                        if (HAS_LAYER(layer_mask,OUTLINE))
-                        {
-                            uint32_t outline_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-2);
-
-                            GlyphVertex& v1_layer_outline = vertices[outline_index];
-                            GlyphVertex& v2_layer_outline = vertices[outline_index + 1];
-                            GlyphVertex& v3_layer_outline = vertices[outline_index + 2];
-                            GlyphVertex& v4_layer_outline = vertices[outline_index + 3];
-                            GlyphVertex& v5_layer_outline = vertices[outline_index + 4];
-                            GlyphVertex& v6_layer_outline = vertices[outline_index + 5];
-
-                            v1_layer_outline = v1_layer_face;
-                            v2_layer_outline = v2_layer_face;
-                            v3_layer_outline = v3_layer_face;
-                            v4_layer_outline = v4_layer_face;
-                            v5_layer_outline = v5_layer_face;
-                            v6_layer_outline = v6_layer_face;
-
-                            SET_VERTEX_LAYER_MASK(v1_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v2_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v3_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v4_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v5_layer_outline,0,1,0)
-                            SET_VERTEX_LAYER_MASK(v6_layer_outline,0,1,0)
-                        }
-
-                        // Set shadow vertices
-                        if (HAS_LAYER(layer_mask,SHADOW))
-                        {
-                            uint32_t shadow_index = vertexindex;
-                            float shadow_x        = font_map->m_ShadowX;
-                            float shadow_y        = font_map->m_ShadowY;
-
-                            GlyphVertex& v1_layer_shadow = vertices[shadow_index];
-                            GlyphVertex& v2_layer_shadow = vertices[shadow_index + 1];
-                            GlyphVertex& v3_layer_shadow = vertices[shadow_index + 2];
-                            GlyphVertex& v4_layer_shadow = vertices[shadow_index + 3];
-                            GlyphVertex& v5_layer_shadow = vertices[shadow_index + 4];
-                            GlyphVertex& v6_layer_shadow = vertices[shadow_index + 5];
-
-                            v1_layer_shadow = v1_layer_face;
-                            v2_layer_shadow = v2_layer_face;
-                            v3_layer_shadow = v3_layer_face;
-                            v6_layer_shadow = v6_layer_face;
-
-                            // Shadow offsets must be calculated since we need to offset in local space (before vertex transformation)
-                            (Vector4&) v1_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y - descent + shadow_y, 0, 1);
-                            (Vector4&) v2_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x, y + ascent + shadow_y, 0, 1);
-                            (Vector4&) v3_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y - descent + shadow_y, 0, 1);
-                            (Vector4&) v6_layer_shadow.m_Position = te.m_Transform * Vector4(x + g->m_LeftBearing + shadow_x + width, y + ascent + shadow_y, 0, 1);
-
-                            v4_layer_shadow = v3_layer_shadow;
-                            v5_layer_shadow = v2_layer_shadow;
-
-                            SET_VERTEX_LAYER_MASK(v1_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v2_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v3_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v4_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v5_layer_shadow,0,0,1)
-                            SET_VERTEX_LAYER_MASK(v6_layer_shadow,0,0,1)
-                        }
-
-                        // If we only have one layer, we need to set the mask to (1,1,1)
-                        // so that we can use the same calculations for both single and multi.
-                        // The mask is set last for layer 1 since we copy the vertices to
-                        // all other layers to avoid re-calculating their data.
-                        uint8_t is_one_layer = layer_count > 1 ? 0 : 1;
-                        SET_VERTEX_LAYER_MASK(v1_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v2_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v3_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v4_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v5_layer_face,1,is_one_layer,is_one_layer)
-                        SET_VERTEX_LAYER_MASK(v6_layer_face,1,is_one_layer,is_one_layer)
-
-                        #undef SET_VERTEX_LAYER_MASK
-
-                        vertexindex += vertices_per_quad;
+                // Set shadow vertices
+                if (HAS_LAYER(layer_mask,SHADOW))
+                {
+                    GlyphVertex* shadow = &vertices[vertexindex];
+                    float shadow_x      = font_map->m_ShadowX;
+                    float shadow_y      = font_map->m_ShadowY;
+                    for (uint32_t v = 0; v < 4; ++v)
+                    {
+                        shadow[v] = face[v];
+                        // Shadow offsets must be calculated since we need to offset in local space (before vertex transformation)
+                        SetGlyphPosition(shadow[v], te.m_Transform * Vector4(quad_x[v] + shadow_x, quad_y[v] + shadow_y, 0, 1));
+                        SetGlyphLayerMask(shadow[v], 0, 0, 255);
                     }
                 }
-                x += (int16_t)(g->m_Advance + tracking);
+
+                vertexindex += vertices_per_quad;
             }
         }
 
@@ -978,7 +1439,6 @@ namespace dmRender
         ro->m_SetBlendFactors = 1;
         ro->m_Material = first_te.m_Material;
         ro->m_Textures[0] = font_map->m_Texture;
-        ro->m_VertexStart = text_context.m_VertexIndex;
         ro->m_StencilTestParams = first_te.m_StencilTestParams;
         ro->m_SetStencilTest = first_te.m_StencilTestParamsSet;
 
@@ -993,6 +1453,11 @@ namespace dmRender
             dmRender::EnableRenderObjectConstant(ro, c.m_NameHash, c.m_Value);
         }
 
+        uint32_t vertex_start = text_context.m_VertexIndex;
+        uint32_t cache_hits = font_map->m_CacheHits;
+        uint32_t cache_misses = font_map->m_CacheMisses;
+        uint32_t cache_evictions = font_map->m_CacheEvictions;
+
         for (uint32_t *i = begin;i != end; ++i)
         {
             const TextEntry& te = *(TextEntry*) buf[*i].m_UserData;
@@ -1002,7 +1467,14 @@ namespace dmRender
             text_context.m_VertexIndex += num_indices;
         }
 
-        ro->m_VertexCount = text_context.m_VertexIndex - ro->m_VertexStart;
+        DM_COUNTER("FontGlyphCacheHits", font_map->m_CacheHits - cache_hits);
+        DM_COUNTER("FontGlyphCacheMisses", font_map->m_CacheMisses - cache_misses);
+        DM_COUNTER("FontGlyphCacheEvictions", font_map->m_CacheEvictions - cache_evictions);
+
+        // The quads are drawn from the static index buffer, with the start as a byte offset
+        uint32_t index_size = text_context.m_IndexType == dmGraphics::TYPE_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+        ro->m_VertexStart = (vertex_start / 4) * 6 * index_size;
+        ro->m_VertexCount = ((text_context.m_VertexIndex - vertex_start) / 4) * 6;
 
         dmRender::AddToRender(render_context, ro);
     }
@@ -1026,6 +1498,8 @@ namespace dmRender
                     dmGraphics::SetVertexBufferData(text_context.m_VertexBuffer, buffer_size, text_context.m_ClientBuffer, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
                     text_context.m_VerticesFlushed = text_context.m_VertexIndex;
                     DM_COUNTER("FontVertexBuffer", buffer_size);
+
+                    UploadGlyphCaches(text_context);
                 }
                 break;
             default:
@@ -1054,6 +1528,7 @@ namespace dmRender
                 {
                     TextEntry& te = text_context.m_TextEntries[text_context.m_TextEntriesFlushed + i];
                     write_ptr->m_WorldPosition = Point3(te.m_Transform.getTranslation());
+                    write_ptr->m_BoundRadius = te.m_BoundRadius;
                     write_ptr->m_MinorOrder = 0;
                     write_ptr->m_MajorOrder = major_order;
                     write_ptr->m_Order = render_order;
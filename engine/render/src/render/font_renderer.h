@@ -50,18 +50,21 @@ namespace dmRender
         uint64_t    m_GlyphDataOffset;
         uint64_t    m_GlyphDataSize;
         uint32_t    m_Frame;
+        /// Neighbours in the glyph cache, ordered from the most to the least recently used
+        Glyph*      m_CachePrev;
+        Glyph*      m_CacheNext;
     };
 
-    struct DM_ALIGNED(16) GlyphVertex
+    struct GlyphVertex
     {
-        // NOTE: The struct *must* be 16-bytes aligned due to SIMD operations.
-        float m_Position[4];
-        float m_UV[2];
-        float m_FaceColor[4];
-        float m_OutlineColor[4];
-        float m_ShadowColor[4];
-        float m_SdfParams[4];
-        float m_LayerMasks[3];
+        // NOTE: The members must match the order of the vertex declaration, without any padding
+        float       m_Position[3];
+        uint16_t    m_UV[2];            // Normalized
+        uint8_t     m_FaceColor[4];     // Normalized, packed as dmGraphics::PackRGBA
+        uint8_t     m_OutlineColor[4];
+        uint8_t     m_ShadowColor[4];
+        uint8_t     m_LayerMasks[4];    // Normalized, the last one is unused
+        float       m_SdfParams[4];
     };
 
     /**
@@ -215,6 +218,8 @@ namespace dmRender
         TextVAlign m_VAlign;
         /// Stencil parameters
         StencilTestParams m_StencilTestParams;
+        /// Radius of a sphere around the translation of m_WorldTransform that contains the text, used for culling. Zero if unknown.
+        float       m_BoundRadius;
         /// Stencil parameters set or not
         uint8_t m_StencilTestParamsSet : 1;
     };
@@ -159,7 +159,43 @@ namespace dmRender
         }
     }
 
+    /*
+     * Gets the layout of a text entry from the cache of the text context,
+     * laying it out if it is not among the recently used layouts.
+     * The layout is valid until the next call.
+     */
+    struct TextLayout* GetTextLayout(struct TextContext& text_context, HFontMap font_map, const char* text, const struct TextEntry& te);
+
+    /*
+     * Gets a glyph of the font map, or the fallback glyph '~' if the font map
+     * lacks the character.
+     */
+    Glyph* GetGlyph(HFontMap font_map, uint32_t c);
+
+    /*
+     * Makes sure the glyph is in the glyph cache of the font map and marks it as
+     * used this frame. The least recently used glyphs are evicted to make room.
+     * Returns false if the cache is full of glyphs used this frame.
+     */
+    bool CacheGlyph(HFontMap font_map, struct TextContext& text_context, Glyph* g);
+
+    /*
+     * Uploads the changed parts of the glyph caches of the font maps used this frame.
+     * Called at the end of the frame, once all texts are drawn.
+     */
+    void UploadGlyphCaches(struct TextContext& text_context);
+
+    struct FontMapCacheStats
+    {
+        uint32_t m_Hits;
+        uint32_t m_Misses;
+        uint32_t m_Evictions;
+        // Total number of bytes uploaded to the cache texture
+        uint32_t m_UploadSize;
+    };
+
     // Used in unit tests
+    void GetFontMapCacheStats(HFontMap font_map, FontMapCacheStats* stats);
     bool VerifyFontMapMinFilter(dmRender::HFontMap font_map, dmGraphics::TextureFilter filter);
     bool VerifyFontMapMagFilter(dmRender::HFontMap font_map, dmGraphics::TextureFilter filter);
 }
@@ -89,6 +89,7 @@ namespace dmRender
     , m_MaxCharacters(0)
     , m_CommandBufferSize(1024)
     , m_MaxDebugVertexCount(0)
+    , m_FrustumCulling(0)
     {
 
     }
@@ -135,8 +136,19 @@ namespace dmRender
 
         context->m_StencilBufferCleared = 0;
 
+        context->m_FrustumCulling = params.m_FrustumCulling;
+
         context->m_RenderListDispatch.SetCapacity(255);
 
+        for (uint32_t i = 0; i < RENDER_LIST_SORT_CACHE_SIZE; ++i)
+        {
+            context->m_RenderListSortCache[i].m_TagMask = 0;
+            context->m_RenderListSortCache[i].m_Generation = 0;
+        }
+        context->m_RenderListSortCacheNext = 0;
+        context->m_RenderListGeneration = 1;
+        context->m_RenderListArenaKey = dmThread::AllocTls();
+
         dmMessage::Result r = dmMessage::NewSocket(RENDER_SOCKET_NAME, &context->m_Socket);
         assert(r == dmMessage::RESULT_OK);
 
@@ -152,6 +164,7 @@ namespace dmRender
         FinalizeDebugRenderer(render_context);
         FinalizeTextContext(render_context);
         dmMessage::DeleteSocket(render_context->m_Socket);
+        dmThread::FreeTls(render_context->m_RenderListArenaKey);
         delete render_context;
 
         return RESULT_OK;
@@ -161,17 +174,30 @@ namespace dmRender
         return render_context->m_ScriptContext;
     }
 
+    static void RenderListChanged(HRenderContext render_context)
+    {
+        // Zero is used for unused sort cache entries
+        if (++render_context->m_RenderListGeneration == 0)
+            render_context->m_RenderListGeneration = 1;
+    }
+
     void RenderListBegin(HRenderContext render_context)
     {
+        RenderListChanged(render_context);
         render_context->m_RenderList.SetSize(0);
         render_context->m_RenderListSortIndices.SetSize(0);
         render_context->m_RenderListDispatch.SetSize(0);
         render_context->m_RenderListRanges.SetSize(0);
     }
 
-    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
+    static inline RenderListArena* GetBoundArena(HRenderContext render_context)
+    {
+        return (RenderListArena*)dmThread::GetTlsValue(render_context->m_RenderListArenaKey);
+    }
+
+    static HRenderListDispatch MakeDispatch(dmArray<RenderListDispatch>& dispatch, RenderListDispatchFn fn, void* user_data)
     {
-        if (render_context->m_RenderListDispatch.Size() == render_context->m_RenderListDispatch.Capacity())
+        if (dispatch.Size() == dispatch.Capacity())
         {
             dmLogError("Exhausted number of render dispatches. Too many collections?");
             return RENDERLIST_INVALID_DISPATCH;
@@ -181,64 +207,159 @@ namespace dmRender
         RenderListDispatch d;
         d.m_Fn = fn;
         d.m_UserData = user_data;
-        render_context->m_RenderListDispatch.Push(d);
+        dispatch.Push(d);
 
-        return render_context->m_RenderListDispatch.Size() - 1;
+        return dispatch.Size() - 1;
     }
 
-    // Allocate a buffer (from the array) with room for 'entries' entries.
-    //
-    // NOTE: Pointer might go invalid after a consecutive call to RenderListAlloc if reallocation
-    //       of backing buffer happens.
-    RenderListEntry* RenderListAlloc(HRenderContext render_context, uint32_t entries)
+    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
     {
-        dmArray<RenderListEntry> & render_list = render_context->m_RenderList;
+        RenderListArena* arena = GetBoundArena(render_context);
+        if (arena)
+        {
+            return MakeDispatch(arena->m_Dispatch, fn, user_data);
+        }
+        return MakeDispatch(render_context->m_RenderListDispatch, fn, user_data);
+    }
 
+    static RenderListEntry* AllocEntries(dmArray<RenderListEntry>& render_list, dmArray<uint32_t>& indices, uint32_t entries)
+    {
         if (render_list.Remaining() < entries)
         {
             const uint32_t needed = entries - render_list.Remaining();
             render_list.OffsetCapacity(dmMath::Max<uint32_t>(256, needed));
-            render_context->m_RenderListSortIndices.SetCapacity(render_list.Capacity());
+            indices.SetCapacity(render_list.Capacity());
         }
 
         uint32_t size = render_list.Size();
         render_list.SetSize(size + entries);
+        // Components that don't provide bounds leave them zeroed
+        memset((void*)(render_list.Begin() + size), 0, sizeof(RenderListEntry) * entries);
         return (render_list.Begin() + size);
     }
 
-    // Submit a range of entries (pointers must be from a range allocated by RenderListAlloc, and not between two alloc calls).
-    void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end)
+    // Allocate a buffer (from the array) with room for 'entries' entries.
+    //
+    // NOTE: Pointer might go invalid after a consecutive call to RenderListAlloc if reallocation
+    //       of backing buffer happens.
+    RenderListEntry* RenderListAlloc(HRenderContext render_context, uint32_t entries)
     {
-        if (end == begin) {
-            return;
+        RenderListArena* arena = GetBoundArena(render_context);
+        if (arena)
+        {
+            return AllocEntries(arena->m_Entries, arena->m_Indices, entries);
         }
+        return AllocEntries(render_context->m_RenderList, render_context->m_RenderListSortIndices, entries);
+    }
+
+    static void SubmitEntries(dmArray<RenderListEntry>& render_list, dmArray<uint32_t>& indices, RenderListEntry *begin, RenderListEntry *end)
+    {
         // Insert the used up indices into the sort buffer.
-        assert(end - begin <= (intptr_t)render_context->m_RenderListSortIndices.Remaining());
-        assert(end <= render_context->m_RenderList.End());
+        assert(end - begin <= (intptr_t)indices.Remaining());
+        assert(end <= render_list.End());
 
         // Transform pointers back to indices.
-        RenderListEntry *base = render_context->m_RenderList.Begin();
-        uint32_t *insert = render_context->m_RenderListSortIndices.End();
+        RenderListEntry *base = render_list.Begin();
+        uint32_t *insert = indices.End();
 
         for (RenderListEntry* i=begin;i!=end;i++)
             *insert++ = i - base;
 
-        render_context->m_RenderListSortIndices.SetSize(render_context->m_RenderListSortIndices.Size() + (end - begin));
+        indices.SetSize(indices.Size() + (end - begin));
+    }
+
+    // Submit a range of entries (pointers must be from a range allocated by RenderListAlloc, and not between two alloc calls).
+    void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end)
+    {
+        if (end == begin) {
+            return;
+        }
+
+        RenderListArena* arena = GetBoundArena(render_context);
+        if (arena)
+        {
+            SubmitEntries(arena->m_Entries, arena->m_Indices, begin, end);
+            return;
+        }
+
+        SubmitEntries(render_context->m_RenderList, render_context->m_RenderListSortIndices, begin, end);
 
         // invalidate the ranges if this is a call to the debug rendering (happening in the middle of the frame)
         render_context->m_RenderListRanges.SetSize(0);
+        RenderListChanged(render_context);
     }
 
-    struct RenderListSorter
+    HRenderListArena NewRenderListArena()
     {
-        bool operator()(uint32_t a, uint32_t b) const
+        RenderListArena* arena = new RenderListArena;
+        arena->m_Dispatch.SetCapacity(255);
+        return arena;
+    }
+
+    void DeleteRenderListArena(HRenderListArena arena)
+    {
+        delete arena;
+    }
+
+    void RenderListBindArena(HRenderContext render_context, HRenderListArena arena)
+    {
+        dmThread::SetTlsValue(render_context->m_RenderListArenaKey, arena);
+    }
+
+    void RenderListMergeArena(HRenderContext render_context, HRenderListArena arena)
+    {
+        DM_PROFILE(Render, "RenderListMergeArena");
+        assert(GetBoundArena(render_context) == 0x0);
+
+        dmArray<RenderListDispatch>& dispatch = render_context->m_RenderListDispatch;
+        uint32_t dispatch_base = dispatch.Size();
+        uint32_t dispatch_count = arena->m_Dispatch.Size();
+        if (dispatch_count > dispatch.Remaining())
         {
-            const RenderListSortValue& u = values[a];
-            const RenderListSortValue& v = values[b];
-            return u.m_SortKey < v.m_SortKey;
+            dmLogError("Exhausted number of render dispatches. Too many collections?");
+            dispatch_count = dispatch.Remaining();
         }
-        RenderListSortValue* values;
-    };
+        for (uint32_t i = 0; i < dispatch_count; ++i)
+        {
+            dispatch.Push(arena->m_Dispatch[i]);
+        }
+
+        uint32_t entry_count = arena->m_Entries.Size();
+        if (entry_count > 0)
+        {
+            dmArray<uint32_t>& indices = render_context->m_RenderListSortIndices;
+            uint32_t entry_base = render_context->m_RenderList.Size();
+            RenderListEntry* entries = AllocEntries(render_context->m_RenderList, indices, entry_count);
+            memcpy((void*)entries, arena->m_Entries.Begin(), sizeof(RenderListEntry) * entry_count);
+            for (uint32_t i = 0; i < entry_count; ++i)
+            {
+                uint32_t d = entries[i].m_Dispatch;
+                if (d != RENDERLIST_INVALID_DISPATCH)
+                {
+                    entries[i].m_Dispatch = d < dispatch_count ? dispatch_base + d : RENDERLIST_INVALID_DISPATCH;
+                }
+            }
+
+            uint32_t index_count = arena->m_Indices.Size();
+            if (index_count > 0)
+            {
+                uint32_t* insert = indices.End();
+                const uint32_t* src = arena->m_Indices.Begin();
+                for (uint32_t i = 0; i < index_count; ++i)
+                {
+                    insert[i] = entry_base + src[i];
+                }
+                indices.SetSize(indices.Size() + index_count);
+
+                render_context->m_RenderListRanges.SetSize(0);
+                RenderListChanged(render_context);
+            }
+        }
+
+        arena->m_Entries.SetSize(0);
+        arena->m_Indices.SetSize(0);
+        arena->m_Dispatch.SetSize(0);
+    }
 
     void RenderListEnd(HRenderContext render_context)
     {
@@ -378,15 +499,132 @@ namespace dmRender
         return false;
     }
 
-    // Compute new sort values for everything that matches tag_mask
+    void RadixSort(RenderListSortPair* pairs, uint32_t count, dmArray<RenderListSortPair>& scratch)
+    {
+        if (count < 2)
+            return;
+
+        if (scratch.Capacity() < count)
+            scratch.SetCapacity(count);
+        scratch.SetSize(count);
+
+        // Histograms for all eight bytes of the key, in a single pass
+        uint32_t histograms[8][256];
+        memset(histograms, 0, sizeof(histograms));
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t key = pairs[i].m_Key;
+            for (uint32_t b = 0; b < 8; ++b)
+            {
+                histograms[b][(key >> (b * 8)) & 0xff]++;
+            }
+        }
+
+        RenderListSortPair* src = pairs;
+        RenderListSortPair* dst = scratch.Begin();
+        for (uint32_t b = 0; b < 8; ++b)
+        {
+            const uint32_t shift = b * 8;
+            uint32_t* histogram = histograms[b];
+
+            // Skip the pass if all keys have the same value for this byte (e.g. unused high bits)
+            if (histogram[(src[0].m_Key >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t n = histogram[i];
+                histogram[i] = offset;
+                offset += n;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const RenderListSortPair& pair = src[i];
+                dst[histogram[(pair.m_Key >> shift) & 0xff]++] = pair;
+            }
+
+            RenderListSortPair* tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+
+        if (src != pairs)
+        {
+            memcpy(pairs, src, sizeof(RenderListSortPair) * count);
+        }
+    }
+
+    // Radix sorts the first count pairs of the context, and writes the sorted indices to out
+    static void SortRenderListPairs(HRenderContext context, uint32_t count, uint32_t* out)
+    {
+        RenderListSortPair* pairs = context->m_RenderListSortPairs.Begin();
+        RadixSort(pairs, count, context->m_RenderListSortScratch);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out[i] = pairs[i].m_Index;
+        }
+    }
+
+    static RenderListSortPair* AllocRenderListSortPairs(HRenderContext context, uint32_t count)
+    {
+        dmArray<RenderListSortPair>& pairs = context->m_RenderListSortPairs;
+        if (pairs.Capacity() < count)
+            pairs.SetCapacity(count);
+        pairs.SetSize(count);
+        return pairs.Begin();
+    }
+
+    // Planes of the frustum as (normal, distance), with the normals pointing inwards
+    struct FrustumPlanes
+    {
+        Vector4 m_Planes[6];
+    };
+
+    static void MakeFrustumPlanes(const Matrix4& view_proj, FrustumPlanes& frustum)
+    {
+        const Vector4 r0 = view_proj.getRow(0);
+        const Vector4 r1 = view_proj.getRow(1);
+        const Vector4 r2 = view_proj.getRow(2);
+        const Vector4 r3 = view_proj.getRow(3);
+        frustum.m_Planes[0] = r3 + r0; // left
+        frustum.m_Planes[1] = r3 - r0; // right
+        frustum.m_Planes[2] = r3 + r1; // bottom
+        frustum.m_Planes[3] = r3 - r1; // top
+        frustum.m_Planes[4] = r3 + r2; // near
+        frustum.m_Planes[5] = r3 - r2; // far
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            const float length = Vectormath::Aos::length(frustum.m_Planes[i].getXYZ());
+            if (length > 0.0f)
+            {
+                frustum.m_Planes[i] /= length;
+            }
+        }
+    }
+
+    static inline bool IsOutsideFrustum(const FrustumPlanes& frustum, const Point3& center, float radius)
+    {
+        const Vector4 p(center);
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            if (dot(frustum.m_Planes[i], p) < -radius)
+                return true;
+        }
+        return false;
+    }
+
+    // Compute new sort values for everything that matches tag_mask, and is inside the view frustum
     static void MakeSortBuffer(HRenderContext context, uint32_t tag_mask)
     {
         DM_PROFILE(Render, "MakeSortBuffer");
 
         const uint32_t required_capacity = context->m_RenderListSortIndices.Capacity();
         // SetCapacity does early out if they are the same, so just call anyway.
-        context->m_RenderListSortBuffer.SetCapacity(required_capacity);
+        // The buffer is swapped with the sort cache, so it's cleared first.
         context->m_RenderListSortBuffer.SetSize(0);
+        context->m_RenderListSortBuffer.SetCapacity(required_capacity);
         context->m_RenderListSortValues.SetCapacity(required_capacity);
         context->m_RenderListSortValues.SetSize(context->m_RenderListSortIndices.Size());
 
@@ -395,6 +633,14 @@ namespace dmRender
 
         const Matrix4& transform = context->m_ViewProj;
 
+        FrustumPlanes frustum;
+        const bool frustum_culling = context->m_FrustumCulling;
+        if (frustum_culling)
+        {
+            MakeFrustumPlanes(transform, frustum);
+        }
+        uint32_t culled_count = 0;
+
         float minZW = FLT_MAX;
         float maxZW = -FLT_MAX;
 
@@ -406,54 +652,57 @@ namespace dmRender
             if ( (range.m_TagMask & tag_mask) != tag_mask )
                 continue;
 
-            // Write z values...
+            // Cull and write z values...
             for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
             {
                 uint32_t idx = context->m_RenderListSortIndices[i];
                 RenderListEntry* entry = &entries[idx];
-                if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
-                    continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
-
-                const Vector4 res = transform * entry->m_WorldPosition;
-                const float zw = res.getZ() / res.getW();
-                sort_values[idx].m_ZW = zw;
-                if (zw < minZW) minZW = zw;
-                if (zw > maxZW) maxZW = zw;
+                if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
+                {
+                    if (frustum_culling && entry->m_BoundRadius > 0.0f && IsOutsideFrustum(frustum, entry->m_WorldPosition, entry->m_BoundRadius))
+                    {
+                        ++culled_count;
+                        continue;
+                    }
+
+                    const Vector4 res = transform * entry->m_WorldPosition;
+                    const float zw = res.getZ() / res.getW();
+                    sort_values[idx].m_ZW = zw;
+                    if (zw < minZW) minZW = zw;
+                    if (zw > maxZW) maxZW = zw;
+                }
+                context->m_RenderListSortBuffer.Push(idx);
             }
         }
 
+        DM_COUNTER("RenderListCulled", culled_count);
+
         // ... and compute range
         float rc = 0;
         if (maxZW > minZW)
             rc = 1.0f / (maxZW - minZW);
 
-        for( uint32_t i = 0; i < num_ranges; ++i)
+        uint32_t* sort_buffer = context->m_RenderListSortBuffer.Begin();
+        uint32_t sort_count = context->m_RenderListSortBuffer.Size();
+        for (uint32_t i = 0; i < sort_count; ++i)
         {
-            RenderListRange& range = ranges[i];
-            if ( (range.m_TagMask & tag_mask) != tag_mask )
-                continue;
+            uint32_t idx = sort_buffer[i];
+            RenderListEntry* entry = &entries[idx];
 
-            for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
+            sort_values[idx].m_MajorOrder = entry->m_MajorOrder;
+            if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
             {
-                uint32_t idx = context->m_RenderListSortIndices[i];
-                RenderListEntry* entry = &entries[idx];
-
-                sort_values[idx].m_MajorOrder = entry->m_MajorOrder;
-                if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
-                {
-                    const float z = sort_values[idx].m_ZW;
-                    sort_values[idx].m_Order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (z - minZW));
-                }
-                else
-                {
-                    // use the integer value provided.
-                    sort_values[idx].m_Order = entry->m_Order;
-                }
-                sort_values[idx].m_MinorOrder = entry->m_MinorOrder;
-                sort_values[idx].m_BatchKey = entry->m_BatchKey & 0x00ffffff;
-                sort_values[idx].m_Dispatch = entry->m_Dispatch;
-                context->m_RenderListSortBuffer.Push(idx);
+                const float z = sort_values[idx].m_ZW;
+                sort_values[idx].m_Order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (z - minZW));
+            }
+            else
+            {
+                // use the integer value provided.
+                sort_values[idx].m_Order = entry->m_Order;
             }
+            sort_values[idx].m_MinorOrder = entry->m_MinorOrder;
+            sort_values[idx].m_BatchKey = entry->m_BatchKey & 0x00ffffff;
+            sort_values[idx].m_Dispatch = entry->m_Dispatch;
         }
     }
 
@@ -501,9 +750,16 @@ namespace dmRender
 
         // First sort on the tag masks
         {
-            RenderListEntrySorter sort;
-            sort.m_Base = context->m_RenderList.Begin();
-            std::stable_sort(context->m_RenderListSortIndices.Begin(), context->m_RenderListSortIndices.End(), sort);
+            const RenderListEntry* entries = context->m_RenderList.Begin();
+            uint32_t* indices = context->m_RenderListSortIndices.Begin();
+            uint32_t count = context->m_RenderListSortIndices.Size();
+            RenderListSortPair* pairs = AllocRenderListSortPairs(context, count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                pairs[i].m_Key = entries[indices[i]].m_TagMask;
+                pairs[i].m_Index = indices[i];
+            }
+            SortRenderListPairs(context, count, indices);
         }
         // Now find the ranges of tag masks
         {
@@ -514,6 +770,44 @@ namespace dmRender
         }
     }
 
+    static RenderListSortCacheEntry* FindRenderListSortCache(HRenderContext context, uint32_t tag_mask)
+    {
+        for (uint32_t i = 0; i < RENDER_LIST_SORT_CACHE_SIZE; ++i)
+        {
+            RenderListSortCacheEntry* entry = &context->m_RenderListSortCache[i];
+            if (entry->m_Generation == context->m_RenderListGeneration && entry->m_TagMask == tag_mask &&
+                memcmp(&entry->m_ViewProj, &context->m_ViewProj, sizeof(Matrix4)) == 0)
+            {
+                return entry;
+            }
+        }
+        return 0;
+    }
+
+    // Moves the sort buffer into a cache entry, replacing an outdated entry if there is one
+    static RenderListSortCacheEntry* StoreRenderListSortCache(HRenderContext context, uint32_t tag_mask)
+    {
+        RenderListSortCacheEntry* entry = 0;
+        for (uint32_t i = 0; i < RENDER_LIST_SORT_CACHE_SIZE; ++i)
+        {
+            if (context->m_RenderListSortCache[i].m_Generation != context->m_RenderListGeneration)
+            {
+                entry = &context->m_RenderListSortCache[i];
+                break;
+            }
+        }
+        if (!entry)
+        {
+            entry = &context->m_RenderListSortCache[context->m_RenderListSortCacheNext];
+            context->m_RenderListSortCacheNext = (context->m_RenderListSortCacheNext + 1) % RENDER_LIST_SORT_CACHE_SIZE;
+        }
+        entry->m_ViewProj = context->m_ViewProj;
+        entry->m_TagMask = tag_mask;
+        entry->m_Generation = context->m_RenderListGeneration;
+        entry->m_Indices.Swap(context->m_RenderListSortBuffer);
+        return entry;
+    }
+
     Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer)
     {
         DM_PROFILE(Render, "DrawRenderList");
@@ -533,18 +827,37 @@ namespace dmRender
             SortRenderList(context);
         }
 
-        MakeSortBuffer(context, tag_mask);
+        RenderListSortCacheEntry* sorted = FindRenderListSortCache(context, tag_mask);
+        if (sorted)
+        {
+            DM_COUNTER("RenderListSortCacheHit", 1);
+        }
+        else
+        {
+            DM_COUNTER("RenderListSortCacheMiss", 1);
 
-        if (context->m_RenderListSortBuffer.Empty())
-            return RESULT_OK;
+            MakeSortBuffer(context, tag_mask);
 
-        {
-            DM_PROFILE(Render, "DrawRenderList_SORT");
-            RenderListSorter sort;
-            sort.values = context->m_RenderListSortValues.Begin();
-            std::stable_sort(context->m_RenderListSortBuffer.Begin(), context->m_RenderListSortBuffer.End(), sort);
+            {
+                DM_PROFILE(Render, "DrawRenderList_SORT");
+                const RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
+                uint32_t* indices = context->m_RenderListSortBuffer.Begin();
+                uint32_t count = context->m_RenderListSortBuffer.Size();
+                RenderListSortPair* pairs = AllocRenderListSortPairs(context, count);
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    pairs[i].m_Key = sort_values[indices[i]].m_SortKey;
+                    pairs[i].m_Index = indices[i];
+                }
+                SortRenderListPairs(context, count, indices);
+            }
+
+            sorted = StoreRenderListSortCache(context, tag_mask);
         }
 
+        if (sorted->m_Indices.Empty())
+            return RESULT_OK;
+
         // Construct render objects
         context->m_RenderObjects.SetSize(0);
 
@@ -566,12 +879,12 @@ namespace dmRender
 
         // Make batches for matching dispatch, batch key & minor order
         RenderListEntry *base = context->m_RenderList.Begin();
-        uint32_t *last = context->m_RenderListSortBuffer.Begin();
-        uint32_t count = context->m_RenderListSortBuffer.Size();
+        uint32_t *last = sorted->m_Indices.Begin();
+        uint32_t count = sorted->m_Indices.Size();
 
         for (uint32_t i=1;i<=count;i++)
         {
-            uint32_t *idx = context->m_RenderListSortBuffer.Begin() + i;
+            uint32_t *idx = sorted->m_Indices.Begin() + i;
             const RenderListEntry *last_entry = &base[*last];
             const RenderListEntry *current_entry = &base[*idx];
 
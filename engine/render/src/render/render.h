@@ -167,6 +167,8 @@ namespace dmRender
         /// Max debug vertex count
         /// NOTE: This is per debug-type and not the total sum
         uint32_t                        m_MaxDebugVertexCount;
+        /// Skip world entries outside the view frustum when drawing the render list, off by default
+        uint8_t                         m_FrustumCulling:1;
     };
 
     enum RenderOrder
@@ -185,6 +187,9 @@ namespace dmRender
         uint32_t m_Order;
         uint32_t m_BatchKey;
         uint32_t m_TagMask;
+        /// Radius of a sphere around m_WorldPosition that contains the entry, used for frustum culling.
+        /// Entries with a zero radius are never culled.
+        float    m_BoundRadius;
         uint64_t m_UserData;
         uint32_t m_MinorOrder:4;
         uint32_t m_MajorOrder:2;
@@ -223,6 +228,41 @@ namespace dmRender
     void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end);
     void RenderListEnd(HRenderContext render_context);
 
+    /// Render list arena handle
+    typedef struct RenderListArena* HRenderListArena;
+
+    /**
+     * Create a render list arena. While an arena is bound to a thread, the render list calls
+     * (RenderListAlloc, RenderListMakeDispatch and RenderListSubmit) made on that thread build
+     * the entries into the arena instead of the render list of the context. This makes it possible
+     * to build render lists on several threads at once, one arena per thread.
+     * @return arena handle
+     */
+    HRenderListArena NewRenderListArena();
+
+    /**
+     * Delete a render list arena
+     * @param arena arena handle
+     */
+    void DeleteRenderListArena(HRenderListArena arena);
+
+    /**
+     * Bind an arena to the calling thread, for the render list calls made with the context.
+     * An arena must only be bound to one thread at a time.
+     * @param render_context render context
+     * @param arena arena handle, or 0x0 to unbind the current arena
+     */
+    void RenderListBindArena(HRenderContext render_context, HRenderListArena arena);
+
+    /**
+     * Append the entries and dispatches of an arena to the render list of the context, and clear the arena.
+     * Merging the arenas in the same order every frame gives the same render list as if all entries
+     * were built on the calling thread, in that order. Must not be called while an arena is bound to the calling thread.
+     * @param render_context render context
+     * @param arena arena handle
+     */
+    void RenderListMergeArena(HRenderContext render_context, HRenderListArena arena);
+
     void SetSystemFontMap(HRenderContext render_context, HFontMap font_map);
 
     dmGraphics::HContext GetGraphicsContext(HRenderContext render_context);
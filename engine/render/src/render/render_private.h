@@ -18,6 +18,7 @@
 #include <dlib/array.h>
 #include <dlib/message.h>
 #include <dlib/hashtable.h>
+#include <dlib/thread.h>
 
 #include "render.h"
 
@@ -137,6 +138,7 @@ namespace dmRender
         float               m_Height;
         float               m_Leading;
         float               m_Tracking;
+        float               m_BoundRadius;
         int32_t             m_Next;
         int32_t             m_Tail;
         uint32_t            m_Align : 2;
@@ -144,12 +146,35 @@ namespace dmRender
         uint32_t            m_StencilTestParamsSet : 1;
     };
 
+    struct Glyph;
+
+    struct TextLayoutGlyph
+    {
+        Glyph*  m_Glyph;
+        int16_t m_X;
+        int16_t m_Y;
+    };
+
+    // The visible glyphs of a text, laid out in the local space of the text
+    struct TextLayout
+    {
+        uint64_t            m_Key;
+        TextLayoutGlyph*    m_Glyphs;
+        uint32_t            m_GlyphCount;
+        uint32_t            m_GlyphCapacity;
+        uint32_t            m_Prev;
+        uint32_t            m_Next;
+    };
+
     struct TextContext
     {
         dmArray<dmRender::RenderObject>     m_RenderObjects;
         dmGraphics::HVertexBuffer           m_VertexBuffer;
         void*                               m_ClientBuffer;
         dmGraphics::HVertexDeclaration      m_VertexDecl;
+        // Static index buffer shared by all glyph quads
+        dmGraphics::HIndexBuffer            m_IndexBuffer;
+        dmGraphics::Type                    m_IndexType;
         uint32_t                            m_RenderObjectIndex;
         uint32_t                            m_VertexIndex;
         uint32_t                            m_MaxVertexCount;
@@ -159,6 +184,17 @@ namespace dmRender
         dmArray<TextEntry>                  m_TextEntries;
         uint32_t                            m_TextEntriesFlushed;
         uint32_t                            m_Frame;
+        // Layouts of recently rendered texts, keyed on the text, font and layout parameters
+        dmHashTable64<uint32_t>             m_TextLayoutIndices;
+        dmArray<TextLayout>                 m_TextLayouts;
+        uint32_t                            m_TextLayoutHead; // Most recently used
+        uint32_t                            m_TextLayoutTail; // Least recently used
+        uint32_t                            m_TextLayoutHits;
+        uint32_t                            m_TextLayoutMisses;
+        // Font maps with glyph cache changes that are uploaded at the end of the frame
+        dmArray<HFontMap>                   m_DirtyFontMaps;
+        // Staging for the changed glyph cache rects that aren't contiguous in the cache
+        dmArray<uint8_t>                    m_GlyphUploadBuffer;
     };
 
     struct RenderScriptContext
@@ -194,6 +230,33 @@ namespace dmRender
         };
     };
 
+    // Sort key and render list index, for sorting
+    struct RenderListSortPair
+    {
+        uint64_t m_Key;
+        uint32_t m_Index;
+    };
+
+    // Sorted render list indices of a draw call, reused by later draw calls with the same
+    // tag mask and view projection, as long as the render list is unchanged
+    struct RenderListSortCacheEntry
+    {
+        Matrix4             m_ViewProj;
+        dmArray<uint32_t>   m_Indices;
+        uint32_t            m_TagMask;
+        uint32_t            m_Generation;   // Render list generation when sorted, zero if unused
+    };
+
+    static const uint32_t RENDER_LIST_SORT_CACHE_SIZE = 8;
+
+    // Render list entries built on another thread, see RenderListBindArena
+    struct RenderListArena
+    {
+        dmArray<RenderListEntry>    m_Entries;
+        dmArray<uint32_t>           m_Indices;      // Submitted entries, indices into m_Entries
+        dmArray<RenderListDispatch> m_Dispatch;     // Dispatch indices of the entries are local to the arena
+    };
+
     struct RenderListRange
     {
         uint32_t m_TagMask;
@@ -216,7 +279,13 @@ namespace dmRender
         dmArray<RenderListSortValue>m_RenderListSortValues;
         dmArray<uint32_t>           m_RenderListSortBuffer;
         dmArray<uint32_t>           m_RenderListSortIndices;
+        dmArray<RenderListSortPair> m_RenderListSortPairs;
+        dmArray<RenderListSortPair> m_RenderListSortScratch;   // Scratch buffer for the radix sort
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
+        RenderListSortCacheEntry    m_RenderListSortCache[RENDER_LIST_SORT_CACHE_SIZE];
+        uint32_t                    m_RenderListSortCacheNext;  // Next cache entry to replace
+        uint32_t                    m_RenderListGeneration;     // Incremented when entries are added to the render list
+        dmThread::TlsKey            m_RenderListArenaKey;       // Arena bound to the current thread, if any
 
         HFontMap                    m_SystemFontMap;
 
@@ -232,6 +301,7 @@ namespace dmRender
 
         uint32_t                    m_OutOfResources : 1;
         uint32_t                    m_StencilBufferCleared : 1;
+        uint32_t                    m_FrustumCulling : 1;
     };
 
     void RenderTypeTextBegin(HRenderContext rendercontext, void* user_context);
@@ -258,6 +328,17 @@ namespace dmRender
         RenderListEntry* m_Base;
     };
 
+    struct RenderListSorter
+    {
+        bool operator()(uint32_t a, uint32_t b) const
+        {
+            const RenderListSortValue& u = values[a];
+            const RenderListSortValue& v = values[b];
+            return u.m_SortKey < v.m_SortKey;
+        }
+        RenderListSortValue* values;
+    };
+
     struct FindRangeComparator
     {
         RenderListEntry* m_Entries;
@@ -273,6 +354,9 @@ namespace dmRender
     void FindRenderListRanges(uint32_t* first, size_t offset, size_t size, RenderListEntry* entries, FindRangeComparator& comp, void* ctx, RangeCallback callback );
 
     bool FindTagMaskRange(RenderListRange* ranges, uint32_t num_ranges, uint32_t tag_mask, RenderListRange& range);
+
+    // Stable sort of the pairs on the key (LSB radix sort). The scratch buffer is grown when needed.
+    void RadixSort(RenderListSortPair* pairs, uint32_t count, dmArray<RenderListSortPair>& scratch);
 }
 
 #endif
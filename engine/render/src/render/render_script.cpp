@@ -2758,7 +2758,15 @@ bail:
 
                 dmMessage::Message* message = (dmMessage::Message*)args;
                 dmScript::PushHash(L, message->m_Id);
-                if (message->m_Descriptor != 0)
+                if (dmScript::IsSharedPayloadMessage(message->m_Descriptor))
+                {
+                    if (dmProfile::g_IsInitialized)
+                    {
+                        message_name = (const char*)dmHashReverse64(message->m_Id, 0);
+                    }
+                    dmScript::PushSharedPayload(L, (const char*)message->m_Data, message->m_DataSize);
+                }
+                else if (message->m_Descriptor != 0)
                 {
                     dmDDF::Descriptor* descriptor = (dmDDF::Descriptor*)message->m_Descriptor;
                     // TODO: setjmp/longjmp here... how to handle?!!! We are not running "from lua" here
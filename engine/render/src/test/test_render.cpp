@@ -11,12 +11,18 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/math.h>
+#include <dlib/thread.h>
+#include <dlib/time.h>
 
 #include <script/script.h>
 #include <algorithm> // std::stable_sort
@@ -49,6 +55,7 @@ protected:
         params.m_ScriptContext = m_ScriptContext;
         params.m_MaxDebugVertexCount = 256;
         params.m_MaxCharacters = 256;
+        params.m_FrustumCulling = 1;
         m_Context = dmRender::NewRenderContext(m_GraphicsContext, params);
 
         dmRender::FontMapParams font_map_params;
@@ -438,6 +445,247 @@ TEST_F(dmRenderTest, TestRenderListOrder)
     ASSERT_EQ(ctx.m_Z, orders[2]);
 }
 
+struct TestRenderListCullingDispatchCtx
+{
+    uint32_t m_EntriesRendered;
+    uint64_t m_RenderedMask;
+};
+
+static void TestRenderListCullingDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestRenderListCullingDispatchCtx *ctx = (TestRenderListCullingDispatchCtx*) params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+        {
+            ctx->m_EntriesRendered++;
+            ctx->m_RenderedMask |= 1ULL << params.m_Buf[*i].m_UserData;
+        }
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListFrustumCulling)
+{
+    TestRenderListCullingDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(TestRenderListCullingDispatchCtx));
+
+    // Visible volume is x [0, WIDTH], y [0, HEIGHT], z [-1, -0.1]
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, HEIGHT, 0.0f, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestRenderListCullingDispatch, &ctx);
+
+    struct Entry
+    {
+        Point3   m_Position;
+        float    m_Radius;
+        uint32_t m_MajorOrder;
+        bool     m_Visible;
+    };
+    const Entry entries[] = {
+        { Point3(WIDTH * 0.5f, HEIGHT * 0.5f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, true },
+        { Point3(-100.0f, HEIGHT * 0.5f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, false },      // left
+        { Point3(WIDTH + 100.0f, HEIGHT * 0.5f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, false },// right
+        { Point3(WIDTH * 0.5f, -100.0f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, false },       // below
+        { Point3(WIDTH * 0.5f, HEIGHT + 100.0f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, false },// above
+        { Point3(WIDTH * 0.5f, HEIGHT * 0.5f, 5.0f), 1.0f, dmRender::RENDER_ORDER_WORLD, false },    // behind the camera
+        { Point3(WIDTH * 0.5f, HEIGHT * 0.5f, -5.0f), 1.0f, dmRender::RENDER_ORDER_WORLD, false },   // beyond the far plane
+        { Point3(-5.0f, HEIGHT * 0.5f, -0.5f), 10.0f, dmRender::RENDER_ORDER_WORLD, true },         // intersects the left plane
+        { Point3(-100.0f, HEIGHT * 0.5f, -0.5f), 0.0f, dmRender::RENDER_ORDER_WORLD, true },        // no bounds
+        { Point3(-100.0f, HEIGHT * 0.5f, -0.5f), 10.0f, dmRender::RENDER_ORDER_AFTER_WORLD, true }, // not in world space
+    };
+    const uint32_t n = sizeof(entries) / sizeof(entries[0]);
+
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry & entry = out[i];
+        entry.m_WorldPosition = entries[i].m_Position;
+        entry.m_BoundRadius = entries[i].m_Radius;
+        entry.m_MajorOrder = entries[i].m_MajorOrder;
+        entry.m_MinorOrder = 0;
+        entry.m_TagMask = 0;
+        entry.m_Order = i;
+        entry.m_BatchKey = 0;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = i;
+    }
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0);
+
+    uint32_t visible_count = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(entries[i].m_Visible, (ctx.m_RenderedMask & (1ULL << i)) != 0);
+        visible_count += entries[i].m_Visible ? 1 : 0;
+    }
+    ASSERT_EQ(visible_count, ctx.m_EntriesRendered);
+}
+
+TEST_F(dmRenderTest, TestRenderListSortCache)
+{
+    // Repeated draw calls reuse the sorted render list, as long as the view projection and the list are unchanged
+    TestRenderListCullingDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(TestRenderListCullingDispatchCtx));
+
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, HEIGHT, 0.0f, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestRenderListCullingDispatch, &ctx);
+
+    // One entry on screen, and one to the left of the screen
+    const uint32_t n = 2;
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry & entry = out[i];
+        entry.m_WorldPosition = Point3(i == 0 ? WIDTH * 0.5f : -100.0f, HEIGHT * 0.5f, -0.5f);
+        entry.m_BoundRadius = 10.0f;
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = i;
+    }
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(1U, ctx.m_EntriesRendered);
+    ASSERT_EQ(1ULL, ctx.m_RenderedMask);
+
+    memset(&ctx, 0x00, sizeof(TestRenderListCullingDispatchCtx));
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(1U, ctx.m_EntriesRendered);
+    ASSERT_EQ(1ULL, ctx.m_RenderedMask);
+
+    // Move the view so that only the second entry is visible
+    view = Vectormath::Aos::Matrix4::translation(Vector3(WIDTH * 0.5f + 100.0f, 0.0f, 0.0f));
+    dmRender::SetViewMatrix(m_Context, view);
+    memset(&ctx, 0x00, sizeof(TestRenderListCullingDispatchCtx));
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(1U, ctx.m_EntriesRendered);
+    ASSERT_EQ(2ULL, ctx.m_RenderedMask);
+
+    // Entries submitted between the draw calls are included
+    out = dmRender::RenderListAlloc(m_Context, 1);
+    out->m_WorldPosition = Point3(-100.0f, HEIGHT * 0.5f, -0.5f);
+    out->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+    out->m_Dispatch = dispatch;
+    out->m_UserData = 2;
+    dmRender::RenderListSubmit(m_Context, out, out + 1);
+    memset(&ctx, 0x00, sizeof(TestRenderListCullingDispatchCtx));
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    ASSERT_EQ(2U, ctx.m_EntriesRendered);
+    ASSERT_EQ(6ULL, ctx.m_RenderedMask);
+}
+
+// Submits the first two of three entries, with user data first, first+1 and first+2
+static void BuildTestArenaEntries(dmRender::HRenderContext context, TestRenderListCullingDispatchCtx* dispatch_ctx, uint32_t first)
+{
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(context, TestRenderListCullingDispatch, dispatch_ctx);
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(context, 3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        dmRender::RenderListEntry & entry = out[i];
+        entry.m_WorldPosition = Point3(WIDTH * 0.5f, HEIGHT * 0.5f, -0.5f);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = first + i;
+    }
+    dmRender::RenderListSubmit(context, out, out + 2);
+}
+
+struct TestArenaThreadCtx
+{
+    dmRender::HRenderContext            m_Context;
+    dmRender::HRenderListArena          m_Arena;
+    TestRenderListCullingDispatchCtx*   m_DispatchCtx;
+    uint32_t                            m_First;
+};
+
+static void BuildTestArenaThread(void* arg)
+{
+    TestArenaThreadCtx* ctx = (TestArenaThreadCtx*)arg;
+    dmRender::RenderListBindArena(ctx->m_Context, ctx->m_Arena);
+    BuildTestArenaEntries(ctx->m_Context, ctx->m_DispatchCtx, ctx->m_First);
+    dmRender::RenderListBindArena(ctx->m_Context, 0x0);
+}
+
+TEST_F(dmRenderTest, TestRenderListArena)
+{
+    // Entries built on other threads are merged in the same order as if they were built on this thread
+    TestRenderListCullingDispatchCtx dispatch_ctx[3];
+    memset(dispatch_ctx, 0x00, sizeof(dispatch_ctx));
+
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, HEIGHT, 0.0f, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    dmRender::RenderListBegin(m_Context);
+    BuildTestArenaEntries(m_Context, &dispatch_ctx[0], 0);
+
+    TestArenaThreadCtx thread_ctx[2];
+    dmThread::Thread threads[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        thread_ctx[i].m_Context = m_Context;
+        thread_ctx[i].m_Arena = dmRender::NewRenderListArena();
+        thread_ctx[i].m_DispatchCtx = &dispatch_ctx[i + 1];
+        thread_ctx[i].m_First = (i + 1) * 4;
+        threads[i] = dmThread::New(BuildTestArenaThread, 0x80000, &thread_ctx[i], "arena");
+    }
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+
+    // Nothing is added to the render list until the arenas are merged
+    ASSERT_EQ(3U, m_Context->m_RenderList.Size());
+    ASSERT_EQ(2U, m_Context->m_RenderListSortIndices.Size());
+    ASSERT_EQ(1U, m_Context->m_RenderListDispatch.Size());
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        dmRender::RenderListMergeArena(m_Context, thread_ctx[i].m_Arena);
+    }
+    // Merged arenas are empty
+    dmRender::RenderListMergeArena(m_Context, thread_ctx[0].m_Arena);
+
+    ASSERT_EQ(9U, m_Context->m_RenderList.Size());
+    ASSERT_EQ(6U, m_Context->m_RenderListSortIndices.Size());
+    ASSERT_EQ(3U, m_Context->m_RenderListDispatch.Size());
+    for (uint32_t i = 0; i < 9; ++i)
+    {
+        const dmRender::RenderListEntry& entry = m_Context->m_RenderList[i];
+        ASSERT_EQ((i / 3) * 4 + i % 3, entry.m_UserData);
+        ASSERT_EQ(i / 3, (uint32_t)entry.m_Dispatch);
+    }
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        ASSERT_EQ((i / 2) * 3 + i % 2, m_Context->m_RenderListSortIndices[i]);
+    }
+    dmRender::RenderListEnd(m_Context);
+
+    dmRender::DrawRenderList(m_Context, 0, 0);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(2U, dispatch_ctx[i].m_EntriesRendered);
+        ASSERT_EQ(3ULL << (i * 4), dispatch_ctx[i].m_RenderedMask);
+    }
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        dmRender::DeleteRenderListArena(thread_ctx[i].m_Arena);
+    }
+}
+
 TEST_F(dmRenderTest, TestRenderListDebug)
 {
     // Test submitting debug drawing when there is no other drawing going on
@@ -665,6 +913,408 @@ TEST_F(dmRenderTest, TextAlignment)
     }
 }
 
+TEST_F(dmRenderTest, TextLayoutCache)
+{
+    dmRender::TextContext& text_context = m_Context->m_TextContext;
+    const int charwidth = 2;
+    const int lineheight = 3;
+
+    dmRender::TextEntry te;
+    memset(&te, 0, sizeof(te));
+    te.m_Width = 8*charwidth;
+    te.m_Leading = 1.0f;
+    te.m_LineBreak = true;
+
+    uint32_t hits = text_context.m_TextLayoutHits;
+    uint32_t misses = text_context.m_TextLayoutMisses;
+
+    // Two lines of five glyphs
+    dmRender::TextLayout* layout = dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te);
+    ASSERT_EQ(misses + 1, text_context.m_TextLayoutMisses);
+    ASSERT_EQ(10U, layout->m_GlyphCount);
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ((int16_t)(i*charwidth), layout->m_Glyphs[i].m_X);
+        ASSERT_EQ((int16_t)(i*charwidth), layout->m_Glyphs[i + 5].m_X);
+        ASSERT_EQ(layout->m_Glyphs[0].m_Y, layout->m_Glyphs[i].m_Y);
+        ASSERT_EQ(layout->m_Glyphs[0].m_Y - lineheight, layout->m_Glyphs[i + 5].m_Y);
+    }
+
+    ASSERT_EQ(layout, dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te));
+    ASSERT_EQ(hits + 1, text_context.m_TextLayoutHits);
+
+    // Without line breaks it is a different layout
+    te.m_LineBreak = false;
+    layout = dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te);
+    ASSERT_EQ(misses + 2, text_context.m_TextLayoutMisses);
+    ASSERT_EQ(11U, layout->m_GlyphCount);
+
+    // Fill the cache, while keeping the first layout recently used
+    uint32_t capacity = text_context.m_TextLayouts.Capacity();
+    for (uint32_t i = 0; i < capacity - 1; ++i)
+    {
+        char text[16];
+        dmSnPrintf(text, sizeof(text), "%u", i);
+        dmRender::GetTextLayout(text_context, m_SystemFontMap, text, te);
+        te.m_LineBreak = true;
+        dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te);
+        te.m_LineBreak = false;
+    }
+    ASSERT_EQ(capacity, text_context.m_TextLayouts.Size());
+
+    misses = text_context.m_TextLayoutMisses;
+    te.m_LineBreak = true;
+    dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te);
+    ASSERT_EQ(misses, text_context.m_TextLayoutMisses);
+    te.m_LineBreak = false;
+    dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello World", te);
+    ASSERT_EQ(misses + 1, text_context.m_TextLayoutMisses);
+
+    // Aligned texts without line breaks are offset by the width of the text entry
+    te.m_Align = dmRender::TEXT_ALIGN_RIGHT;
+    te.m_Width = 20*charwidth;
+    layout = dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello", te);
+    ASSERT_EQ(5U, layout->m_GlyphCount);
+    ASSERT_EQ((int16_t)(15*charwidth), layout->m_Glyphs[0].m_X);
+    te.m_Width = 30*charwidth;
+    layout = dmRender::GetTextLayout(text_context, m_SystemFontMap, "Hello", te);
+    ASSERT_EQ(5U, layout->m_GlyphCount);
+    ASSERT_EQ((int16_t)(25*charwidth), layout->m_Glyphs[0].m_X);
+}
+
+TEST_F(dmRenderTest, GlyphCache)
+{
+    dmRender::TextContext& text_context = m_Context->m_TextContext;
+
+    // 25 glyphs of 6x6 pixels fit in the cache, the last glyph is 12x12
+    const uint32_t glyph_count = 27;
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 32;
+    font_map_params.m_CacheHeight = 32;
+    font_map_params.m_CacheCellWidth = 12;
+    font_map_params.m_CacheCellHeight = 12;
+    font_map_params.m_MaxAscent = 8;
+    font_map_params.m_MaxDescent = 4;
+    font_map_params.m_Glyphs.SetCapacity(glyph_count);
+    font_map_params.m_Glyphs.SetSize(glyph_count);
+    memset((void*)&font_map_params.m_Glyphs[0], 0, sizeof(dmRender::Glyph)*glyph_count);
+    uint32_t glyph_data_size = 0;
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        uint32_t scale = i == glyph_count - 1 ? 2 : 1;
+        dmRender::Glyph& g = font_map_params.m_Glyphs[i];
+        g.m_Character = 'A' + i;
+        g.m_Width = 6 * scale;
+        g.m_Advance = 6 * scale;
+        g.m_Ascent = 4 * scale;
+        g.m_Descent = 2 * scale;
+        g.m_GlyphDataOffset = glyph_data_size;
+        g.m_GlyphDataSize = 1 + g.m_Width * (g.m_Ascent + g.m_Descent); // Uncompressed
+        glyph_data_size += g.m_GlyphDataSize;
+    }
+    font_map_params.m_GlyphData = calloc(1, glyph_data_size);
+    dmRender::HFontMap font_map = dmRender::NewFontMap(m_GraphicsContext, font_map_params);
+
+    dmRender::Glyph* glyphs[glyph_count];
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        glyphs[i] = dmRender::GetGlyph(font_map, 'A' + i);
+    }
+
+    for (uint32_t i = 0; i < 25; ++i)
+    {
+        ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, glyphs[i]));
+    }
+    // The changes are uploaded once, at the end of the frame
+    ASSERT_EQ(1U, text_context.m_DirtyFontMaps.Size());
+    ASSERT_EQ(font_map, text_context.m_DirtyFontMaps[0]);
+
+    // Glyphs used this frame are never evicted
+    ASSERT_FALSE(dmRender::CacheGlyph(font_map, text_context, glyphs[25]));
+
+    dmRender::FontMapCacheStats stats;
+    dmRender::GetFontMapCacheStats(font_map, &stats);
+    ASSERT_EQ(0U, stats.m_Hits);
+    ASSERT_EQ(26U, stats.m_Misses);
+    ASSERT_EQ(0U, stats.m_Evictions);
+
+    // The least recently used glyph is evicted
+    text_context.m_Frame++;
+    ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, glyphs[0]));
+    int32_t x = glyphs[1]->m_X;
+    int32_t y = glyphs[1]->m_Y;
+    ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, glyphs[25]));
+    ASSERT_FALSE(glyphs[1]->m_InCache);
+    ASSERT_EQ(x, glyphs[25]->m_X);
+    ASSERT_EQ(y, glyphs[25]->m_Y);
+
+    dmRender::GetFontMapCacheStats(font_map, &stats);
+    ASSERT_EQ(1U, stats.m_Hits);
+    ASSERT_EQ(27U, stats.m_Misses);
+    ASSERT_EQ(1U, stats.m_Evictions);
+
+    // A larger glyph takes the place of several evicted ones
+    ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, glyphs[26]));
+    ASSERT_TRUE(glyphs[0]->m_InCache);
+    ASSERT_TRUE(glyphs[25]->m_InCache);
+    dmRender::GetFontMapCacheStats(font_map, &stats);
+    ASSERT_LT(2U, stats.m_Evictions);
+
+    // The cached glyphs must not overlap
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        const dmRender::Glyph* a = glyphs[i];
+        if (!a->m_InCache)
+            continue;
+        int32_t a_height = a->m_Ascent + a->m_Descent;
+        ASSERT_LE(a->m_X + (int32_t)a->m_Width, 32);
+        ASSERT_LE(a->m_Y + a_height, 32);
+        for (uint32_t j = i + 1; j < glyph_count; ++j)
+        {
+            const dmRender::Glyph* b = glyphs[j];
+            if (!b->m_InCache)
+                continue;
+            int32_t b_height = b->m_Ascent + b->m_Descent;
+            bool overlap = a->m_X < b->m_X + (int32_t)b->m_Width && b->m_X < a->m_X + (int32_t)a->m_Width &&
+                           a->m_Y < b->m_Y + b_height && b->m_Y < a->m_Y + a_height;
+            ASSERT_FALSE(overlap);
+        }
+    }
+
+    text_context.m_DirtyFontMaps.SetSize(0);
+    dmRender::DeleteFontMap(font_map);
+}
+
+// A font map with 6x6 glyphs 'A', 'B', ... in a 32x32 cache, five glyphs per row
+static dmRender::HFontMap NewGlyphCacheUploadFontMap(dmGraphics::HContext graphics_context, uint32_t glyph_count)
+{
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 32;
+    font_map_params.m_CacheHeight = 32;
+    font_map_params.m_CacheCellWidth = 6;
+    font_map_params.m_CacheCellHeight = 6;
+    font_map_params.m_MaxAscent = 4;
+    font_map_params.m_MaxDescent = 2;
+    font_map_params.m_Glyphs.SetCapacity(glyph_count);
+    font_map_params.m_Glyphs.SetSize(glyph_count);
+    memset((void*)&font_map_params.m_Glyphs[0], 0, sizeof(dmRender::Glyph)*glyph_count);
+    uint32_t glyph_data_size = 0;
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        dmRender::Glyph& g = font_map_params.m_Glyphs[i];
+        g.m_Character = 'A' + i;
+        g.m_Width = 6;
+        g.m_Advance = 6;
+        g.m_Ascent = 4;
+        g.m_Descent = 2;
+        g.m_GlyphDataOffset = glyph_data_size;
+        g.m_GlyphDataSize = 1 + g.m_Width * (g.m_Ascent + g.m_Descent); // Uncompressed
+        glyph_data_size += g.m_GlyphDataSize;
+    }
+    font_map_params.m_GlyphData = calloc(1, glyph_data_size);
+    return dmRender::NewFontMap(graphics_context, font_map_params);
+}
+
+TEST_F(dmRenderTest, GlyphCacheUpload)
+{
+    dmRender::TextContext& text_context = m_Context->m_TextContext;
+
+    const uint32_t glyph_count = 6;
+    dmRender::HFontMap font_map = NewGlyphCacheUploadFontMap(m_GraphicsContext, glyph_count);
+
+    // Only the glyphs are uploaded, not the full rows of the cache they are in
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, dmRender::GetGlyph(font_map, 'A' + i)));
+    }
+    ASSERT_EQ(1U, text_context.m_DirtyFontMaps.Size());
+    dmRender::UploadGlyphCaches(text_context);
+    ASSERT_EQ(0U, text_context.m_DirtyFontMaps.Size());
+
+    dmRender::FontMapCacheStats stats;
+    dmRender::GetFontMapCacheStats(font_map, &stats);
+    ASSERT_EQ(glyph_count * 6 * 6, stats.m_UploadSize);
+
+    // Nothing is uploaded when the glyphs are already in the cache
+    text_context.m_Frame++;
+    ASSERT_TRUE(dmRender::CacheGlyph(font_map, text_context, dmRender::GetGlyph(font_map, 'A')));
+    ASSERT_EQ(0U, text_context.m_DirtyFontMaps.Size());
+
+    // A font map that is deleted before the end of the frame is no longer uploaded
+    dmRender::HFontMap deleted_font_map = NewGlyphCacheUploadFontMap(m_GraphicsContext, glyph_count);
+    ASSERT_TRUE(dmRender::CacheGlyph(deleted_font_map, text_context, dmRender::GetGlyph(deleted_font_map, 'A')));
+    ASSERT_EQ(1U, text_context.m_DirtyFontMaps.Size());
+    dmRender::DeleteFontMap(deleted_font_map);
+    ASSERT_EQ(0U, text_context.m_DirtyFontMaps.Size());
+    dmRender::UploadGlyphCaches(text_context);
+
+    dmRender::DeleteFontMap(font_map);
+}
+
+// A font map with 6x6 glyphs 'A', 'B', ... in a 32x32 cache, with the given layers (face 0x1, outline 0x2, shadow 0x4)
+static dmRender::HFontMap NewTextVertexFontMap(dmGraphics::HContext graphics_context, uint32_t glyph_count, uint8_t layer_mask)
+{
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 32;
+    font_map_params.m_CacheHeight = 32;
+    font_map_params.m_CacheCellWidth = 6;
+    font_map_params.m_CacheCellHeight = 6;
+    font_map_params.m_MaxAscent = 4;
+    font_map_params.m_MaxDescent = 2;
+    font_map_params.m_Alpha = 1.0f;
+    font_map_params.m_OutlineAlpha = 1.0f;
+    font_map_params.m_ShadowAlpha = 1.0f;
+    font_map_params.m_ShadowX = 2.0f;
+    font_map_params.m_ShadowY = -3.0f;
+    font_map_params.m_LayerMask = layer_mask;
+    font_map_params.m_Glyphs.SetCapacity(glyph_count);
+    font_map_params.m_Glyphs.SetSize(glyph_count);
+    memset((void*)&font_map_params.m_Glyphs[0], 0, sizeof(dmRender::Glyph)*glyph_count);
+    uint32_t glyph_data_size = 0;
+    for (uint32_t i = 0; i < glyph_count; ++i)
+    {
+        dmRender::Glyph& g = font_map_params.m_Glyphs[i];
+        g.m_Character = 'A' + i;
+        g.m_Width = 6;
+        g.m_Advance = 6;
+        g.m_Ascent = 4;
+        g.m_Descent = 2;
+        g.m_GlyphDataOffset = glyph_data_size;
+        g.m_GlyphDataSize = 1 + g.m_Width * (g.m_Ascent + g.m_Descent); // Uncompressed
+        glyph_data_size += g.m_GlyphDataSize;
+    }
+    font_map_params.m_GlyphData = calloc(1, glyph_data_size);
+    return dmRender::NewFontMap(graphics_context, font_map_params);
+}
+
+static void AssertGlyphColor(const uint8_t* color, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    ASSERT_EQ(r, color[0]);
+    ASSERT_EQ(g, color[1]);
+    ASSERT_EQ(b, color[2]);
+    ASSERT_EQ(a, color[3]);
+}
+
+// Checks one glyph quad, in the order left-bottom, left-top, right-bottom, right-top
+static void AssertGlyphQuad(const dmRender::GlyphVertex* quad, dmRender::HFontMap font_map, char c, float x, float y, uint8_t face, uint8_t outline, uint8_t shadow)
+{
+    const dmRender::Glyph* g = dmRender::GetGlyph(font_map, c);
+    ASSERT_TRUE(g->m_InCache);
+
+    // The UVs are normalized to the whole uint16 range, in the 32x32 cache
+    uint16_t u[] = { (uint16_t)(g->m_X / 32.0f * 65535.0f + 0.5f), (uint16_t)((g->m_X + 6) / 32.0f * 65535.0f + 0.5f) };
+    uint16_t v[] = { (uint16_t)((g->m_Y + 6) / 32.0f * 65535.0f + 0.5f), (uint16_t)(g->m_Y / 32.0f * 65535.0f + 0.5f) };
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        const dmRender::GlyphVertex& vertex = quad[i];
+        ASSERT_EQ(x + (i / 2) * 6.0f, vertex.m_Position[0]);
+        ASSERT_EQ(y + (i % 2) * 6.0f, vertex.m_Position[1]);
+        ASSERT_EQ(0.5f, vertex.m_Position[2]);
+        ASSERT_EQ(u[i / 2], vertex.m_UV[0]);
+        ASSERT_EQ(v[i % 2], vertex.m_UV[1]);
+        AssertGlyphColor(vertex.m_FaceColor, 255, 0, 0, 255);
+        AssertGlyphColor(vertex.m_OutlineColor, 0, 255, 0, 255);
+        AssertGlyphColor(vertex.m_ShadowColor, 0, 0, 255, 127);
+        AssertGlyphColor(vertex.m_LayerMasks, face, outline, shadow, 0);
+    }
+}
+
+TEST_F(dmRenderTest, TextVertexData)
+{
+    dmRender::TextContext& text_context = m_Context->m_TextContext;
+
+    dmGraphics::ShaderDesc::Shader shader;
+    memset(&shader, 0, sizeof(shader));
+    shader.m_Source.m_Data = (uint8_t*)"foo";
+    shader.m_Source.m_Count = 3;
+    dmGraphics::HVertexProgram vp = dmGraphics::NewVertexProgram(m_GraphicsContext, &shader);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &shader);
+    dmRender::HMaterial material = dmRender::NewMaterial(m_Context, vp, fp);
+
+    dmRender::HFontMap face_font_map = NewTextVertexFontMap(m_GraphicsContext, 3, 0x1);
+    dmRender::HFontMap layered_font_map = NewTextVertexFontMap(m_GraphicsContext, 3, 0x7);
+
+    dmRender::RenderListBegin(m_Context);
+
+    dmRender::DrawTextParams params;
+    params.m_WorldTransform = Matrix4::translation(Vector3(100.0f, 50.0f, 0.5f));
+    params.m_FaceColor = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+    params.m_OutlineColor = Vector4(0.0f, 1.0f, 0.0f, 1.0f);
+    params.m_ShadowColor = Vector4(0.0f, 0.0f, 1.0f, 0.5f);
+    params.m_VAlign = dmRender::TEXT_VALIGN_BOTTOM;
+    params.m_Text = "AB";
+    dmRender::DrawText(m_Context, face_font_map, material, 0, params);
+    params.m_Text = "ABC";
+    dmRender::DrawText(m_Context, layered_font_map, material, 0, params);
+
+    dmRender::FlushTexts(m_Context, dmRender::RENDER_ORDER_AFTER_WORLD, 0, true);
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::DrawRenderList(m_Context, 0, 0));
+
+    // 4 vertices per glyph and layer
+    ASSERT_EQ(2U * 4 + 3U * 4 * 3, text_context.m_VertexIndex);
+    ASSERT_EQ(2U, text_context.m_RenderObjectIndex);
+
+    const dmRender::RenderObject* face_ro = &text_context.m_RenderObjects[0];
+    const dmRender::RenderObject* layered_ro = &text_context.m_RenderObjects[1];
+    if (face_ro->m_Textures[0] != dmRender::GetFontMapTexture(face_font_map))
+    {
+        std::swap(face_ro, layered_ro);
+    }
+    ASSERT_EQ(dmRender::GetFontMapTexture(face_font_map), face_ro->m_Textures[0]);
+    ASSERT_EQ(dmRender::GetFontMapTexture(layered_font_map), layered_ro->m_Textures[0]);
+
+    // The quads are drawn from the shared index buffer, with 6 indices per quad and a byte offset to the first index
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const dmRender::RenderObject* ro = &text_context.m_RenderObjects[i];
+        ASSERT_EQ(text_context.m_VertexBuffer, ro->m_VertexBuffer);
+        ASSERT_EQ(text_context.m_IndexBuffer, ro->m_IndexBuffer);
+        ASSERT_EQ(dmGraphics::TYPE_UNSIGNED_SHORT, ro->m_IndexType);
+        ASSERT_EQ(dmGraphics::PRIMITIVE_TRIANGLES, ro->m_PrimitiveType);
+    }
+    ASSERT_EQ(2U * 6, face_ro->m_VertexCount);
+    ASSERT_EQ(3U * 3 * 6, layered_ro->m_VertexCount);
+    if (face_ro->m_VertexStart == 0)
+    {
+        ASSERT_EQ(2U * 6 * sizeof(uint16_t), layered_ro->m_VertexStart);
+    }
+    else
+    {
+        ASSERT_EQ(0U, layered_ro->m_VertexStart);
+        ASSERT_EQ(3U * 3 * 6 * sizeof(uint16_t), face_ro->m_VertexStart);
+    }
+
+    const dmRender::GlyphVertex* vertices = (const dmRender::GlyphVertex*)text_context.m_ClientBuffer;
+
+    // A single layer is drawn with all layer masks set
+    const dmRender::GlyphVertex* face = &vertices[(face_ro->m_VertexStart / (6 * sizeof(uint16_t))) * 4];
+    float x = face[0].m_Position[0];
+    float y = face[0].m_Position[1];
+    ASSERT_EQ(100.0f, x);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        AssertGlyphQuad(&face[i * 4], face_font_map, 'A' + i, x + i * 6.0f, y, 255, 255, 255);
+    }
+
+    // The layers are drawn back to front, the shadows of all glyphs first, then the outlines and the faces
+    const dmRender::GlyphVertex* layers = &vertices[(layered_ro->m_VertexStart / (6 * sizeof(uint16_t))) * 4];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        AssertGlyphQuad(&layers[i * 4], layered_font_map, 'A' + i, x + i * 6.0f + 2.0f, y - 3.0f, 0, 0, 255);
+        AssertGlyphQuad(&layers[(3 + i) * 4], layered_font_map, 'A' + i, x + i * 6.0f, y, 0, 255, 0);
+        AssertGlyphQuad(&layers[(6 + i) * 4], layered_font_map, 'A' + i, x + i * 6.0f, y, 255, 0, 0);
+    }
+
+    dmRender::ClearRenderObjects(m_Context);
+    text_context.m_DirtyFontMaps.SetSize(0);
+    dmRender::DeleteFontMap(face_font_map);
+    dmRender::DeleteFontMap(layered_font_map);
+
+    dmRender::DeleteMaterial(m_Context, material);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+}
+
 struct SRangeCtx
 {
     uint32_t m_NumRanges;
@@ -762,6 +1412,148 @@ TEST_F(dmRenderTest, FindRanges)
     ASSERT_EQ(6, range.m_Count);
 }
 
+static void MakeRandomSortValues(dmArray<dmRender::RenderListSortValue>& values, uint32_t count, uint32_t seed)
+{
+    srand(seed);
+    values.SetCapacity(count);
+    values.SetSize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmRender::RenderListSortValue& v = values[i];
+        v.m_SortKey = 0;
+        // Few batch keys and dispatches, many orders, like a typical frame
+        v.m_BatchKey = rand() % 16;
+        v.m_Dispatch = rand() % 4;
+        v.m_Order = rand() & 0xffffff;
+        v.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        v.m_MinorOrder = 0;
+    }
+}
+
+static void RadixSortIndices(dmRender::RenderListSortValue* values, uint32_t* indices, uint32_t count,
+                             dmArray<dmRender::RenderListSortPair>& pairs, dmArray<dmRender::RenderListSortPair>& scratch)
+{
+    pairs.SetCapacity(count);
+    pairs.SetSize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        pairs[i].m_Key = values[indices[i]].m_SortKey;
+        pairs[i].m_Index = indices[i];
+    }
+    dmRender::RadixSort(pairs.Begin(), count, scratch);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        indices[i] = pairs[i].m_Index;
+    }
+}
+
+TEST(dmRenderListSort, RadixSort)
+{
+    const uint32_t count = 5000;
+    dmArray<dmRender::RenderListSortValue> values;
+    MakeRandomSortValues(values, count, 42);
+    // Many duplicate keys, to verify that the sort is stable
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values[i].m_Order &= 0x3;
+    }
+
+    dmArray<uint32_t> expected;
+    dmArray<uint32_t> actual;
+    expected.SetCapacity(count);
+    expected.SetSize(count);
+    actual.SetCapacity(count);
+    actual.SetSize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Indices in reverse order, so that the stable order differs from the index order
+        expected[i] = actual[i] = count - 1 - i;
+    }
+
+    dmRender::RenderListSorter sort;
+    sort.values = values.Begin();
+    std::stable_sort(expected.Begin(), expected.End(), sort);
+
+    dmArray<dmRender::RenderListSortPair> pairs;
+    dmArray<dmRender::RenderListSortPair> scratch;
+    RadixSortIndices(values.Begin(), actual.Begin(), count, pairs, scratch);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(expected[i], actual[i]);
+    }
+
+    // Keys where all bytes differ
+    dmRender::RenderListSortPair wide[4] = {
+        { 0x0102030405060708ULL, 0 },
+        { 0x0000000000000001ULL, 1 },
+        { 0xff00000000000000ULL, 2 },
+        { 0x0102030405060707ULL, 3 },
+    };
+    dmRender::RadixSort(wide, 4, scratch);
+    ASSERT_EQ(1U, wide[0].m_Index);
+    ASSERT_EQ(3U, wide[1].m_Index);
+    ASSERT_EQ(0U, wide[2].m_Index);
+    ASSERT_EQ(2U, wide[3].m_Index);
+
+    // Trivial sizes
+    dmRender::RadixSort(wide, 0, scratch);
+    dmRender::RadixSort(wide, 1, scratch);
+    ASSERT_EQ(1U, wide[0].m_Index);
+}
+
+static void RunSortBenchmark(uint32_t count)
+{
+    const uint32_t iterations = 20;
+    dmArray<dmRender::RenderListSortValue> values;
+    MakeRandomSortValues(values, count, 1234);
+
+    dmArray<uint32_t> indices;
+    indices.SetCapacity(count);
+    indices.SetSize(count);
+    dmArray<dmRender::RenderListSortPair> pairs;
+    dmArray<dmRender::RenderListSortPair> scratch;
+
+    dmRender::RenderListSorter sort;
+    sort.values = values.Begin();
+
+    uint64_t stable_sort_time = 0;
+    uint64_t radix_sort_time = 0;
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        for (uint32_t j = 0; j < count; ++j)
+            indices[j] = j;
+        uint64_t start = dmTime::GetTime();
+        std::stable_sort(indices.Begin(), indices.End(), sort);
+        stable_sort_time += dmTime::GetTime() - start;
+
+        for (uint32_t j = 0; j < count; ++j)
+            indices[j] = j;
+        start = dmTime::GetTime();
+        RadixSortIndices(values.Begin(), indices.Begin(), count, pairs, scratch);
+        radix_sort_time += dmTime::GetTime() - start;
+    }
+
+    printf("Render list sort %6u entries: stable_sort %7.3f ms, radix sort %7.3f ms\n", count,
+        stable_sort_time / (iterations * 1000.0f),
+        radix_sort_time / (iterations * 1000.0f));
+}
+
+TEST(dmRenderListSort, Benchmark1k)
+{
+    RunSortBenchmark(1000);
+}
+
+TEST(dmRenderListSort, Benchmark10k)
+{
+    RunSortBenchmark(10000);
+}
+
+TEST(dmRenderListSort, Benchmark100k)
+{
+    RunSortBenchmark(100000);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
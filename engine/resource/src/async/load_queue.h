@@ -35,6 +35,9 @@ namespace dmLoadQueue
         dmResource::FResourcePreload m_Function;
         dmResource::PreloadHintInfo m_HintInfo;
         void* m_Context;
+        // If set, the resource is also created by the queue, see dmResource::SetTypeThreadSafeCreate
+        dmResource::SResourceType* m_CreateType;
+        dmhash_t m_CanonicalPathHash;
     };
 
     struct LoadResult
@@ -42,6 +45,9 @@ namespace dmLoadQueue
         dmResource::Result m_LoadResult;
         dmResource::Result m_PreloadResult;
         void* m_PreloadData;
+        // RESULT_PENDING unless the resource was created by the queue
+        dmResource::Result m_CreateResult;
+        dmResource::SResourceDescriptor m_Resource;
     };
 
     HQueue CreateQueue(dmResource::HFactory factory);
@@ -49,7 +55,8 @@ namespace dmLoadQueue
 
     // If the queue does not want to accept any more requests at the moment, it returns 0
     // The name and canonical_path provided must have a lifetime that lasts until EndLoad is called
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info);
+    // Requests with a higher priority are loaded first, and requests of the same priority in the order they are supplied
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, dmResource::LoadPriority priority, PreloadInfo* info);
 
     // Actual load result will be put in load_result. Ptrs can be handled until FreeLoad has been called.
     Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result);
@@ -49,7 +49,7 @@ namespace dmLoadQueue
         delete queue;
     }
 
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info)
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, dmResource::LoadPriority priority, PreloadInfo* info)
     {
         if (queue->m_ActiveRequest != 0)
         {
@@ -73,6 +73,8 @@ namespace dmLoadQueue
         load_result->m_LoadResult    = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
         load_result->m_PreloadResult = dmResource::RESULT_PENDING;
         load_result->m_PreloadData   = 0;
+        // Resources are always created by the preloader, since it runs on this thread anyway
+        load_result->m_CreateResult  = dmResource::RESULT_PENDING;
 
         if (load_result->m_LoadResult == dmResource::RESULT_OK && request->m_PreloadInfo.m_Function)
         {
@@ -10,12 +10,15 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <string.h>
+
 #include "resource.h"
 #include "resource_private.h"
 #include "load_queue.h"
 
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/array.h>
 #include <dlib/thread.h>
 #include <dlib/mutex.h>
@@ -24,16 +27,24 @@
 
 namespace dmLoadQueue
 {
-    // Implementation of dmLoadQueue with a thread that loads items in the order they are supplied,
+    // Implementation of dmLoadQueue with a pool of threads that load items in priority order.
+    // Items of the same priority are loaded in the order they are supplied.
 
     // Default to small buffers since a lot of what is loaded are just small objects anyway.
     // That way we can have more in flight, but throttle when max pending data grows too large anyway
     const uint64_t DEFAULT_CAPACITY = 5 * 1024;
 
-    // Once the loader has this amount not picked up, it will stop loading more.
-    // This sets the bandwidth of the loader.
-    const uint64_t MAX_PENDING_DATA = 4 * 1024 * 1024;
-    const uint32_t QUEUE_SLOTS      = 16;
+    // Min number of requests in flight, and per loader thread
+    const uint32_t QUEUE_SLOTS            = 16;
+    const uint32_t QUEUE_SLOTS_PER_THREAD = 4;
+
+    enum RequestState
+    {
+        REQUEST_STATE_FREE    = 0,
+        REQUEST_STATE_QUEUED  = 1,
+        REQUEST_STATE_LOADING = 2,
+        REQUEST_STATE_DONE    = 3,
+    };
 
     struct Request
     {
@@ -42,6 +53,10 @@ namespace dmLoadQueue
         dmResource::LoadBufferType m_Buffer;
         PreloadInfo m_PreloadInfo;
         LoadResult m_Result;
+        // Order in which the request was queued
+        uint32_t m_Sequence;
+        uint8_t m_Priority;
+        uint8_t m_State;
     };
 
     struct Queue
@@ -49,17 +64,16 @@ namespace dmLoadQueue
         dmResource::HFactory m_Factory;
         dmMutex::HMutex m_Mutex;
         dmConditionVariable::HConditionVariable m_WakeupCond;
-        dmThread::Thread m_Thread;
-        Request m_Request[QUEUE_SLOTS];
-        uint32_t m_Front, m_Back, m_Loaded;
+        dmArray<dmThread::Thread> m_Threads;
+        // Never resized after creation, since the requests are handed out as pointers
+        dmArray<Request> m_Requests;
+        uint32_t m_NextSequence;
+        uint32_t m_FreeCount;
         uint64_t m_BytesWaiting;
+        // Once the loaders have this amount not picked up, they will stop loading more.
+        // This sets the bandwidth of the loader.
+        uint64_t m_MaxPendingData;
         bool m_Shutdown;
-
-        // Circular queue with indexing as follow (exclusive end)
-        //
-        //          m_Back           m_Loaded   m_Front
-        // [N/A]   [loaded] [loaded] [to-load]  [N/A]
-        //
     };
 
     static Request* GetNextRequest(Queue* queue)
@@ -68,17 +82,40 @@ namespace dmLoadQueue
         // that are waiting to be picked up by the preloader. In the case of the queue being filled
         // with only large requests (say only 4Mb textures), this throttles a bit so memory consumption
         // does not run away.
-        if (queue->m_BytesWaiting >= MAX_PENDING_DATA)
+        if (queue->m_BytesWaiting >= queue->m_MaxPendingData)
         {
             return 0x0;
         }
 
-        if (queue->m_Loaded == queue->m_Front)
+        Request* next = 0x0;
+        uint32_t count = queue->m_Requests.Size();
+        for (uint32_t i = 0; i < count; ++i)
         {
-            return 0x0;
+            Request* r = &queue->m_Requests[i];
+            if (r->m_State != REQUEST_STATE_QUEUED)
+                continue;
+            if (next == 0x0 || r->m_Priority < next->m_Priority ||
+                (r->m_Priority == next->m_Priority && (int32_t)(r->m_Sequence - next->m_Sequence) < 0))
+            {
+                next = r;
+            }
         }
+        return next;
+    }
 
-        return &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+    static void TrimBuffers(Queue* queue)
+    {
+        // Reset any buffers of inactive requests that are not at default capacity
+        uint32_t count = queue->m_Requests.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Request* r = &queue->m_Requests[i];
+            if (r->m_State == REQUEST_STATE_FREE && r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
+            {
+                // Just free the memory here, no need to allocate while holding the mutex
+                r->m_Buffer.SetCapacity(0);
+            }
+        }
     }
 
     static void LoadThread(void* arg)
@@ -86,76 +123,86 @@ namespace dmLoadQueue
         Queue* queue     = (Queue*)arg;
         Request* current = 0;
         LoadResult result;
+        // The archive entry of the current request, before it is decompressed into the request buffer
+        dmResource::LoadBufferType entry_buffer;
         while (true)
         {
             {
                 dmMutex::ScopedLock lk(queue->m_Mutex);
                 if (current != 0)
                 {
-                    // Just finished one (from previous iteratino)
+                    // Just finished one (from previous iteration)
                     queue->m_BytesWaiting += current->m_Buffer.Capacity();
-                    queue->m_Loaded++;
                     current->m_Result = result;
+                    current->m_State  = REQUEST_STATE_DONE;
                     current           = 0;
                 }
-                if (queue->m_Shutdown)
-                {
-                    return;
-                }
 
-                current = GetNextRequest(queue);
-                if (current == 0x0)
+                while (!queue->m_Shutdown && (current = GetNextRequest(queue)) == 0x0)
                 {
-                    // Nothing to do, reset any buffers of inactive requests that are not at default capacity
-                    for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
-                    {
-                        Request* r = &queue->m_Request[i];
-                        if (r->m_Buffer.Size() == 0)
-                        {
-                            if (r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
-                            {
-                                // Just free the memory here, no need to allocate while holding the mutex
-                                r->m_Buffer.SetCapacity(0);
-                            }
-                        }
-                    }
+                    // Nothing to do
+                    TrimBuffers(queue);
                     dmConditionVariable::Wait(queue->m_WakeupCond, queue->m_Mutex);
-                    current = GetNextRequest(queue);
                 }
+                if (queue->m_Shutdown)
+                {
+                    return;
+                }
+                current->m_State = REQUEST_STATE_LOADING;
             }
 
-            if (current)
+            // We use the temporary result object here to fill in the data so it can be written with the mutex held.
+            uint32_t size;
+
+            assert(current->m_Buffer.Size() == 0);
+            if (current->m_Buffer.Capacity() != DEFAULT_CAPACITY)
             {
-                // We use the temporary result object here to fill in the data so it can be written with the mutex held.
-                uint32_t size;
+                current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
+            }
+            result.m_LoadResult    = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer, &entry_buffer);
+            result.m_PreloadResult = dmResource::RESULT_PENDING;
+            result.m_PreloadData   = 0;
+            result.m_CreateResult  = dmResource::RESULT_PENDING;
 
-                assert(current->m_Buffer.Size() == 0);
-                if (current->m_Buffer.Capacity() != DEFAULT_CAPACITY)
+            if (result.m_LoadResult == dmResource::RESULT_OK)
+            {
+                assert(current->m_Buffer.Size() == size);
+                if (current->m_PreloadInfo.m_Function)
                 {
-                    current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
+                    dmResource::ResourcePreloadParams params;
+                    params.m_Factory       = queue->m_Factory;
+                    params.m_Context       = current->m_PreloadInfo.m_Context;
+                    params.m_Buffer        = current->m_Buffer.Begin();
+                    params.m_BufferSize    = current->m_Buffer.Size();
+                    params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
+                    params.m_PreloadData   = &result.m_PreloadData;
+                    result.m_PreloadResult = current->m_PreloadInfo.m_Function(params);
+                }
+                else
+                {
+                    result.m_PreloadResult = dmResource::RESULT_OK;
                 }
-                result.m_LoadResult    = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
-                result.m_PreloadResult = dmResource::RESULT_PENDING;
-                result.m_PreloadData   = 0;
 
-                if (result.m_LoadResult == dmResource::RESULT_OK)
+                dmResource::SResourceType* create_type = current->m_PreloadInfo.m_CreateType;
+                if (create_type && result.m_PreloadResult == dmResource::RESULT_OK)
                 {
-                    assert(current->m_Buffer.Size() == size);
-                    if (current->m_PreloadInfo.m_Function)
-                    {
-                        dmResource::ResourcePreloadParams params;
-                        params.m_Factory       = queue->m_Factory;
-                        params.m_Context       = current->m_PreloadInfo.m_Context;
-                        params.m_Buffer        = current->m_Buffer.Begin();
-                        params.m_BufferSize    = current->m_Buffer.Size();
-                        params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
-                        params.m_PreloadData   = &result.m_PreloadData;
-                        result.m_PreloadResult = current->m_PreloadInfo.m_Function(params);
-                    }
-                    else
-                    {
-                        result.m_PreloadResult = dmResource::RESULT_OK;
-                    }
+                    // Create the resource here, instead of on the thread updating the preloader
+                    dmResource::SResourceDescriptor* resource = &result.m_Resource;
+                    memset(resource, 0, sizeof(*resource));
+                    resource->m_NameHash           = current->m_PreloadInfo.m_CanonicalPathHash;
+                    resource->m_ReferenceCount     = 1;
+                    resource->m_ResourceType       = (void*)create_type;
+                    resource->m_ResourceSizeOnDisc = current->m_Buffer.Size();
+
+                    dmResource::ResourceCreateParams params;
+                    params.m_Factory      = queue->m_Factory;
+                    params.m_Context      = create_type->m_Context;
+                    params.m_PreloadData  = result.m_PreloadData;
+                    params.m_Resource     = resource;
+                    params.m_Filename     = current->m_Name;
+                    params.m_Buffer       = current->m_Buffer.Begin();
+                    params.m_BufferSize   = current->m_Buffer.Size();
+                    result.m_CreateResult = create_type->m_CreateFunction(params);
                 }
             }
         }
@@ -163,16 +210,39 @@ namespace dmLoadQueue
 
     HQueue CreateQueue(dmResource::HFactory factory)
     {
-        Queue* q          = new Queue();
-        q->m_Factory      = factory;
-        q->m_Front        = 0;
-        q->m_Back         = 0;
-        q->m_Loaded       = 0;
-        q->m_Shutdown     = false;
-        q->m_BytesWaiting = 0;
-        q->m_Mutex        = dmMutex::New();
-        q->m_WakeupCond   = dmConditionVariable::New();
-        q->m_Thread       = dmThread::New(&LoadThread, 65536, q, "AsyncLoad");
+        uint32_t thread_count = dmResource::GetLoadWorkerCount(factory);
+        uint32_t slot_count   = dmMath::Max(QUEUE_SLOTS, thread_count * QUEUE_SLOTS_PER_THREAD);
+
+        Queue* q            = new Queue();
+        q->m_Factory        = factory;
+        q->m_NextSequence   = 0;
+        q->m_FreeCount      = slot_count;
+        q->m_Shutdown       = false;
+        q->m_BytesWaiting   = 0;
+        // Always allow at least one request to be waiting, or the loaders would never load anything
+        q->m_MaxPendingData = dmMath::Max((uint64_t)dmResource::GetLoadBudget(factory), DEFAULT_CAPACITY);
+        q->m_Mutex          = dmMutex::New();
+        q->m_WakeupCond     = dmConditionVariable::New();
+
+        q->m_Requests.SetCapacity(slot_count);
+        q->m_Requests.SetSize(slot_count);
+        for (uint32_t i = 0; i < slot_count; ++i)
+        {
+            Request* r         = &q->m_Requests[i];
+            r->m_Name          = 0x0;
+            r->m_CanonicalPath = 0x0;
+            r->m_Sequence      = 0;
+            r->m_Priority      = dmResource::LOAD_PRIORITY_NORMAL;
+            r->m_State         = REQUEST_STATE_FREE;
+        }
+
+        q->m_Threads.SetCapacity(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            char name[32];
+            dmSnPrintf(name, sizeof(name), "AsyncLoad%u", i);
+            q->m_Threads.Push(dmThread::New(&LoadThread, 65536, q, name));
+        }
 
         return q;
     }
@@ -182,16 +252,19 @@ namespace dmLoadQueue
         {
             dmMutex::ScopedLock lk(queue->m_Mutex);
             queue->m_Shutdown = true;
-            // Wake up the worker so it can exit and allow us to join
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            // Wake up the workers so they can exit and allow us to join
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        for (uint32_t i = 0; i < queue->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(queue->m_Threads[i]);
         }
-        dmThread::Join(queue->m_Thread);
         dmConditionVariable::Delete(queue->m_WakeupCond);
         dmMutex::Delete(queue->m_Mutex);
         delete queue;
     }
 
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info)
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, dmResource::LoadPriority priority, PreloadInfo* info)
     {
         assert(name != 0);
         assert(name[0] != 0);
@@ -201,29 +274,41 @@ namespace dmLoadQueue
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
         // Refuse more if full.
-        if ((queue->m_Front - queue->m_Back) == QUEUE_SLOTS)
+        if (queue->m_FreeCount == 0)
             return 0;
 
-        if (queue->m_Loaded == queue->m_Front)
+        Request* req = 0x0;
+        uint32_t count = queue->m_Requests.Size();
+        for (uint32_t i = 0; i < count; ++i)
         {
-            // The worker is sleeping waiting for request, wake it up
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            if (queue->m_Requests[i].m_State == REQUEST_STATE_FREE)
+            {
+                req = &queue->m_Requests[i];
+                break;
+            }
         }
+        assert(req != 0x0);
+        --queue->m_FreeCount;
 
-        Request* req         = &queue->m_Request[(queue->m_Front++) % QUEUE_SLOTS];
         req->m_Name          = name;
         req->m_CanonicalPath = canonical_path;
+        req->m_Sequence      = queue->m_NextSequence++;
+        req->m_Priority      = (uint8_t)priority;
+        req->m_State         = REQUEST_STATE_QUEUED;
 
         req->m_PreloadInfo         = *info;
         req->m_Result.m_LoadResult = dmResource::RESULT_PENDING;
 
+        // Wake up a sleeping worker, if any
+        dmConditionVariable::Signal(queue->m_WakeupCond);
+
         return req;
     }
 
     Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result)
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
-        if (request->m_Result.m_LoadResult == dmResource::RESULT_PENDING)
+        if (request->m_State != REQUEST_STATE_DONE)
             return RESULT_PENDING;
 
         *buf         = request->m_Buffer.Begin();
@@ -237,28 +322,28 @@ namespace dmLoadQueue
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
-        uint32_t old_bytes_waiting = queue->m_BytesWaiting;
+        uint64_t old_bytes_waiting = queue->m_BytesWaiting;
 
         // Make sure we don't copy any data if we reallocate the buffer
         request->m_Buffer.SetSize(0);
 
         uint32_t buffer_capacity = request->m_Buffer.Capacity();
         queue->m_BytesWaiting -= buffer_capacity;
-        // If we either have blocked further processing by exceeding MAX_PENDING_DATA or
-        // the buffer has a non-default capacity, we want to wake up the worker
-        if (buffer_capacity != DEFAULT_CAPACITY || (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA))
+        if (old_bytes_waiting >= queue->m_MaxPendingData && queue->m_BytesWaiting < queue->m_MaxPendingData)
         {
-            // Wake up thread, we can now fit a new request
+            // All workers may be blocked by exceeding the max pending data, wake them all up
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        else if (buffer_capacity != DEFAULT_CAPACITY)
+        {
+            // Wake up a worker to trim the buffer
             dmConditionVariable::Signal(queue->m_WakeupCond);
         }
 
         // Clean up picked up requests
         request->m_Name          = 0x0;
         request->m_CanonicalPath = 0x0;
-
-        while (queue->m_Back != queue->m_Loaded && queue->m_Request[queue->m_Back % QUEUE_SLOTS].m_Name == 0x0)
-        {
-            queue->m_Back++;
-        }
+        request->m_State         = REQUEST_STATE_FREE;
+        ++queue->m_FreeCount;
     }
 } // namespace dmLoadQueue
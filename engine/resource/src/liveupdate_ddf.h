@@ -0,0 +1,114 @@
+#ifndef LIVEUPDATE_DDF_H
+#define LIVEUPDATE_DDF_H
+
+#include <stdint.h>
+#include <assert.h>
+#include "ddf/ddf_math.h"
+#include <dlib/align.h>
+#include <ddf/ddf.h>
+namespace dmLiveUpdateDDF {
+enum HashAlgorithm
+{
+    HASH_UNKNOWN = 0,
+    HASH_MD5 = 1,
+    HASH_SHA1 = 2,
+    HASH_SHA256 = 3,
+    HASH_SHA512 = 4,
+};
+enum SignAlgorithm
+{
+    SIGN_UNKNOWN = 0,
+    SIGN_RSA = 1,
+};
+enum ResourceEntryFlag
+{
+    BUNDLED = 1,
+    EXCLUDED = 2,
+};
+struct HashDigest
+{
+    struct {
+        uint8_t* m_Data;
+        const uint8_t& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        uint8_t& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Data;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+struct ManifestHeader
+{
+    int32_t m_MagicNumber;
+    int32_t m_Version;
+    dmLiveUpdateDDF::HashAlgorithm m_ResourceHashAlgorithm;
+    dmLiveUpdateDDF::HashAlgorithm m_SignatureHashAlgorithm;
+    dmLiveUpdateDDF::SignAlgorithm m_SignatureSignAlgorithm;
+    dmLiveUpdateDDF::HashDigest m_ProjectIdentifier;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+struct ResourceEntry
+{
+    const char* m_Url;
+    uint64_t m_UrlHash;
+    dmLiveUpdateDDF::HashDigest m_Hash;
+    struct {
+        dmLiveUpdateDDF::HashDigest* m_Data;
+        const dmLiveUpdateDDF::HashDigest& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        dmLiveUpdateDDF::HashDigest& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Dependants;
+    uint32_t m_Flags;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+struct ManifestData
+{
+    dmLiveUpdateDDF::ManifestHeader m_Header;
+    struct {
+        dmLiveUpdateDDF::HashDigest* m_Data;
+        const dmLiveUpdateDDF::HashDigest& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        dmLiveUpdateDDF::HashDigest& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_EngineVersions;
+    struct {
+        dmLiveUpdateDDF::ResourceEntry* m_Data;
+        const dmLiveUpdateDDF::ResourceEntry& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        dmLiveUpdateDDF::ResourceEntry& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Resources;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+struct ManifestFile
+{
+    struct {
+        uint8_t* m_Data;
+        const uint8_t& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        uint8_t& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Data;
+    struct {
+        uint8_t* m_Data;
+        const uint8_t& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        uint8_t& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Signature;
+    struct {
+        uint8_t* m_Data;
+        const uint8_t& operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        uint8_t& operator[](uint32_t i) { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_ArchiveIdentifier;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+}
+#ifdef DDF_EXPOSE_DESCRIPTORS
+extern dmDDF::Descriptor dmLiveUpdateDDF_HashDigest_DESCRIPTOR;
+extern dmDDF::Descriptor dmLiveUpdateDDF_ManifestHeader_DESCRIPTOR;
+extern dmDDF::Descriptor dmLiveUpdateDDF_ResourceEntry_DESCRIPTOR;
+extern dmDDF::Descriptor dmLiveUpdateDDF_ManifestData_DESCRIPTOR;
+extern dmDDF::Descriptor dmLiveUpdateDDF_ManifestFile_DESCRIPTOR;
+#endif
+#endif
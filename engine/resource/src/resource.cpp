@@ -78,6 +78,8 @@ const char* BUNDLE_DATA_FILENAME                = "game.arcd";
 
 
 const char* MAX_RESOURCES_KEY = "resource.max_resources";
+const char* LOAD_WORKER_COUNT_KEY = "resource.load_worker_count";
+const char* LOAD_BUDGET_KEY = "resource.load_budget";
 
 struct ResourceReloadedCallbackPair
 {
@@ -131,6 +133,10 @@ struct SResourceFactory
     Manifest*                                    m_Manifest;
     void*                                        m_ArchiveMountInfo;
 
+    // Load queue settings, see NewFactoryParams
+    uint32_t                                     m_LoadWorkerCount;
+    uint32_t                                     m_LoadBudget;
+
     uint8_t                                      m_UseLiveUpdate : 1;
 };
 
@@ -192,6 +198,8 @@ void SetDefaultNewFactoryParams(struct NewFactoryParams* params)
 {
     params->m_MaxResources = 1024;
     params->m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+    params->m_LoadWorkerCount = 1;
+    params->m_LoadBudget = 4 * 1024 * 1024;
 
     params->m_ArchiveManifest.m_Data = 0;
     params->m_ArchiveManifest.m_Size = 0;
@@ -456,6 +464,8 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     memset(factory, 0, sizeof(*factory));
     factory->m_Socket = socket;
     factory->m_UseLiveUpdate = params->m_Flags & RESOURCE_FACTORY_FLAGS_LIVE_UPDATE ? 1 : 0;
+    factory->m_LoadWorkerCount = dmMath::Max(1U, params->m_LoadWorkerCount);
+    factory->m_LoadBudget = params->m_LoadBudget;
 
     dmURI::Result uri_result = dmURI::Parse(uri, &factory->m_UriParts);
     if (uri_result != dmURI::RESULT_OK)
@@ -773,12 +783,44 @@ Result RegisterType(HFactory factory,
     resource_type.m_PostCreateFunction = post_create_function;
     resource_type.m_DestroyFunction = destroy_function;
     resource_type.m_RecreateFunction = recreate_function;
+    resource_type.m_LoadPriority = LOAD_PRIORITY_NORMAL;
+    resource_type.m_ThreadSafeCreate = false;
 
     factory->m_ResourceTypes[factory->m_ResourceTypesCount++] = resource_type;
 
     return RESULT_OK;
 }
 
+Result SetTypeLoadPriority(HFactory factory, const char* extension, LoadPriority priority)
+{
+    SResourceType* resource_type = FindResourceType(factory, extension);
+    if (resource_type == 0)
+        return RESULT_UNKNOWN_RESOURCE_TYPE;
+    if (priority >= LOAD_PRIORITY_COUNT)
+        return RESULT_INVAL;
+    resource_type->m_LoadPriority = priority;
+    return RESULT_OK;
+}
+
+Result SetTypeThreadSafeCreate(HFactory factory, const char* extension, bool thread_safe)
+{
+    SResourceType* resource_type = FindResourceType(factory, extension);
+    if (resource_type == 0)
+        return RESULT_UNKNOWN_RESOURCE_TYPE;
+    resource_type->m_ThreadSafeCreate = thread_safe;
+    return RESULT_OK;
+}
+
+uint32_t GetLoadWorkerCount(HFactory factory)
+{
+    return factory->m_LoadWorkerCount;
+}
+
+uint32_t GetLoadBudget(HFactory factory)
+{
+    return factory->m_LoadBudget;
+}
+
 // Finds the specific entry in a sorted list of entries
 static int FindEntryIndex(const Manifest* manifest, dmhash_t path_hash)
 {
@@ -843,7 +885,24 @@ Result VerifyResourcesBundled(dmResourceArchive::HArchiveIndexContainer base_arc
     return VerifyResourcesBundled(entries, entry_count, hash_len, base_archive);
 }
 
-static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer)
+// A load that is finished after m_LoadMutex is released, see DoLoadResource
+enum DeferredLoadType
+{
+    DEFERRED_LOAD_NONE          = 0,
+    DEFERRED_LOAD_ARCHIVE_ENTRY = 1,
+    DEFERRED_LOAD_FILE          = 2,
+};
+
+struct DeferredLoad
+{
+    dmResourceArchive::EntryData m_Entry;
+    // The archive entry as it is stored, copied out of the archive while the lock is held
+    LoadBufferType*              m_EntryBuffer;
+    char                         m_Path[RESOURCE_PATH_MAX];
+    DeferredLoadType             m_Type;
+};
+
+static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer, DeferredLoad* deferred)
 {
     dmhash_t path_hash = dmHashString64(path);
 
@@ -868,6 +927,28 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
         }
 
         buffer->SetSize(0);
+
+        if (deferred && dmResourceArchive::HasDefaultReader(archive))
+        {
+            // Only copy the entry out of the archive here, it's decrypted and decompressed without the lock
+            uint32_t entry_size = dmResourceArchive::GetEntryDataSize(&ed);
+            LoadBufferType* entry_buffer = deferred->m_EntryBuffer;
+            if (entry_buffer->Capacity() < entry_size)
+            {
+                entry_buffer->SetCapacity(entry_size);
+            }
+            entry_buffer->SetSize(0);
+            if (dmResourceArchive::ReadEntryData(archive, &ed, entry_buffer->Begin()) != dmResourceArchive::RESULT_OK)
+            {
+                return RESULT_IO_ERROR;
+            }
+            entry_buffer->SetSize(entry_size);
+            deferred->m_Entry = ed;
+            deferred->m_Type  = DEFERRED_LOAD_ARCHIVE_ENTRY;
+            *resource_size = file_size;
+            return RESULT_OK;
+        }
+
         dmResourceArchive::Result read_result = dmResourceArchive::Read(archive, hash, hash_len, &ed, buffer->Begin());
         if (read_result != dmResourceArchive::RESULT_OK)
         {
@@ -888,13 +969,43 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
     return RESULT_IO_ERROR;
 }
 
+static Result LoadFromFile(const char* fs_path, uint32_t* resource_size, LoadBufferType* buffer)
+{
+    uint32_t file_size;
+    dmSys::Result r = dmSys::ResourceSize(fs_path, &file_size);
+    if (r != dmSys::RESULT_OK) {
+        if (r == dmSys::RESULT_NOENT)
+            return RESULT_RESOURCE_NOT_FOUND;
+        else
+            return RESULT_IO_ERROR;
+    }
+
+    if (buffer->Capacity() < file_size) {
+        buffer->SetCapacity(file_size);
+    }
+    buffer->SetSize(0);
+
+    r = dmSys::LoadResource(fs_path, buffer->Begin(), file_size, &file_size);
+    if (r == dmSys::RESULT_OK) {
+        buffer->SetSize(file_size);
+        *resource_size = file_size;
+        return RESULT_OK;
+    } else {
+        if (r == dmSys::RESULT_NOENT)
+            return RESULT_RESOURCE_NOT_FOUND;
+        else
+            return RESULT_IO_ERROR;
+    }
+}
+
 // Assumes m_LoadMutex is already held
-static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// If deferred is set, archive entries and files may be left to be decoded or read by the caller once the lock is released
+static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, DeferredLoad* deferred)
 {
     DM_PROFILE(Resource, "LoadResource");
     if (factory->m_BuiltinsManifest)
     {
-        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer) == RESULT_OK)
+        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer, deferred) == RESULT_OK)
         {
             return RESULT_OK;
         }
@@ -948,7 +1059,7 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     }
     else if (factory->m_Manifest)
     {
-        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer);
+        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer, deferred);
         return r;
     }
     else
@@ -964,40 +1075,51 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
         fs_path = fs_mount_path;
 
         // Load over local file system
-        uint32_t file_size;
-        dmSys::Result r = dmSys::ResourceSize(fs_path, &file_size);
-        if (r != dmSys::RESULT_OK) {
-            if (r == dmSys::RESULT_NOENT)
-                return RESULT_RESOURCE_NOT_FOUND;
-            else
-                return RESULT_IO_ERROR;
-        }
-
-        if (buffer->Capacity() < file_size) {
-            buffer->SetCapacity(file_size);
-        }
-        buffer->SetSize(0);
-
-        r = dmSys::LoadResource(fs_path, buffer->Begin(), file_size, &file_size);
-        if (r == dmSys::RESULT_OK) {
-            buffer->SetSize(file_size);
-            *resource_size = file_size;
+        if (deferred)
+        {
+            // Reading the file doesn't use the factory
+            dmStrlCpy(deferred->m_Path, fs_path, sizeof(deferred->m_Path));
+            deferred->m_Type = DEFERRED_LOAD_FILE;
             return RESULT_OK;
-        } else {
-            if (r == dmSys::RESULT_NOENT)
-                return RESULT_RESOURCE_NOT_FOUND;
-            else
-                return RESULT_IO_ERROR;
         }
+        return LoadFromFile(fs_path, resource_size, buffer);
     }
 }
 
-// Takes the lock.
-Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// Takes the lock, but only while the shared factory state is used: the manifests and archives (that live update
+// may replace) and the http client. Archive entries are decrypted and decompressed, and files are read, without it.
+Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* entry_buffer)
 {
-    // Called from async queue so we wrap around a lock
-    dmMutex::ScopedLock lk(factory->m_LoadMutex);
-    return DoLoadResourceLocked(factory, path, original_name, resource_size, buffer);
+    DeferredLoad deferred;
+    deferred.m_EntryBuffer = entry_buffer;
+    deferred.m_Type        = DEFERRED_LOAD_NONE;
+
+    Result r;
+    {
+        dmMutex::ScopedLock lk(factory->m_LoadMutex);
+        r = DoLoadResourceLocked(factory, path, original_name, resource_size, buffer, &deferred);
+    }
+    if (r != RESULT_OK)
+    {
+        return r;
+    }
+
+    if (deferred.m_Type == DEFERRED_LOAD_ARCHIVE_ENTRY)
+    {
+        DM_PROFILE(Resource, "DecodeEntry");
+        if (dmResourceArchive::DecodeEntryData(&deferred.m_Entry, entry_buffer->Begin(), buffer->Begin()) != dmResourceArchive::RESULT_OK)
+        {
+            return RESULT_IO_ERROR;
+        }
+        buffer->SetSize(deferred.m_Entry.m_ResourceSize);
+        *resource_size = deferred.m_Entry.m_ResourceSize;
+    }
+    else if (deferred.m_Type == DEFERRED_LOAD_FILE)
+    {
+        DM_PROFILE(Resource, "LoadFile");
+        return LoadFromFile(deferred.m_Path, resource_size, buffer);
+    }
+    return RESULT_OK;
 }
 
 // Assumes m_LoadMutex is already held
@@ -1007,7 +1129,7 @@ Result LoadResource(HFactory factory, const char* path, const char* original_nam
         factory->m_Buffer.SetCapacity(DEFAULT_BUFFER_SIZE);
     }
     factory->m_Buffer.SetSize(0);
-    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer);
+    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer, 0);
     if (r == RESULT_OK)
         *buffer = factory->m_Buffer.Begin();
     else
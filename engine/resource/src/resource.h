@@ -33,6 +33,17 @@ namespace dmResource
      */
     extern const char* MAX_RESOURCES_KEY;
 
+    /**
+     * Configuration key used to tweak the number of threads loading resources for each preloader.
+     */
+    extern const char* LOAD_WORKER_COUNT_KEY;
+
+    /**
+     * Configuration key used to tweak the max amount of loaded data (in kilobytes) waiting to be created,
+     * before the loader threads pause.
+     */
+    extern const char* LOAD_BUDGET_KEY;
+
     extern const char* BUNDLE_MANIFEST_FILENAME;
     extern const char* BUNDLE_INDEX_FILENAME;
     extern const char* BUNDLE_DATA_FILENAME;
@@ -147,6 +158,20 @@ namespace dmResource
 
     typedef uintptr_t ResourceType;
 
+    /**
+     * Order in which queued resources are loaded by the preloader. Within a priority, resources are
+     * loaded in the order they were requested.
+     */
+    enum LoadPriority
+    {
+        /// Loaded first, e.g. collections and game objects, that reveal more resources to load
+        LOAD_PRIORITY_HIGH   = 0,
+        LOAD_PRIORITY_NORMAL = 1,
+        /// Loaded last, e.g. textures and sounds, that are large and have no dependencies
+        LOAD_PRIORITY_LOW    = 2,
+        LOAD_PRIORITY_COUNT  = 3,
+    };
+
     /**
      * Parameters to ResourcePreload callback.
      */
@@ -358,7 +383,14 @@ namespace dmResource
         EmbeddedResource m_ArchiveData;
         EmbeddedResource m_ArchiveManifest;
 
-        uint32_t m_Reserved[5];
+        /// Number of threads loading resources for each preloader. Default is 1
+        uint32_t m_LoadWorkerCount;
+
+        /// Max number of bytes of loaded data waiting to be created, before the loader threads pause. Default is 4 MB
+        /// Values smaller than a single request buffer (5 KB) are raised to that size
+        uint32_t m_LoadBudget;
+
+        uint32_t m_Reserved[3];
 
         NewFactoryParams()
         {
@@ -407,6 +439,27 @@ namespace dmResource
                                FResourceDestroy destroy_function,
                                FResourceRecreate recreate_function);
 
+    /**
+     * Set the load priority of a resource type, used by the preloader. The default is LOAD_PRIORITY_NORMAL
+     * @param factory Factory handle
+     * @param extension File extension of the resource type
+     * @param priority Load priority
+     * @return RESULT_OK on success
+     */
+    Result SetTypeLoadPriority(HFactory factory, const char* extension, LoadPriority priority);
+
+    /**
+     * Declare that the create function of a resource type is thread safe. The preloader then calls it
+     * on the loader threads, right after the preload function. Such a create function must not access the
+     * factory (e.g. Get other resources), the graphics context or a Lua state, and the preload function
+     * must not call PreloadHint. The default is false, i.e. create on the thread updating the preloader.
+     * @param factory Factory handle
+     * @param extension File extension of the resource type
+     * @param thread_safe If the create function is thread safe
+     * @return RESULT_OK on success
+     */
+    Result SetTypeThreadSafeCreate(HFactory factory, const char* extension, bool thread_safe);
+
     /**
      * Get a resource from factory
      * @param factory Factory handle
@@ -528,6 +528,55 @@ namespace dmResourceArchive
         return RESULT_OK;
     }
 
+    bool HasDefaultReader(HArchiveIndexContainer archive)
+    {
+        return archive->m_Loader.m_Read == ReadEntryFromArchive;
+    }
+
+    uint32_t GetEntryDataSize(const EntryData* entry)
+    {
+        return entry->m_ResourceCompressedSize != 0xFFFFFFFF ? entry->m_ResourceCompressedSize : entry->m_ResourceSize;
+    }
+
+    Result ReadEntryData(HArchiveIndexContainer archive, const EntryData* entry, void* buffer)
+    {
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        uint32_t size = GetEntryDataSize(entry);
+        if (afi->m_IsMemMapped)
+        {
+            memcpy(buffer, (const void*)((uintptr_t)afi->m_ResourceData + entry->m_ResourceDataOffset), size);
+            return RESULT_OK;
+        }
+
+        FILE* resource_file = afi->m_FileResourceData;
+        fseek(resource_file, entry->m_ResourceDataOffset, SEEK_SET);
+        if (fread(buffer, 1, size, resource_file) != size)
+        {
+            return RESULT_IO_ERROR;
+        }
+        return RESULT_OK;
+    }
+
+    Result DecodeEntryData(const EntryData* entry, void* data, void* buffer)
+    {
+        uint32_t size = GetEntryDataSize(entry);
+        if (entry->m_Flags & ENTRY_FLAG_ENCRYPTED)
+        {
+            Result r = DecryptBuffer(data, size);
+            if (r != RESULT_OK)
+            {
+                return r;
+            }
+        }
+
+        if (entry->m_ResourceCompressedSize != 0xFFFFFFFF)
+        {
+            return DecompressBuffer(data, size, buffer, entry->m_ResourceSize);
+        }
+        memcpy(buffer, data, size);
+        return RESULT_OK;
+    }
+
     void RegisterDefaultArchiveLoader()
     {
         dmResourceArchive::ArchiveLoader loader;
@@ -213,6 +213,19 @@ namespace dmResourceArchive
     // Reads an entry from a single archive
     Result ReadEntryFromArchive(HArchiveIndexContainer archive, const uint8_t* hash, uint32_t hash_len, const EntryData* entry, void* buffer);
 
+    // Returns true if the archive reads its entries with ReadEntryFromArchive, ie they can be read with ReadEntryData and DecodeEntryData
+    bool HasDefaultReader(HArchiveIndexContainer archive);
+
+    // Size of an entry as it is stored in the archive
+    uint32_t GetEntryDataSize(const EntryData* entry);
+
+    // Reads an entry from a single archive as it is stored, possibly encrypted and compressed. The buffer must hold GetEntryDataSize() bytes
+    Result ReadEntryData(HArchiveIndexContainer archive, const EntryData* entry, void* buffer);
+
+    // Decrypts (in place) and decompresses entry data read with ReadEntryData. The buffer must hold the resource size.
+    // Doesn't use the archive, so it can be called while the archive is being modified
+    Result DecodeEntryData(const EntryData* entry, void* data, void* buffer);
+
     // Calls each loader in sequence
 
     /*# Loads the archives, calling each registered loader in sequence
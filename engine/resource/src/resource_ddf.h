@@ -0,0 +1,24 @@
+#ifndef RESOURCE_DDF_H
+#define RESOURCE_DDF_H
+
+#include <stdint.h>
+#include <assert.h>
+#include "ddf/ddf_math.h"
+#include <dlib/align.h>
+#include <ddf/ddf.h>
+namespace dmResourceDDF {
+struct Reload
+{
+    struct {
+        const char** m_Data;
+        const char* operator[](uint32_t i) const { assert(i < m_Count); return m_Data[i]; }
+        uint32_t m_Count;
+    } m_Resources;
+    static dmDDF::Descriptor* m_DDFDescriptor;
+    static const uint64_t m_DDFHash;
+};
+}
+#ifdef DDF_EXPOSE_DESCRIPTORS
+extern dmDDF::Descriptor dmResourceDDF_Reload_DESCRIPTOR;
+#endif
+#endif
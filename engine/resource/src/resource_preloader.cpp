@@ -506,6 +506,8 @@ namespace dmResource
         return NewPreloader(factory, names);
     }
 
+    static void FinishCreateResource(HPreloader preloader, PreloadRequest* req, SResourceDescriptor& tmp_resource);
+
     // CreateResource operation ends either with
     //   1) Having created the resource and free:d all buffers => RESULT_OK + m_Resource
     //   2) Having failed, (or created and destroyed), leaving => RESULT_SOME_ERROR + everything free:d
@@ -555,6 +557,14 @@ namespace dmResource
             req->m_LoadResult                 = resource_type->m_CreateFunction(params);
         }
 
+        FinishCreateResource(preloader, req, tmp_resource);
+    }
+
+    // Registers the created resource, with the create result in req->m_LoadResult
+    static void FinishCreateResource(HPreloader preloader, PreloadRequest* req, SResourceDescriptor& tmp_resource)
+    {
+        SResourceType* resource_type = req->m_PathDescriptor.m_ResourceType;
+
         if (req->m_LoadResult == RESULT_OK)
         {
             if (resource_type->m_PostCreateFunction)
@@ -705,6 +715,21 @@ namespace dmResource
         {
             req->m_LoadResult = load_result.m_PreloadResult;
         }
+        else if (load_result.m_CreateResult != RESULT_PENDING && req->m_FirstChild != -1)
+        {
+            // The resource was created by the load queue, before its dependencies
+            dmLogError("Resource '%s' is created on the loader threads, but has dependencies", req->m_PathDescriptor.m_InternalizedName);
+            if (load_result.m_CreateResult == RESULT_OK)
+            {
+                SResourceType* resource_type = req->m_PathDescriptor.m_ResourceType;
+                ResourceDestroyParams params;
+                params.m_Factory  = preloader->m_Factory;
+                params.m_Context  = resource_type->m_Context;
+                params.m_Resource = &load_result.m_Resource;
+                resource_type->m_DestroyFunction(params);
+            }
+            req->m_LoadResult = RESULT_NOT_SUPPORTED;
+        }
 
         // On error remove all children
         if (req->m_LoadResult != RESULT_PENDING)
@@ -722,8 +747,17 @@ namespace dmResource
         {
             if (req->m_LoadResult == RESULT_PENDING)
             {
-                // Create the resource using the loading buffer directly.
-                CreateResource(preloader, req, buffer, buffer_size);
+                if (load_result.m_CreateResult != RESULT_PENDING)
+                {
+                    // Already created by the load queue
+                    req->m_LoadResult = load_result.m_CreateResult;
+                    FinishCreateResource(preloader, req, load_result.m_Resource);
+                }
+                else
+                {
+                    // Create the resource using the loading buffer directly.
+                    CreateResource(preloader, req, buffer, buffer_size);
+                }
                 created_resource = true;
             }
             UnmarkPathInProgress(preloader, &req->m_PathDescriptor);
@@ -859,10 +893,15 @@ namespace dmResource
         info.m_HintInfo.m_Parent    = index;
         info.m_Function             = req->m_PathDescriptor.m_ResourceType->m_PreloadFunction;
         info.m_Context              = req->m_PathDescriptor.m_ResourceType->m_Context;
+        info.m_CreateType           = req->m_PathDescriptor.m_ResourceType->m_ThreadSafeCreate ? req->m_PathDescriptor.m_ResourceType : 0;
+        info.m_CanonicalPathHash    = req->m_PathDescriptor.m_CanonicalPathHash;
+
+        // The root resource (e.g. a collection) is loaded first since it reveals the rest of the resources to load
+        LoadPriority priority = index == 0 ? LOAD_PRIORITY_HIGH : req->m_PathDescriptor.m_ResourceType->m_LoadPriority;
 
         // If we can't add the request to the load queue it is because the queue is full
         // We will try again once we completed loading of an item via dmLoadQueue::EndLoad
-        if ((req->m_LoadRequest = dmLoadQueue::BeginLoad(preloader->m_LoadQueue, req->m_PathDescriptor.m_InternalizedName, req->m_PathDescriptor.m_InternalizedCanonicalPath, &info)))
+        if ((req->m_LoadRequest = dmLoadQueue::BeginLoad(preloader->m_LoadQueue, req->m_PathDescriptor.m_InternalizedName, req->m_PathDescriptor.m_InternalizedCanonicalPath, priority, &info)))
         {
             MarkPathInProgress(preloader, &req->m_PathDescriptor);
             return true;
@@ -40,6 +40,8 @@ namespace dmResource
         FResourcePostCreate m_PostCreateFunction;
         FResourceDestroy    m_DestroyFunction;
         FResourceRecreate   m_RecreateFunction;
+        LoadPriority        m_LoadPriority;
+        bool                m_ThreadSafeCreate;
     };
 
     typedef dmArray<char> LoadBufferType;
@@ -50,8 +52,13 @@ namespace dmResource
 
     // load with default internal buffer and its management, returns buffer ptr in 'buffer'
     Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
-    // load with own buffer
-    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+    // load with own buffer. entry_buffer holds archive entries while they are decoded, and must not be shared with other threads
+    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* entry_buffer);
+
+    // Number of threads loading resources for each preloader
+    uint32_t GetLoadWorkerCount(HFactory factory);
+    // Max number of bytes of loaded data waiting to be created
+    uint32_t GetLoadBudget(HFactory factory);
 
     Result InsertResource(HFactory factory, const char* path, uint64_t canonical_path_hash, SResourceDescriptor* descriptor);
     uint32_t GetCanonicalPath(const char* relative_dir, char* buf);
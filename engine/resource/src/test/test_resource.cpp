@@ -16,6 +16,9 @@
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/message.h>
+#include <dlib/mutex.h>
+#include <dlib/atomic.h>
+#include <dlib/array.h>
 #include <dlib/socket.h>
 #include <dlib/sys.h>
 #include <dlib/thread.h>
@@ -30,6 +33,7 @@
 #include "resource_ddf.h"
 #include "../resource.h"
 #include "../resource_private.h"
+#include "../async/load_queue.h"
 #include "test/test_resource_ddf.h"
 
 #if defined(TEST_HTTP_SUPPORTED)
@@ -823,6 +827,31 @@ TEST_P(GetResourceTest, PreloadGetParallell)
     }
 }
 
+TEST_P(GetResourceTest, PreloadGetThreadSafeCreate)
+{
+    // The foo resources are created by the load queue
+    dmResource::Result e = dmResource::SetTypeThreadSafeCreate(m_Factory, "foo", true);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+
+    TestResourceContainer* resource = 0;
+    e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, resource);
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerCreateCallCount);
+    ASSERT_EQ(resource->m_Resources.size(), m_FooResourceCreateCallCount);
+    ASSERT_EQ(m_FooResourceCreateCallCount, m_FooResourcePostCreateCallCount);
+    ASSERT_EQ((uint32_t) 123, resource->m_Resources[0]->m_X);
+    ASSERT_EQ((uint32_t) 456, resource->m_Resources[1]->m_X);
+
+    dmResource::SResourceDescriptor descriptor;
+    e = dmResource::GetDescriptor(m_Factory, "/test01.foo", &descriptor);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ((uint32_t) 1, descriptor.m_ReferenceCount);
+
+    dmResource::Release(m_Factory, resource);
+    ASSERT_EQ(m_FooResourceCreateCallCount, m_FooResourceDestroyCallCount);
+}
+
 TEST_P(GetResourceTest, PreloadGetManyRefs)
 {
     // this has more references than the preloader can fit into its tree
@@ -1381,6 +1410,343 @@ TEST_P(GetResourceTest, OverflowTestRecursive)
 }
 
 
+#if !defined(__EMSCRIPTEN__) // The web load queue loads a single request at a time, in the order they are supplied
+
+// Load queue tests. The requests record the order in which their preload functions are called. The test
+// can hold a request in its preload function, to make sure the other requests are queued before any is picked
+static const uint32_t LOAD_QUEUE_TEST_REQUEST_COUNT = 6;
+
+struct LoadQueueTestState
+{
+    dmMutex::HMutex   m_Mutex;
+    dmArray<uint32_t> m_Loaded;
+    int32_atomic_t    m_Hold;
+};
+
+struct LoadQueueTestRequest
+{
+    LoadQueueTestState*   m_State;
+    dmLoadQueue::HRequest m_Request;
+    uint32_t              m_Index;
+    char                  m_Name[64];
+};
+
+static dmResource::Result LoadQueueTestPreload(const dmResource::ResourcePreloadParams& params)
+{
+    LoadQueueTestRequest* request = (LoadQueueTestRequest*)params.m_Context;
+    LoadQueueTestState* state = request->m_State;
+    {
+        dmMutex::ScopedLock lk(state->m_Mutex);
+        state->m_Loaded.Push(request->m_Index);
+    }
+    if (request->m_Index == 0)
+    {
+        while (dmAtomicAdd32(&state->m_Hold, 0) != 0)
+        {
+            dmTime::Sleep(1000);
+        }
+    }
+    return dmResource::RESULT_OK;
+}
+
+static void WriteLoadQueueTestFile(const char* name, const void* data, uint32_t size)
+{
+    char file_name[512];
+    dmSnPrintf(file_name, sizeof(file_name), ".%s", name);
+    char host_name[512];
+    FILE* f = fopen(MakeHostPath(host_name, sizeof(host_name), file_name), "wb");
+    assert(f != 0);
+    fwrite(data, 1, size, f);
+    fclose(f);
+}
+
+static void DeleteLoadQueueTestFile(const char* name)
+{
+    char file_name[512];
+    dmSnPrintf(file_name, sizeof(file_name), ".%s", name);
+    char host_name[512];
+    dmSys::Unlink(MakeHostPath(host_name, sizeof(host_name), file_name));
+}
+
+static void InitLoadQueueTest(LoadQueueTestState* state, LoadQueueTestRequest* requests, bool hold)
+{
+    state->m_Mutex = dmMutex::New();
+    state->m_Loaded.SetCapacity(LOAD_QUEUE_TEST_REQUEST_COUNT);
+    state->m_Hold = hold ? 1 : 0;
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        LoadQueueTestRequest* request = &requests[i];
+        request->m_State   = state;
+        request->m_Request = 0;
+        request->m_Index   = i;
+        dmSnPrintf(request->m_Name, sizeof(request->m_Name), "/__testloadqueue%u__.loaddata", i);
+        WriteLoadQueueTestFile(request->m_Name, "data", 4);
+    }
+}
+
+static void FinalizeLoadQueueTest(LoadQueueTestState* state, LoadQueueTestRequest* requests)
+{
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        DeleteLoadQueueTestFile(requests[i].m_Name);
+    }
+    dmMutex::Delete(state->m_Mutex);
+}
+
+static uint32_t GetLoadQueueTestLoadedCount(LoadQueueTestState* state)
+{
+    dmMutex::ScopedLock lk(state->m_Mutex);
+    return state->m_Loaded.Size();
+}
+
+static dmLoadQueue::HRequest BeginLoadQueueTestRequest(dmLoadQueue::HQueue queue, LoadQueueTestRequest* request, dmResource::LoadPriority priority)
+{
+    dmLoadQueue::PreloadInfo info;
+    memset(&info, 0, sizeof(info));
+    info.m_Function = LoadQueueTestPreload;
+    info.m_Context  = request;
+    request->m_Request = dmLoadQueue::BeginLoad(queue, request->m_Name, request->m_Name, priority, &info);
+    return request->m_Request;
+}
+
+// Returns false if the request isn't loaded within a few seconds
+static bool WaitForLoadQueueTestRequest(dmLoadQueue::HQueue queue, LoadQueueTestRequest* request)
+{
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        void* buf;
+        uint32_t size;
+        dmLoadQueue::LoadResult result;
+        if (dmLoadQueue::EndLoad(queue, request->m_Request, &buf, &size, &result) == dmLoadQueue::RESULT_OK)
+        {
+            return result.m_LoadResult == dmResource::RESULT_OK && result.m_PreloadResult == dmResource::RESULT_OK;
+        }
+        dmTime::Sleep(1000);
+    }
+    return false;
+}
+
+TEST(LoadQueueTest, Priority)
+{
+    dmResource::NewFactoryParams params;
+    params.m_LoadWorkerCount = 1;
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    ASSERT_NE((void*) 0, factory);
+    dmLoadQueue::HQueue queue = dmLoadQueue::CreateQueue(factory);
+
+    LoadQueueTestState state;
+    LoadQueueTestRequest requests[LOAD_QUEUE_TEST_REQUEST_COUNT];
+    InitLoadQueueTest(&state, requests, true);
+
+    // Keep the loader thread busy with the first request, until the rest are queued
+    ASSERT_NE((void*) 0, BeginLoadQueueTestRequest(queue, &requests[0], dmResource::LOAD_PRIORITY_NORMAL));
+    for (uint32_t i = 0; i < 5000 && GetLoadQueueTestLoadedCount(&state) == 0; ++i)
+    {
+        dmTime::Sleep(1000);
+    }
+    ASSERT_EQ(1U, GetLoadQueueTestLoadedCount(&state));
+
+    const dmResource::LoadPriority priorities[] = {
+        dmResource::LOAD_PRIORITY_LOW,
+        dmResource::LOAD_PRIORITY_NORMAL,
+        dmResource::LOAD_PRIORITY_HIGH,
+        dmResource::LOAD_PRIORITY_LOW,
+        dmResource::LOAD_PRIORITY_HIGH,
+    };
+    for (uint32_t i = 1; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        ASSERT_NE((void*) 0, BeginLoadQueueTestRequest(queue, &requests[i], priorities[i - 1]));
+    }
+    dmAtomicStore32(&state.m_Hold, 0);
+
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        ASSERT_TRUE(WaitForLoadQueueTestRequest(queue, &requests[i]));
+    }
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        dmLoadQueue::FreeLoad(queue, requests[i].m_Request);
+    }
+
+    // By priority, and in the order they were queued within a priority
+    const uint32_t expected[] = { 0, 3, 5, 2, 1, 4 };
+    ASSERT_EQ(LOAD_QUEUE_TEST_REQUEST_COUNT, state.m_Loaded.Size());
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        ASSERT_EQ(expected[i], state.m_Loaded[i]);
+    }
+
+    dmLoadQueue::DeleteQueue(queue);
+    FinalizeLoadQueueTest(&state, requests);
+    dmResource::DeleteFactory(factory);
+}
+
+TEST(LoadQueueTest, LoadBudget)
+{
+    dmResource::NewFactoryParams params;
+    params.m_LoadWorkerCount = 1;
+    // Raised to fit a single request
+    params.m_LoadBudget = 0;
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    ASSERT_NE((void*) 0, factory);
+    dmLoadQueue::HQueue queue = dmLoadQueue::CreateQueue(factory);
+
+    LoadQueueTestState state;
+    LoadQueueTestRequest requests[LOAD_QUEUE_TEST_REQUEST_COUNT];
+    InitLoadQueueTest(&state, requests, false);
+
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        ASSERT_NE((void*) 0, BeginLoadQueueTestRequest(queue, &requests[i], dmResource::LOAD_PRIORITY_NORMAL));
+    }
+
+    for (uint32_t i = 0; i < LOAD_QUEUE_TEST_REQUEST_COUNT; ++i)
+    {
+        ASSERT_TRUE(WaitForLoadQueueTestRequest(queue, &requests[i]));
+
+        // The loaded request isn't picked up yet, and uses the whole budget
+        dmTime::Sleep(20000);
+        ASSERT_EQ(i + 1, GetLoadQueueTestLoadedCount(&state));
+        if (i + 1 < LOAD_QUEUE_TEST_REQUEST_COUNT)
+        {
+            void* buf;
+            uint32_t size;
+            dmLoadQueue::LoadResult result;
+            ASSERT_EQ(dmLoadQueue::RESULT_PENDING, dmLoadQueue::EndLoad(queue, requests[i + 1].m_Request, &buf, &size, &result));
+        }
+
+        dmLoadQueue::FreeLoad(queue, requests[i].m_Request);
+    }
+
+    dmLoadQueue::DeleteQueue(queue);
+    FinalizeLoadQueueTest(&state, requests);
+    dmResource::DeleteFactory(factory);
+}
+
+// Loading benchmark. A root resource referencing many data resources that are "decoded" in the preload
+// function, like a large collection referencing its textures and meshes
+static const uint32_t LOAD_BENCHMARK_RESOURCE_COUNT = 256;
+static const uint32_t LOAD_BENCHMARK_RESOURCE_SIZE  = 64 * 1024;
+
+static int32_atomic_t g_LoadBenchmarkCreateCount = 0;
+
+static dmResource::Result LoadBenchmarkRootPreload(const dmResource::ResourcePreloadParams& params)
+{
+    for (uint32_t i = 0; i < LOAD_BENCHMARK_RESOURCE_COUNT; ++i)
+    {
+        char name[64];
+        dmSnPrintf(name, sizeof(name), "/__testload%03u__.benchdata", i);
+        dmResource::PreloadHint(params.m_HintInfo, name);
+    }
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result LoadBenchmarkDataPreload(const dmResource::ResourcePreloadParams& params)
+{
+    // Simulate decoding the data
+    uint32_t* checksum = new uint32_t;
+    *checksum = 0;
+    const uint8_t* buffer = (const uint8_t*)params.m_Buffer;
+    for (uint32_t pass = 0; pass < 16; ++pass)
+    {
+        for (uint32_t i = 0; i < params.m_BufferSize; ++i)
+        {
+            *checksum = *checksum * 31 + buffer[i];
+        }
+    }
+    *params.m_PreloadData = checksum;
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result LoadBenchmarkCreate(const dmResource::ResourceCreateParams& params)
+{
+    params.m_Resource->m_Resource = params.m_PreloadData ? params.m_PreloadData : new uint32_t(0);
+    dmAtomicIncrement32(&g_LoadBenchmarkCreateCount);
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result LoadBenchmarkDestroy(const dmResource::ResourceDestroyParams& params)
+{
+    delete (uint32_t*)params.m_Resource->m_Resource;
+    return dmResource::RESULT_OK;
+}
+
+// Time from starting to load the root resource until it and all its dependencies are created,
+// which is when the first frame of the collection can be rendered
+static uint64_t RunLoadBenchmark(uint32_t worker_count)
+{
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = LOAD_BENCHMARK_RESOURCE_COUNT + 1;
+    params.m_LoadWorkerCount = worker_count;
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    assert(factory != 0);
+
+    dmResource::RegisterType(factory, "benchroot", 0, &LoadBenchmarkRootPreload, &LoadBenchmarkCreate, 0, &LoadBenchmarkDestroy, 0);
+    dmResource::RegisterType(factory, "benchdata", 0, &LoadBenchmarkDataPreload, &LoadBenchmarkCreate, 0, &LoadBenchmarkDestroy, 0);
+    dmResource::SetTypeLoadPriority(factory, "benchdata", dmResource::LOAD_PRIORITY_LOW);
+
+    g_LoadBenchmarkCreateCount = 0;
+    uint64_t start = dmTime::GetTime();
+    dmResource::HPreloader pr = dmResource::NewPreloader(factory, "/__testload__.benchroot");
+    dmResource::Result r;
+    do
+    {
+        r = dmResource::UpdatePreloader(pr, 0, 0, 16*1000);
+    } while (r == dmResource::RESULT_PENDING);
+    uint64_t elapsed = dmTime::GetTime() - start;
+
+    dmResource::DeletePreloader(pr);
+    dmResource::DeleteFactory(factory);
+    return r == dmResource::RESULT_OK ? elapsed : 0;
+}
+
+TEST(LoadQueueTest, LoadBenchmark)
+{
+    char name[64];
+    uint8_t* data = new uint8_t[LOAD_BENCHMARK_RESOURCE_SIZE];
+    for (uint32_t i = 0; i < LOAD_BENCHMARK_RESOURCE_SIZE; ++i)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+    WriteLoadQueueTestFile("/__testload__.benchroot", "root", 4);
+    for (uint32_t i = 0; i < LOAD_BENCHMARK_RESOURCE_COUNT; ++i)
+    {
+        dmSnPrintf(name, sizeof(name), "/__testload%03u__.benchdata", i);
+        WriteLoadQueueTestFile(name, data, LOAD_BENCHMARK_RESOURCE_SIZE);
+    }
+    delete [] data;
+
+    const uint32_t worker_counts[] = { 1, 2, 4 };
+    for (uint32_t i = 0; i < sizeof(worker_counts) / sizeof(worker_counts[0]); ++i)
+    {
+        uint64_t elapsed = RunLoadBenchmark(worker_counts[i]);
+        ASSERT_NE(0U, elapsed);
+        ASSERT_EQ(LOAD_BENCHMARK_RESOURCE_COUNT + 1, (uint32_t)g_LoadBenchmarkCreateCount);
+        printf("Load %u resources, %u workers: time to first frame %7.3f ms\n", LOAD_BENCHMARK_RESOURCE_COUNT + 1, worker_counts[i], elapsed / 1000.0f);
+    }
+
+    DeleteLoadQueueTestFile("/__testload__.benchroot");
+    for (uint32_t i = 0; i < LOAD_BENCHMARK_RESOURCE_COUNT; ++i)
+    {
+        dmSnPrintf(name, sizeof(name), "/__testload%03u__.benchdata", i);
+        DeleteLoadQueueTestFile(name);
+    }
+}
+
+#endif
+
+TEST(LoadQueueTest, SetTypeLoadPriority)
+{
+    dmResource::NewFactoryParams params;
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    ASSERT_NE((void*) 0, factory);
+    ASSERT_EQ(dmResource::RESULT_UNKNOWN_RESOURCE_TYPE, dmResource::SetTypeLoadPriority(factory, "foo", dmResource::LOAD_PRIORITY_HIGH));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::RegisterType(factory, "foo", 0, 0, &RecreateResourceCreate, 0, &RecreateResourceDestroy, 0));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::SetTypeLoadPriority(factory, "foo", dmResource::LOAD_PRIORITY_HIGH));
+    ASSERT_EQ(dmResource::RESULT_INVAL, dmResource::SetTypeLoadPriority(factory, "foo", dmResource::LOAD_PRIORITY_COUNT));
+    dmResource::DeleteFactory(factory);
+}
+
 TEST_F(ResourceTest, ManifestLoadDdfFail)
 {
     dmResource::Manifest* manifest = new dmResource::Manifest();
@@ -719,6 +719,15 @@ TEST(dmResourceArchive, Wrap)
 
         ASSERT_EQ(strlen(content[i]), strlen(buffer));
         ASSERT_STREQ(content[i], buffer);
+
+        // The resource loaders read the entry as it is stored, and decode it separately
+        ASSERT_TRUE(dmResourceArchive::HasDefaultReader(entryarchive));
+        char entry_data[1024];
+        char decoded[1024] = { 0 };
+        ASSERT_GE(sizeof(entry_data), dmResourceArchive::GetEntryDataSize(&entry));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::ReadEntryData(entryarchive, &entry, entry_data));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::DecodeEntryData(&entry, entry_data, decoded));
+        ASSERT_STREQ(content[i], decoded);
     }
 
     uint8_t invalid_hash[] = { 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U };
@@ -753,6 +762,15 @@ TEST(dmResourceArchive, Wrap_Compressed)
 
         ASSERT_EQ(strlen(content[i]), strlen(buffer));
         ASSERT_STREQ(content[i], buffer);
+
+        // The resource loaders read the entry as it is stored, and decode it separately
+        ASSERT_TRUE(dmResourceArchive::HasDefaultReader(entryarchive));
+        char entry_data[1024];
+        char decoded[1024] = { 0 };
+        ASSERT_GE(sizeof(entry_data), dmResourceArchive::GetEntryDataSize(&entry));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::ReadEntryData(entryarchive, &entry, entry_data));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::DecodeEntryData(&entry, entry_data, decoded));
+        ASSERT_STREQ(content[i], decoded);
     }
 
     uint8_t invalid_hash[] = { 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U };
@@ -788,6 +806,15 @@ TEST(dmResourceArchive, LoadFromDisk)
 
         ASSERT_EQ(strlen(content[i]), strlen(buffer));
         ASSERT_STREQ(content[i], buffer);
+
+        // The resource loaders read the entry as it is stored, and decode it separately
+        ASSERT_TRUE(dmResourceArchive::HasDefaultReader(entryarchive));
+        char entry_data[1024];
+        char decoded[1024] = { 0 };
+        ASSERT_GE(sizeof(entry_data), dmResourceArchive::GetEntryDataSize(&entry));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::ReadEntryData(entryarchive, &entry, entry_data));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::DecodeEntryData(&entry, entry_data, decoded));
+        ASSERT_STREQ(content[i], decoded);
     }
 
     uint8_t invalid_hash[] = { 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U };
@@ -832,6 +859,15 @@ TEST(dmResourceArchive, LoadFromDisk_Compressed)
 
         ASSERT_EQ(strlen(content[i]), strlen(buffer));
         ASSERT_STREQ(content[i], buffer);
+
+        // The resource loaders read the entry as it is stored, and decode it separately
+        ASSERT_TRUE(dmResourceArchive::HasDefaultReader(entryarchive));
+        char entry_data[1024];
+        char decoded[1024] = { 0 };
+        ASSERT_GE(sizeof(entry_data), dmResourceArchive::GetEntryDataSize(&entry));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::ReadEntryData(entryarchive, &entry, entry_data));
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::DecodeEntryData(&entry, entry_data, decoded));
+        ASSERT_STREQ(content[i], decoded);
     }
 
     uint8_t invalid_hash[] = { 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U };
@@ -279,6 +279,23 @@ namespace dmScript
      */
     void PushTable(lua_State*L, const char* data, uint32_t data_size);
 
+    /**
+     * Check if a message was posted with a shared payload (see msg.payload). These messages have a
+     * descriptor without fields, and their data must be pushed with PushSharedPayload instead of PushDDF.
+     * @param descriptor Message descriptor
+     * @return true if the message data is a shared payload
+     */
+    bool IsSharedPayloadMessage(uintptr_t descriptor);
+
+    /**
+     * Push the table of a message posted with a shared payload to the supplied lua state, will increase the stack by 1.
+     * A new table is decoded for every call, so receivers don't see each others changes.
+     * @param L Lua state
+     * @param data Message data
+     * @param data_size Size of the message data
+     */
+    void PushSharedPayload(lua_State* L, const char* data, uint32_t data_size);
+
     /**
      * Check if the value at #index is a hash
      * @param L Lua state
@@ -13,10 +13,14 @@
 #include "script.h"
 
 #include "script_private.h"
+#include "script_msg.h"
 
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include <dlib/atomic.h>
 #include <dlib/dlib.h>
 #include <dlib/dstrings.h>
 #include <dlib/math.h>
@@ -34,8 +38,11 @@ namespace dmScript
 {
 #define SCRIPT_LIB_NAME "msg"
 #define SCRIPT_TYPE_NAME_URL "url"
+#define SCRIPT_TYPE_NAME_PAYLOAD "payload"
+#define SCRIPT_PAYLOAD_BUFFER "__msg_payload_buffer"
 
     static uint32_t SCRIPT_URL_TYPE_HASH = 0;
+    static uint32_t SCRIPT_PAYLOAD_TYPE_HASH = 0;
 
 
     /*# Messaging API documentation
@@ -48,6 +55,93 @@ namespace dmScript
      */
 
     const uint32_t MAX_MESSAGE_DATA_SIZE = 2048;
+    const uint32_t MAX_SHARED_PAYLOAD_SIZE = 64 * 1024;
+
+    /*
+     * A serialized table that is shared by all messages posted with it, see msg.payload.
+     * The payload is immutable and freed when the last message and the Lua object are gone.
+     */
+    struct SharedPayload
+    {
+        int32_atomic_t  m_RefCount;
+        uint32_t        m_Size;
+        // m_Size bytes, allocated with the payload
+        char            m_Data[1];
+    };
+
+    // The message data of a message posted with a shared payload
+    struct SharedPayloadMessage
+    {
+        SharedPayload*  m_Payload;
+    };
+
+    // The descriptor of messages posted with a shared payload. It has no fields, so code that handles ddf
+    // messages by descriptor ignores it, and since msg.post doesn't allow payloads for ddf message ids, the
+    // message id never matches a ddf message either. The message data is only trusted for this descriptor.
+    static const dmDDF::Descriptor g_SharedPayloadDescriptor =
+    {
+        0, 0, "payload", 0, sizeof(SharedPayloadMessage), 0, 0, 0
+    };
+
+    static void ReleaseSharedPayload(SharedPayload* payload)
+    {
+        if (dmAtomicDecrement32(&payload->m_RefCount) == 1)
+        {
+            free(payload);
+        }
+    }
+
+    static void DestroySharedPayloadMessage(dmMessage::Message* message)
+    {
+        ReleaseSharedPayload(((SharedPayloadMessage*)message->m_Data)->m_Payload);
+    }
+
+    static SharedPayload* CheckSharedPayload(lua_State* L, int index)
+    {
+        return *(SharedPayload**)dmScript::CheckUserType(L, index, SCRIPT_PAYLOAD_TYPE_HASH, 0);
+    }
+
+    static int Payload_gc(lua_State* L)
+    {
+        SharedPayload** payload = (SharedPayload**)lua_touserdata(L, 1);
+        if (*payload)
+        {
+            ReleaseSharedPayload(*payload);
+            *payload = 0;
+        }
+        return 0;
+    }
+
+    static int Payload_tostring(lua_State* L)
+    {
+        SharedPayload* payload = CheckSharedPayload(L, 1);
+        lua_pushfstring(L, "%s.%s(%d bytes)", SCRIPT_LIB_NAME, SCRIPT_TYPE_NAME_PAYLOAD, payload->m_Size);
+        return 1;
+    }
+
+    static const luaL_reg Payload_methods[] =
+    {
+        {0,0}
+    };
+
+    static const luaL_reg Payload_meta[] =
+    {
+        {"__gc",        Payload_gc},
+        {"__tostring",  Payload_tostring},
+        {0,0}
+    };
+
+    bool IsSharedPayloadMessage(uintptr_t descriptor)
+    {
+        return descriptor == (uintptr_t)&g_SharedPayloadDescriptor;
+    }
+
+    void PushSharedPayload(lua_State* L, const char* data, uint32_t data_size)
+    {
+        assert(data_size == sizeof(SharedPayloadMessage));
+        const SharedPayload* payload = ((const SharedPayloadMessage*)data)->m_Payload;
+        PushTable(L, payload->m_Data, payload->m_Size);
+    }
 
     bool IsURL(lua_State *L, int index)
     {
@@ -443,6 +537,64 @@ namespace dmScript
         return 1;
     }
 
+    // The tables are serialized into a scratch buffer that is kept in the registry, since it's too large for
+    // the stack. It's created on first use, and is owned by the Lua state so it's not leaked if serialization fails.
+    static char* GetSharedPayloadBuffer(lua_State* L)
+    {
+        lua_getfield(L, LUA_REGISTRYINDEX, SCRIPT_PAYLOAD_BUFFER);
+        char* buffer = (char*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        if (buffer == 0)
+        {
+            buffer = (char*)lua_newuserdata(L, MAX_SHARED_PAYLOAD_SIZE);
+            lua_setfield(L, LUA_REGISTRYINDEX, SCRIPT_PAYLOAD_BUFFER);
+        }
+        return buffer;
+    }
+
+    /*# creates a shared message payload
+     *
+     * Serializes a table once into a payload that can be posted with [ref:msg.post]
+     * any number of times. Messages posted with a payload only carry a reference to it,
+     * so posting the same event to many receivers does not serialize the table again.
+     * The payload is immutable. Every receiver gets its own table, decoded on delivery.
+     *
+     * [icon:attention] There is a 64 kilobyte limit to the payload size.
+     *
+     * @name msg.payload
+     * @param message [type:table] a lua table with message parameters
+     * @return payload [type:payload] the serialized payload
+     * @examples
+     *
+     * Broadcast an event to a list of listeners:
+     *
+     * ```lua
+     * local payload = msg.payload({ score = 100, items = self.items })
+     * for _, listener in ipairs(self.listeners) do
+     *     msg.post(listener, hash("score_changed"), payload)
+     * end
+     * ```
+     */
+    static int Msg_Payload(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+        luaL_checktype(L, 1, LUA_TTABLE);
+
+        char* buffer = GetSharedPayloadBuffer(L);
+        uint32_t size = dmScript::CheckTable(L, buffer, MAX_SHARED_PAYLOAD_SIZE, 1);
+
+        SharedPayload* payload = (SharedPayload*)malloc(offsetof(SharedPayload, m_Data) + size);
+        payload->m_RefCount = 1;
+        payload->m_Size = size;
+        memcpy(payload->m_Data, buffer, size);
+
+        SharedPayload** payloadp = (SharedPayload**)lua_newuserdata(L, sizeof(SharedPayload*));
+        *payloadp = payload;
+        luaL_getmetatable(L, SCRIPT_TYPE_NAME_PAYLOAD);
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
     /*# posts a message to a receiving URL
      *
      * Post a message to a receiving URL. The most common case is to send messages
@@ -455,11 +607,12 @@ namespace dmScript
      * - `"#"` the current component
      *
      * [icon:attention] There is a 2 kilobyte limit to the message parameter table size.
+     * Use [ref:msg.payload] for larger tables, or for tables that are posted to many receivers.
      *
      * @name msg.post
      * @param receiver [type:string|url|hash] The receiver must be a string in URL-format, a URL object or a hashed string.
-     * @param message_id [type:string|hash] The id must be a string or a hashed string.
-     * @param [message] [type:table|nil] a lua table with message parameters to send.
+     * @param message_id [type:string|hash] The id must be a string or a hashed string. Hashed ids are the fastest to post.
+     * @param [message] [type:table|payload|nil] a lua table with message parameters to send, or a payload created with [ref:msg.payload].
      * @examples
      *
      * Send "enable" to the sprite "my_sprite" in "my_gameobject":
@@ -488,7 +641,12 @@ namespace dmScript
         ResolveURL(L, 1, &receiver, &sender);
 
         dmhash_t message_id;
-        if (lua_isstring(L, 2))
+        if (IsHash(L, 2))
+        {
+            // Pre-hashed ids are the common case for frequent messages
+            message_id = *(dmhash_t*)lua_touserdata(L, 2);
+        }
+        else if (lua_isstring(L, 2))
         {
             message_id = dmHashString64(lua_tostring(L, 2));
         }
@@ -499,10 +657,23 @@ namespace dmScript
 
         DM_ALIGNED(16) char data[MAX_MESSAGE_DATA_SIZE];
         uint32_t data_size = 0;
-
+        dmMessage::MessageDestroyCallback destroy_callback = 0;
 
         const dmDDF::Descriptor* desc = dmDDF::GetDescriptorFromHash(message_id);
-        if (desc != 0)
+        if (top > 2 && lua_type(L, 3) == LUA_TUSERDATA)
+        {
+            if (desc != 0)
+            {
+                return luaL_error(L, "The message '%s' can't be sent with a %s.%s.", desc->m_Name, SCRIPT_LIB_NAME, SCRIPT_TYPE_NAME_PAYLOAD);
+            }
+            SharedPayloadMessage* payload_message = (SharedPayloadMessage*)data;
+            payload_message->m_Payload = CheckSharedPayload(L, 3);
+            dmAtomicIncrement32(&payload_message->m_Payload->m_RefCount);
+            data_size = sizeof(SharedPayloadMessage);
+            destroy_callback = DestroySharedPayloadMessage;
+            desc = &g_SharedPayloadDescriptor;
+        }
+        else if (desc != 0)
         {
             if (desc->m_Size > MAX_MESSAGE_DATA_SIZE)
             {
@@ -530,7 +701,11 @@ namespace dmScript
 
         assert(top == lua_gettop(L));
 
-        dmMessage::Result result = dmMessage::Post(&sender, &receiver, message_id, 0, (uintptr_t) desc, data, data_size, 0);
+        dmMessage::Result result = dmMessage::Post(&sender, &receiver, message_id, 0, (uintptr_t) desc, data, data_size, destroy_callback);
+        if (result != dmMessage::RESULT_OK && destroy_callback != 0)
+        {
+            ReleaseSharedPayload(((SharedPayloadMessage*)data)->m_Payload);
+        }
         if (result == dmMessage::RESULT_SOCKET_NOT_FOUND)
         {
             char receiver_buffer[64];
@@ -551,6 +726,7 @@ namespace dmScript
     {
         {SCRIPT_TYPE_NAME_URL, URL_new},
         {"post", Msg_Post},
+        {"payload", Msg_Payload},
         {0, 0}
     };
 
@@ -559,6 +735,7 @@ namespace dmScript
         int top = lua_gettop(L);
 
         SCRIPT_URL_TYPE_HASH = dmScript::RegisterUserType(L, SCRIPT_TYPE_NAME_URL, URL_methods, URL_meta);
+        SCRIPT_PAYLOAD_TYPE_HASH = dmScript::RegisterUserType(L, SCRIPT_TYPE_NAME_PAYLOAD, Payload_methods, Payload_meta);
 
         luaL_register(L, SCRIPT_LIB_NAME, ScriptMsg_methods);
         lua_pop(L, 1);
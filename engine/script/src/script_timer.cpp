@@ -14,6 +14,7 @@
 #include "script_timer_private.h"
 
 #include <string.h>
+#include <algorithm>
 #include <dlib/index_pool.h>
 #include <dlib/hashtable.h>
 #include <dlib/profile.h>
@@ -37,20 +38,27 @@ namespace dmScript
      */
 
     /*
-        The timers are stored in a flat array with no holes which we scan sequenctially on each update.
+        The timers are stored in a flat array with no holes.
 
         When a timer is removed the last timer in the list may change location (EraseSwap).
 
-        This is to keep the array sweep fast and handle cases where multiple short lived timers are
-        created followed by one long-lived timer. If we did not re-shuffle and keep holes we would keep
-        scanning the array to the end where the only live timer exists skipping all the holes.
-        How much of an issue this is guesswork at this point.
-
         The timer identity is an index into an indirection layer combined with a generation counter,
         this makes it possible to reuse the index for the indirection layer without risk of using
         stale indexes - the caller to CancelTimer is allowed to call with an handle of a timer that already
         has expired.
 
+        Each timer has an absolute deadline in the world time, and the live timers are also kept in a
+        min-heap ordered by deadline. An update only visits the timers that are due, so long running
+        timers cost nothing until they trigger. The due timers are triggered in the order they are stored
+        in the timer array, the same order as when all timers were scanned on each update.
+
+        The world time is accumulated in double precision. A timer that lands right at its deadline might
+        therefore trigger one update earlier or later than when its remaining time was counted down in float
+        precision on each update.
+
+        Cancelled timers leave their heap entries behind, which are skipped when they reach the top of the
+        heap. The heap is rebuilt when it holds more stale entries than live ones.
+
         Each script instance needs to call KillTimers for its owner to clean up potential timers
         that has not yet been cancelled or completed (one-shot).
     */
@@ -64,12 +72,12 @@ namespace dmScript
         uintptr_t       m_Owner;
         uintptr_t       m_UserData;
 
+        // When the timer fires, in world time
+        double          m_Deadline;
+
         // Store complete timer handle with generation here to identify stale timer handles
         HTimer          m_Handle;
 
-        // How much time remaining until the timer fires
-        float           m_Remaining;
-
         // The timer delay, we need to keep this for repeating timers
         float           m_Delay;
 
@@ -77,18 +85,36 @@ namespace dmScript
         uint32_t        m_Repeat : 1;
         // Flag if the timer is alive
         uint32_t        m_IsAlive : 1;
+        // Flag if the timer has an entry in the heap
+        uint32_t        m_InHeap : 1;
+    };
+
+    struct TimerHeapEntry
+    {
+        double          m_Deadline;
+        HTimer          m_Handle;
     };
 
     #define INVALID_TIMER_LOOKUP_INDEX  0xffffu
     #define INITIAL_TIMER_CAPACITY      8u
     #define MAX_TIMER_CAPACITY          65000u  // Needs to be less that 65535 since 65535 is reserved for invalid index
     #define TIMER_CAPACITY_GROWTH       16u
+    #define MIN_STALE_HEAP_ENTRIES      64u     // Don't bother rebuilding small heaps
 
     struct TimerWorld
     {
         dmArray<Timer>                      m_Timers;
         dmArray<uint16_t>                   m_IndexLookup;
         dmIndexPool<uint16_t>               m_IndexPool;
+        // Min-heap of the timer deadlines
+        dmArray<TimerHeapEntry>             m_Heap;
+        // Timers that are due in the current update, as indices into m_Timers
+        dmArray<uint32_t>                   m_Due;
+        // Timers that died during the current update as indices into m_Timers, freed at the end of the update
+        dmArray<uint32_t>                   m_Dead;
+        // Accumulated time of all updates
+        double                              m_Time;
+        uint32_t                            m_StaleHeapEntries;
         uint16_t                            m_Version;   // Incremented to avoid collisions each time we push timer indexes back to the m_IndexPool
         uint16_t                            m_InUpdate : 1;
     };
@@ -103,6 +129,88 @@ namespace dmScript
         return (((uint32_t)generation) << 16) | (lookup_index);
     }
 
+    static Timer* GetTimer(HTimerWorld timer_world, HTimer handle)
+    {
+        uint16_t lookup_index = GetLookupIndex(handle);
+        if (lookup_index >= timer_world->m_IndexLookup.Size())
+        {
+            return 0x0;
+        }
+
+        uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
+        if (timer_index >= timer_world->m_Timers.Size())
+        {
+            return 0x0;
+        }
+
+        Timer* timer = &timer_world->m_Timers[timer_index];
+        if (timer->m_Handle != handle)
+        {
+            return 0x0;
+        }
+        return timer;
+    }
+
+    // Orders the heap with the earliest deadline on top
+    static bool HeapEntryLater(const TimerHeapEntry& a, const TimerHeapEntry& b)
+    {
+        return a.m_Deadline > b.m_Deadline;
+    }
+
+    static void PushHeap(HTimerWorld timer_world, Timer& timer)
+    {
+        assert(timer.m_InHeap == 0);
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        if (heap.Full())
+        {
+            heap.OffsetCapacity(dmMath::Max(TIMER_CAPACITY_GROWTH, heap.Capacity() / 2));
+        }
+        TimerHeapEntry entry;
+        entry.m_Deadline = timer.m_Deadline;
+        entry.m_Handle = timer.m_Handle;
+        heap.Push(entry);
+        std::push_heap(heap.Begin(), heap.End(), HeapEntryLater);
+        timer.m_InHeap = 1;
+    }
+
+    // Returns the timer of the entry, if the entry is not stale
+    static Timer* GetHeapEntryTimer(HTimerWorld timer_world, const TimerHeapEntry& entry)
+    {
+        Timer* timer = GetTimer(timer_world, entry.m_Handle);
+        if (timer == 0x0 || timer->m_IsAlive == 0 || timer->m_InHeap == 0 || timer->m_Deadline != entry.m_Deadline)
+        {
+            return 0x0;
+        }
+        return timer;
+    }
+
+    // Called when a timer dies, if it has an entry in the heap the entry is now stale
+    static void RemoveFromHeap(HTimerWorld timer_world, Timer& timer)
+    {
+        if (timer.m_InHeap)
+        {
+            timer.m_InHeap = 0;
+            ++timer_world->m_StaleHeapEntries;
+        }
+    }
+
+    static void CompactHeap(HTimerWorld timer_world)
+    {
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        uint32_t size = heap.Size();
+        uint32_t live = 0;
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            if (GetHeapEntryTimer(timer_world, heap[i]) != 0x0)
+            {
+                heap[live++] = heap[i];
+            }
+        }
+        heap.SetSize(live);
+        std::make_heap(heap.Begin(), heap.End(), HeapEntryLater);
+        timer_world->m_StaleHeapEntries = 0;
+    }
+
     static Timer* AllocateTimer(HTimerWorld timer_world, uintptr_t owner)
     {
         assert(timer_world != 0x0);
@@ -136,6 +244,7 @@ namespace dmScript
         Timer& timer = timer_world->m_Timers[timer_count];
         timer.m_Handle = handle;
         timer.m_Owner = owner;
+        timer.m_InHeap = 0;
 
         uint16_t lookup_index = GetLookupIndex(handle);
 
@@ -160,6 +269,7 @@ namespace dmScript
     {
         assert(timer_world != 0x0);
         assert(timer.m_IsAlive == 0);
+        assert(timer.m_InHeap == 0);
 
         uint16_t lookup_index = GetLookupIndex(timer.m_Handle);
         uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
@@ -168,6 +278,21 @@ namespace dmScript
         EraseTimer(timer_world, timer_index);
     }
 
+    // Kills a live timer, the timer is freed right away unless we are in an update
+    static void KillTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        timer.m_IsAlive = 0;
+        RemoveFromHeap(timer_world, timer);
+        if (timer_world->m_InUpdate)
+        {
+            if (timer_world->m_Dead.Full())
+            {
+                timer_world->m_Dead.OffsetCapacity(TIMER_CAPACITY_GROWTH);
+            }
+            timer_world->m_Dead.Push((uint32_t)(&timer - timer_world->m_Timers.Begin()));
+        }
+    }
+
     HTimerWorld NewTimerWorld()
     {
         TimerWorld* timer_world = new TimerWorld();
@@ -176,6 +301,9 @@ namespace dmScript
         timer_world->m_IndexLookup.SetSize(INITIAL_TIMER_CAPACITY);
         memset(&timer_world->m_IndexLookup[0], 0u, INITIAL_TIMER_CAPACITY * sizeof(uint16_t));
         timer_world->m_IndexPool.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Heap.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Time = 0.0;
+        timer_world->m_StaleHeapEntries = 0;
         timer_world->m_Version = 0;
         timer_world->m_InUpdate = 0;
         return timer_world;
@@ -193,34 +321,59 @@ namespace dmScript
         DM_PROFILE(TimerWorld, "Update");
 
         timer_world->m_InUpdate = 1;
+        timer_world->m_Time += dt;
+        double time = timer_world->m_Time;
 
-        // We only scan timers for trigger if the timer *existed at entry to UpdateTimers*, any timers added
-        // in a trigger callback will always be added at the end of m_Timers and not triggered in this scope.
-        uint32_t size = timer_world->m_Timers.Size();
-        DM_COUNTER("timerc", size);
+        DM_COUNTER("timerc", timer_world->m_Timers.Size());
 
-        for (uint32_t i = 0; i < size; ++i)
+        // Collect the due timers before triggering any of them. Timers added in a trigger callback are
+        // always added at the end of m_Timers and will not be triggered in this scope.
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        dmArray<uint32_t>& due = timer_world->m_Due;
+        due.SetSize(0);
+        while (!heap.Empty() && heap.Front().m_Deadline <= time)
         {
-            Timer* timer = &timer_world->m_Timers[i];
-            if (timer->m_IsAlive == 0)
+            Timer* timer = GetHeapEntryTimer(timer_world, heap.Front());
+            if (timer == 0x0 && timer_world->m_StaleHeapEntries > 0)
             {
-                continue;
+                --timer_world->m_StaleHeapEntries;
             }
+            std::pop_heap(heap.Begin(), heap.End(), HeapEntryLater);
+            heap.Pop();
 
-            timer->m_Remaining -= dt;
-            if (timer->m_Remaining > 0.0f)
+            if (timer != 0x0)
+            {
+                timer->m_InHeap = 0;
+                if (due.Full())
+                {
+                    due.OffsetCapacity(dmMath::Max(TIMER_CAPACITY_GROWTH, due.Capacity() / 2));
+                }
+                due.Push((uint32_t)(timer - timer_world->m_Timers.Begin()));
+            }
+        }
+
+        // Trigger in array order. No timers are erased from the array during the update.
+        std::sort(due.Begin(), due.End());
+
+        uint32_t due_count = due.Size();
+        for (uint32_t i = 0; i < due_count; ++i)
+        {
+            uint32_t timer_index = due[i];
+            Timer* timer = &timer_world->m_Timers[timer_index];
+            if (timer->m_IsAlive == 0)
             {
                 continue;
             }
 
-            float elapsed_time = timer->m_Delay - timer->m_Remaining;
+            float remaining = (float)(timer->m_Deadline - time);
+            float elapsed_time = timer->m_Delay - remaining;
 
             TimerEventType eventType = timer->m_Repeat == 0 ? TIMER_EVENT_TRIGGER_WILL_DIE : TIMER_EVENT_TRIGGER_WILL_REPEAT;
 
             timer->m_Callback(timer_world, eventType, timer->m_Handle, elapsed_time, timer->m_Owner, timer->m_UserData);
 
             // The array might have been reallocated here! So grab the pointer again...
-            timer = &timer_world->m_Timers[i];
+            timer = &timer_world->m_Timers[timer_index];
 
             if (timer->m_IsAlive == 0)
             {
@@ -229,45 +382,51 @@ namespace dmScript
 
             if (timer->m_Repeat == 0)
             {
-                timer->m_IsAlive = 0;
+                KillTimer(timer_world, *timer);
                 continue;
             }
 
             if (timer->m_Delay == 0.0f)
             {
-                timer->m_Remaining = 0.0f;
-                continue;
+                timer->m_Deadline = time;
             }
-
-            float wrapped_count = ((-timer->m_Remaining) / timer->m_Delay) + 1.f;
-            float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
-            timer->m_Remaining += offset_to_next_trigger;
-            assert(timer->m_Remaining >= 0.f);
+            else
+            {
+                float wrapped_count = ((-remaining) / timer->m_Delay) + 1.f;
+                float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
+                assert(remaining + offset_to_next_trigger >= 0.f);
+                timer->m_Deadline += offset_to_next_trigger;
+            }
+            PushHeap(timer_world, *timer);
         }
 
         timer_world->m_InUpdate = 0;
 
-        size = timer_world->m_Timers.Size();
-        uint32_t original_size = size;
-        uint32_t i = 0;
-        while (i < size)
+        // Free the dead timers from the front of the array, since freeing a timer moves the last
+        // timer into its place. This keeps the order of the live timers as if the whole array was swept.
+        dmArray<uint32_t>& dead = timer_world->m_Dead;
+        std::sort(dead.Begin(), dead.End());
+        uint32_t dead_count = dead.Size();
+        for (uint32_t i = 0; i < dead_count; ++i)
         {
-            Timer& timer = timer_world->m_Timers[i];
-            if (timer.m_IsAlive == 0)
+            uint32_t timer_index = dead[i];
+            // The timer might already have been freed, if it was moved into the place of a previous timer
+            while (timer_index < timer_world->m_Timers.Size() && timer_world->m_Timers[timer_index].m_IsAlive == 0)
             {
-                FreeTimer(timer_world, timer);
-                --size;
-            }
-            else
-            {
-                ++i;
+                FreeTimer(timer_world, timer_world->m_Timers[timer_index]);
             }
         }
+        dead.SetSize(0);
 
-        if (size != original_size)
+        if (dead_count > 0)
         {
             ++timer_world->m_Version;
         }
+
+        if (timer_world->m_StaleHeapEntries > MIN_STALE_HEAP_ENTRIES && timer_world->m_StaleHeapEntries * 2 > heap.Size())
+        {
+            CompactHeap(timer_world);
+        }
     }
 
     HTimer AddTimer(HTimerWorld timer_world,
@@ -287,11 +446,12 @@ namespace dmScript
         }
 
         timer->m_Delay = delay;
-        timer->m_Remaining = delay;
+        timer->m_Deadline = timer_world->m_Time + delay;
         timer->m_UserData = userdata;
         timer->m_Callback = timer_callback;
         timer->m_Repeat = repeat;
         timer->m_IsAlive = 1;
+        PushHeap(timer_world, *timer);
 
         return timer->m_Handle;
     }
@@ -299,35 +459,19 @@ namespace dmScript
     bool CancelTimer(HTimerWorld timer_world, HTimer handle)
     {
         assert(timer_world != 0x0);
-        uint16_t lookup_index = GetLookupIndex(handle);
-        if (lookup_index >= timer_world->m_IndexLookup.Size())
+        Timer* timer = GetTimer(timer_world, handle);
+        if (timer == 0x0 || timer->m_IsAlive == 0)
         {
             return false;
         }
 
-        uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
-        if (timer_index >= timer_world->m_Timers.Size())
-        {
-            return false;
-        }
-
-        Timer& timer = timer_world->m_Timers[timer_index];
-        if (timer.m_Handle != handle)
-        {
-            return false;
-        }
-
-        if (timer.m_IsAlive == 0)
-        {
-            return false;
-        }
-
-        timer.m_IsAlive = 0;
-        timer.m_Callback(timer_world, TIMER_EVENT_CANCELLED, timer.m_Handle, 0.f, timer.m_Owner, timer.m_UserData);
+        KillTimer(timer_world, *timer);
+        timer->m_Callback(timer_world, TIMER_EVENT_CANCELLED, timer->m_Handle, 0.f, timer->m_Owner, timer->m_UserData);
 
         if (timer_world->m_InUpdate == 0)
         {
-            FreeTimer(timer_world, timer);
+            // The callback might have added timers, so look up the timer again
+            FreeTimer(timer_world, *GetTimer(timer_world, handle));
             ++timer_world->m_Version;
         }
         return true;
@@ -343,17 +487,14 @@ namespace dmScript
         while (timer_index < size)
         {
             Timer& timer = timer_world->m_Timers[timer_index];
-            if (timer.m_Owner != owner)
+            if (timer.m_Owner != owner || timer.m_IsAlive == 0)
             {
                 ++timer_index;
                 continue;
             }
 
-            if (timer.m_IsAlive == 1)
-            {
-                timer.m_IsAlive = 0;
-                ++cancelled_count;
-            }
+            KillTimer(timer_world, timer);
+            ++cancelled_count;
 
             if (timer_world->m_InUpdate == 0)
             {
@@ -2265,6 +2265,136 @@ namespace dmScript
         return 1;
     }
 
+    /*# adds two vectors into an existing vector
+     *
+     * Adds two vectors of the same type and stores the result in `out`, which
+     * must be of the same type as the operands. Unlike `a + b`, no new vector is
+     * allocated, which avoids garbage collection pressure in per-frame code.
+     * `out` may be one of the operands.
+     *
+     * @name vmath.add_to
+     * @param out [type:vector3|vector4] vector to store the result in
+     * @param v1 [type:vector3|vector4] first vector
+     * @param v2 [type:vector3|vector4] second vector
+     * @return out [type:vector3|vector4] the `out` vector
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.pos = vmath.vector3()
+     * end
+     *
+     * function update(self, dt)
+     *     go.get_position(nil, self.pos)
+     *     vmath.add_to(self.pos, self.pos, self.velocity)
+     *     go.set_position(self.pos)
+     * end
+     * ```
+     */
+    static int AddTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = CheckVector3(L, 1);
+            *out = *CheckVector3(L, 2) + *CheckVector3(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = CheckVector4(L, 1);
+            *out = *CheckVector4(L, 2) + *CheckVector4(L, 3);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s) as arguments.", SCRIPT_LIB_NAME, "add_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# subtracts two vectors into an existing vector
+     *
+     * Subtracts `v2` from `v1` and stores the result in `out`, which must be of
+     * the same type as the operands. Unlike `a - b`, no new vector is allocated.
+     * `out` may be one of the operands.
+     *
+     * @name vmath.sub_to
+     * @param out [type:vector3|vector4] vector to store the result in
+     * @param v1 [type:vector3|vector4] first vector
+     * @param v2 [type:vector3|vector4] second vector
+     * @return out [type:vector3|vector4] the `out` vector
+     * @examples
+     *
+     * ```lua
+     * local dir = vmath.vector3()
+     * vmath.sub_to(dir, target_pos, pos)
+     * ```
+     */
+    static int SubTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = CheckVector3(L, 1);
+            *out = *CheckVector3(L, 2) - *CheckVector3(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = CheckVector4(L, 1);
+            *out = *CheckVector4(L, 2) - *CheckVector4(L, 3);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s) as arguments.", SCRIPT_LIB_NAME, "sub_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# multiplies into an existing vector or quaternion
+     *
+     * Multiplies a vector by a number, or two quaternions, and stores the result
+     * in `out`. Unlike `a * b`, no new value is allocated. `out` may be one of
+     * the operands.
+     *
+     * @name vmath.mul_to
+     * @param out [type:vector3|vector4|quaternion] value to store the result in
+     * @param v1 [type:vector3|vector4|quaternion] vector to scale, or first quaternion
+     * @param v2 [type:number|quaternion] scale factor, or second quaternion
+     * @return out [type:vector3|vector4|quaternion] the `out` value
+     * @examples
+     *
+     * ```lua
+     * local step = vmath.vector3()
+     * vmath.mul_to(step, self.velocity, dt)
+     * ```
+     */
+    static int MulTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = CheckVector3(L, 1);
+            *out = *CheckVector3(L, 2) * (float) luaL_checknumber(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = CheckVector4(L, 1);
+            *out = *CheckVector4(L, 2) * (float) luaL_checknumber(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_QUAT)
+        {
+            Vectormath::Aos::Quat* out = CheckQuat(L, 1);
+            *out = *CheckQuat(L, 2) * *CheckQuat(L, 3);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s|%s) as arguments.", SCRIPT_LIB_NAME, "mul_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4, SCRIPT_TYPE_NAME_QUAT);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
     static const luaL_reg methods[] =
     {
         {SCRIPT_TYPE_NAME_VECTOR, Vector_new},
@@ -2301,6 +2431,9 @@ namespace dmScript
         {"inv", Inverse},
         {"ortho_inv", OrthoInverse},
         {"mul_per_elem", MulPerElem},
+        {"add_to", AddTo},
+        {"sub_to", SubTo},
+        {"mul_to", MulTo},
         {0, 0}
     };
 
@@ -106,3 +106,11 @@ assert(math.abs(vmath.length_sqr(q) - 1) < 0.0000001, "normalized not unit lengt
 local t = 1 / vmath.length(vmath.quat(1, 2, 3, 4))
 assert(math.abs(q.x - t) < 0.000001 and math.abs(q.y - 2*t) < 0.000001 and math.abs(q.z - 3*t) < 0.000001 and math.abs(q.w - 4*t) < 0.000001, "normalize")
 
+
+-- mul_to
+local q1 = vmath.quat_rotation_z(math.pi * 0.25)
+local out = vmath.quat()
+local r = vmath.mul_to(out, q1, q1)
+local expected = q1 * q1
+assert(r == out, "mul_to does not return out")
+assert(out.x == expected.x and out.y == expected.y and out.z == expected.z and out.w == expected.w, "mul_to")
@@ -765,6 +765,154 @@ TEST_F(ScriptMsgTest, TestPerf)
     printf("Time per post: %.4f\n", time / (double)count);
 }
 
+struct PayloadUserData
+{
+    lua_State* L;
+    uint32_t m_Count;
+    uint32_t m_TestValue;
+    size_t m_TextLength;
+    bool m_IsPayload;
+};
+
+void DispatchCallbackPayload(dmMessage::Message *message, void* user_ptr)
+{
+    PayloadUserData* user_data = (PayloadUserData*)user_ptr;
+    lua_State* L = user_data->L;
+    user_data->m_IsPayload = dmScript::IsSharedPayloadMessage(message->m_Descriptor);
+    if (!user_data->m_IsPayload)
+    {
+        return;
+    }
+    dmScript::PushSharedPayload(L, (const char*)message->m_Data, message->m_DataSize);
+    lua_getfield(L, -1, "uint_value");
+    user_data->m_TestValue = (uint32_t) lua_tonumber(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, -1, "text");
+    user_data->m_TextLength = lua_objlen(L, -1);
+    lua_pop(L, 1);
+    // Every receiver gets its own table, so this change must not be seen by the next receiver
+    lua_pushnumber(L, 100);
+    lua_setfield(L, -2, "uint_value");
+    lua_pop(L, 1);
+    user_data->m_Count++;
+}
+
+TEST_F(ScriptMsgTest, TestPostPayload)
+{
+    int top = lua_gettop(L);
+
+    dmMessage::HSocket socket;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("socket", &socket));
+
+    // Larger than the max size of a message table
+    ASSERT_TRUE(RunString(L,
+        "local payload = msg.payload({uint_value = 1, text = string.rep(\"a\", 4000)})\n"
+        "for i = 1,3 do\n"
+        "    msg.post(\"socket:\", hash(\"table\"), payload)\n"
+        "end\n"
+        ));
+    PayloadUserData user_data;
+    user_data.L = L;
+    user_data.m_Count = 0;
+    user_data.m_TestValue = 0;
+    user_data.m_TextLength = 0;
+    user_data.m_IsPayload = false;
+    ASSERT_EQ(3u, dmMessage::Dispatch(socket, DispatchCallbackPayload, &user_data));
+    ASSERT_EQ(3u, user_data.m_Count);
+    ASSERT_EQ(1u, user_data.m_TestValue);
+    ASSERT_EQ(4000u, (uint32_t)user_data.m_TextLength);
+
+    // Pending messages keep the payload alive after the Lua object is collected
+    ASSERT_TRUE(RunString(L,
+        "msg.post(\"socket:\", \"table\", msg.payload({uint_value = 2}))\n"
+        "collectgarbage(\"collect\")\n"
+        ));
+    user_data.m_Count = 0;
+    ASSERT_EQ(1u, dmMessage::Dispatch(socket, DispatchCallbackPayload, &user_data));
+    ASSERT_EQ(2u, user_data.m_TestValue);
+
+    // Plain tables aren't flagged as payloads
+    ASSERT_TRUE(RunString(L,
+        "msg.post(\"socket:\", \"table\", {uint_value = 3})\n"
+        ));
+    user_data.m_Count = 0;
+    ASSERT_EQ(1u, dmMessage::Dispatch(socket, DispatchCallbackPayload, &user_data));
+    ASSERT_FALSE(user_data.m_IsPayload);
+    ASSERT_EQ(0u, user_data.m_Count);
+
+    // The tables are serialized into the same scratch buffer, so creating a payload only allocates the payload object
+    ASSERT_TRUE(RunString(L,
+        "msg.payload({uint_value = 1})\n"
+        "collectgarbage(\"stop\")\n"
+        "local before = collectgarbage(\"count\")\n"
+        "for i = 1,16 do\n"
+        "    msg.payload({uint_value = i})\n"
+        "end\n"
+        "local allocated = collectgarbage(\"count\") - before\n"
+        "collectgarbage(\"restart\")\n"
+        "assert(allocated < 64, \"allocated \" .. allocated .. \" kb\")\n"
+        ));
+
+    // Not for system messages
+    ASSERT_FALSE(RunString(L,
+        "msg.post(\"socket:\", \"sub_msg\", msg.payload({uint_value = 1}))\n"
+        ));
+    ASSERT_FALSE(RunString(L,
+        "msg.payload(1)\n"
+        ));
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(socket));
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
+static void DispatchCallbackPushTable(dmMessage::Message *message, void* user_ptr)
+{
+    lua_State* L = (lua_State*)user_ptr;
+    if (dmScript::IsSharedPayloadMessage(message->m_Descriptor))
+        dmScript::PushSharedPayload(L, (const char*)message->m_Data, message->m_DataSize);
+    else
+        dmScript::PushTable(L, (const char*)message->m_Data, message->m_DataSize);
+    lua_pop(L, 1);
+}
+
+TEST_F(ScriptMsgTest, TestPerfPayload)
+{
+    dmMessage::HSocket socket;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("socket", &socket));
+
+    // An event posted to many listeners, with the table per post or with a shared payload
+    const uint32_t receivers = 100;
+    const char* programs[] = {
+        "local event = {}\n"
+        "for i = 1,20 do event[\"field\" .. i] = vmath.vector3(i) end\n"
+        "for i = 1,%u do\n"
+        "    msg.post(\"socket:\", hash(\"event\"), event)\n"
+        "end\n",
+        "local event = {}\n"
+        "for i = 1,20 do event[\"field\" .. i] = vmath.vector3(i) end\n"
+        "local payload = msg.payload(event)\n"
+        "for i = 1,%u do\n"
+        "    msg.post(\"socket:\", hash(\"event\"), payload)\n"
+        "end\n"
+    };
+    const char* names[] = {"table", "payload"};
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        char program[512];
+        dmSnPrintf(program, sizeof(program), programs[i], receivers);
+        uint64_t time = dmTime::GetTime();
+        ASSERT_TRUE(RunString(L, program));
+        uint64_t post_time = dmTime::GetTime() - time;
+        time = dmTime::GetTime();
+        ASSERT_EQ(receivers, dmMessage::Dispatch(socket, DispatchCallbackPushTable, L));
+        uint64_t dispatch_time = dmTime::GetTime() - time;
+        printf("%-8s %u receivers: post %.4f ms, receive %.4f ms\n", names[i], receivers, post_time / 1000.0, dispatch_time / 1000.0);
+    }
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(socket));
+}
+
 TEST_F(ScriptMsgTest, TestPostDeletedSocket)
 {
     dmMessage::HSocket socket;
@@ -867,6 +867,22 @@ TEST_F(LuaTableTest, CorruptedTables)
     ASSERT_EQ(top, lua_gettop(L));
 }
 
+TEST_F(LuaTableTest, PointerLikeData)
+{
+    int top = lua_gettop(L);
+
+    // Data that looks like a magic number followed by a pointer is parsed as a table, and never dereferenced
+    uint32_t data[4] = { 0x44524853, 0, 0xdeadbeef, 0xdeadbeef };
+    lua_pushcfunction(L, ParseTruncatedTable);
+    lua_pushlstring(L, (const char*)data, sizeof(data));
+    lua_pushnumber(L, sizeof(data));
+    int res = lua_pcall(L, 2, 0, 0x0);
+    ASSERT_EQ(LUA_ERRRUN, res);
+    lua_pop(L, 1);
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
 static void RandomString(char* s, int max_len)
 {
     int n = rand() % max_len + 1;
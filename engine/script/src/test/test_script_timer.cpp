@@ -14,6 +14,7 @@
 #include <jc_test/jc_test.h>
 #include "../script.h"
 #include "../script_timer_private.h"
+#include <dlib/time.h>
 
 #if defined(__NX__)
     #define MOUNTFS "host:/"
@@ -724,6 +725,230 @@ TEST_F(ScriptTimerTest, TestKillTimers)
     dmScript::DeleteTimerWorld(timer_world);
 }
 
+// Records the userdata of the triggered timers, in trigger order
+struct TimerTriggerOrder
+{
+    static uintptr_t userdata[64];
+    static uint32_t count;
+};
+
+uintptr_t TimerTriggerOrder::userdata[64];
+uint32_t TimerTriggerOrder::count = 0;
+
+static void TriggerOrderCallback(dmScript::HTimerWorld timer_world, dmScript::TimerEventType event_type, dmScript::HTimer timer_handle, float time_elapsed, uintptr_t owner, uintptr_t userdata)
+{
+    switch (event_type)
+    {
+        case dmScript::TIMER_EVENT_TRIGGER_WILL_DIE:
+        case dmScript::TIMER_EVENT_TRIGGER_WILL_REPEAT:
+            ++TimerTestCallback::callback_count;
+            ASSERT_GT(64u, TimerTriggerOrder::count);
+            TimerTriggerOrder::userdata[TimerTriggerOrder::count++] = userdata;
+            break;
+        case dmScript::TIMER_EVENT_CANCELLED:
+            ++TimerTestCallback::cancel_count;
+            break;
+    }
+}
+
+TEST_F(ScriptTimerTest, TestEqualDeadlinesTriggerInOrder)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+    TimerTriggerOrder::count = 0;
+
+    // Timers with the same deadline, added at different times and mixed with later timers in the heap
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 2.f, false, TriggerOrderCallback, 0x10, i));
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 3.f, false, TriggerOrderCallback, 0x10, 100 + i));
+    }
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(0u, TimerTestCallback::callback_count);
+
+    for (uint32_t i = 16; i < 32; ++i)
+    {
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 1.f, false, TriggerOrderCallback, 0x10, i));
+    }
+
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(32u, TimerTestCallback::callback_count);
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        ASSERT_EQ(i, TimerTriggerOrder::userdata[i]);
+    }
+
+    // The live timers were moved in the array when the triggered ones were freed, they trigger in array order
+    TimerTriggerOrder::count = 0;
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(48u, TimerTestCallback::callback_count);
+    ASSERT_EQ(16u, TimerTriggerOrder::count);
+    uint32_t triggered = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ASSERT_LE(100u, TimerTriggerOrder::userdata[i]);
+        ASSERT_GT(116u, TimerTriggerOrder::userdata[i]);
+        triggered |= 1u << (TimerTriggerOrder::userdata[i] - 100);
+    }
+    ASSERT_EQ(0xffffu, triggered);
+
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
+TEST_F(ScriptTimerTest, TestCancelInCallbackLeavesNoTrigger)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+    TimerTriggerOrder::count = 0;
+
+    static dmScript::HTimer due_handle = dmScript::INVALID_TIMER_HANDLE;
+    static dmScript::HTimer later_handle = dmScript::INVALID_TIMER_HANDLE;
+    static dmScript::HTimer added_handle = dmScript::INVALID_TIMER_HANDLE;
+
+    struct Callback {
+        static void cb(dmScript::HTimerWorld timer_world, dmScript::TimerEventType event_type, dmScript::HTimer timer_handle, float time_elapsed, uintptr_t owner, uintptr_t userdata)
+        {
+            TriggerOrderCallback(timer_world, event_type, timer_handle, time_elapsed, owner, userdata);
+            if (event_type != dmScript::TIMER_EVENT_CANCELLED && userdata == 0)
+            {
+                // Cancel a timer that is due in this update and one with a later deadline
+                ASSERT_TRUE(dmScript::CancelTimer(timer_world, due_handle));
+                ASSERT_TRUE(dmScript::CancelTimer(timer_world, later_handle));
+                // A timer added with no delay is due, but is not triggered until the next update
+                added_handle = dmScript::AddTimer(timer_world, 0.f, false, TriggerOrderCallback, owner, 4);
+                ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, added_handle);
+            }
+        }
+    };
+
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 1.f, false, Callback::cb, 0x10, 0));
+    due_handle = dmScript::AddTimer(timer_world, 1.f, false, Callback::cb, 0x10, 1);
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, due_handle);
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 1.f, false, Callback::cb, 0x10, 2));
+    later_handle = dmScript::AddTimer(timer_world, 2.f, false, Callback::cb, 0x10, 3);
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, later_handle);
+
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(2u, TimerTestCallback::callback_count);
+    ASSERT_EQ(2u, TimerTestCallback::cancel_count);
+    ASSERT_EQ(0u, TimerTriggerOrder::userdata[0]);
+    ASSERT_EQ(2u, TimerTriggerOrder::userdata[1]);
+    ASSERT_FALSE(dmScript::CancelTimer(timer_world, due_handle));
+    ASSERT_FALSE(dmScript::CancelTimer(timer_world, later_handle));
+    ASSERT_EQ(1u, GetAliveTimers(timer_world));
+
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(3u, TimerTestCallback::callback_count);
+    ASSERT_EQ(4u, TimerTriggerOrder::userdata[2]);
+
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(3u, TimerTestCallback::callback_count);
+
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
+TEST_F(ScriptTimerTest, TestCancelManyInCallback)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+
+    const uint32_t timer_count = 200;
+    static dmScript::HTimer handles[timer_count];
+
+    struct Callback {
+        static void cb(dmScript::HTimerWorld timer_world, dmScript::TimerEventType event_type, dmScript::HTimer timer_handle, float time_elapsed, uintptr_t owner, uintptr_t userdata)
+        {
+            TestCallback(timer_world, event_type, timer_handle, time_elapsed, owner, userdata);
+            if (event_type == dmScript::TIMER_EVENT_TRIGGER_WILL_DIE)
+            {
+                // Leaves more stale heap entries than live ones
+                for (uint32_t i = 0; i < timer_count; ++i)
+                {
+                    if (i % 4 != 0)
+                    {
+                        ASSERT_TRUE(dmScript::CancelTimer(timer_world, handles[i]));
+                    }
+                }
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < timer_count; ++i)
+    {
+        handles[i] = dmScript::AddTimer(timer_world, 2.f + (i % 7), true, TestCallback, 0x10, 0x0);
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, handles[i]);
+    }
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 1.f, false, Callback::cb, 0x10, 0x0));
+
+    dmScript::UpdateTimers(timer_world, 1.f);
+    ASSERT_EQ(1u, TimerTestCallback::callback_count);
+    ASSERT_EQ(150u, TimerTestCallback::cancel_count);
+    ASSERT_EQ(50u, GetAliveTimers(timer_world));
+
+    // Each of the remaining timers repeats once every 2 to 8 seconds
+    uint32_t expected_count = 1;
+    for (uint32_t t = 2; t <= 9; ++t)
+    {
+        dmScript::UpdateTimers(timer_world, 1.f);
+        for (uint32_t i = 0; i < timer_count; i += 4)
+        {
+            uint32_t delay = 2 + (i % 7);
+            expected_count += (t % delay) == 0 ? 1 : 0;
+        }
+        ASSERT_EQ(expected_count, TimerTestCallback::callback_count);
+    }
+
+    ASSERT_EQ(50u, dmScript::KillTimers(timer_world, 0x10));
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
+TEST_F(ScriptTimerTest, TestRepeatTimerDrift)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+
+    // The update steps don't line up with the delay, the timer triggers on the first update at or past each whole second
+    dmScript::HTimer handle = dmScript::AddTimer(timer_world, 1.f, true, TestCallback, 0x10, 0x0);
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, handle);
+
+    const uint32_t expected_count[] = { 0, 1, 2, 3, 3, 4, 5, 6, 6, 7, 8, 9 };
+    const float expected_elapsed[] = { 0.f, 1.5f, 2.75f, 3.75f, 3.75f, 5.25f, 6.5f, 7.5f, 7.5f, 9.f, 10.25f, 11.25f };
+    for (uint32_t i = 0; i < sizeof(expected_count) / sizeof(expected_count[0]); ++i)
+    {
+        dmScript::UpdateTimers(timer_world, 0.75f);
+        ASSERT_EQ(expected_count[i], TimerTestCallback::callback_count);
+        ASSERT_EQ(expected_elapsed[i], TimerTestCallback::elapsed_time);
+    }
+    ASSERT_TRUE(dmScript::CancelTimer(timer_world, handle));
+
+    // Repeating timers are put back in the heap with the next deadline on each trigger.
+    // At 60 updates per second, they keep triggering on the same updates without drifting.
+    ResetTestCallback();
+    TimerTriggerOrder::count = 0;
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 1.f, true, TriggerOrderCallback, 0x10, 0));
+    ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, 2.f, true, TriggerOrderCallback, 0x10, 1));
+
+    const float dt = 1.0f / 60.0f;
+    for (uint32_t frame = 1; frame <= 60 * 20; ++frame)
+    {
+        uint32_t count = TimerTestCallback::callback_count;
+        dmScript::UpdateTimers(timer_world, dt);
+        uint32_t expected = count + ((frame % 60) == 0 ? 1 : 0) + ((frame % 120) == 0 ? 1 : 0);
+        ASSERT_EQ(expected, TimerTestCallback::callback_count);
+    }
+    ASSERT_EQ(30u, TimerTestCallback::callback_count);
+    // When both trigger in the same update, they trigger in the order they were added
+    ASSERT_EQ(0u, TimerTriggerOrder::userdata[1]);
+    ASSERT_EQ(1u, TimerTriggerOrder::userdata[2]);
+
+    ASSERT_EQ(2u, dmScript::KillTimers(timer_world, 0x10));
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
 static bool RunString(lua_State* L, const char* script)
 {
     luaL_loadstring(L, script);
@@ -950,6 +1175,96 @@ TEST_F(ScriptTimerTest, TestLuaRepeating)
     dmScript::DeleteScriptWorld(script_world);
 }
 
+// The previous timer update, that visited every timer on each update. Used as a reference in the benchmark.
+struct LinearTimer
+{
+    float    m_Remaining;
+    float    m_Delay;
+    uint32_t m_IsAlive;
+};
+
+static uint32_t UpdateLinearTimers(LinearTimer* timers, uint32_t count, float dt)
+{
+    uint32_t triggered = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        LinearTimer* timer = &timers[i];
+        if (timer->m_IsAlive == 0)
+        {
+            continue;
+        }
+        timer->m_Remaining -= dt;
+        if (timer->m_Remaining > 0.0f)
+        {
+            continue;
+        }
+        timer->m_IsAlive = 0;
+        ++triggered;
+    }
+    // Second pass that compacts the array
+    uint32_t size = count;
+    uint32_t i = 0;
+    while (i < size)
+    {
+        if (timers[i].m_IsAlive == 0)
+        {
+            timers[i] = timers[--size];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return triggered;
+}
+
+TEST_F(ScriptTimerTest, TestIdleTimersBenchmark)
+{
+    const uint32_t timer_count = 10000;
+    const uint32_t update_count = 1000;
+    const float dt = 1.0f / 60.0f;
+
+    LinearTimer* linear_timers = new LinearTimer[timer_count];
+    for (uint32_t i = 0; i < timer_count; ++i)
+    {
+        linear_timers[i].m_Remaining = 3600.0f + i;
+        linear_timers[i].m_Delay = 3600.0f + i;
+        linear_timers[i].m_IsAlive = 1;
+    }
+
+    uint32_t triggered = 0;
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < update_count; ++i)
+    {
+        triggered += UpdateLinearTimers(linear_timers, timer_count, dt);
+    }
+    uint64_t linear_time = dmTime::GetTime() - start;
+    ASSERT_EQ(0u, triggered);
+    delete [] linear_timers;
+
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+    for (uint32_t i = 0; i < timer_count; ++i)
+    {
+        dmScript::HTimer handle = dmScript::AddTimer(timer_world, 3600.0f + i, false, TestCallback, 0x10, 0x0);
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, handle);
+    }
+
+    start = dmTime::GetTime();
+    for (uint32_t i = 0; i < update_count; ++i)
+    {
+        dmScript::UpdateTimers(timer_world, dt);
+    }
+    uint64_t heap_time = dmTime::GetTime() - start;
+    ASSERT_EQ(0u, TimerTestCallback::callback_count);
+    ASSERT_EQ(timer_count, GetAliveTimers(timer_world));
+
+    printf("UpdateTimers %u idle timers, %u updates: linear scan %7.3f ms, deadline heap %7.3f ms\n",
+        timer_count, update_count, linear_time / 1000.0f, heap_time / 1000.0f);
+
+    ASSERT_EQ(timer_count, dmScript::KillTimers(timer_world, 0x10));
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -159,6 +159,11 @@ TEST_F(ScriptVmathTest, TestVector3Fail)
     ASSERT_FALSE(RunString(L, "local s = vmath.mul_per_elem(1, 1)"));
 }
 
+TEST_F(ScriptVmathTest, TestAllocations)
+{
+    ASSERT_TRUE(RunFile(L, "test_vmath_alloc.luac"));
+}
+
 TEST_F(ScriptVmathTest, TestVector4)
 {
     int top = lua_gettop(L);
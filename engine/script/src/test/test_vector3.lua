@@ -120,4 +120,13 @@ assert(math.abs(v.x - 0.5 * sq2) < 0.000001 and math.abs(v.y + 0.5 * sq2) < 0.00
 v = vmath.mul_per_elem(vmath.vector3(1,2,3), vmath.vector3(5,6,7))
 assert(v.x == 5, "v.x is not 5")
 assert(v.y ==12, "v.y is not 12")
-assert(v.z ==21, "v.z is not 21")
\ No newline at end of file
+assert(v.z ==21, "v.z is not 21")
+-- add_to, sub_to, mul_to
+local out = vmath.vector3()
+local r = vmath.add_to(out, vmath.vector3(1, 2, 3), vmath.vector3(4, 5, 6))
+assert(r == out, "add_to does not return out")
+assert(out.x == 5 and out.y == 7 and out.z == 9, "add_to")
+vmath.sub_to(out, out, vmath.vector3(1, 1, 1))
+assert(out.x == 4 and out.y == 6 and out.z == 8, "sub_to")
+vmath.mul_to(out, out, 0.5)
+assert(out.x == 2 and out.y == 3 and out.z == 4, "mul_to")
@@ -131,3 +131,13 @@ assert(v.x == 5, "v.x is not 5")
 assert(v.y ==12, "v.y is not 12")
 assert(v.z ==21, "v.z is not 21")
 assert(v.w ==32, "v.w is not 32")
+
+-- add_to, sub_to, mul_to
+local out = vmath.vector4()
+local r = vmath.add_to(out, vmath.vector4(1, 2, 3, 4), vmath.vector4(4, 5, 6, 7))
+assert(r == out, "add_to does not return out")
+assert(out.x == 5 and out.y == 7 and out.z == 9 and out.w == 11, "add_to")
+vmath.sub_to(out, out, vmath.vector4(1, 1, 1, 1))
+assert(out.x == 4 and out.y == 6 and out.z == 8 and out.w == 10, "sub_to")
+vmath.mul_to(out, out, 0.5)
+assert(out.x == 2 and out.y == 3 and out.z == 4 and out.w == 5, "mul_to")
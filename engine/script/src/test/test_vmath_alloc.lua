@@ -0,0 +1,57 @@
+-- Copyright 2020 The Defold Foundation
+-- Licensed under the Defold License version 1.0 (the "License"); you may not use
+-- this file except in compliance with the License.
+-- 
+-- You may obtain a copy of the License, together with FAQs at
+-- https://www.defold.com/license
+-- 
+-- Unless required by applicable law or agreed to in writing, software distributed
+-- under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+-- CONDITIONS OF ANY KIND, either express or implied. See the License for the
+-- specific language governing permissions and limitations under the License.
+
+-- Compares the allocations of the operators, which create a new value per call,
+-- with the in-place vmath.*_to functions.
+
+local ITERATIONS = 10000
+
+-- returns the number of bytes allocated per call of fn
+local function bytes_per_op(fn)
+    collectgarbage("collect")
+    collectgarbage("stop")
+    local before = collectgarbage("count")
+    for i = 1, ITERATIONS do
+        fn()
+    end
+    local after = collectgarbage("count")
+    collectgarbage("restart")
+    return (after - before) * 1024 / ITERATIONS
+end
+
+local a = vmath.vector3(1, 2, 3)
+local b = vmath.vector3(4, 5, 6)
+local q = vmath.quat_rotation_z(0.1)
+local out = vmath.vector3()
+local out_q = vmath.quat()
+local r
+
+local results = {
+    { "a + b",                      bytes_per_op(function() r = a + b end) },
+    { "vmath.add_to(out, a, b)",    bytes_per_op(function() vmath.add_to(out, a, b) end) },
+    { "a - b",                      bytes_per_op(function() r = a - b end) },
+    { "vmath.sub_to(out, a, b)",    bytes_per_op(function() vmath.sub_to(out, a, b) end) },
+    { "a * 2",                      bytes_per_op(function() r = a * 2 end) },
+    { "vmath.mul_to(out, a, 2)",    bytes_per_op(function() vmath.mul_to(out, a, 2) end) },
+    { "q * q",                      bytes_per_op(function() r = q * q end) },
+    { "vmath.mul_to(out_q, q, q)",  bytes_per_op(function() vmath.mul_to(out_q, q, q) end) },
+}
+
+for _, result in ipairs(results) do
+    print(string.format("%-28s %6.1f bytes/op", result[1], result[2]))
+end
+
+-- the in-place functions must not allocate
+for i = 2, #results, 2 do
+    assert(results[i][2] < 1, results[i][1] .. " allocates")
+    assert(results[i - 1][2] > 0, results[i - 1][1] .. " does not allocate")
+end